@@ -0,0 +1,92 @@
+#include "bench_support.hpp"
+#include "sysmon/alert_engine.hpp"
+#include <string>
+
+namespace {
+
+sysmon::AlertConfig quiet_alerts() {
+    sysmon::AlertConfig config;
+    config.log_to_file = false;
+    return config;
+}
+
+void BM_CheckCpu(benchmark::State& state) {
+    sysmon::AlertEngine engine(quiet_alerts());
+    sysmon::CpuConfig config;
+    auto snapshot = sysmon::bench::make_snapshot(static_cast<int>(state.range(0)), 0, 0);
+
+    uint64_t before = sysmon::bench::allocations();
+    for (auto _ : state) {
+        auto alerts = engine.check_cpu(snapshot.cpu, config);
+        benchmark::DoNotOptimize(alerts);
+    }
+    sysmon::bench::report_allocations(state, before);
+}
+BENCHMARK(BM_CheckCpu)->Arg(8)->Arg(512);
+
+void BM_CheckDisk(benchmark::State& state) {
+    sysmon::AlertEngine engine(quiet_alerts());
+    sysmon::DiskConfig config;
+    auto snapshot = sysmon::bench::make_snapshot(1, static_cast<int>(state.range(0)), 0);
+    for (const auto& disk : snapshot.disks) {
+        config.mount_points.push_back({disk.mount_point, disk.label, {0.0, 0.0}});
+    }
+
+    uint64_t before = sysmon::bench::allocations();
+    for (auto _ : state) {
+        auto alerts = engine.check_disk(snapshot.disks, config);
+        benchmark::DoNotOptimize(alerts);
+    }
+    sysmon::bench::report_allocations(state, before);
+}
+BENCHMARK(BM_CheckDisk)->Arg(4)->Arg(64);
+
+// N rules over a host with 64 cores, 16 disks and 16 interfaces
+void BM_CheckRules(benchmark::State& state) {
+    auto config = quiet_alerts();
+    const char* exprs[] = {
+        "cpu.iowait > 30 and rate(memory.usage) > 0",
+        "disk.usage > 95",
+        "net.rx_mbps > 900 or net.tx_mbps > 900",
+        "avg_over(cpu.usage, 5) > 85",
+        "core.usage > 99",
+    };
+    for (int i = 0; i < state.range(0); ++i) {
+        sysmon::AlertRuleConfig rule;
+        rule.name = "rule" + std::to_string(i);
+        rule.expr = exprs[i % 5];
+        config.rules.push_back(rule);
+    }
+    sysmon::AlertEngine engine(config);
+    auto snapshot = sysmon::bench::make_snapshot(64, 16, 16);
+
+    uint64_t before = sysmon::bench::allocations();
+    for (auto _ : state) {
+        snapshot.timestamp += std::chrono::seconds(1);
+        auto alerts = engine.check_rules(snapshot);
+        benchmark::DoNotOptimize(alerts);
+    }
+    sysmon::bench::report_allocations(state, before);
+}
+BENCHMARK(BM_CheckRules)->Arg(5)->Arg(50);
+
+void BM_CheckAnomalies(benchmark::State& state) {
+    sysmon::AlertEngine engine(quiet_alerts());
+    sysmon::SysMonConfig config;
+    config.anomaly.enabled = true;
+    config.anomaly.method = "mad";
+    config.anomaly.per_core = true;
+    auto snapshot = sysmon::bench::make_snapshot(static_cast<int>(state.range(0)), 8, 8);
+
+    uint64_t before = sysmon::bench::allocations();
+    for (auto _ : state) {
+        snapshot.timestamp += std::chrono::seconds(1);
+        snapshot.wall_time += std::chrono::seconds(1);
+        auto alerts = engine.check_anomalies(snapshot, config);
+        benchmark::DoNotOptimize(alerts);
+    }
+    sysmon::bench::report_allocations(state, before);
+}
+BENCHMARK(BM_CheckAnomalies)->Arg(8)->Arg(512);
+
+} // namespace
@@ -0,0 +1,170 @@
+#include "bench_support.hpp"
+#include "fake_procfs.hpp"
+#include "sysmon/cpu_topology.hpp"
+#include "sysmon/interrupts.hpp"
+#include "sysmon/perf_events.hpp"
+
+#ifdef __linux__
+
+namespace {
+
+using sysmon::testing::FakeProcfs;
+
+// Parse cost of one /proc/stat read at 4 to 512 cores
+void BM_CollectCpu(benchmark::State& state) {
+    FakeProcfs procfs({.cores = static_cast<int>(state.range(0)), .disks = 0, .interfaces = 0});
+    auto collector = sysmon::create_metrics_collector(procfs.root());
+    procfs.tick(40.0);
+
+    uint64_t before = sysmon::bench::allocations();
+    for (auto _ : state) {
+        auto cpu = collector->collect_cpu();
+        benchmark::DoNotOptimize(cpu);
+    }
+    sysmon::bench::report_allocations(state, before);
+}
+BENCHMARK(BM_CollectCpu)->Arg(4)->Arg(64)->Arg(512);
+
+void BM_CollectMemory(benchmark::State& state) {
+    FakeProcfs procfs({.cores = 1, .disks = 0, .interfaces = 0});
+    auto collector = sysmon::create_metrics_collector(procfs.root());
+
+    uint64_t before = sysmon::bench::allocations();
+    for (auto _ : state) {
+        auto memory = collector->collect_memory();
+        benchmark::DoNotOptimize(memory);
+    }
+    sysmon::bench::report_allocations(state, before);
+}
+BENCHMARK(BM_CollectMemory);
+
+void BM_CollectDisk(benchmark::State& state) {
+    FakeProcfs procfs({.cores = 1, .disks = static_cast<int>(state.range(0)), .interfaces = 0});
+    auto collector = sysmon::create_metrics_collector(procfs.root());
+    auto mounts = procfs.mount_points();
+
+    uint64_t before = sysmon::bench::allocations();
+    for (auto _ : state) {
+        auto disks = collector->collect_disk(mounts);
+        benchmark::DoNotOptimize(disks);
+    }
+    sysmon::bench::report_allocations(state, before);
+}
+BENCHMARK(BM_CollectDisk)->Arg(1)->Arg(16);
+
+void BM_CollectNetwork(benchmark::State& state) {
+    FakeProcfs procfs({.cores = 1, .disks = 0, .interfaces = static_cast<int>(state.range(0))});
+    auto collector = sysmon::create_metrics_collector(procfs.root());
+
+    uint64_t before = sysmon::bench::allocations();
+    for (auto _ : state) {
+        auto nics = collector->collect_network({});
+        benchmark::DoNotOptimize(nics);
+    }
+    sysmon::bench::report_allocations(state, before);
+}
+BENCHMARK(BM_CollectNetwork)->Arg(2)->Arg(64);
+
+// Everything the monitoring loop collects per tick: cores, 4 disks, 8 NICs
+void BM_CollectTick(benchmark::State& state) {
+    FakeProcfs procfs({.cores = static_cast<int>(state.range(0)), .disks = 4, .interfaces = 8});
+    auto collector = sysmon::create_metrics_collector(procfs.root());
+    auto mounts = procfs.mount_points();
+
+    uint64_t before = sysmon::bench::allocations();
+    for (auto _ : state) {
+        sysmon::MetricSnapshot snapshot;
+        snapshot.cpu = collector->collect_cpu();
+        snapshot.memory = collector->collect_memory();
+        snapshot.disks = collector->collect_disk(mounts);
+        snapshot.network = collector->collect_network({});
+        benchmark::DoNotOptimize(snapshot);
+    }
+    sysmon::bench::report_allocations(state, before);
+}
+BENCHMARK(BM_CollectTick)->Arg(8)->Arg(128)->Arg(512);
+
+// Folding a 2-socket, 128-core, 256-thread host's usage into cores and sockets
+void BM_TopologyAggregate(benchmark::State& state) {
+    std::vector<int> packages;
+    std::vector<int> cores;
+    for (int thread = 0; thread < 256; ++thread) {
+        int core = thread % 128;
+        packages.push_back(core / 64);
+        cores.push_back(core % 64);
+    }
+    sysmon::CpuTopology topology(packages, cores);
+    std::vector<double> usage(256);
+    for (size_t i = 0; i < usage.size(); ++i) {
+        usage[i] = static_cast<double>(i % 101);
+    }
+    sysmon::CpuTopologyMetrics metrics;
+
+    for (auto _ : state) {
+        topology.aggregate(usage, metrics);
+        benchmark::DoNotOptimize(metrics);
+    }
+}
+BENCHMARK(BM_TopologyAggregate);
+
+// Both files read and parsed, rates and imbalance; the per-tick cost
+void BM_CollectInterrupts(benchmark::State& state) {
+    FakeProcfs procfs({.cores = static_cast<int>(state.range(0)), .disks = 0, .interfaces = 0});
+    auto collector = sysmon::create_metrics_collector(procfs.root());
+    collector->collect_interrupts();
+    procfs.tick(40.0);
+
+    uint64_t before = sysmon::bench::allocations();
+    for (auto _ : state) {
+        auto interrupts = collector->collect_interrupts();
+        benchmark::DoNotOptimize(interrupts);
+    }
+    sysmon::bench::report_allocations(state, before);
+}
+BENCHMARK(BM_CollectInterrupts)->Arg(4)->Arg(64)->Arg(512);
+
+// Parsing alone: a 512-CPU /proc/interrupts with 64 device rows, mostly padding
+void BM_ParseInterrupts(benchmark::State& state) {
+    constexpr int kCpus = 512;
+    std::string text = "     ";
+    for (int i = 0; i < kCpus; ++i) {
+        std::string name = "CPU" + std::to_string(i);
+        text += std::string(11 - name.size(), ' ') + name;
+    }
+    text += "\n";
+    for (int row = 0; row < 64; ++row) {
+        text += " " + std::to_string(100 + row) + ":";
+        for (int i = 0; i < kCpus; ++i) {
+            std::string count = std::to_string((row * 7919 + i * 104729) % 1000000);
+            text += std::string(11 - count.size(), ' ') + count;
+        }
+        text += "  PCI-MSI 524288-edge      eth0-TxRx-" + std::to_string(row) + "\n";
+    }
+    sysmon::InterruptCounts counts;
+
+    uint64_t before = sysmon::bench::allocations();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sysmon::parse_interrupt_matrix(text, counts));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+    sysmon::bench::report_allocations(state, before);
+}
+BENCHMARK(BM_ParseInterrupts);
+
+// One group read() per CPU plus the rate arithmetic, on the real counters
+void BM_PerfRead(benchmark::State& state) {
+    sysmon::PerfEventGroups groups({0}, {0});
+    if (!groups.available()) {
+        state.SkipWithError("perf counters not permitted");
+        return;
+    }
+    for (auto _ : state) {
+        auto perf = groups.read();
+        benchmark::DoNotOptimize(perf);
+    }
+}
+BENCHMARK(BM_PerfRead);
+
+} // namespace
+
+#endif
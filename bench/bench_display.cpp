@@ -0,0 +1,45 @@
+#include "bench_support.hpp"
+#include "sysmon/display.hpp"
+#include <iostream>
+
+namespace {
+
+// One full dashboard frame, written to a counting null stream
+void BM_RenderFrame(benchmark::State& state) {
+    int cores = static_cast<int>(state.range(0));
+    auto snapshot = sysmon::bench::make_snapshot(cores, 4, 4);
+    sysmon::SysMonConfig config;
+    config.network.enabled = true;
+    std::deque<double> cpu_history(30, 50.0);
+    std::deque<double> memory_history(30, 75.0);
+    sysmon::Alert alert;
+    alert.category = "CPU";
+    alert.message = "CPU usage is 92%";
+    alert.level = sysmon::AlertLevel::Critical;
+    std::vector<sysmon::Alert> alerts(3, alert);
+
+    sysmon::QuantileConfig quantiles;
+    sysmon::SeriesSketches sketches(quantiles);
+    for (int i = 0; i < 300; ++i) {
+        snapshot.timestamp += std::chrono::seconds(1);
+        sketches.observe(snapshot, snapshot.timestamp);
+    }
+
+    sysmon::Display display(config.display);
+    sysmon::bench::NullBuffer sink;
+    auto* saved = std::cout.rdbuf(&sink);
+
+    uint64_t before = sysmon::bench::allocations();
+    for (auto _ : state) {
+        display.render(snapshot.cpu, snapshot.memory, snapshot.disks, snapshot.network, alerts,
+                       cpu_history, memory_history, config.cpu, config.memory, config.disk, config.network,
+                       config.update_interval, &sketches);
+    }
+    sysmon::bench::report_allocations(state, before);
+    std::cout.rdbuf(saved);
+    state.counters["bytes/frame"] = benchmark::Counter(static_cast<double>(sink.bytes()),
+                                                       benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_RenderFrame)->Arg(4)->Arg(64)->Arg(512);
+
+} // namespace
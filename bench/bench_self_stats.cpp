@@ -0,0 +1,29 @@
+#include "bench_support.hpp"
+#include "sysmon/self_stats.hpp"
+
+namespace {
+
+// What every instrumented stage costs: two clock reads and a sketch insert
+void BM_StageScope(benchmark::State& state) {
+    sysmon::SelfStats stats;
+    uint64_t before = sysmon::bench::allocations();
+    for (auto _ : state) {
+        sysmon::SelfStats::Scope timed(&stats, sysmon::Stage::CollectCpu);
+        benchmark::ClobberMemory();
+    }
+    sysmon::bench::report_allocations(state, before);
+}
+BENCHMARK(BM_StageScope);
+
+// Per-tick bookkeeping: the Tick sample plus getrusage and /proc/self/statm
+void BM_TickBookkeeping(benchmark::State& state) {
+    sysmon::SelfStats stats;
+    for (auto _ : state) {
+        stats.begin_tick();
+        stats.end_tick(std::chrono::seconds(1));
+    }
+    benchmark::DoNotOptimize(stats.resident_bytes());
+}
+BENCHMARK(BM_TickBookkeeping);
+
+} // namespace
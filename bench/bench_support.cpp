@@ -0,0 +1,53 @@
+#include "bench_support.hpp"
+#include "sysmon/self_stats.hpp"
+#include <string>
+
+namespace sysmon::bench {
+
+uint64_t allocations() {
+    return thread_heap_allocations();
+}
+
+void report_allocations(benchmark::State& state, uint64_t before) {
+    state.counters["allocs/iter"] = benchmark::Counter(static_cast<double>(allocations() - before),
+                                                       benchmark::Counter::kAvgIterations);
+}
+
+MetricSnapshot make_snapshot(int cores, int disks, int nics) {
+    MetricSnapshot snapshot;
+    snapshot.timestamp = std::chrono::steady_clock::now();
+    snapshot.wall_time = std::chrono::system_clock::now();
+
+    snapshot.cpu.core_count = static_cast<uint32_t>(cores);
+    snapshot.cpu.model_name = "Bench CPU";
+    for (int i = 0; i < cores; ++i) {
+        snapshot.cpu.per_core_usage.push_back(static_cast<double>((i * 37) % 100));
+    }
+    snapshot.cpu.overall_usage = 72.0;
+    snapshot.cpu.iowait_percent = 3.0;
+
+    snapshot.memory.total_bytes = 64ull << 30;
+    snapshot.memory.used_bytes = 48ull << 30;
+    snapshot.memory.available_bytes = 16ull << 30;
+    snapshot.memory.usage_percent = 75.0;
+
+    for (int i = 0; i < disks; ++i) {
+        DiskMetrics disk;
+        disk.mount_point = "/mnt/disk" + std::to_string(i);
+        disk.label = disk.mount_point;
+        disk.total_bytes = 1ull << 40;
+        disk.used_bytes = (1ull << 40) / 100 * static_cast<uint64_t>(50 + i % 50);
+        disk.usage_percent = 50.0 + i % 50;
+        snapshot.disks.push_back(disk);
+    }
+    for (int i = 0; i < nics; ++i) {
+        NetworkMetrics net;
+        net.interface_name = "eth" + std::to_string(i);
+        net.download_mbps = 10.0 * i;
+        net.upload_mbps = 5.0 * i;
+        snapshot.network.push_back(net);
+    }
+    return snapshot;
+}
+
+} // namespace sysmon::bench
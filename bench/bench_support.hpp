@@ -0,0 +1,39 @@
+#pragma once
+
+#include "sysmon/metrics_collector.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <streambuf>
+
+namespace sysmon::bench {
+
+// Heap allocations made so far by the benchmark thread, counted by the
+// operator new hooks in src/alloc_hooks.cpp
+uint64_t allocations();
+
+// Report allocations since `before` as an allocs/iter counter; call after the loop
+void report_allocations(benchmark::State& state, uint64_t before);
+
+// Discards output but counts it, to time rendering without a terminal
+class NullBuffer : public std::streambuf {
+public:
+    uint64_t bytes() const { return bytes_; }
+
+protected:
+    int_type overflow(int_type ch) override {
+        ++bytes_;
+        return traits_type::not_eof(ch);
+    }
+    std::streamsize xsputn(const char*, std::streamsize n) override {
+        bytes_ += static_cast<uint64_t>(n);
+        return n;
+    }
+
+private:
+    uint64_t bytes_ = 0;
+};
+
+// A snapshot with `cores` busy cores, `disks` mounts and `nics` interfaces
+MetricSnapshot make_snapshot(int cores, int disks, int nics);
+
+} // namespace sysmon::bench
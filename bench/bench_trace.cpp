@@ -0,0 +1,54 @@
+#include "bench_support.hpp"
+#include "sysmon/trace.hpp"
+#include <sstream>
+#include <string>
+
+namespace {
+
+// A trace point with tracing off: one relaxed load
+void BM_TraceDisabled(benchmark::State& state) {
+    sysmon::trace::set_enabled(false);
+    int64_t i = 0;
+    for (auto _ : state) {
+        SYSMON_TRACE(Debug, "tick {} of {}", i, 42);
+        ++i;
+    }
+}
+BENCHMARK(BM_TraceDisabled);
+
+// Enabled: a clock read and a 64-byte record, no formatting or I/O
+void BM_TraceEnabled(benchmark::State& state) {
+    sysmon::trace::set_enabled(true);
+    std::string path = "/proc/stat";
+    int64_t i = 0;
+    uint64_t before = sysmon::bench::allocations();
+    for (auto _ : state) {
+        SYSMON_TRACE(Debug, "read {} lines from {} in {} ms", i, path, 0.25);
+        ++i;
+    }
+    sysmon::bench::report_allocations(state, before);
+    sysmon::trace::set_enabled(false);
+    std::ostringstream discard;
+    sysmon::trace::drain(discard);
+}
+BENCHMARK(BM_TraceEnabled);
+
+// The deferred half: formatting a full ring
+void BM_TraceDrain(benchmark::State& state) {
+    sysmon::trace::set_enabled(true);
+    std::ostringstream out;
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (size_t i = 0; i < sysmon::trace::kRingRecords; ++i) {
+            SYSMON_TRACE(Debug, "read {} lines from {}", i, "/proc/stat");
+        }
+        out.str({});
+        state.ResumeTiming();
+        sysmon::trace::drain(out);
+    }
+    sysmon::trace::set_enabled(false);
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * sysmon::trace::kRingRecords));
+}
+BENCHMARK(BM_TraceDrain);
+
+} // namespace
@@ -2,9 +2,12 @@
 
 #include "sysmon/config_manager.hpp"
 #include "sysmon/metrics_collector.hpp"
+#include "sysmon/rule_engine.hpp"
+#include "sysmon/anomaly_detector.hpp"
+#include "sysmon/log_sink.hpp"
 #include <vector>
 #include <chrono>
-#include <fstream>
+#include <memory>
 
 namespace sysmon {
 
@@ -15,10 +18,14 @@ enum class AlertLevel {
 };
 
 struct Alert {
-    std::string category;    // "CPU", "Memory", "Disk"
+    std::string category;    // "CPU", "Memory", "Disk", "Scheduler", "Interrupts", "NUMA", "Rule", "Anomaly"
     std::string message;     // "CPU usage is 92%"
     AlertLevel level;
     std::chrono::system_clock::time_point timestamp;
+    std::chrono::steady_clock::time_point monotonic;
+    std::string entity;      // "/var", "eth0", "core 3"; empty for host-wide alerts
+    double value = 0.0;      // measured value that triggered the alert
+    double threshold = 0.0;  // threshold it crossed
 };
 
 class AlertEngine {
@@ -30,10 +37,23 @@ public:
     std::vector<Alert> check_cpu(const CpuMetrics& metrics, const CpuConfig& config);
     std::vector<Alert> check_memory(const MemoryMetrics& metrics, const MemoryConfig& config);
     std::vector<Alert> check_disk(const std::vector<DiskMetrics>& metrics, const DiskConfig& config);
+    std::vector<Alert> check_topology(const CpuTopologyMetrics& metrics, const CpuConfig& config);
+    std::vector<Alert> check_scheduler(const SchedulerMetrics& metrics, const SchedulerConfig& config);
+    std::vector<Alert> check_interrupts(const InterruptMetrics& metrics, const InterruptConfig& config);
+    std::vector<Alert> check_numa(const NumaMetrics& metrics, const NumaConfig& config);
     
-    // Log alerts to file
+    // Evaluate user-defined rules from alerts.rules
+    std::vector<Alert> check_rules(const MetricSnapshot& snapshot);
+    
+    // Compare each series against its learned baseline (anomaly section)
+    std::vector<Alert> check_anomalies(const MetricSnapshot& snapshot, const SysMonConfig& config);
+    
+    // Queue alert for the background log writer (never blocks)
     void log_alert(const Alert& alert);
     
+    // Alerts the log writer had no queue room for, across reopens
+    uint64_t log_records_dropped() const;
+    
     // Trigger system beep (optional)
     void beep_if_enabled();
     
@@ -42,10 +62,14 @@ public:
 
 private:
     AlertLevel determine_level(double value, const ThresholdConfig& thresholds);
-    std::string format_timestamp(const std::chrono::system_clock::time_point& tp);
+    void open_log();
+    void compile_rules();
     
     AlertConfig alert_config_;
-    std::ofstream log_file_;
+    std::unique_ptr<LogSink> log_sink_;
+    uint64_t closed_sinks_dropped_ = 0;
+    RuleEngine rule_engine_;
+    AnomalyDetector anomaly_detector_;
 };
 
 } // namespace sysmon
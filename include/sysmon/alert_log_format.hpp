@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace sysmon {
+
+enum class AlertLevel;
+
+// On-disk alert log encodings (alerts.log_format)
+enum class LogFormat {
+    Text,       // [2024-01-01 12:00:00] WARNING - CPU: CPU usage: 91.0% ...
+    JsonLines,  // one flat JSON object per line
+    Binary      // file magic, then length-prefixed little-endian records
+};
+
+bool parse_log_format(const std::string& name, LogFormat& out);
+
+// One decoded log entry. String fields point into the source buffer (or a
+// caller-provided scratch buffer when JSON escapes had to be undone).
+struct AlertLogEntry {
+    int64_t timestamp_us = 0;    // wall clock, microseconds since epoch
+    int64_t monotonic_ns = 0;    // steady clock, for ordering / rate math
+    double value = 0.0;
+    double threshold = 0.0;
+    AlertLevel level;
+    std::string_view category;
+    std::string_view entity;
+    std::string_view message;
+};
+
+// Binary layout:
+//   file:    kBinaryLogMagic (8 bytes) record*
+//   record:  u16 payload_len, payload
+//   payload: i64 timestamp_us, i64 monotonic_ns, f64 value, f64 threshold,
+//            u8 level, u8 category_len, u8 entity_len, u16 message_len,
+//            category, entity, message
+constexpr char kBinaryLogMagic[8] = {'S', 'M', 'O', 'N', 'L', 'O', 'G', '1'};
+constexpr size_t kBinaryLogFixedBytes = 8 + 8 + 8 + 8 + 1 + 1 + 1 + 2;
+
+bool has_binary_log_magic(const char* data, size_t size);
+
+// Format of an existing log from its first bytes: binary if it starts with
+// the magic, JSON lines if with '{', otherwise text
+LogFormat detect_log_format(const char* data, size_t size);
+
+const char* log_level_name(AlertLevel level);
+bool parse_log_level(std::string_view name, AlertLevel& out);
+
+// Caches the formatted "[YYYY-mm-dd HH:MM:SS] " prefix across a second
+class TimestampFormatter {
+public:
+    std::string_view prefix(int64_t timestamp_us);
+
+private:
+    int64_t second_ = INT64_MIN;
+    char buffer_[32] = {};
+    size_t length_ = 0;
+};
+
+// Quoted, escaped JSON string
+void append_json_string(std::string& out, std::string_view text);
+
+void append_text(std::string& out, const AlertLogEntry& entry, TimestampFormatter& timestamps);
+void append_jsonl(std::string& out, const AlertLogEntry& entry);
+void append_binary(std::string& out, const AlertLogEntry& entry);
+
+// Decode one binary record from [data, data + size). Returns bytes consumed,
+// 0 if more data is needed, or SIZE_MAX if the record is corrupt.
+size_t decode_binary(const char* data, size_t size, AlertLogEntry& out);
+
+// Parse one JSON line written by append_jsonl(); scratch holds unescaped text
+bool decode_jsonl(std::string_view line, AlertLogEntry& out, std::string& scratch);
+
+} // namespace sysmon
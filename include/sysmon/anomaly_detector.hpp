@@ -0,0 +1,126 @@
+#pragma once
+
+#include "sysmon/config_manager.hpp"
+#include "sysmon/metrics_collector.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sysmon {
+
+struct Alert;
+
+enum class AnomalyMethod {
+    Ewma,       // exponentially weighted mean / variance
+    Mad,        // rolling median / median absolute deviation
+    Seasonal    // per time-of-period baseline learned over previous periods
+};
+
+bool parse_anomaly_method(const std::string& name, AnomalyMethod& out);
+
+// Identifies one metric stream, e.g. {"core", 3} or {"disk", 0, "/var"}
+struct SeriesKey {
+    std::string group;       // "cpu", "memory", "core", "disk", "net.rx", ...
+    uint32_t index = 0;      // core number (or 0)
+    std::string name;        // mount point / interface (or empty)
+
+    bool operator==(const SeriesKey& other) const = default;
+    std::string display_name() const;
+};
+
+struct SeriesKeyHash {
+    size_t operator()(const SeriesKey& key) const;
+};
+
+// Online statistics for one series. Fixed size: no allocation after creation,
+// constant work per sample (the median window has a fixed length).
+class SeriesStats {
+public:
+    static constexpr size_t kWindow = 32;
+    static constexpr size_t kMaxSeasonBuckets = 48;
+
+    struct Score {
+        bool ready = false;      // enough history to judge
+        double baseline = 0.0;   // expected value
+        double z = 0.0;          // deviation in (robust) standard deviations
+    };
+
+    // Score x against the state *before* x, then fold x in
+    Score observe(double x, int64_t wall_seconds, AnomalyMethod method, const AnomalyConfig& config);
+
+private:
+    Score score_ewma(double x, const AnomalyConfig& config) const;
+    Score score_mad(double x, const AnomalyConfig& config);
+    Score score_seasonal(double x, int bucket) const;
+    void update_ewma(double x, double alpha);
+    void update_window(double x);
+    void update_seasonal(double x, int bucket, int64_t cycle, double alpha);
+
+    // EWMA / EWMV
+    double mean_ = 0.0;
+    double var_ = 0.0;
+    uint32_t count_ = 0;
+
+    // Rolling median / MAD
+    std::array<float, kWindow> ring_{};
+    std::array<float, kWindow> sorted_{};
+    uint8_t ring_pos_ = 0;
+    uint8_t filled_ = 0;
+
+    // Seasonal baseline: per-bucket mean/variance learned across cycles
+    // from the completed bucket of each cycle
+    std::array<float, kMaxSeasonBuckets> season_mean_{};
+    std::array<float, kMaxSeasonBuckets> season_var_{};
+    std::array<uint16_t, kMaxSeasonBuckets> season_cycles_{};
+    int current_bucket_ = -1;
+    int64_t current_cycle_ = -1;
+    double bucket_sum_ = 0.0;
+    double bucket_sumsq_ = 0.0;
+    uint32_t bucket_n_ = 0;
+};
+
+// Tracks every series the monitor feeds it and reports anomalies. Once
+// max_series are tracked, a new series takes the place of one that missed
+// the previous tick; with none to spare it is counted in dropped_series().
+class AnomalyDetector {
+public:
+    // Apply a (validated) config; learned state is discarded when the
+    // method or the seasonal period changes
+    void configure(const AnomalyConfig& config);
+
+    // Feed one sample; appends an alert if it is anomalous
+    void observe(const SeriesKey& key, double value, std::chrono::system_clock::time_point wall_time,
+                 std::vector<Alert>& alerts);
+
+    // Feed the standard host series of a snapshot (enabled sections only),
+    // as one tick; applies config first if it changed
+    void observe_snapshot(const MetricSnapshot& snapshot, const SysMonConfig& config, std::vector<Alert>& alerts);
+
+    size_t series_count() const { return series_.size(); }
+    uint64_t dropped_series() const { return dropped_; }
+    void reset();
+
+private:
+    struct Series {
+        SeriesKey key;
+        SeriesStats stats;
+        uint64_t last_tick = 0;
+    };
+
+    Series* find(const SeriesKey& key);
+    size_t stale_slot() const;
+
+    std::vector<Series> series_;
+    std::unordered_map<SeriesKey, size_t, SeriesKeyHash> index_;
+    size_t cursor_ = 0;     // series are usually fed in the same order every tick
+    uint64_t tick_ = 0;
+    uint64_t dropped_ = 0;
+
+    AnomalyConfig config_;
+    AnomalyMethod method_ = AnomalyMethod::Mad;
+};
+
+} // namespace sysmon
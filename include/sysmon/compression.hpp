@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace sysmon {
+
+// Block codecs for shipped metric batches. Which ones are usable depends on
+// the libraries found at build time (see codec_available()).
+enum class Codec : uint8_t {
+    None = 0,
+    Zstd = 1,
+    Lz4 = 2,
+    Zlib = 3
+};
+
+bool parse_codec(const std::string& name, Codec& out);
+const char* codec_name(Codec codec);
+bool codec_available(Codec codec);
+
+// Append the compressed form of input to out
+bool compress_block(Codec codec, std::string_view input, std::string& out);
+
+// Append raw_size decompressed bytes to out; false on corrupt input
+bool decompress_block(Codec codec, std::string_view input, size_t raw_size, std::string& out);
+
+} // namespace sysmon
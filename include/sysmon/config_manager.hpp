@@ -1,11 +1,14 @@
 #pragma once
 
+#include "sysmon/config_watcher.hpp"
 #include <typiconf/typiconf.hpp>
 #include <string>
 #include <vector>
 #include <optional>
 #include <filesystem>
 #include <chrono>
+#include <atomic>
+#include <memory>
 
 namespace sysmon {
 
@@ -13,6 +16,8 @@ struct ThresholdConfig {
     double warning = 70.0;
     double critical = 90.0;
     
+    bool operator==(const ThresholdConfig&) const = default;
+    
     bool validate() const {
         return warning >= 0.0 && warning <= 100.0 &&
                critical >= 0.0 && critical <= 100.0 &&
@@ -30,12 +35,23 @@ struct CpuConfig {
     ThresholdConfig thresholds;
     bool show_per_core = true;
     bool show_model_name = true;
+    double core_saturation = 95.0;                  // a physical core's mean thread usage counted as saturated
+    ThresholdConfig saturated_cores{50.0, 80.0};    // share of a package's physical cores saturated
+    
+    bool operator==(const CpuConfig&) const = default;
+    
+    bool validate() const {
+        return thresholds.validate() && saturated_cores.validate() &&
+               core_saturation > 0.0 && core_saturation <= 100.0;
+    }
     
     TYPICONF_DEFINE_FIELDS(CpuConfig,
         TYPICONF_FIELD(enabled),
         TYPICONF_FIELD(thresholds),
         TYPICONF_FIELD(show_per_core),
-        TYPICONF_FIELD(show_model_name)
+        TYPICONF_FIELD(show_model_name),
+        TYPICONF_FIELD(core_saturation),
+        TYPICONF_FIELD(saturated_cores)
     )
 };
 
@@ -45,6 +61,8 @@ struct MemoryConfig {
     bool show_swap = true;
     bool show_model_name = true;
     
+    bool operator==(const MemoryConfig&) const = default;
+    
     TYPICONF_DEFINE_FIELDS(MemoryConfig,
         TYPICONF_FIELD(enabled),
         TYPICONF_FIELD(thresholds),
@@ -56,7 +74,12 @@ struct MemoryConfig {
 struct MountPointConfig {
     std::string path;
     std::string label;
-    ThresholdConfig thresholds;  // required
+    ThresholdConfig thresholds{0.0, 0.0};  // unset (0/0) inherits disk.thresholds
+    
+    bool operator==(const MountPointConfig&) const = default;
+    
+    bool inherits_thresholds() const { return thresholds.warning == 0.0 && thresholds.critical == 0.0; }
+    bool validate() const { return !path.empty() && (inherits_thresholds() || thresholds.validate()); }
     
     TYPICONF_DEFINE_FIELDS(MountPointConfig,
         TYPICONF_FIELD(path),
@@ -70,13 +93,24 @@ struct DiskConfig {
     ThresholdConfig thresholds;
     std::vector<MountPointConfig> mount_points;
     bool show_model_name = true;
+    double forecast_horizon_hours = 24.0;   // warn when projected full within this (0 = off)
+    double forecast_critical_hours = 2.0;   // critical when projected full within this
+    int forecast_window_minutes = 60;       // time constant of the usage trend
+    
+    bool operator==(const DiskConfig&) const = default;
     
     TYPICONF_DEFINE_FIELDS(DiskConfig,
         TYPICONF_FIELD(enabled),
         TYPICONF_FIELD(thresholds),
         TYPICONF_FIELD(mount_points),
-        TYPICONF_FIELD(show_model_name)
+        TYPICONF_FIELD(show_model_name),
+        TYPICONF_FIELD(forecast_horizon_hours),
+        TYPICONF_FIELD(forecast_critical_hours),
+        TYPICONF_FIELD(forecast_window_minutes)
     )
+    
+    // The mount's own thresholds unless it inherits (0/0) or is not listed
+    const ThresholdConfig& thresholds_for(const std::string& mount_point) const;
 };
 
 struct NetworkConfig {
@@ -86,6 +120,8 @@ struct NetworkConfig {
     std::vector<std::string> interfaces;
     bool show_model_name = true;
     
+    bool operator==(const NetworkConfig&) const = default;
+    
     TYPICONF_DEFINE_FIELDS(NetworkConfig,
         TYPICONF_FIELD(enabled),
         TYPICONF_FIELD(upload_mbps),
@@ -95,17 +131,114 @@ struct NetworkConfig {
     )
 };
 
+// Run queue and blocked task alerts (Linux /proc/stat); thresholds are
+// counts, not percentages
+struct SchedulerConfig {
+    bool enabled = true;
+    ThresholdConfig run_queue_per_core{2.0, 4.0};   // runnable tasks per logical processor
+    ThresholdConfig blocked_tasks{8.0, 32.0};       // tasks in uninterruptible sleep
+    
+    bool operator==(const SchedulerConfig&) const = default;
+    
+    bool validate() const {
+        auto valid = [](const ThresholdConfig& t) { return t.warning >= 0.0 && t.warning < t.critical; };
+        return valid(run_queue_per_core) && valid(blocked_tasks);
+    }
+    
+    TYPICONF_DEFINE_FIELDS(SchedulerConfig,
+        TYPICONF_FIELD(enabled),
+        TYPICONF_FIELD(run_queue_per_core),
+        TYPICONF_FIELD(blocked_tasks)
+    )
+};
+
+// Per-node memory and allocation locality (Linux /sys/devices/system/node)
+struct NumaConfig {
+    bool enabled = true;
+    ThresholdConfig thresholds{85.0, 95.0};        // a node's memory usage
+    ThresholdConfig remote_percent{30.0, 60.0};    // share of a node's allocations made from other nodes
+    double min_allocs_per_sec = 1000.0;            // page allocations below which locality is not reported
+    
+    bool operator==(const NumaConfig&) const = default;
+    
+    bool validate() const {
+        return thresholds.validate() && remote_percent.validate() && min_allocs_per_sec >= 0.0;
+    }
+    
+    TYPICONF_DEFINE_FIELDS(NumaConfig,
+        TYPICONF_FIELD(enabled),
+        TYPICONF_FIELD(thresholds),
+        TYPICONF_FIELD(remote_percent),
+        TYPICONF_FIELD(min_allocs_per_sec)
+    )
+};
+
+// Per-CPU interrupt and softirq rates (Linux /proc/interrupts, /proc/softirqs)
+struct InterruptConfig {
+    bool enabled = true;
+    double imbalance_warning = 4.0;     // busiest CPU's device interrupt rate over the mean
+    double imbalance_critical = 8.0;
+    double min_rate = 10000.0;          // device interrupts/s below which imbalance is not reported
+    
+    bool operator==(const InterruptConfig&) const = default;
+    
+    bool validate() const {
+        return imbalance_warning >= 1.0 && imbalance_warning < imbalance_critical && min_rate >= 0.0;
+    }
+    
+    TYPICONF_DEFINE_FIELDS(InterruptConfig,
+        TYPICONF_FIELD(enabled),
+        TYPICONF_FIELD(imbalance_warning),
+        TYPICONF_FIELD(imbalance_critical),
+        TYPICONF_FIELD(min_rate)
+    )
+};
+
+// Per-CPU perf_event_open counters (Linux); needs CAP_PERFMON or
+// kernel.perf_event_paranoid <= 0
+struct PerfConfig {
+    bool enabled = false;
+    
+    bool operator==(const PerfConfig&) const = default;
+    
+    TYPICONF_DEFINE_FIELDS(PerfConfig,
+        TYPICONF_FIELD(enabled)
+    )
+};
+
 struct DisplayConfig {
     std::string color_scheme = "default";
     int refresh_rate = 1;
     bool show_graphs = true;
     int graph_height = 10;
+    bool show_self_stats = true;   // sysmon's own cost above the footer
+    
+    bool operator==(const DisplayConfig&) const = default;
     
     TYPICONF_DEFINE_FIELDS(DisplayConfig,
         TYPICONF_FIELD(color_scheme),
         TYPICONF_FIELD(refresh_rate),
         TYPICONF_FIELD(show_graphs),
-        TYPICONF_FIELD(graph_height)
+        TYPICONF_FIELD(graph_height),
+        TYPICONF_FIELD(show_self_stats)
+    )
+};
+
+struct AlertRuleConfig {
+    std::string name;
+    std::string expr;              // e.g. "cpu.iowait > 30 and rate(memory.usage) > 0"
+    std::string level = "warning"; // warning, critical
+    std::string match;             // glob on entity (mount point, label, interface, core)
+    std::string message;
+    
+    bool operator==(const AlertRuleConfig&) const = default;
+    
+    TYPICONF_DEFINE_FIELDS(AlertRuleConfig,
+        TYPICONF_FIELD(name),
+        TYPICONF_FIELD(expr),
+        TYPICONF_FIELD(level),
+        TYPICONF_FIELD(match),
+        TYPICONF_FIELD(message)
     )
 };
 
@@ -114,12 +247,236 @@ struct AlertConfig {
     bool beep_on_critical = false;
     bool log_to_file = true;
     std::string log_path = "./sysmon.log";
+    std::string log_format = "text";   // text, jsonl, binary
+    int log_queue_size = 4096;         // records buffered for the writer thread
+    int log_flush_interval_ms = 1000;  // group commit at least this often
+    int log_flush_kb = 64;             // ...or once this much is pending
+    int log_max_size_mb = 10;          // rotate above this size (0 = never)
+    int log_max_files = 5;             // rotated files kept
+    bool log_compress = true;          // gzip rotated files
+    std::vector<AlertRuleConfig> rules;
+    
+    bool operator==(const AlertConfig&) const = default;
+    
+    // Every rule compiles; errors receives "rule 'name': reason" for each
+    // one that does not. Defined with compile_rule() in rule_engine.cpp
+    bool validate(std::vector<std::string>* errors = nullptr) const;
     
     TYPICONF_DEFINE_FIELDS(AlertConfig,
         TYPICONF_FIELD(enabled),
         TYPICONF_FIELD(beep_on_critical),
         TYPICONF_FIELD(log_to_file),
-        TYPICONF_FIELD(log_path)
+        TYPICONF_FIELD(log_path),
+        TYPICONF_FIELD(log_format),
+        TYPICONF_FIELD(log_queue_size),
+        TYPICONF_FIELD(log_flush_interval_ms),
+        TYPICONF_FIELD(log_flush_kb),
+        TYPICONF_FIELD(log_max_size_mb),
+        TYPICONF_FIELD(log_max_files),
+        TYPICONF_FIELD(log_compress),
+        TYPICONF_FIELD(rules)
+    )
+};
+
+struct AnomalyConfig {
+    bool enabled = false;
+    std::string method = "mad";        // ewma, mad, seasonal
+    double ewma_alpha = 0.05;          // weight of the newest sample (ewma)
+    double z_warning = 4.0;            // deviation in standard deviations
+    double z_critical = 6.0;
+    double min_deviation = 5.0;        // ignore smaller absolute deviations (metric units)
+    int warmup_samples = 30;           // samples before a series is judged
+    int seasonal_period_minutes = 1440;
+    int seasonal_buckets = 24;
+    bool per_core = false;             // also track every logical CPU
+    int max_series = 4096;             // hard cap on tracked series
+    
+    bool operator==(const AnomalyConfig&) const = default;
+    
+    // Defined with parse_anomaly_method() in anomaly_detector.cpp
+    bool validate() const;
+    
+    TYPICONF_DEFINE_FIELDS(AnomalyConfig,
+        TYPICONF_FIELD(enabled),
+        TYPICONF_FIELD(method),
+        TYPICONF_FIELD(ewma_alpha),
+        TYPICONF_FIELD(z_warning),
+        TYPICONF_FIELD(z_critical),
+        TYPICONF_FIELD(min_deviation),
+        TYPICONF_FIELD(warmup_samples),
+        TYPICONF_FIELD(seasonal_period_minutes),
+        TYPICONF_FIELD(seasonal_buckets),
+        TYPICONF_FIELD(per_core),
+        TYPICONF_FIELD(max_series)
+    )
+};
+
+// Streaming percentiles per series (QuantileSketch)
+struct QuantileConfig {
+    bool enabled = true;
+    double relative_accuracy = 0.01;   // quantile error relative to the value
+    int max_bins = 2048;               // per sketch
+    int window_seconds = 300;          // sliding window the percentiles cover
+    int window_slots = 10;             // window moves in steps of window / slots
+    
+    bool operator==(const QuantileConfig&) const = default;
+    
+    bool validate() const {
+        return relative_accuracy > 0.0 && relative_accuracy < 1.0 && max_bins > 0 &&
+               window_seconds > 0 && window_slots > 0;
+    }
+    
+    TYPICONF_DEFINE_FIELDS(QuantileConfig,
+        TYPICONF_FIELD(enabled),
+        TYPICONF_FIELD(relative_accuracy),
+        TYPICONF_FIELD(max_bins),
+        TYPICONF_FIELD(window_seconds),
+        TYPICONF_FIELD(window_slots)
+    )
+};
+
+struct ExporterConfig {
+    bool enabled = false;
+    std::string listen_address = "127.0.0.1";
+    int port = 9101;
+    std::string path = "/metrics";
+    int max_connections = 64;
+    
+    bool operator==(const ExporterConfig&) const = default;
+    
+    bool validate() const {
+        return port >= 0 && port <= 65535 && !path.empty() && path[0] == '/' && max_connections > 0;
+    }
+    
+    TYPICONF_DEFINE_FIELDS(ExporterConfig,
+        TYPICONF_FIELD(enabled),
+        TYPICONF_FIELD(listen_address),
+        TYPICONF_FIELD(port),
+        TYPICONF_FIELD(path),
+        TYPICONF_FIELD(max_connections)
+    )
+};
+
+struct QueryConfig {
+    bool enabled = false;
+    std::string socket_path = "./sysmon.sock";
+    int history_points = 3600;         // samples kept per series for range queries
+    int max_connections = 64;
+    
+    bool operator==(const QueryConfig&) const = default;
+    
+    bool validate() const {
+        return !socket_path.empty() && history_points > 0 && max_connections > 0;
+    }
+    
+    TYPICONF_DEFINE_FIELDS(QueryConfig,
+        TYPICONF_FIELD(enabled),
+        TYPICONF_FIELD(socket_path),
+        TYPICONF_FIELD(history_points),
+        TYPICONF_FIELD(max_connections)
+    )
+};
+
+struct ShmConfig {
+    bool enabled = false;
+    std::string name = "/sysmon";      // POSIX shared memory object name
+    
+    bool operator==(const ShmConfig&) const = default;
+    
+    bool validate() const {
+        return name.size() > 1 && name[0] == '/' && name.find('/', 1) == std::string::npos;
+    }
+    
+    TYPICONF_DEFINE_FIELDS(ShmConfig,
+        TYPICONF_FIELD(enabled),
+        TYPICONF_FIELD(name)
+    )
+};
+
+struct PushConfig {
+    bool enabled = false;
+    std::string endpoint = "127.0.0.1:9102";   // host:port of the receiver
+    std::string transport = "tcp";             // tcp, udp
+    std::string format = "binary";             // binary, line
+    std::string compression = "none";          // none, zstd, lz4, zlib
+    int batch_interval_ms = 10000;             // samples per message window
+    std::string host;                          // empty = gethostname()
+    std::string spool_path = "./sysmon.spool";
+    int spool_max_mb = 64;                     // 0 disables spooling
+    int queue_size = 256;                      // snapshots waiting for the I/O thread
+    
+    bool operator==(const PushConfig&) const = default;
+    
+    bool validate() const {
+        auto colon = endpoint.rfind(':');
+        return colon != std::string::npos && colon > 0 && colon + 1 < endpoint.size() &&
+               (transport == "tcp" || transport == "udp") &&
+               (format == "binary" || format == "line") &&
+               (compression == "none" || compression == "zstd" || compression == "lz4" || compression == "zlib") &&
+               batch_interval_ms > 0 && spool_max_mb >= 0 && queue_size > 0;
+    }
+    
+    TYPICONF_DEFINE_FIELDS(PushConfig,
+        TYPICONF_FIELD(enabled),
+        TYPICONF_FIELD(endpoint),
+        TYPICONF_FIELD(transport),
+        TYPICONF_FIELD(format),
+        TYPICONF_FIELD(compression),
+        TYPICONF_FIELD(batch_interval_ms),
+        TYPICONF_FIELD(host),
+        TYPICONF_FIELD(spool_path),
+        TYPICONF_FIELD(spool_max_mb),
+        TYPICONF_FIELD(queue_size)
+    )
+};
+
+struct FlightRecorderConfig {
+    bool enabled = true;
+    int minutes = 10;                       // history kept in memory, at every update
+    std::string directory = ".";            // where dumps are written
+    bool dump_on_critical = true;
+    int min_dump_interval_seconds = 300;    // between alert-triggered dumps
+    
+    bool operator==(const FlightRecorderConfig&) const = default;
+    
+    bool validate() const {
+        return minutes > 0 && minutes <= 24 * 60 && !directory.empty() && min_dump_interval_seconds >= 0;
+    }
+    
+    TYPICONF_DEFINE_FIELDS(FlightRecorderConfig,
+        TYPICONF_FIELD(enabled),
+        TYPICONF_FIELD(minutes),
+        TYPICONF_FIELD(directory),
+        TYPICONF_FIELD(dump_on_critical),
+        TYPICONF_FIELD(min_dump_interval_seconds)
+    )
+};
+
+// Used by --aggregate mode only
+struct AggregatorConfig {
+    std::string listen_address = "0.0.0.0";
+    int port = 9102;                   // TCP and UDP
+    int max_connections = 2048;
+    int max_hosts = 10000;
+    int history_points = 300;          // samples kept per host
+    int stale_seconds = 30;            // host counts as down after this silence
+    int top_n = 10;
+    
+    bool operator==(const AggregatorConfig&) const = default;
+    
+    bool validate() const {
+        return port >= 0 && port <= 65535 && max_connections > 0 && max_hosts > 0 &&
+               history_points > 0 && stale_seconds > 0 && top_n > 0;
+    }
+    
+    TYPICONF_DEFINE_FIELDS(AggregatorConfig,
+        TYPICONF_FIELD(listen_address),
+        TYPICONF_FIELD(port),
+        TYPICONF_FIELD(max_connections),
+        TYPICONF_FIELD(max_hosts),
+        TYPICONF_FIELD(history_points),
+        TYPICONF_FIELD(stale_seconds),
+        TYPICONF_FIELD(top_n)
     )
 };
 
@@ -128,12 +485,28 @@ struct SysMonConfig {
     int update_interval = 2;
     int history_size = 30;
     bool debug_logging = false;  // debug option
+    std::string trace_path;      // where debug_logging traces go; empty = stderr
+    std::string fs_root;         // prefix for /proc and /sys; empty = /
     CpuConfig cpu;
     MemoryConfig memory;
     DiskConfig disk;
     NetworkConfig network;
+    SchedulerConfig scheduler;
+    InterruptConfig interrupts;
+    NumaConfig numa;
+    PerfConfig perf;
     DisplayConfig display;
     AlertConfig alerts;
+    AnomalyConfig anomaly;
+    QuantileConfig quantiles;
+    ExporterConfig exporter;
+    QueryConfig query;
+    ShmConfig shm;
+    PushConfig push;
+    FlightRecorderConfig flight_recorder;
+    AggregatorConfig aggregator;
+    
+    bool operator==(const SysMonConfig&) const = default;
     
     bool validate() const;
     
@@ -142,29 +515,80 @@ struct SysMonConfig {
         TYPICONF_FIELD(update_interval),
         TYPICONF_FIELD(history_size),
         TYPICONF_FIELD(debug_logging),
+        TYPICONF_FIELD(trace_path),
+        TYPICONF_FIELD(fs_root),
         TYPICONF_FIELD(cpu),
         TYPICONF_FIELD(memory),
         TYPICONF_FIELD(disk),
         TYPICONF_FIELD(network),
+        TYPICONF_FIELD(scheduler),
+        TYPICONF_FIELD(interrupts),
+        TYPICONF_FIELD(numa),
+        TYPICONF_FIELD(perf),
         TYPICONF_FIELD(display),
-        TYPICONF_FIELD(alerts)
+        TYPICONF_FIELD(alerts),
+        TYPICONF_FIELD(anomaly),
+        TYPICONF_FIELD(quantiles),
+        TYPICONF_FIELD(exporter),
+        TYPICONF_FIELD(query),
+        TYPICONF_FIELD(shm),
+        TYPICONF_FIELD(push),
+        TYPICONF_FIELD(flight_recorder),
+        TYPICONF_FIELD(aggregator)
     )
 };
 
+// An immutable config; reloads publish a new one instead of editing it
+using ConfigSnapshot = std::shared_ptr<const SysMonConfig>;
+
+// What a reload changed, so that only the affected components are touched
+// and the rest keep their state (histories, rule rates, open files, sockets)
+struct ConfigDiff {
+    bool collector = false;   // fs_root, which the collector is built with
+    bool display = false;
+    bool alerts = false;
+    bool services = false;    // quantiles, exporter, query, shm, push, flight_recorder
+    std::vector<std::string> sections;   // changed top-level keys, in file order
+    
+    bool empty() const { return sections.empty(); }
+};
+
+ConfigDiff diff_configs(const SysMonConfig& before, const SysMonConfig& after);
+
 class ConfigManager {
 public:
     explicit ConfigManager(const std::string& config_path);
     
     bool load(); // load + hot-reload
+    
+    // Reload if the file changed. A config that fails to parse or validate
+    // is reported and the current one stays in effect (returns false).
     bool check_and_reload();
     
-    const SysMonConfig& get_config() const { return config_; }
+    // Sleep between ticks, returning early when the config file changes so
+    // the next check_and_reload() applies it at once
+    bool wait_for_change(std::chrono::milliseconds timeout) { return watcher_.wait(timeout); }
+    
+    // The current config, safe to take from any thread and to hold across
+    // reloads: a reload parses and validates into a fresh snapshot and only
+    // then swaps the pointer, so readers never wait on the parse and never
+    // see a half-applied config. The swap is an atomic shared_ptr store,
+    // which the standard library may implement with a brief internal lock.
+    ConfigSnapshot snapshot() const { return config_.load(std::memory_order_acquire); }
+    
+    // Shorthand for the reloading thread; the reference is only valid until
+    // the next load()
+    const SysMonConfig& get_config() const { return *snapshot(); }
     bool validate_config(std::string& error_msg) const;
 
 private:
+    ConfigSnapshot parse();
+    bool reload();
+    
     std::string config_path_;
-    SysMonConfig config_;
+    std::atomic<ConfigSnapshot> config_;
     std::filesystem::file_time_type last_modified_;
+    ConfigWatcher watcher_;
 };
 
 } // namespace sysmon
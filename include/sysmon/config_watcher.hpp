@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+namespace sysmon {
+
+// Change notification for one file. On Linux this is an inotify watch on the
+// file's directory, so a file replaced by rename (editors, config management)
+// is seen as well as one rewritten in place, whatever its mtime. A symlinked
+// path is re-resolved on every event in its directory, so a retargeted link
+// (a Kubernetes ConfigMap swapping ..data) counts as a change, and the
+// target's own directory is watched too. Elsewhere, or if inotify is
+// unavailable, is_active() is false and callers poll.
+class ConfigWatcher {
+public:
+    explicit ConfigWatcher(const std::string& path);
+    ~ConfigWatcher();
+
+    ConfigWatcher(const ConfigWatcher&) = delete;
+    ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+    bool is_active() const { return fd_ >= 0; }
+
+    // Block for up to timeout; returns true as soon as the file changes.
+    // Returns false on timeout or when a signal interrupts the wait.
+    bool wait(std::chrono::milliseconds timeout);
+
+    // Whether a change was seen by wait() since the last call; no syscalls
+    bool take_change();
+
+private:
+    bool drain();
+    // Re-resolve path_ and move the target watch; true if the target changed
+    bool retarget();
+
+    int fd_ = -1;
+    std::string path_;
+    std::string name_;
+    int link_wd_ = -1;
+    std::string target_;        // canonical path_ as last resolved
+    std::string target_name_;
+    int target_wd_ = -1;        // -1 while the target shares path_'s directory
+    bool pending_ = false;
+};
+
+} // namespace sysmon
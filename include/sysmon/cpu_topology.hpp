@@ -0,0 +1,44 @@
+#pragma once
+
+#include "sysmon/metrics_collector.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace sysmon {
+
+// Which package and physical core each logical processor belongs to, as
+// /sys/devices/system/cpu/cpu*/topology describes it. Built once; folding
+// a tick's per-thread usage up the hierarchy is then one pass over
+// precomputed indices, with no lookups or sorting.
+class CpuTopology {
+public:
+    CpuTopology() = default;
+
+    // package_ids[i] and core_ids[i] are the sysfs physical_package_id and
+    // core_id of logical processor i (the i-th cpu line of /proc/stat)
+    CpuTopology(const std::vector<int>& package_ids, const std::vector<int>& core_ids);
+
+    bool empty() const { return core_of_.empty(); }
+    size_t threads() const { return core_of_.size(); }
+    size_t cores() const { return core_threads_.size(); }
+    size_t packages() const { return package_cores_.size(); }
+    uint32_t threads_per_core() const { return threads_per_core_; }
+
+    // Dense physical core and package index of a logical processor
+    uint32_t core_of(size_t thread) const { return core_of_[thread]; }
+    uint32_t package_of(size_t thread) const { return package_of_[thread]; }
+
+    // Fill out from one tick's per-thread usage; leaves it unavailable when
+    // the number of threads no longer matches (CPU hotplug)
+    void aggregate(const std::vector<double>& per_thread_usage, CpuTopologyMetrics& out) const;
+
+private:
+    std::vector<uint32_t> core_of_;          // per thread
+    std::vector<uint32_t> package_of_;       // per thread
+    std::vector<uint32_t> core_threads_;     // per physical core
+    std::vector<uint32_t> package_cores_;    // per package
+    std::vector<uint32_t> package_threads_;  // per package
+    uint32_t threads_per_core_ = 1;
+};
+
+} // namespace sysmon
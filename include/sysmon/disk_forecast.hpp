@@ -0,0 +1,67 @@
+#pragma once
+
+#include "sysmon/config_manager.hpp"
+#include "sysmon/metrics_collector.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sysmon {
+
+// Linear trend of one mount's used bytes over time. Exponentially weighted
+// least squares kept as running weighted means and co-moments, so each
+// sample costs O(1) and no history is stored. Residuals beyond a few mean
+// absolute deviations are down-weighted (Huber) so a single burst does not
+// swing the estimate.
+class CapacityTrend {
+public:
+    static constexpr uint32_t kMinSamples = 10;
+
+    // Fold in one sample; window_seconds is the time constant of the decay
+    void add(double t_seconds, double used_bytes, double total_bytes, double window_seconds);
+
+    // Bytes per second (positive while filling)
+    double slope() const;
+
+    // Seconds until used reaches total_bytes, or -1 if unknown / not filling
+    double seconds_to_full(double t_seconds, double total_bytes) const;
+
+    uint32_t samples() const { return samples_; }
+    void reset();
+
+private:
+    double predict(double t_seconds) const;
+
+    double weight_ = 0.0;       // decayed sum of sample weights
+    double mean_t_ = 0.0;
+    double mean_y_ = 0.0;
+    double c_tt_ = 0.0;         // weighted co-moments about the means
+    double c_ty_ = 0.0;
+    double scale_ = 0.0;        // weighted mean absolute residual
+    double scale_weight_ = 0.0;
+    double last_t_ = 0.0;
+    double last_y_ = 0.0;
+    uint32_t samples_ = 0;
+};
+
+// Keeps a CapacityTrend per mount point and publishes time-to-full
+class DiskForecaster {
+public:
+    // Update trends from this tick and fill DiskMetrics::seconds_to_full
+    void update(std::vector<DiskMetrics>& disks, std::chrono::steady_clock::time_point now,
+                const DiskConfig& config);
+
+private:
+    struct Entry {
+        CapacityTrend trend;
+        uint64_t seen = 0;
+    };
+
+    std::unordered_map<std::string, Entry> trends_;
+    std::chrono::steady_clock::time_point origin_;
+    uint64_t tick_ = 0;
+};
+
+} // namespace sysmon
@@ -3,6 +3,9 @@
 #include "sysmon/config_manager.hpp"
 #include "sysmon/metrics_collector.hpp"
 #include "sysmon/alert_engine.hpp"
+#include "sysmon/fleet_state.hpp"
+#include "sysmon/quantile_sketch.hpp"
+#include "sysmon/self_stats.hpp"
 #include <deque>
 #include <string>
 
@@ -24,24 +27,44 @@ public:
                 const MemoryConfig& memory_config,
                 const DiskConfig& disk_config,
                 const NetworkConfig& network_config,
-                int update_interval);
+                int update_interval,
+                const SeriesSketches* sketches = nullptr,
+                const SelfStats* self_stats = nullptr);
+    
+    // Fleet view for --aggregate mode
+    void render_fleet(const FleetSummary& fleet,
+                      const CpuConfig& cpu_config,
+                      const MemoryConfig& memory_config,
+                      const DiskConfig& disk_config);
     
     // Update configuration (for hot-reload)
     void update_config(const DisplayConfig& config);
 
 private:
-    void render_header();
+    void render_header(const std::string& title = "SYSMON");
     void render_cpu(const CpuMetrics& cpu, const CpuConfig& cpu_config);
+    void render_perf(const PerfMetrics& perf);
+    void render_topology(const CpuTopologyMetrics& topology, const CpuConfig& cpu_config, bool per_core);
+    void render_scheduler(const SchedulerMetrics& scheduler);
+    void render_interrupts(const InterruptMetrics& interrupts);
     void render_memory(const MemoryMetrics& memory, const MemoryConfig& memory_config);
+    void render_numa(const NumaMetrics& numa, const ThresholdConfig& thresholds);
     void render_disks(const std::vector<DiskMetrics>& disks, const DiskConfig& disk_config);
     void render_network(const std::vector<NetworkMetrics>& network, const NetworkConfig& network_config);
     void render_alerts(const std::vector<Alert>& alerts);
-    void render_history(const std::deque<double>& cpu_history, const std::deque<double>& memory_history, int update_interval);
+    void render_history(const std::deque<double>& cpu_history, const std::deque<double>& memory_history, int update_interval,
+                        const SeriesSketches* sketches);
+    void render_percentiles(const std::string& label, const SeriesSketches& sketches, std::string_view series);
+    void render_self_stats(const SelfStats& stats);
     void render_footer();
+    void render_fleet_stats(const std::string& label, const FleetStats& stats, const ThresholdConfig& thresholds);
+    void render_fleet_hosts(const std::string& title, const std::vector<FleetHostRow>& rows,
+                            float FleetSample::*metric, const ThresholdConfig& thresholds);
     
     // Helper rendering functions
     std::string create_progress_bar(double percentage, int width, AlertLevel level);
     std::string create_graph(const std::deque<double>& data, int height);
+    std::string create_usage_strip(const std::vector<double>& usage, size_t first, size_t count, const CpuConfig& cpu_config);
     AlertLevel get_alert_level(double value, const ThresholdConfig& thresholds);
     
     // Color helpers (ANSI escape codes)
@@ -55,6 +78,8 @@ private:
 
 // Helper functions for formatting
 std::string format_bytes(uint64_t bytes);
+std::string format_duration(double seconds);
+std::string format_rate(double per_second);
 std::string alert_icon(AlertLevel level);
 
 } // namespace sysmon
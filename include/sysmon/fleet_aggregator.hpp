@@ -0,0 +1,74 @@
+#pragma once
+
+#include "sysmon/config_manager.hpp"
+#include "sysmon/fleet_state.hpp"
+#include "sysmon/wire_format.hpp"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sysmon {
+
+// Receiver for push messages from many sysmon instances (--aggregate mode).
+// One epoll thread accepts TCP streams and UDP datagrams on the same port,
+// decodes binary batches and feeds them into a FleetState.
+class FleetAggregator {
+public:
+    FleetAggregator(const AggregatorConfig& config, const QuantileConfig& quantiles);
+    ~FleetAggregator();
+
+    FleetAggregator(const FleetAggregator&) = delete;
+    FleetAggregator& operator=(const FleetAggregator&) = delete;
+
+    bool is_running() const { return server_.joinable(); }
+    const AggregatorConfig& config() const { return config_; }
+    uint16_t port() const { return port_; }
+
+    // Expires silent hosts, then summarizes; called by the display thread
+    FleetSummary summary();
+    bool history(const std::string& host, std::vector<FleetSample>& out);
+
+    uint64_t messages() const { return messages_.load(std::memory_order_relaxed); }
+    uint64_t rejected() const { return rejected_.load(std::memory_order_relaxed); }
+
+private:
+    struct Connection;
+
+    void server_loop();
+    void accept_clients();
+    void handle_readable(Connection& conn);
+    void receive_datagrams();
+    bool process_message(const PushHeader& header, const char* payload);
+    void close_connection(Connection& conn);
+
+    AggregatorConfig config_;
+    uint16_t port_ = 0;
+    int listen_fd_ = -1;
+    int udp_fd_ = -1;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+
+    std::vector<Connection> connections_;
+    std::vector<size_t> free_connections_;
+
+    // Server thread only
+    std::string raw_;
+    std::string host_;
+    std::vector<MetricSnapshot> decoded_;
+    WireDecoder decoder_;
+    std::vector<char> datagram_;
+    bool warned_format_ = false;
+    bool warned_hosts_ = false;
+
+    std::mutex state_mutex_;
+    FleetState state_;
+
+    std::atomic<uint64_t> messages_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::thread server_;
+};
+
+} // namespace sysmon
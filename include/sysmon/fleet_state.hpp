@@ -0,0 +1,135 @@
+#pragma once
+
+#include "sysmon/metrics_collector.hpp"
+#include "sysmon/quantile_sketch.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sysmon {
+
+// One pushed sample as kept per host by the aggregator
+struct FleetSample {
+    int64_t timestamp_ms = 0;
+    float cpu = 0.0f;                  // 0-100%
+    float memory = 0.0f;               // 0-100%
+    float disk = 0.0f;                 // fullest mount, 0-100%
+    float net_mbps = 0.0f;             // rx + tx over all interfaces
+};
+
+struct FleetHostRow {
+    std::string host;
+    FleetSample latest;
+    double age_seconds = 0.0;          // since the last message from the host
+};
+
+// Distribution of the latest per-host values over hosts that are up
+struct FleetStats {
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+    double mean = 0.0;
+};
+
+struct FleetSummary {
+    size_t hosts_total = 0;
+    size_t hosts_up = 0;
+    uint64_t samples = 0;              // ingested since start
+    FleetStats cpu;
+    FleetStats memory;
+    FleetStats disk;
+    int window_seconds = 0;            // 0 when quantile sketches are disabled
+    FleetStats cpu_window;             // every sample of every host in the window
+    FleetStats memory_window;
+    std::vector<FleetHostRow> top_cpu;
+    std::vector<FleetHostRow> top_memory;
+    std::vector<FleetHostRow> top_disk;
+    std::vector<FleetHostRow> stale;   // longest silent first
+};
+
+// Per-host ring buffers plus fleet rollups, updated incrementally on every
+// sample: percentiles come from a fixed 0.1% histogram and top-N from an
+// ordered set, so neither needs a pass over all hosts. Each host also keeps
+// windowed sketches of CPU and memory, merged on summary() into fleet-wide
+// percentiles over time. Not thread-safe.
+class FleetState {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    FleetState(size_t history_points, std::chrono::seconds stale_after, size_t max_hosts,
+               const QuantileConfig& quantiles = {});
+
+    // False if the host is new and max_hosts is reached
+    bool ingest(const std::string& host, const MetricSnapshot& snapshot, Clock::time_point now);
+
+    // Take hosts silent for longer than stale_after out of the rollups
+    void expire(Clock::time_point now);
+
+    FleetSummary summary(size_t top_n, Clock::time_point now) const;
+
+    size_t host_count() const { return hosts_.size(); }
+
+    // Oldest first
+    bool history(const std::string& host, std::vector<FleetSample>& out) const;
+
+private:
+    static constexpr size_t kBuckets = 1001;
+
+    class Rollup {
+    public:
+        void insert(uint32_t host, float value);
+        void remove(uint32_t host, float value);
+        FleetStats stats() const;
+        size_t size() const { return ordered_.size(); }
+
+        // Highest values first
+        template<typename Fn>
+        void top(size_t n, Fn&& fn) const {
+            for (auto it = ordered_.rbegin(); it != ordered_.rend() && n > 0; ++it, --n) {
+                fn(it->second);
+            }
+        }
+
+    private:
+        static size_t bucket(float value);
+
+        std::array<uint32_t, kBuckets> counts_{};
+        std::set<std::pair<float, uint32_t>> ordered_;
+        double sum_ = 0.0;
+    };
+
+    struct Host {
+        std::string name;
+        std::vector<FleetSample> ring;
+        size_t head = 0;
+        size_t size = 0;
+        FleetSample latest;
+        Clock::time_point last_seen;
+        bool up = false;
+        std::optional<WindowedSketch> cpu_window;
+        std::optional<WindowedSketch> memory_window;
+    };
+
+    void add_to_rollups(uint32_t id);
+    void remove_from_rollups(uint32_t id);
+    FleetHostRow row(uint32_t id, Clock::time_point now) const;
+
+    size_t history_points_;
+    std::chrono::seconds stale_after_;
+    size_t max_hosts_;
+    QuantileConfig quantiles_;
+    std::vector<Host> hosts_;
+    std::unordered_map<std::string, uint32_t> index_;
+    Rollup cpu_;
+    Rollup memory_;
+    Rollup disk_;
+    uint64_t samples_ = 0;
+};
+
+} // namespace sysmon
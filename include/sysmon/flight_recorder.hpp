@@ -0,0 +1,94 @@
+#pragma once
+
+#include "sysmon/config_manager.hpp"
+#include "sysmon/metrics_collector.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sysmon {
+
+// Always-on, in-memory history of every metric at full sampling resolution
+// (flight_recorder section). Each tick is packed into one fixed-size record
+// in a ring allocated up front: percentages as 0.01% fixed point, byte
+// counters as-is, rates as floats. Names and models are kept once, in a
+// template snapshot. A change in the set of cores, disks or interfaces
+// starts a new ring; the old one is kept as a segment with its own template
+// and retired record by record as the new ring fills, so a window across a
+// hotplug is never lost. A dump copies the records and writes them as a
+// recording (see recording.hpp) on a worker thread, so it can be replayed
+// with --replay. Used from the sampling thread only.
+class FlightRecorder {
+public:
+    FlightRecorder(const FlightRecorderConfig& config, int update_interval_seconds);
+    ~FlightRecorder();
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    const FlightRecorderConfig& config() const { return config_; }
+    int update_interval() const { return update_interval_; }
+
+    // Pack one snapshot, overwriting the oldest once full
+    void record(const MetricSnapshot& snapshot);
+
+    // The recorded snapshots, oldest first
+    std::vector<MetricSnapshot> snapshots() const;
+
+    // Start writing what is recorded to <directory>/sysmon-flight-<time>-<reason>.smr,
+    // with a -2, -3, ... suffix if that file exists.
+    // Returns the path, or an empty string if there is nothing to write or
+    // the previous dump is still being written.
+    std::string dump(const std::string& reason);
+
+    // Dump for a critical alert unless dump_on_critical is off or the last
+    // such dump was less than min_dump_interval_seconds before now
+    std::string dump_on_critical(std::chrono::steady_clock::time_point now);
+
+    // Block until the dump in progress, if any, is written
+    void wait();
+
+    size_t capacity() const { return capacity_; }
+    size_t size() const { return count_ + previous_count_; }
+    size_t record_bytes() const { return record_bytes_; }
+    uint64_t dumps() const { return dumps_; }
+
+private:
+    // Records sharing one template, oldest first
+    struct Segment {
+        MetricSnapshot shape;
+        size_t record_bytes = 0;
+        std::vector<unsigned char> records;
+        size_t first = 0;    // records before this were retired
+        size_t count = 0;
+    };
+
+    bool same_shape(const MetricSnapshot& snapshot) const;
+    void reshape(const MetricSnapshot& snapshot);
+    // The live ring's records, unrolled oldest first
+    Segment live_segment() const;
+    // Every recorded segment, oldest first
+    std::vector<Segment> segments() const;
+
+    FlightRecorderConfig config_;
+    int update_interval_;
+    size_t capacity_;
+    MetricSnapshot shape_;              // names and models, no values
+    size_t record_bytes_ = 0;
+    std::vector<unsigned char> ring_;   // capacity_ records
+    size_t head_ = 0;                   // next record written
+    size_t count_ = 0;
+    std::deque<Segment> previous_;      // earlier shapes, still in the window
+    size_t previous_count_ = 0;
+    bool have_last_critical_dump_ = false;
+    std::chrono::steady_clock::time_point last_critical_dump_;
+    uint64_t dumps_ = 0;
+    std::atomic<bool> writing_{false};
+    std::thread writer_;
+};
+
+} // namespace sysmon
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "sysmon/metrics_collector.hpp"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace sysmon {
+
+// Per-CPU column sums of a /proc/interrupts or /proc/softirqs matrix
+struct InterruptCounts {
+    std::vector<uint64_t> total;     // every row
+    std::vector<uint64_t> devices;   // numbered rows: device IRQs, which affinity steers
+    std::vector<uint64_t> net;       // NET_RX and NET_TX rows (softirqs)
+};
+
+// Sum the rows of a matrix whose header names one CPU per column. Runs of
+// padding are skipped a word at a time, since on wide hosts most of the
+// file is spaces. The vectors are resized, not reallocated, between calls
+// with the same width. Returns the number of columns, 0 without a header.
+size_t parse_interrupt_matrix(std::string_view text, InterruptCounts& out);
+
+// Rates between two readings of each file. imbalance compares the busiest
+// CPU's device interrupt rate with the mean over all CPUs.
+InterruptMetrics interrupt_rates(const InterruptCounts& irq_before, const InterruptCounts& irq_after,
+                                 const InterruptCounts& softirq_before, const InterruptCounts& softirq_after,
+                                 double seconds);
+
+} // namespace sysmon
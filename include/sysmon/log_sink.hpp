@@ -0,0 +1,87 @@
+#pragma once
+
+#include "sysmon/alert_log_format.hpp"
+#include "sysmon/mpsc_queue.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace sysmon {
+
+struct Alert;
+enum class AlertLevel;
+
+struct LogSinkOptions {
+    std::string path;
+    LogFormat format = LogFormat::Text;
+    size_t queue_size = 4096;                    // records
+    std::chrono::milliseconds flush_interval{1000};
+    size_t flush_bytes = 64 * 1024;              // group commit threshold
+    uint64_t max_file_bytes = 0;                 // rotate when exceeded (0 = never)
+    int max_files = 5;                           // rotated files kept
+    bool compress_rotated = true;                // gzip rotated files (if built with zlib)
+};
+
+// Fixed-size record copied into the queue by the sampling thread.
+// Encoding (text / JSON / binary) happens on the writer thread.
+struct LogRecord {
+    int64_t timestamp_us = 0;                    // system_clock since epoch
+    int64_t monotonic_ns = 0;                    // steady_clock since epoch
+    double value = 0.0;
+    double threshold = 0.0;
+    AlertLevel level;
+    uint8_t category_len = 0;
+    uint8_t entity_len = 0;
+    uint8_t message_len = 0;
+    char category[16];
+    char entity[48];
+    char message[200];
+};
+
+// Background alert log writer. submit() is lock-free and never blocks; a
+// dedicated thread drains the queue, batches lines and commits them to disk
+// by size or time, rotating the file when it grows past max_file_bytes.
+class LogSink {
+public:
+    explicit LogSink(const LogSinkOptions& options);
+    ~LogSink();
+
+    LogSink(const LogSink&) = delete;
+    LogSink& operator=(const LogSink&) = delete;
+
+    bool is_open() const { return file_ != nullptr; }
+
+    // Returns false if the queue is full (record dropped)
+    bool submit(const Alert& alert);
+
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    void writer_loop();
+    void drain();
+    void encode_record(const LogRecord& record);
+    void commit();
+    void rotate();
+
+    LogSinkOptions options_;
+    MpscQueue<LogRecord> queue_;
+    std::FILE* file_ = nullptr;
+    uint64_t file_bytes_ = 0;
+    std::string buffer_;
+    std::chrono::steady_clock::time_point last_commit_;
+
+    TimestampFormatter timestamps_;
+
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<bool> stopping_{false};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::thread writer_;
+};
+
+} // namespace sysmon
@@ -4,34 +4,107 @@
 #include <string>
 #include <memory>
 #include <cstdint>
+#include <chrono>
 #include <iostream>
 
 namespace sysmon {
 
 struct SysMonConfig;
-class DebugLogger {
-public:
-    static void set_enabled(bool enabled) { enabled_ = enabled; }
-    static bool is_enabled() { return enabled_; }
-    
-    template<typename... Args>
-    static void log(Args&&... args) {
-        if (enabled_) {
-            std::cerr << "[DEBUG] ";
-            ((std::cerr << args), ...);
-            std::cerr << std::endl;
-        }
-    }
-    
-private:
-    static bool enabled_;
+using ConfigSnapshot = std::shared_ptr<const SysMonConfig>;
+// Hardware and software event rates (per second) over the last tick
+struct PerfCounters {
+    bool available = true;                   // false if the counters never ran during the tick
+    double cycles = 0.0;
+    double instructions = 0.0;
+    double cache_references = 0.0;
+    double cache_misses = 0.0;
+    double context_switches = 0.0;
+    double cpu_migrations = 0.0;
+    double page_faults = 0.0;
+    double ipc = 0.0;                        // instructions per cycle; 0 without a PMU
+    double cache_miss_percent = 0.0;         // of cache references
+};
+
+struct PerfMetrics {
+    bool available = false;                  // counters are open (perf section enabled and permitted)
+    bool hardware = false;                   // PMU events counted, not just software ones
+    PerfCounters total;
+    std::vector<PerfCounters> per_cpu;       // Indexed like per_core_usage
+    std::vector<PerfCounters> per_socket;    // By package, numbered in package id order
+};
+
+// Kernel activity and run queue, from the /proc/stat read that yields
+// CpuMetrics and from /proc/loadavg; rates are per second over the last tick
+struct SchedulerMetrics {
+    bool available = false;
+    double context_switches_per_sec = 0.0;
+    double interrupts_per_sec = 0.0;
+    double softirqs_per_sec = 0.0;
+    double forks_per_sec = 0.0;
+    uint32_t procs_running = 0;              // Runnable tasks, including sysmon
+    uint32_t procs_blocked = 0;              // Tasks in uninterruptible sleep, mostly on I/O
+    uint32_t threads = 0;                    // Scheduling entities in existence
+    double run_queue_per_core = 0.0;         // Other runnable tasks per logical processor
+    double load1 = 0.0;
+    double load5 = 0.0;
+    double load15 = 0.0;
+};
+
+// Interrupt load per logical processor (/proc/interrupts, /proc/softirqs),
+// per second over the last tick; vectors are indexed like per_core_usage
+struct InterruptMetrics {
+    bool available = false;
+    std::vector<double> irq_per_cpu;          // Device interrupts
+    std::vector<double> softirq_per_cpu;      // All softirqs
+    std::vector<double> net_softirq_per_cpu;  // NET_RX + NET_TX
+    double irq_total = 0.0;
+    double softirq_total = 0.0;
+    double net_softirq_total = 0.0;
+    double imbalance = 0.0;                   // Busiest CPU's device interrupt rate over the mean; 1 = even
+    int busiest_cpu = -1;
+};
+
+// Per-thread usage folded up package -> physical core -> SMT thread.
+// Physical cores are numbered package by package, so package p owns the
+// package_cores[p] cores that follow those of the packages before it
+struct CpuTopologyMetrics {
+    bool available = false;
+    uint32_t threads_per_core = 1;           // Most SMT siblings on any core
+    std::vector<double> core_usage;          // Per physical core: mean of its threads
+    std::vector<uint32_t> package_cores;     // Physical cores per package
+    std::vector<double> package_usage;       // Per package: mean of its threads
 };
 
 struct CpuMetrics {
     double overall_usage = 0.0;              // 0-100%
+    double iowait_percent = 0.0;             // 0-100%, time idle waiting on I/O
     std::vector<double> per_core_usage;      // Per logical processor (thread) percentages
     uint32_t core_count = 0;                 // Number of logical processors (threads)
     std::string model_name;                  // CPU model name
+    PerfMetrics perf;                        // Only with the perf section enabled
+    SchedulerMetrics scheduler;
+    InterruptMetrics interrupts;             // Only with the interrupts section enabled
+    CpuTopologyMetrics topology;             // Where sysfs describes the topology
+};
+
+// One NUMA node: its memory, its share of CPU and where its allocations land
+struct NumaNodeMetrics {
+    int node = 0;
+    std::vector<int> cpus;                   // Logical processors on the node
+    uint64_t total_bytes = 0;
+    uint64_t available_bytes = 0;            // Free plus reclaimable page cache and slab
+    uint64_t used_bytes = 0;
+    double usage_percent = 0.0;
+    double cpu_usage = 0.0;                  // Mean usage of the node's logical processors
+    double local_allocs_per_sec = 0.0;       // Pages allocated here by tasks running here
+    double remote_allocs_per_sec = 0.0;      // Pages allocated here by tasks on other nodes
+    double miss_allocs_per_sec = 0.0;        // Pages meant for this node that went elsewhere
+    double remote_percent = 0.0;             // remote / (local + remote)
+};
+
+struct NumaMetrics {
+    bool available = false;
+    std::vector<NumaNodeMetrics> nodes;
 };
 
 struct MemoryMetrics {
@@ -43,6 +116,7 @@ struct MemoryMetrics {
     uint64_t swap_total_bytes = 0;
     uint64_t swap_used_bytes = 0;
     std::string model_name;                  // Memory model/manufacturer
+    NumaMetrics numa;
 };
 
 struct DiskMetrics {
@@ -52,6 +126,8 @@ struct DiskMetrics {
     uint64_t used_bytes = 0;
     double usage_percent = 0.0;
     std::string model_name;                  // Disk model name
+    double seconds_to_full = -1.0;           // Projected from the usage trend; < 0 if not filling
+    double growth_bytes_per_sec = 0.0;
 };
 
 struct NetworkMetrics {
@@ -63,20 +139,85 @@ struct NetworkMetrics {
     std::string model_name;                  // Network adapter model
 };
 
+// Everything collected during one tick of the monitoring loop
+struct MetricSnapshot {
+    CpuMetrics cpu;
+    MemoryMetrics memory;
+    std::vector<DiskMetrics> disks;
+    std::vector<NetworkMetrics> network;
+    std::chrono::steady_clock::time_point timestamp;
+    std::chrono::system_clock::time_point wall_time;
+};
+
+// Call fn(name, value) for each named series of a snapshot. Names follow the
+// rule variables: cpu.usage, cpu.iowait, memory.usage, swap.usage,
+// disk.usage:<mount>, net.rx_mbps:<interface>, net.tx_mbps:<interface>.
+// key is scratch space for building names without allocating per call.
+template<typename Fn>
+void for_each_series(const MetricSnapshot& snapshot, std::string& key, Fn&& fn) {
+    if (snapshot.cpu.core_count > 0) {
+        key = "cpu.usage";
+        fn(key, snapshot.cpu.overall_usage);
+        key = "cpu.iowait";
+        fn(key, snapshot.cpu.iowait_percent);
+    }
+    if (snapshot.memory.total_bytes > 0) {
+        key = "memory.usage";
+        fn(key, snapshot.memory.usage_percent);
+        key = "swap.usage";
+        double swap = snapshot.memory.swap_total_bytes > 0
+            ? 100.0 * snapshot.memory.swap_used_bytes / snapshot.memory.swap_total_bytes : 0.0;
+        fn(key, swap);
+    }
+    for (const auto& disk : snapshot.disks) {
+        key = "disk.usage:";
+        key += disk.mount_point;
+        fn(key, disk.usage_percent);
+    }
+    for (const auto& net : snapshot.network) {
+        key = "net.rx_mbps:";
+        key += net.interface_name;
+        fn(key, net.download_mbps);
+        key = "net.tx_mbps:";
+        key += net.interface_name;
+        fn(key, net.upload_mbps);
+    }
+}
+
 class MetricsCollector {
 public:
     virtual ~MetricsCollector() = default;
     
-    // Set config for debug logging
-    virtual void set_config(const SysMonConfig* config) = 0;
+    // The collector keeps the snapshot it is given
+    virtual void set_config(ConfigSnapshot config) = 0;
     
     virtual CpuMetrics collect_cpu() = 0;
     virtual MemoryMetrics collect_memory() = 0;
     virtual std::vector<DiskMetrics> collect_disk(const std::vector<std::string>& mount_points) = 0;
     virtual std::vector<NetworkMetrics> collect_network(const std::vector<std::string>& interfaces) = 0;
+    
+    // Counters are opened on the first call with the perf section enabled
+    // and closed once it is disabled; not available on every platform
+    virtual PerfMetrics collect_perf() { return {}; }
+    
+    // Rates since the previous call; not available on every platform
+    virtual InterruptMetrics collect_interrupts() { return {}; }
+    
+    // Per-node memory and allocation rates since the previous call; cpu_usage
+    // is left for numa_cpu_usage(). Not available on every platform
+    virtual NumaMetrics collect_numa() { return {}; }
+    
+    // Logical processor number of each per_core_usage entry, ascending; CPUs
+    // taken offline leave gaps. Empty when entry i is simply CPU i
+    virtual const std::vector<int>& online_cpus() const {
+        static const std::vector<int> none;
+        return none;
+    }
 };
 
-// Factory function
-std::unique_ptr<MetricsCollector> create_metrics_collector();
+// Factory function. fs_root prefixes every /proc and /sys path read on Linux
+// (a host's filesystem mounted into a container, or a test fixture); empty
+// means the real root. Ignored on other platforms.
+std::unique_ptr<MetricsCollector> create_metrics_collector(const std::string& fs_root = "");
 
 } // namespace sysmon
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "sysmon/config_manager.hpp"
+#include "sysmon/metrics_collector.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sysmon {
+
+struct Alert;
+class SeriesSketches;
+class SelfStats;
+
+// Append the snapshot in OpenMetrics text format (terminated by "# EOF"),
+// with per-series window percentiles as a summary when sketches are given
+// and sysmon_self_* families when self stats are
+void render_openmetrics(std::string& out, const MetricSnapshot& snapshot, const std::vector<Alert>& alerts,
+                        const SeriesSketches* sketches = nullptr, const SelfStats* self = nullptr);
+
+// Embedded HTTP endpoint for Prometheus-style scrapers (exporter section).
+// The page is rendered once per tick by publish(); a single epoll thread
+// serves every scrape straight from that buffer, so scrape cost does not
+// depend on scrape frequency and the sampling loop never waits on clients.
+class MetricsExporter {
+public:
+    explicit MetricsExporter(const ExporterConfig& config);
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    bool is_running() const { return server_.joinable(); }
+    const ExporterConfig& config() const { return config_; }
+
+    // Port actually bound (useful with port 0)
+    uint16_t port() const { return port_; }
+
+    // Render the latest snapshot; called from the sampling thread
+    void publish(const MetricSnapshot& snapshot, const std::vector<Alert>& alerts,
+                 const SeriesSketches* sketches = nullptr, const SelfStats* self = nullptr);
+
+    uint64_t scrapes() const { return scrapes_.load(std::memory_order_relaxed); }
+
+private:
+    // Pre-rendered response: status line + headers, then the body
+    struct Page {
+        std::string header;
+        std::string body;
+    };
+
+    struct Connection;
+
+    void server_loop();
+    void accept_clients();
+    void handle_readable(Connection& conn);
+    bool process_requests(Connection& conn);
+    bool flush_response(Connection& conn);
+    void close_connection(Connection& conn);
+
+    ExporterConfig config_;
+    int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    uint16_t port_ = 0;
+
+    std::vector<Connection> connections_;
+    std::vector<size_t> free_connections_;
+
+    // Current page, swapped under the mutex; the previous page is reused
+    // for the next render once no connection references it
+    std::mutex page_mutex_;
+    std::shared_ptr<Page> page_;
+    std::shared_ptr<Page> spare_;
+
+    std::atomic<uint64_t> scrapes_{0};
+    std::thread server_;
+};
+
+} // namespace sysmon
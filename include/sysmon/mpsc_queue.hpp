@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace sysmon {
+
+// Bounded lock-free multi-producer / single-consumer queue (Vyukov style).
+// Producers never block: try_push() fails when the queue is full.
+template<typename T>
+class MpscQueue {
+public:
+    explicit MpscQueue(size_t capacity)
+        : capacity_(round_up_pow2(capacity < 2 ? 2 : capacity))
+        , mask_(capacity_ - 1)
+        , cells_(new Cell[capacity_])
+    {
+        for (size_t i = 0; i < capacity_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    bool try_push(const T& value) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // full
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Single consumer only
+    bool try_pop(T& out) {
+        Cell& cell = cells_[head_ & mask_];
+        size_t seq = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(head_ + 1) < 0) {
+            return false;  // empty
+        }
+        out = cell.value;
+        cell.sequence.store(head_ + capacity_, std::memory_order_release);
+        ++head_;
+        return true;
+    }
+
+    // Approximate number of queued items (for wake-up heuristics only)
+    size_t size_approx() const {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t head = head_snapshot_.load(std::memory_order_relaxed);
+        return tail >= head ? tail - head : 0;
+    }
+
+    // Publish consumer progress for size_approx(); called by the consumer
+    void publish_head() { head_snapshot_.store(head_, std::memory_order_relaxed); }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static size_t round_up_pow2(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<size_t> tail_{0};
+    alignas(64) size_t head_ = 0;
+    std::atomic<size_t> head_snapshot_{0};
+};
+
+} // namespace sysmon
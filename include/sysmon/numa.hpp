@@ -0,0 +1,34 @@
+#pragma once
+
+#include "sysmon/metrics_collector.hpp"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace sysmon {
+
+// Page allocation counters of one node's numastat
+struct NumaCounts {
+    uint64_t local = 0;     // local_node
+    uint64_t remote = 0;    // other_node
+    uint64_t miss = 0;      // numa_miss
+};
+
+// Fill a node's memory from its sysfs meminfo ("Node 0 MemTotal:  123 kB").
+// The kernel keeps no MemAvailable per node, so available is free memory
+// plus the file LRUs and reclaimable slab, roughly as the host-wide
+// estimate counts them. Returns false without a MemTotal line.
+bool parse_node_meminfo(std::string_view text, NumaNodeMetrics& node);
+
+NumaCounts parse_numastat(std::string_view text);
+
+// Allocation rates between two readings of a node's numastat
+void numa_rates(NumaNodeMetrics& node, const NumaCounts& before, const NumaCounts& after, double seconds);
+
+// Each node's cpu_usage from per-core usage. Entry i of per_core_usage is
+// logical processor online_cpus[i] (ascending), or CPU i when online_cpus
+// is empty
+void numa_cpu_usage(NumaMetrics& numa, const std::vector<double>& per_core_usage,
+                    const std::vector<int>& online_cpus);
+
+} // namespace sysmon
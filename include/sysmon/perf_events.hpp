@@ -0,0 +1,96 @@
+#pragma once
+
+#include "sysmon/metrics_collector.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace sysmon {
+
+enum class PerfEvent : uint8_t {
+    Cycles,
+    Instructions,
+    CacheReferences,
+    CacheMisses,
+    ContextSwitches,
+    CpuMigrations,
+    PageFaults,
+    Count
+};
+
+constexpr size_t kPerfEventCount = static_cast<size_t>(PerfEvent::Count);
+
+// Running totals of each event
+using PerfCounts = std::array<uint64_t, kPerfEventCount>;
+
+// One read of a group: raw totals plus the time the group was enabled and
+// the time it was actually on the PMU
+struct PerfReading {
+    PerfCounts values{};
+    uint64_t enabled = 0;
+    uint64_t running = 0;
+};
+
+// Counts between two readings, each scaled by the interval's enabled over
+// running time to make up for multiplexing. False when the group never ran
+// in between: the counts are then unknown, not zero
+bool perf_interval(const PerfReading& before, const PerfReading& after, PerfCounts& out);
+
+// Per-second rates between two readings, with IPC and miss percentage
+PerfCounters perf_rates(const PerfCounts& before, const PerfCounts& after, double seconds);
+
+// Add part's rates to sum and derive sum's ratios afresh; sum becomes available
+void add_perf_rates(PerfCounters& sum, const PerfCounters& part);
+
+// CPU list as sysfs writes it ("0-3,8,10-11")
+std::vector<int> parse_cpu_list(std::string_view list);
+
+// One perf event group per CPU: cycles leading instructions, cache
+// references and misses, with context switches, migrations and page faults
+// alongside. Without a usable PMU (VMs, containers) the group is led by
+// cpu-clock and carries the software events only. Each read() returns the
+// whole group (PERF_FORMAT_GROUP), so a tick costs one syscall per CPU.
+// Linux only; elsewhere nothing opens.
+//
+// The PMU is all or nothing: if cycles cannot be counted on any CPU, every
+// group is software only, so totals never mix the two.
+class PerfEventGroups {
+public:
+    // packages[i] is the physical package id of cpus[i]; sockets are
+    // numbered densely in package id order
+    PerfEventGroups(const std::vector<int>& cpus, const std::vector<int>& packages);
+    ~PerfEventGroups();
+
+    PerfEventGroups(const PerfEventGroups&) = delete;
+    PerfEventGroups& operator=(const PerfEventGroups&) = delete;
+
+    bool available() const { return !groups_.empty(); }
+    bool hardware() const { return hardware_; }
+
+    // Rates since the previous call; zero on the first
+    PerfMetrics read();
+
+private:
+    struct Group {
+        int cpu = 0;
+        int package = 0;
+        std::vector<int> fds;                  // leader first
+        std::array<uint64_t, kPerfEventCount> ids{};   // kernel event ids, 0 if not opened
+        PerfReading last;
+    };
+
+    bool open_all(const std::vector<int>& cpus, const std::vector<int>& sockets, bool hardware);
+    bool open_group(Group& group, bool hardware);
+    void close_all();
+
+    std::vector<Group> groups_;
+    bool hardware_ = false;
+    int sockets_ = 0;
+    std::vector<uint64_t> buffer_;             // read_format of the largest group
+    std::chrono::steady_clock::time_point last_read_;
+    bool primed_ = false;
+};
+
+} // namespace sysmon
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "sysmon/config_manager.hpp"
+#include "sysmon/metrics_collector.hpp"
+#include "sysmon/mpsc_queue.hpp"
+#include "sysmon/wire_format.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace sysmon {
+
+// Ships snapshots to a remote receiver (push section), for hosts that cannot
+// be scraped. submit() is lock-free and never blocks; a dedicated I/O thread
+// batches samples over batch_interval_ms, encodes and compresses each batch
+// into one push message and sends it over TCP or UDP. Messages that cannot be
+// delivered are appended to a bounded spool file and replayed, in order,
+// once the receiver is reachable again.
+class PushSink {
+public:
+    explicit PushSink(const PushConfig& config);
+    ~PushSink();
+
+    PushSink(const PushSink&) = delete;
+    PushSink& operator=(const PushSink&) = delete;
+
+    bool is_running() const { return io_thread_.joinable(); }
+    const PushConfig& config() const { return config_; }
+    const std::string& host() const { return host_; }
+
+    // Returns false if the queue is full (snapshot dropped)
+    bool submit(const MetricSnapshot& snapshot);
+
+    uint64_t dropped_samples() const { return dropped_samples_.load(std::memory_order_relaxed); }
+    uint64_t sent_messages() const { return sent_messages_.load(std::memory_order_relaxed); }
+    uint64_t dropped_messages() const { return dropped_messages_.load(std::memory_order_relaxed); }
+    uint64_t spool_bytes() const { return spool_bytes_.load(std::memory_order_relaxed); }
+
+private:
+    void io_loop();
+    void drain();
+    void flush_batch();
+    void deliver();
+    bool connect();
+    void disconnect();
+    bool send_message(const char* data, size_t size);
+    bool replay_spool();
+    void append_spool();
+
+    PushConfig config_;
+    WireFormat format_ = WireFormat::Binary;
+    Codec codec_ = Codec::None;
+    bool udp_ = false;
+    std::string host_;
+    std::chrono::milliseconds batch_interval_;
+    size_t max_batch_bytes_;
+    uint64_t spool_limit_;
+
+    MpscQueue<MetricSnapshot> queue_;
+    WireEncoder encoder_;
+    std::string raw_;
+    std::string message_;
+    size_t batch_frames_ = 0;
+    std::chrono::steady_clock::time_point batch_start_;
+
+    int fd_ = -1;
+    bool reachable_ = true;                      // last connect attempt succeeded
+    std::chrono::milliseconds retry_delay_{0};   // grows while the receiver stays down
+    std::chrono::steady_clock::time_point retry_at_;
+
+    std::atomic<uint64_t> dropped_samples_{0};
+    std::atomic<uint64_t> sent_messages_{0};
+    std::atomic<uint64_t> dropped_messages_{0};
+    std::atomic<uint64_t> spool_bytes_{0};
+    std::atomic<bool> stopping_{false};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::thread io_thread_;
+};
+
+} // namespace sysmon
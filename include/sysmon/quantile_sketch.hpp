@@ -0,0 +1,114 @@
+#pragma once
+
+#include "sysmon/config_manager.hpp"
+#include "sysmon/metrics_collector.hpp"
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sysmon {
+
+// DDSketch: quantiles with a bounded relative error. Values map to
+// logarithmic bins, so insertion is O(1) and two sketches with the same
+// accuracy merge exactly by adding bin counts. Memory is bounded by
+// max_bins; beyond that the lowest bins collapse, which only loses accuracy
+// for the smallest values. Negative values are counted as zero.
+class QuantileSketch {
+public:
+    explicit QuantileSketch(double relative_accuracy = 0.01, size_t max_bins = 2048);
+
+    void add(double value, uint64_t count = 1);
+
+    // False (and no change) if the sketches use different accuracies
+    bool merge(const QuantileSketch& other);
+
+    // q in [0, 1]; 0 for an empty sketch
+    double quantile(double q) const;
+
+    void clear();
+
+    uint64_t count() const { return count_; }
+    double sum() const { return sum_; }
+    double min() const { return count_ ? min_ : 0.0; }
+    double max() const { return count_ ? max_ : 0.0; }
+    double mean() const { return count_ ? sum_ / static_cast<double>(count_) : 0.0; }
+    double relative_accuracy() const { return relative_accuracy_; }
+    size_t bin_count() const { return bins_.size(); }
+
+private:
+    int key(double value) const;
+    double value(int key) const;
+    size_t slot(int key);
+
+    double relative_accuracy_;
+    double gamma_;
+    double log_gamma_;
+    size_t max_bins_;
+
+    std::vector<uint64_t> bins_;       // bins_[i] counts key offset_ + i
+    int offset_ = 0;
+    uint64_t zero_count_ = 0;
+    uint64_t count_ = 0;
+    double sum_ = 0.0;
+    double min_ = 0.0;
+    double max_ = 0.0;
+};
+
+// Sliding time window of sketches: window_slots sub-sketches each covering
+// window_seconds / window_slots, recycled as time moves on. A query merges
+// the slots still inside the window.
+class WindowedSketch {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit WindowedSketch(const QuantileConfig& config);
+
+    void add(double value, Clock::time_point now);
+
+    // Merge the slots covering (now - window, now] into out
+    void merge_into(QuantileSketch& out, Clock::time_point now) const;
+
+private:
+    int64_t epoch(Clock::time_point now) const;
+
+    std::chrono::nanoseconds slot_length_;
+    std::vector<QuantileSketch> slots_;
+    std::vector<int64_t> slot_epochs_;
+};
+
+// One WindowedSketch per snapshot series (see for_each_series)
+class SeriesSketches {
+public:
+    explicit SeriesSketches(const QuantileConfig& config);
+
+    const QuantileConfig& config() const { return config_; }
+
+    void observe(const MetricSnapshot& snapshot, WindowedSketch::Clock::time_point now);
+
+    // Window ending at the last observe(); false for an unknown series
+    bool window(std::string_view name, QuantileSketch& out) const;
+
+    std::vector<std::string> names() const;
+
+    // fn(name, window) for every series in name order
+    template<typename Fn>
+    void for_each_window(Fn&& fn) const {
+        QuantileSketch window(config_.relative_accuracy, static_cast<size_t>(config_.max_bins));
+        for (const auto& [name, sketch] : series_) {
+            window.clear();
+            sketch.merge_into(window, last_observed_);
+            fn(name, window);
+        }
+    }
+
+private:
+    QuantileConfig config_;
+    std::map<std::string, WindowedSketch, std::less<>> series_;
+    WindowedSketch::Clock::time_point last_observed_{};
+    std::string key_;
+};
+
+} // namespace sysmon
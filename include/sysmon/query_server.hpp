@@ -0,0 +1,161 @@
+#pragma once
+
+#include "sysmon/alert_engine.hpp"
+#include "sysmon/config_manager.hpp"
+#include "sysmon/metrics_collector.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace sysmon {
+
+// Local query protocol (query section), spoken over a Unix stream socket.
+//
+// Binary mode, little-endian:
+//   request:  u8 0, u8 QueryType, u16 payload_len, payload
+//   response: u8 QueryStatus, u8 QueryType, u32 payload_len, payload
+//   Snapshot: request empty; response encode_snapshot()
+//   Range:    request i64 since_ms, i64 until_ms, series name;
+//             response u32 count, count x (i64 timestamp_ms, f64 value)
+//   Alerts:   request empty; response u16 count, count x alert log binary record
+//   Series:   request empty; response u16 count, count x (u8 len, name)
+//
+// JSON mode: one text line per request, answered by one line of JSON:
+//   "snapshot", "alerts", "series", "range <series> [since_ms [until_ms]]"
+enum class QueryType : uint8_t {
+    Snapshot = 1,
+    Range = 2,
+    Alerts = 3,
+    Series = 4
+};
+
+enum class QueryStatus : uint8_t {
+    Ok = 0,
+    BadRequest = 1,
+    UnknownSeries = 2,
+    NoData = 3
+};
+
+constexpr size_t kQueryRequestHeader = 4;
+constexpr size_t kQueryResponseHeader = 6;
+
+// Snapshot payload:
+//   i64 timestamp_ms
+//   f64 cpu_usage, f64 iowait, u16 cores, cores x f64
+//   u64 mem_total, u64 mem_used, u64 mem_available, f64 mem_usage, u64 swap_total, u64 swap_used
+//   u16 disks, disks x (u8 len, mount, u64 total, u64 used, f64 usage, f64 seconds_to_full)
+//   u16 nics,  nics x  (u8 len, name, u64 rx_bytes, u64 tx_bytes, f64 rx_mbps, f64 tx_mbps)
+void encode_snapshot(std::string& out, const MetricSnapshot& snapshot);
+bool decode_snapshot(std::string_view payload, MetricSnapshot& out);
+
+void append_snapshot_json(std::string& out, const MetricSnapshot& snapshot);
+
+// Bounded per-series history for range queries, one ring per series named
+// as in for_each_series(). Not synchronized: the query server only touches
+// it from its own thread.
+class SeriesHistory {
+public:
+    struct Point {
+        int64_t timestamp_ms;
+        double value;
+    };
+
+    explicit SeriesHistory(size_t capacity);
+
+    void append(const MetricSnapshot& snapshot);
+
+    // Points with since_ms <= timestamp < until_ms, oldest first
+    bool range(std::string_view name, int64_t since_ms, int64_t until_ms, std::vector<Point>& out) const;
+    std::vector<std::string> names() const;
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct Ring {
+        std::vector<Point> points;
+        size_t next = 0;
+        size_t size = 0;
+    };
+
+    void add(const std::string& name, int64_t timestamp_ms, double value);
+
+    size_t capacity_;
+    std::unordered_map<std::string, Ring> series_;
+    std::string key_;       // reused while appending
+};
+
+// Serves the protocol above from its own epoll thread. publish() hands the
+// latest snapshot over with one pointer swap and never copies it; the range
+// history and the encodings are built on the server thread, so slow queries
+// never hold up the sampling thread.
+class QueryServer {
+public:
+    explicit QueryServer(const QueryConfig& config);
+    ~QueryServer();
+
+    QueryServer(const QueryServer&) = delete;
+    QueryServer& operator=(const QueryServer&) = delete;
+
+    bool is_running() const { return server_.joinable(); }
+    const QueryConfig& config() const { return config_; }
+
+    // Called from the sampling thread once per update
+    void publish(std::shared_ptr<const MetricSnapshot> snapshot,
+                 std::shared_ptr<const std::vector<Alert>> alerts);
+
+private:
+    struct State {
+        uint64_t sequence = 0;
+        std::shared_ptr<const MetricSnapshot> snapshot;
+        std::shared_ptr<const std::vector<Alert>> alerts;
+    };
+
+    struct Connection;
+
+    void server_loop();
+    void accept_clients();
+    void handle_readable(Connection& conn);
+    bool process_requests(Connection& conn);
+    bool flush_output(Connection& conn);
+    void close_connection(Connection& conn);
+
+    void answer_binary(QueryType type, std::string_view payload, std::string& out);
+    void answer_text(std::string_view line, std::string& out);
+    std::shared_ptr<const State> current_state();
+    void catch_up_history();
+    void wake();
+    void refresh_cache(const std::shared_ptr<const State>& state);
+
+    QueryConfig config_;
+    SeriesHistory history_;
+    int listen_fd_ = -1;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+
+    std::vector<Connection> connections_;
+    std::vector<size_t> free_connections_;
+
+    std::mutex state_mutex_;
+    std::shared_ptr<const State> state_;
+    std::vector<std::shared_ptr<const State>> pending_;   // published, not yet in history_
+    uint64_t sequence_ = 0;
+    std::atomic<bool> stopping_{false};
+
+    // Server thread only: encodings of the current state
+    uint64_t cached_sequence_ = 0;
+    std::string snapshot_binary_;
+    std::string snapshot_json_;
+    std::string alerts_binary_;
+    std::string alerts_json_;
+    std::vector<SeriesHistory::Point> range_scratch_;
+    std::vector<std::shared_ptr<const State>> absorbing_;
+
+    std::thread server_;
+};
+
+} // namespace sysmon
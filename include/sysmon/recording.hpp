@@ -0,0 +1,95 @@
+#pragma once
+
+#include "sysmon/metrics_collector.hpp"
+#include "sysmon/wire_format.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace sysmon {
+
+// Recording file (--record / --replay):
+//   "SMRC", u8 version, 3 reserved bytes, block*
+// Each block is a push message (see encode_push_message) holding one binary
+// wire batch of up to block_frames snapshots. Blocks are independent, so a
+// torn final block only loses its own samples, and a reader can map the file
+// and decode it block by block.
+constexpr char kRecordingMagic[4] = {'S', 'M', 'R', 'C'};
+constexpr uint8_t kRecordingVersion = 1;
+constexpr size_t kRecordingHeaderSize = 8;
+
+// Best codec built in, preferring ratio (zstd, zlib, lz4, none)
+Codec preferred_recording_codec();
+
+class RecordingWriter {
+public:
+    RecordingWriter(const std::string& path, Codec codec, size_t block_frames = 60);
+    ~RecordingWriter();
+
+    RecordingWriter(const RecordingWriter&) = delete;
+    RecordingWriter& operator=(const RecordingWriter&) = delete;
+
+    bool is_open() const { return file_ != nullptr; }
+    const std::string& path() const { return path_; }
+
+    // Buffer one snapshot; writes a block every block_frames
+    bool append(const MetricSnapshot& snapshot);
+
+    // Write the pending block, if any
+    bool flush();
+
+    uint64_t frames() const { return frames_; }
+    uint64_t bytes_written() const { return bytes_written_; }
+
+private:
+    std::string path_;
+    Codec codec_;
+    size_t block_frames_;
+    std::FILE* file_ = nullptr;
+    std::string host_;
+    WireEncoder encoder_;
+    std::string batch_;
+    std::string message_;
+    size_t pending_ = 0;        // frames in batch_
+    uint64_t frames_ = 0;
+    uint64_t bytes_written_ = 0;
+};
+
+// Memory-mapped reader. Snapshots come back with wall_time as recorded and a
+// steady timestamp on the same scale, so rates and windows behave as they did
+// on the recording host.
+class RecordingReader {
+public:
+    explicit RecordingReader(const std::string& path);
+    ~RecordingReader();
+
+    RecordingReader(const RecordingReader&) = delete;
+    RecordingReader& operator=(const RecordingReader&) = delete;
+
+    bool is_open() const { return data_ != nullptr; }
+    const std::string& host() const { return host_; }
+
+    // False at the end of the file or at the first corrupt block
+    bool next(MetricSnapshot& out);
+
+    // True if reading stopped early on a corrupt or torn block
+    bool truncated() const { return truncated_; }
+
+private:
+    bool load_block();
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    size_t pos_ = 0;
+    bool mapped_ = false;
+    std::string buffer_;        // file contents where mmap is unavailable
+    std::string host_;
+    WireDecoder decoder_;
+    std::string raw_;
+    std::vector<MetricSnapshot> block_;
+    size_t next_ = 0;
+    bool truncated_ = false;
+};
+
+} // namespace sysmon
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "sysmon/config_manager.hpp"
+#include "sysmon/metrics_collector.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sysmon {
+
+struct Alert;
+enum class AlertLevel;
+
+// Rule expressions are compiled once (load / hot-reload) into flat bytecode
+// for a small stack machine, then evaluated against every MetricSnapshot.
+//
+//   expr     := or
+//   or       := and (("or" | "||") and)*
+//   and      := not (("and" | "&&") not)*
+//   not      := ("not" | "!") not | compare
+//   compare  := sum ((">" | ">=" | "<" | "<=" | "==" | "!=") sum)?
+//   sum      := product (("+" | "-") product)*
+//   product  := unary (("*" | "/") unary)*
+//   unary    := "-" unary | primary
+//   primary  := number ["%"] | variable | func "(" args ")" | "(" expr ")"
+//
+// Functions: rate(x), avg_over(x, N), abs(x), min(a, b), max(a, b).
+// A rule may reference at most one entity scope (core.*, disk.*, net.*), in
+// which case it is evaluated once per entity accepted by its "match" glob.
+enum class RuleScope : uint8_t {
+    Host,
+    Core,
+    Disk,
+    Network
+};
+
+enum class RuleOp : uint8_t {
+    Const,
+    Load,
+    Add, Sub, Mul, Div, Neg,
+    Lt, Le, Gt, Ge, Eq, Ne,
+    And, Or, Not,
+    Abs, Min, Max,
+    Rate,
+    AvgOver
+};
+
+struct RuleInstruction {
+    RuleOp op;
+    uint16_t arg = 0;        // variable id (Load) or state offset (Rate/AvgOver)
+    uint16_t window = 0;     // sample count (AvgOver)
+    double value = 0.0;      // constant (Const)
+};
+
+struct CompiledRule {
+    std::string name;
+    std::string expr;
+    std::string message;
+    std::string match;
+    AlertLevel level;
+    RuleScope scope = RuleScope::Host;
+    std::vector<RuleInstruction> code;
+    size_t state_size = 0;   // doubles of per-entity state used by rate/avg_over
+};
+
+class RuleEngine {
+public:
+    // Compile all rules, replacing the current set. Rules that fail to compile
+    // are skipped and described in errors. A rule whose name, expression and
+    // match are unchanged keeps its rate()/avg_over() history.
+    bool compile(const std::vector<AlertRuleConfig>& rules, std::vector<std::string>& errors);
+
+    // Evaluate every rule and append one alert per firing rule/entity
+    void evaluate(const MetricSnapshot& snapshot, std::vector<Alert>& alerts);
+
+    size_t rule_count() const { return rules_.size(); }
+
+private:
+    struct EntityState {
+        std::string key;
+        bool matched = true;
+        std::vector<double> data;
+    };
+
+    struct RuleState {
+        std::vector<EntityState> entities;
+    };
+
+    void sync_entities(const CompiledRule& rule, RuleState& state, const MetricSnapshot& snapshot);
+    double run(const CompiledRule& rule, EntityState& entity,
+               const MetricSnapshot& snapshot, size_t entity_index, double now,
+               double& lhs, double& rhs);
+
+    std::vector<CompiledRule> rules_;
+    std::vector<RuleState> states_;
+};
+
+// Compile a single rule; returns false with a description on error
+bool compile_rule(const AlertRuleConfig& config, CompiledRule& out, std::string& error);
+
+// Shell-style glob supporting '*' and '?'
+bool glob_match(const std::string& pattern, const std::string& text);
+
+} // namespace sysmon
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "sysmon/quantile_sketch.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+namespace sysmon {
+
+// Steps of one monitoring tick, timed by SelfStats
+enum class Stage : uint8_t {
+    Reload,
+    CollectCpu,
+    CollectMemory,
+    CollectDisk,
+    CollectNetwork,
+    CollectPerf,
+    Alerts,
+    Log,
+    Publish,
+    Render,
+    Tick,               // the whole loop body, excluding the sleep
+    Count
+};
+
+const char* stage_name(Stage stage);
+
+namespace detail {
+// Bumped by the operator new hooks (alloc_hooks.cpp), which the sysmon
+// executable and sysmon_bench link; elsewhere it stays 0
+extern thread_local uint64_t t_heap_allocations;
+}
+
+// Heap allocations made so far by the calling thread
+inline uint64_t thread_heap_allocations() { return detail::t_heap_allocations; }
+
+struct StageStats {
+    uint64_t calls = 0;
+    double last_ms = 0.0;
+    double mean_ms = 0.0;
+    double p50_ms = 0.0;
+    double p99_ms = 0.0;
+    double max_ms = 0.0;
+    double total_seconds = 0.0;
+    double allocations_per_call = 0.0;
+};
+
+// sysmon's own cost: per-stage latency distributions (2% quantile sketches
+// over the whole run), allocations per stage, process CPU time, RSS and
+// missed deadlines. A timed stage costs two clock reads and a sketch insert;
+// end_tick() adds one getrusage() and a read of /proc/self/statm. Used from
+// the sampling thread only.
+class SelfStats {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Times a stage until destroyed; does nothing for a null SelfStats
+    class Scope {
+    public:
+        Scope(SelfStats* stats, Stage stage)
+            : stats_(stats), stage_(stage)
+        {
+            if (stats_) {
+                allocations_ = thread_heap_allocations();
+                start_ = Clock::now();
+            }
+        }
+        ~Scope() {
+            if (stats_) {
+                stats_->record(stage_, Clock::now() - start_, thread_heap_allocations() - allocations_);
+            }
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        SelfStats* stats_;
+        Stage stage_;
+        Clock::time_point start_;
+        uint64_t allocations_ = 0;
+    };
+
+    SelfStats();
+
+    void record(Stage stage, Clock::duration elapsed, uint64_t allocations);
+
+    // Bracket one tick; a tick longer than budget is a missed deadline
+    void begin_tick();
+    void end_tick(Clock::duration budget);
+
+    StageStats stage(Stage stage) const;
+    uint64_t ticks() const { return slots_[static_cast<size_t>(Stage::Tick)].calls; }
+    uint64_t missed_deadlines() const { return missed_deadlines_; }
+    uint64_t allocations() const { return slots_[static_cast<size_t>(Stage::Tick)].allocations; }  // sampling thread
+    uint64_t resident_bytes() const { return resident_bytes_; }
+    double cpu_seconds() const { return cpu_seconds_; }          // user + system, all threads
+    double cpu_percent() const { return cpu_percent_; }          // of one core, over the last tick
+
+    // Alerts the log writer dropped on a full queue, as of the last tick
+    void set_log_dropped(uint64_t records) { log_dropped_ = records; }
+    uint64_t log_dropped() const { return log_dropped_; }
+
+    // Table for --self-stats
+    void dump(std::ostream& out) const;
+
+private:
+    struct Slot {
+        QuantileSketch sketch{0.02, 512};   // milliseconds
+        uint64_t calls = 0;
+        double last_ms = 0.0;
+        uint64_t allocations = 0;
+    };
+
+    void sample_process();
+
+    std::array<Slot, static_cast<size_t>(Stage::Count)> slots_;
+    Clock::time_point tick_start_;
+    uint64_t tick_allocations_ = 0;
+    uint64_t missed_deadlines_ = 0;
+    uint64_t resident_bytes_ = 0;
+    uint64_t log_dropped_ = 0;
+    double cpu_seconds_ = 0.0;
+    double cpu_percent_ = 0.0;
+    Clock::time_point last_sample_;
+};
+
+} // namespace sysmon
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "sysmon/config_manager.hpp"
+#include "sysmon/metrics_collector.hpp"
+#include "sysmon/shm_snapshot.hpp"
+
+namespace sysmon {
+
+// Publishes every update into a POSIX shared-memory segment (shm section)
+// laid out as shm::Segment, for readers using shm_snapshot.hpp
+class ShmPublisher {
+public:
+    explicit ShmPublisher(const ShmConfig& config);
+    ~ShmPublisher();
+
+    ShmPublisher(const ShmPublisher&) = delete;
+    ShmPublisher& operator=(const ShmPublisher&) = delete;
+
+    bool is_open() const { return segment_ != nullptr; }
+    const ShmConfig& config() const { return config_; }
+
+    void publish(const MetricSnapshot& snapshot);
+
+private:
+    ShmConfig config_;
+    shm::Segment* segment_ = nullptr;
+};
+
+} // namespace sysmon
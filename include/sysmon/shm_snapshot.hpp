@@ -0,0 +1,204 @@
+#pragma once
+
+// Shared-memory snapshot layout and reader (shm section).
+//
+// Header-only and independent of the rest of sysmon, so other programs can
+// copy this file and read host load without any IPC round trip:
+//
+//     sysmon::shm::Reader reader;
+//     if (reader.open("/sysmon")) {
+//         double cpu = 0.0;
+//         reader.read([&](const sysmon::shm::Payload& p) { cpu = p.cpu.usage; });
+//     }
+//
+// The segment is written by a single writer under a sequence lock: the
+// sequence is odd while an update is in progress, and a read is retried
+// if the sequence changed while it was copying.
+//
+// A publisher that exits, or replaces the segment on a reload, marks the old
+// one closed. Reads of a closed segment fail; reader.closed() tells that
+// apart from "nothing published yet", and open() maps the current one.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SYSMON_SHM_POSIX 1
+#endif
+
+namespace sysmon::shm {
+
+constexpr uint32_t kMagic = 0x4E4F4D53;          // "SMON"
+constexpr uint16_t kVersion = 2;                 // bumped on any layout change
+
+constexpr size_t kMaxCores = 1024;
+constexpr size_t kMaxDisks = 32;
+constexpr size_t kMaxInterfaces = 32;
+constexpr size_t kNameSize = 64;                 // NUL-terminated, truncated
+
+struct CpuBlock {
+    double usage;                                // 0-100%
+    double iowait;                               // 0-100%
+    uint32_t core_count;                         // logical processors
+    uint32_t per_core_count;                     // entries used in per_core
+    double per_core[kMaxCores];
+};
+
+struct MemoryBlock {
+    uint64_t total_bytes;
+    uint64_t available_bytes;
+    uint64_t used_bytes;
+    double usage;
+    uint64_t swap_total_bytes;
+    uint64_t swap_used_bytes;
+};
+
+struct DiskBlock {
+    char mount_point[kNameSize];
+    uint64_t total_bytes;
+    uint64_t used_bytes;
+    double usage;
+    double seconds_to_full;                      // < 0 if not filling
+};
+
+struct NetworkBlock {
+    char interface_name[kNameSize];
+    uint64_t bytes_received;
+    uint64_t bytes_sent;
+    double download_mbps;
+    double upload_mbps;
+};
+
+struct Payload {
+    int64_t timestamp_ms;                        // wall clock of the sample
+    uint64_t update_count;
+    CpuBlock cpu;
+    MemoryBlock memory;
+    uint32_t disk_count;
+    uint32_t interface_count;
+    DiskBlock disks[kMaxDisks];
+    NetworkBlock interfaces[kMaxInterfaces];
+};
+
+struct Segment {
+    uint32_t magic;                              // written last by the publisher
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t segment_size;                       // sizeof(Segment) of the writer
+    uint32_t writer_pid;
+    alignas(64) std::atomic<uint64_t> sequence;  // odd while writing
+    std::atomic<uint32_t> closed;                // set once the writer has moved on
+    alignas(64) Payload payload;
+};
+
+static_assert(std::is_trivially_copyable_v<Payload>, "payload must be POD");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "sequence must be usable across processes");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "closed must be usable across processes");
+
+// Writer side of the sequence lock
+inline void begin_write(Segment& segment) {
+    uint64_t seq = segment.sequence.load(std::memory_order_relaxed);
+    segment.sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+inline void end_write(Segment& segment) {
+    uint64_t seq = segment.sequence.load(std::memory_order_relaxed);
+    segment.sequence.store(seq + 1, std::memory_order_release);
+}
+
+// Run fn(const Payload&) until it observes a consistent payload. fn should
+// only copy values out; it may see torn data on attempts that are retried.
+template<typename Fn>
+bool read_consistent(const Segment& segment, Fn&& fn, int max_attempts = 1000) {
+    if (segment.closed.load(std::memory_order_acquire)) {
+        return false;
+    }
+    for (int attempt = 0; attempt < max_attempts; ++attempt) {
+        uint64_t before = segment.sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        fn(segment.payload);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (segment.sequence.load(std::memory_order_relaxed) == before) {
+            return before != 0;      // 0: nothing published yet
+        }
+    }
+    return false;
+}
+
+#ifdef SYSMON_SHM_POSIX
+
+// Maps a published segment read-only
+class Reader {
+public:
+    Reader() = default;
+    ~Reader() { close(); }
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    // name as configured in shm.name, e.g. "/sysmon"
+    bool open(const char* name) {
+        close();
+        int fd = ::shm_open(name, O_RDONLY, 0);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Segment)) {
+            ::close(fd);
+            return false;
+        }
+        void* addr = ::mmap(nullptr, sizeof(Segment), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            return false;
+        }
+        segment_ = static_cast<const Segment*>(addr);
+        if (segment_->magic != kMagic || segment_->version != kVersion ||
+            segment_->segment_size != sizeof(Segment)) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (segment_) {
+            ::munmap(const_cast<Segment*>(segment_), sizeof(Segment));
+            segment_ = nullptr;
+        }
+    }
+
+    bool is_open() const { return segment_ != nullptr; }
+    const Segment* segment() const { return segment_; }
+
+    // The publisher has exited or replaced the segment; open() again
+    bool closed() const { return segment_ && segment_->closed.load(std::memory_order_acquire); }
+
+    template<typename Fn>
+    bool read(Fn&& fn) const {
+        return segment_ && read_consistent(*segment_, fn);
+    }
+
+    // Copy the whole payload (about 14 KB)
+    bool read(Payload& out) const {
+        return read([&out](const Payload& p) { std::memcpy(&out, &p, sizeof(Payload)); });
+    }
+
+private:
+    const Segment* segment_ = nullptr;
+};
+
+#endif
+
+} // namespace sysmon::shm
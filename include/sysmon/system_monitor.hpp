@@ -4,39 +4,94 @@
 #include "sysmon/metrics_collector.hpp"
 #include "sysmon/alert_engine.hpp"
 #include "sysmon/display.hpp"
+#include "sysmon/disk_forecast.hpp"
+#include "sysmon/metrics_exporter.hpp"
+#include "sysmon/query_server.hpp"
+#include "sysmon/shm_publisher.hpp"
+#include "sysmon/push_sink.hpp"
+#include "sysmon/fleet_aggregator.hpp"
+#include "sysmon/flight_recorder.hpp"
+#include "sysmon/quantile_sketch.hpp"
+#include "sysmon/recording.hpp"
+#include "sysmon/self_stats.hpp"
+#include "sysmon/trace.hpp"
 #include <memory>
 #include <deque>
 #include <atomic>
 
 namespace sysmon {
 
+enum class RunMode {
+    Live,         // collect, alert, display and serve the configured services
+    Aggregate,    // --aggregate: display only
+    Replay        // --replay: alerts and display only
+};
+
 class SystemMonitor {
 public:
     SystemMonitor(const std::string& config_path);
     
-    // Initialize all components
-    bool initialize();
+    // Initialize the components the mode uses. Aggregate and replay modes
+    // never open the live daemon's exporter port, query socket, shared
+    // memory, push sink or flight recorder, so they can run next to it.
+    // Replayed alerts go to replay_log if given, never to alerts.log_path.
+    bool initialize(RunMode mode = RunMode::Live, const std::string& replay_log = "");
     
     // Main monitoring loop
     void run();
     
+    // Fleet view of pushed snapshots instead of local metrics (--aggregate)
+    void run_aggregator();
+    
+    // Append every collected snapshot to a recording file (--record)
+    bool start_recording(const std::string& path);
+    
+    // Feed a recording through alerts and display (--replay); speed 0 runs
+    // as fast as possible, N plays N times faster than recorded
+    void run_replay(const std::string& path, double speed);
+    
     // Stop monitoring
     void stop();
+    
+    // Dump the flight recorder on the next tick; async-signal-safe (SIGUSR1)
+    void request_flight_dump() { flight_dump_requested_.store(true, std::memory_order_relaxed); }
+    
+    // Per-stage timings and process cost so far (--self-stats)
+    void dump_self_stats(std::ostream& out) const { self_stats_.dump(out); }
 
 private:
     void monitoring_loop();
+    void apply_service_config(const SysMonConfig& config);
+    void apply_sketch_config(const SysMonConfig& config);
+    void apply_reload(const ConfigSnapshot& config);
+    void apply_trace_config(const SysMonConfig& config);
+    void apply_flight_recorder_config(const SysMonConfig& config);
+    void evaluate(const MetricSnapshot& snapshot, const SysMonConfig& config);
+    void render(const MetricSnapshot& snapshot, const SysMonConfig& config);
     
     std::string config_path_;
     ConfigManager config_manager_;
+    ConfigSnapshot applied_config_;   // what the components were last set up with
     std::unique_ptr<MetricsCollector> metrics_collector_;
     std::unique_ptr<AlertEngine> alert_engine_;
     std::unique_ptr<Display> display_;
+    DiskForecaster disk_forecaster_;
+    std::unique_ptr<MetricsExporter> exporter_;
+    std::unique_ptr<QueryServer> query_server_;
+    std::unique_ptr<ShmPublisher> shm_publisher_;
+    std::unique_ptr<PushSink> push_sink_;
+    std::unique_ptr<RecordingWriter> recorder_;
+    std::unique_ptr<FlightRecorder> flight_recorder_;
+    std::unique_ptr<trace::Writer> trace_writer_;
     
     std::deque<double> cpu_history_;
     std::deque<double> memory_history_;
-    std::vector<Alert> active_alerts_;
+    std::unique_ptr<SeriesSketches> sketches_;
+    std::shared_ptr<const std::vector<Alert>> active_alerts_ = std::make_shared<const std::vector<Alert>>();
+    SelfStats self_stats_;
     
     std::atomic<bool> running_{false};
+    std::atomic<bool> flight_dump_requested_{false};
 };
 
 } // namespace sysmon
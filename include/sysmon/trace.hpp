@@ -0,0 +1,232 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+// Levels below this are compiled out, arguments and all:
+// 0 = debug, 1 = info, 2 = warn
+#ifndef SYSMON_TRACE_MIN_LEVEL
+#define SYSMON_TRACE_MIN_LEVEL 0
+#endif
+
+// SYSMON_TRACE(Debug, "read {} cores from {}", count, path);
+// The format string is registered once per call site; each call then stores
+// only the site id and the raw arguments in the calling thread's ring.
+// Formatting happens later, on drain(). Placeholders are {} and {x} (hex).
+// The format travels inside __VA_ARGS__ so the macro needs neither
+// __VA_OPT__ nor the conforming MSVC preprocessor.
+#define SYSMON_TRACE(level, ...)                                                                \
+    do {                                                                                        \
+        if constexpr (::sysmon::trace::compiled_in(::sysmon::trace::Level::level)) {             \
+            if (::sysmon::trace::enabled()) {                                                   \
+                static const uint16_t sysmon_trace_site = ::sysmon::trace::register_site(       \
+                    ::sysmon::trace::Level::level, __FILE__, __LINE__,                          \
+                    ::sysmon::trace::detail::format_of(__VA_ARGS__));                           \
+                ::sysmon::trace::detail::write_formatted(sysmon_trace_site, __VA_ARGS__);       \
+            }                                                                                   \
+        }                                                                                       \
+    } while (0)
+
+namespace sysmon::trace {
+
+enum class Level : uint8_t { Debug, Info, Warn };
+
+constexpr bool compiled_in(Level level) {
+    int minimum = SYSMON_TRACE_MIN_LEVEL;
+    return static_cast<int>(level) >= minimum;
+}
+
+enum class ArgKind : uint8_t { None, Int, Uint, Double, String };
+
+constexpr size_t kArgSlots = 5;
+constexpr size_t kMaxArgs = 5;
+constexpr size_t kRingRecords = 4096;   // per thread, 256 KB
+
+// One trace event: 24 bytes of header, then up to five 8-byte argument slots.
+// A string argument is a length byte and its characters, spread over as
+// many slots as it needs (truncated to what is left).
+struct Record {
+    uint64_t seq;           // ring index + 1 once written, 0 while being written
+    int64_t time_ns;        // steady clock
+    uint16_t site;
+    uint8_t count;
+    uint8_t reserved;
+    uint32_t kinds;         // 4 bits of ArgKind per argument
+    unsigned char slots[kArgSlots * 8];
+};
+static_assert(sizeof(Record) == 64);
+
+// Single-producer ring owned by one thread. Records are overwritten once
+// the ring is full; the consumer notices and reports what it lost.
+// Tracing never blocks and never allocates after the first call.
+struct Ring {
+    Record records[kRingRecords];
+    std::atomic<uint64_t> head{0};    // next record the owner writes
+    uint64_t tail = 0;                // next record drain() reads; drain's lock
+    uint32_t thread = 0;              // registration order, for the output
+    std::atomic<bool> retired{false}; // owner exited; reused once drained
+};
+
+namespace detail {
+extern std::atomic<bool> g_enabled;
+Ring* register_ring();
+void retire_ring(Ring* ring);
+
+// Hands the ring back when its thread exits, so short-lived threads
+// recycle rings instead of leaking one each
+struct RingLease {
+    Ring* ring = register_ring();
+    ~RingLease() { retire_ring(ring); }
+};
+}
+
+// Off by default; a disabled trace point costs one relaxed load
+inline bool enabled() { return detail::g_enabled.load(std::memory_order_relaxed); }
+void set_enabled(bool on);
+
+uint16_t register_site(Level level, const char* file, int line, const char* format);
+
+// Rings allocated so far; bounded by the most threads tracing at once
+size_t ring_count();
+
+// The calling thread's ring, taken from the registry on first use
+inline Ring& local_ring() {
+    thread_local detail::RingLease lease;
+    return *lease.ring;
+}
+
+namespace detail {
+
+class Encoder {
+public:
+    explicit Encoder(Record& record) : record_(record) {}
+
+    template<typename T>
+    void add(const T& value) {
+        if (record_.count >= kMaxArgs) {
+            return;
+        }
+        if constexpr (std::is_same_v<T, bool>) {
+            put(ArgKind::Uint, static_cast<uint64_t>(value));
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            put(ArgKind::Int, static_cast<int64_t>(value));
+        } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+            put(ArgKind::Uint, static_cast<uint64_t>(value));
+        } else if constexpr (std::is_floating_point_v<T>) {
+            put(ArgKind::Double, static_cast<double>(value));
+        } else {
+            add_string(std::string_view(value));
+        }
+    }
+
+private:
+    template<typename V>
+    void put(ArgKind kind, V value) {
+        if (used_ + 8 > sizeof(record_.slots)) {
+            return;
+        }
+        std::memcpy(record_.slots + used_, &value, 8);
+        used_ += 8;
+        mark(kind);
+    }
+
+    void add_string(std::string_view text) {
+        size_t room = sizeof(record_.slots) - used_;
+        if (room == 0) {
+            return;
+        }
+        size_t length = std::min<size_t>({text.size(), room - 1, 255});
+        record_.slots[used_] = static_cast<unsigned char>(length);
+        std::memcpy(record_.slots + used_ + 1, text.data(), length);
+        used_ += (1 + length + 7) / 8 * 8;
+        mark(ArgKind::String);
+    }
+
+    void mark(ArgKind kind) {
+        record_.kinds |= static_cast<uint32_t>(kind) << (4 * record_.count);
+        ++record_.count;
+    }
+
+    Record& record_;
+    size_t used_ = 0;
+};
+
+} // namespace detail
+
+template<typename... Args>
+void write(uint16_t site, const Args&... args) {
+    Ring& ring = local_ring();
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    Record& record = ring.records[head % kRingRecords];
+    // Sequence lock against drain() reading a record that is being reused
+    std::atomic_ref<uint64_t> seq(record.seq);
+    seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    record.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    record.site = site;
+    record.count = 0;
+    record.kinds = 0;
+    detail::Encoder encoder(record);
+    (encoder.add(args), ...);
+    seq.store(head + 1, std::memory_order_release);
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+namespace detail {
+
+template<typename... Args>
+constexpr const char* format_of(const char* format, const Args&...) {
+    return format;
+}
+
+template<typename... Args>
+void write_formatted(uint16_t site, const char*, const Args&... args) {
+    write(site, args...);
+}
+
+} // namespace detail
+
+// Format every record written since the last drain, oldest first across
+// threads, as "[level] +seconds tN file:line message" lines. Returns the
+// number of records written out.
+size_t drain(std::ostream& out);
+
+// Background thread that drains the rings into a file (stderr if path is
+// empty) periodically and once more when destroyed, so tracing threads
+// never format or do I/O
+class Writer {
+public:
+    Writer(const std::string& path, std::chrono::milliseconds interval);
+    ~Writer();
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    const std::string& path() const { return path_; }
+
+private:
+    void run();
+
+    std::string path_;
+    std::ofstream file_;
+    std::ostream* out_;
+    std::chrono::milliseconds interval_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+} // namespace sysmon::trace
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "sysmon/compression.hpp"
+#include "sysmon/metrics_collector.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sysmon {
+
+// Encodings for shipping snapshots off the host (push section)
+enum class WireFormat : uint8_t {
+    Binary = 0,         // delta + varint batches (WireEncoder / WireDecoder)
+    LineProtocol = 1    // InfluxDB line protocol, one line per measurement
+};
+
+bool parse_wire_format(const std::string& name, WireFormat& out);
+
+// LEB128 varints with zigzag for signed deltas
+void put_varint(std::string& out, uint64_t value);
+bool get_varint(const char*& p, const char* end, uint64_t& value);
+
+inline uint64_t zigzag(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+inline int64_t unzigzag(uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+// Binary batch:
+//   "SMW2", varint host_len, host, frame*
+//   frame: zz(dt_ms), u8 flags, [layout], values
+//   layout (flags & 1, first frame and whenever entities change):
+//     varint cores, varint disks, disks x (varint len, mount),
+//     varint nics, nics x (varint len, interface)
+//   values, each zz(value - previous value):
+//     cpu usage, iowait, cores x core usage             (1/100 %)
+//     mem total, used, available, usage, swap total, swap used
+//     disks x (total, used, usage, seconds_to_full, growth bytes/s)
+//     nics x (rx bytes, tx bytes, rx kbps, tx kbps)
+//     scheduler (flags & 2): context switches, interrupts, softirqs and
+//       forks /s, running, blocked, threads, run queue per core,
+//       load 1, 5, 15
+//     interrupts (flags & 4): irq, softirq and net softirq /s, imbalance,
+//       busiest cpu
+//     per-cpu interrupts (flags & 8): cores x (irq, softirq, net softirq /s)
+// Percentages, per-second rates, run queue, load and imbalance are sent in
+// 1/100, network rates in kbit/s, seconds_to_full in whole seconds (-1 when
+// not filling). A section that is absent reads back as zero and leaves the
+// matching available flag unset.
+//
+// "SMW1" batches, which have neither the optional sections nor disk growth,
+// still decode.
+constexpr char kWireMagic[4] = {'S', 'M', 'W', '2'};
+constexpr char kWireMagicV1[4] = {'S', 'M', 'W', '1'};
+
+// Integer form of a snapshot, the unit of delta encoding
+struct WireFrame {
+    int64_t timestamp_ms = 0;
+    int64_t cpu = 0;
+    int64_t iowait = 0;
+    std::vector<int64_t> cores;
+    std::array<int64_t, 6> memory{};
+    std::vector<std::array<int64_t, 5>> disks;
+    std::vector<std::array<int64_t, 4>> nics;
+    std::array<int64_t, 11> scheduler{};
+    std::array<int64_t, 5> interrupts{};
+    std::vector<std::array<int64_t, 3>> core_interrupts;
+};
+
+class WireEncoder {
+public:
+    // Start a batch in out; resets the delta state
+    void begin(std::string& out, std::string_view host);
+    void append(std::string& out, const MetricSnapshot& snapshot);
+    size_t frames() const { return frames_; }
+
+private:
+    WireFrame prev_;
+    WireFrame cur_;
+    std::vector<std::string> disk_names_;
+    std::vector<std::string> nic_names_;
+    size_t frames_ = 0;
+};
+
+class WireDecoder {
+public:
+    // Decode a whole batch, appending one snapshot per frame
+    bool decode(std::string_view batch, std::string& host, std::vector<MetricSnapshot>& out);
+
+private:
+    WireFrame prev_;
+    std::vector<std::string> disk_names_;
+    std::vector<std::string> nic_names_;
+};
+
+// One line per measurement, nanosecond timestamps
+void append_line_protocol(std::string& out, std::string_view host, const MetricSnapshot& snapshot);
+
+// Push message framing, used on TCP streams, UDP datagrams and the spool:
+//   "SMPB", u8 version, u8 WireFormat, u8 Codec, u8 reserved,
+//   u32 raw_size, u32 payload_size, payload
+constexpr char kPushMagic[4] = {'S', 'M', 'P', 'B'};
+constexpr uint8_t kPushVersion = 1;
+constexpr size_t kPushHeaderSize = 16;
+constexpr uint32_t kMaxPushPayload = 64u << 20;
+
+struct PushHeader {
+    WireFormat format = WireFormat::Binary;
+    Codec codec = Codec::None;
+    uint32_t raw_size = 0;
+    uint32_t payload_size = 0;
+};
+
+// Compress raw and append header + payload to out
+bool encode_push_message(std::string& out, WireFormat format, Codec codec, std::string_view raw);
+bool parse_push_header(const char* data, size_t size, PushHeader& out);
+
+} // namespace sysmon
@@ -1,7 +1,9 @@
 #include "sysmon/alert_engine.hpp"
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <tuple>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -12,30 +14,67 @@ namespace sysmon {
 AlertEngine::AlertEngine(const AlertConfig& config)
     : alert_config_(config)
 {
-    if (alert_config_.log_to_file && alert_config_.enabled) {
-        log_file_.open(alert_config_.log_path, std::ios::app);
-        if (!log_file_.is_open()) {
-            std::cerr << "Warning: Failed to open log file: " << alert_config_.log_path << "\n";
-        }
-    }
+    open_log();
+    compile_rules();
 }
 
-AlertEngine::~AlertEngine() {
-    if (log_file_.is_open()) {
-        log_file_.close();
-    }
-}
+AlertEngine::~AlertEngine() = default;
 
 void AlertEngine::update_config(const AlertConfig& config) {
+    // Everything the sink was opened with; anything else changes in place
+    auto log_settings = [](const AlertConfig& c) {
+        return std::tie(c.enabled, c.log_to_file, c.log_path, c.log_format, c.log_queue_size,
+                        c.log_flush_interval_ms, c.log_flush_kb, c.log_max_size_mb, c.log_max_files,
+                        c.log_compress);
+    };
+    bool reopen_log = log_settings(alert_config_) != log_settings(config);
+    bool recompile = !(alert_config_.rules == config.rules);
     alert_config_ = config;
     
-    // Reopen log file if needed
-    if (log_file_.is_open()) {
-        log_file_.close();
+    // Reopen log file if needed (old sink flushes on destruction)
+    if (reopen_log) {
+        if (log_sink_) {
+            closed_sinks_dropped_ += log_sink_->dropped();
+        }
+        log_sink_.reset();
+        open_log();
     }
+    // Unchanged rules keep their rate()/avg_over() history across a recompile
+    if (recompile) {
+        compile_rules();
+    }
+}
+
+void AlertEngine::open_log() {
+    if (!alert_config_.log_to_file || !alert_config_.enabled) {
+        return;
+    }
+    
+    LogSinkOptions options;
+    options.path = alert_config_.log_path;
+    if (!parse_log_format(alert_config_.log_format, options.format)) {
+        std::cerr << "Warning: Unknown log_format '" << alert_config_.log_format << "', using text\n";
+    }
+    options.queue_size = static_cast<size_t>(std::max(16, alert_config_.log_queue_size));
+    options.flush_interval = std::chrono::milliseconds(std::max(1, alert_config_.log_flush_interval_ms));
+    options.flush_bytes = static_cast<size_t>(std::max(1, alert_config_.log_flush_kb)) * 1024;
+    options.max_file_bytes = static_cast<uint64_t>(std::max(0, alert_config_.log_max_size_mb)) * 1024 * 1024;
+    options.max_files = alert_config_.log_max_files;
+    options.compress_rotated = alert_config_.log_compress;
     
-    if (alert_config_.log_to_file && alert_config_.enabled) {
-        log_file_.open(alert_config_.log_path, std::ios::app);
+    log_sink_ = std::make_unique<LogSink>(options);
+    if (!log_sink_->is_open()) {
+        std::cerr << "Warning: Failed to open log file: " << alert_config_.log_path << "\n";
+        log_sink_.reset();
+    }
+}
+
+void AlertEngine::compile_rules() {
+    std::vector<std::string> errors;
+    if (!rule_engine_.compile(alert_config_.rules, errors)) {
+        for (const auto& error : errors) {
+            std::cerr << "Warning: Ignoring alert " << error << "\n";
+        }
     }
 }
 
@@ -48,20 +87,6 @@ AlertLevel AlertEngine::determine_level(double value, const ThresholdConfig& thr
     return AlertLevel::Normal;
 }
 
-std::string AlertEngine::format_timestamp(const std::chrono::system_clock::time_point& tp) {
-    auto time_t = std::chrono::system_clock::to_time_t(tp);
-    std::tm tm;
-#ifdef _WIN32
-    localtime_s(&tm, &time_t);
-#else
-    localtime_r(&time_t, &tm);
-#endif
-    
-    std::ostringstream oss;
-    oss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
-    return oss.str();
-}
-
 std::vector<Alert> AlertEngine::check_cpu(const CpuMetrics& metrics, const CpuConfig& config) {
     std::vector<Alert> alerts;
     
@@ -76,6 +101,9 @@ std::vector<Alert> AlertEngine::check_cpu(const CpuMetrics& metrics, const CpuCo
         alert.category = "CPU";
         alert.level = level;
         alert.timestamp = std::chrono::system_clock::now();
+        alert.monotonic = std::chrono::steady_clock::now();
+        alert.value = metrics.overall_usage;
+        alert.threshold = level == AlertLevel::Critical ? config.thresholds.critical : config.thresholds.warning;
         
         std::ostringstream oss;
         oss << "CPU usage: " << std::fixed << std::setprecision(1) << metrics.overall_usage << "%";
@@ -97,6 +125,10 @@ std::vector<Alert> AlertEngine::check_cpu(const CpuMetrics& metrics, const CpuCo
                 alert.category = "CPU";
                 alert.level = core_level;
                 alert.timestamp = std::chrono::system_clock::now();
+                alert.monotonic = std::chrono::steady_clock::now();
+                alert.entity = "core " + std::to_string(i);
+                alert.value = metrics.per_core_usage[i];
+                alert.threshold = config.thresholds.critical;
                 
                 std::ostringstream oss;
                 oss << "CPU Core " << i << " usage: " << std::fixed << std::setprecision(1) 
@@ -110,6 +142,66 @@ std::vector<Alert> AlertEngine::check_cpu(const CpuMetrics& metrics, const CpuCo
     return alerts;
 }
 
+// Sockets and physical cores, which per-thread usage and the host average
+// both hide: one busy socket of two reads as 50% overall, and a core whose
+// SMT siblings are both busy has no headroom left
+std::vector<Alert> AlertEngine::check_topology(const CpuTopologyMetrics& metrics, const CpuConfig& config) {
+    std::vector<Alert> alerts;
+    
+    if (!alert_config_.enabled || !config.enabled || !metrics.available) {
+        return alerts;
+    }
+    
+    auto add = [&](AlertLevel level, size_t package, double value, double threshold, const std::string& message) {
+        Alert alert;
+        alert.category = "CPU";
+        alert.level = level;
+        alert.timestamp = std::chrono::system_clock::now();
+        alert.monotonic = std::chrono::steady_clock::now();
+        alert.entity = "socket " + std::to_string(package);
+        alert.value = value;
+        alert.threshold = threshold;
+        alert.message = message;
+        alerts.push_back(alert);
+    };
+    
+    size_t first = 0;
+    for (size_t p = 0; p < metrics.package_cores.size(); ++p) {
+        size_t cores = metrics.package_cores[p];
+        // One package is the host, already covered by overall usage
+        if (metrics.package_cores.size() > 1) {
+            AlertLevel level = determine_level(metrics.package_usage[p], config.thresholds);
+            if (level != AlertLevel::Normal) {
+                double threshold = level == AlertLevel::Critical ? config.thresholds.critical : config.thresholds.warning;
+                std::ostringstream oss;
+                oss << "Socket " << p << " CPU usage: " << std::fixed << std::setprecision(1) << metrics.package_usage[p]
+                    << (level == AlertLevel::Critical ? "% (critical threshold: " : "% (warning threshold: ")
+                    << threshold << "%)";
+                add(level, p, metrics.package_usage[p], threshold, oss.str());
+            }
+        }
+        
+        size_t saturated = 0;
+        for (size_t c = first; c < first + cores && c < metrics.core_usage.size(); ++c) {
+            saturated += metrics.core_usage[c] >= config.core_saturation;
+        }
+        first += cores;
+        double share = cores > 0 ? 100.0 * saturated / cores : 0.0;
+        AlertLevel level = determine_level(share, config.saturated_cores);
+        if (level != AlertLevel::Normal) {
+            double threshold = level == AlertLevel::Critical ? config.saturated_cores.critical : config.saturated_cores.warning;
+            std::ostringstream oss;
+            oss << "Socket " << p << " saturated cores: " << saturated << " of " << cores << " physical cores at "
+                << std::fixed << std::setprecision(0) << config.core_saturation << "%+"
+                << (level == AlertLevel::Critical ? " (critical threshold: " : " (warning threshold: ")
+                << threshold << "%)";
+            add(level, p, share, threshold, oss.str());
+        }
+    }
+    
+    return alerts;
+}
+
 std::vector<Alert> AlertEngine::check_memory(const MemoryMetrics& metrics, const MemoryConfig& config) {
     std::vector<Alert> alerts;
     
@@ -123,6 +215,9 @@ std::vector<Alert> AlertEngine::check_memory(const MemoryMetrics& metrics, const
         alert.category = "Memory";
         alert.level = level;
         alert.timestamp = std::chrono::system_clock::now();
+        alert.monotonic = std::chrono::steady_clock::now();
+        alert.value = metrics.usage_percent;
+        alert.threshold = level == AlertLevel::Critical ? config.thresholds.critical : config.thresholds.warning;
         
         std::ostringstream oss;
         oss << "Memory usage: " << std::fixed << std::setprecision(1) << metrics.usage_percent << "%";
@@ -143,12 +238,49 @@ std::vector<Alert> AlertEngine::check_disk(const std::vector<DiskMetrics>& metri
     }
     
     for (const auto& disk : metrics) {
-        AlertLevel level = determine_level(disk.usage_percent, config.thresholds);
+        const ThresholdConfig& thresholds = config.thresholds_for(disk.mount_point);
+        AlertLevel level = determine_level(disk.usage_percent, thresholds);
+        
+        // Projected exhaustion, reported when it is more urgent than the usage level
+        AlertLevel forecast_level = AlertLevel::Normal;
+        if (config.forecast_horizon_hours > 0.0 && disk.seconds_to_full >= 0.0) {
+            double hours = disk.seconds_to_full / 3600.0;
+            if (hours <= config.forecast_critical_hours) {
+                forecast_level = AlertLevel::Critical;
+            } else if (hours <= config.forecast_horizon_hours) {
+                forecast_level = AlertLevel::Warning;
+            }
+        }
+        if (static_cast<int>(forecast_level) > static_cast<int>(level)) {
+            Alert alert;
+            alert.category = "Disk";
+            alert.level = forecast_level;
+            alert.timestamp = std::chrono::system_clock::now();
+            alert.monotonic = std::chrono::steady_clock::now();
+            alert.entity = disk.mount_point;
+            alert.value = disk.seconds_to_full / 3600.0;
+            alert.threshold = forecast_level == AlertLevel::Critical ? config.forecast_critical_hours
+                                                                     : config.forecast_horizon_hours;
+            
+            std::ostringstream oss;
+            oss << disk.label << " (" << disk.mount_point << ") projected full in ~" 
+                << std::fixed << std::setprecision(1) << alert.value << "h";
+            oss << " (" << std::setprecision(1) << disk.usage_percent << "%, growing "
+                << (disk.growth_bytes_per_sec * 3600.0 / (1024*1024)) << " MB/h)";
+            alert.message = oss.str();
+            alerts.push_back(alert);
+            continue;
+        }
+        
         if (level != AlertLevel::Normal) {
             Alert alert;
             alert.category = "Disk";
             alert.level = level;
             alert.timestamp = std::chrono::system_clock::now();
+            alert.monotonic = std::chrono::steady_clock::now();
+            alert.entity = disk.mount_point;
+            alert.value = disk.usage_percent;
+            alert.threshold = level == AlertLevel::Critical ? thresholds.critical : thresholds.warning;
             
             std::ostringstream oss;
             oss << disk.label << " (" << disk.mount_point << ") usage: " 
@@ -163,21 +295,143 @@ std::vector<Alert> AlertEngine::check_disk(const std::vector<DiskMetrics>& metri
     return alerts;
 }
 
-void AlertEngine::log_alert(const Alert& alert) {
-    if (!alert_config_.log_to_file || !log_file_.is_open()) {
-        return;
+std::vector<Alert> AlertEngine::check_scheduler(const SchedulerMetrics& metrics, const SchedulerConfig& config) {
+    std::vector<Alert> alerts;
+    
+    if (!alert_config_.enabled || !config.enabled || !metrics.available) {
+        return alerts;
+    }
+    
+    auto check = [&](double value, const ThresholdConfig& thresholds, const char* what, int precision) {
+        AlertLevel level = determine_level(value, thresholds);
+        if (level == AlertLevel::Normal) {
+            return;
+        }
+        Alert alert;
+        alert.category = "Scheduler";
+        alert.level = level;
+        alert.timestamp = std::chrono::system_clock::now();
+        alert.monotonic = std::chrono::steady_clock::now();
+        alert.value = value;
+        alert.threshold = level == AlertLevel::Critical ? thresholds.critical : thresholds.warning;
+        
+        std::ostringstream oss;
+        oss << what << ": " << std::fixed << std::setprecision(precision) << value
+            << (level == AlertLevel::Critical ? " (critical threshold: " : " (warning threshold: ")
+            << alert.threshold << ")";
+        alert.message = oss.str();
+        alerts.push_back(alert);
+    };
+    check(metrics.run_queue_per_core, config.run_queue_per_core, "Run queue per core", 2);
+    // Tasks stuck in D state are usually waiting on storage
+    check(metrics.procs_blocked, config.blocked_tasks, "Blocked tasks", 0);
+    
+    return alerts;
+}
+
+// Device interrupts piling onto a few CPUs, which overall usage hides
+std::vector<Alert> AlertEngine::check_interrupts(const InterruptMetrics& metrics, const InterruptConfig& config) {
+    std::vector<Alert> alerts;
+    
+    if (!alert_config_.enabled || !config.enabled || !metrics.available ||
+        metrics.busiest_cpu < 0 || metrics.irq_total < config.min_rate) {
+        return alerts;
+    }
+    
+    AlertLevel level = determine_level(metrics.imbalance, {config.imbalance_warning, config.imbalance_critical});
+    if (level != AlertLevel::Normal) {
+        Alert alert;
+        alert.category = "Interrupts";
+        alert.level = level;
+        alert.timestamp = std::chrono::system_clock::now();
+        alert.monotonic = std::chrono::steady_clock::now();
+        alert.entity = "core " + std::to_string(metrics.busiest_cpu);
+        alert.value = metrics.imbalance;
+        alert.threshold = level == AlertLevel::Critical ? config.imbalance_critical : config.imbalance_warning;
+        
+        std::ostringstream oss;
+        oss << "IRQ imbalance: core " << metrics.busiest_cpu << " takes " << std::fixed << std::setprecision(1)
+            << metrics.imbalance << "x the mean interrupt rate ("
+            << static_cast<uint64_t>(metrics.irq_per_cpu[static_cast<size_t>(metrics.busiest_cpu)]) << "/s)";
+        alert.message = oss.str();
+        alerts.push_back(alert);
+    }
+    
+    return alerts;
+}
+
+// One node filling up while the host still has memory, and allocations
+// served from the wrong node. A single node is the host, already covered
+std::vector<Alert> AlertEngine::check_numa(const NumaMetrics& metrics, const NumaConfig& config) {
+    std::vector<Alert> alerts;
+    
+    if (!alert_config_.enabled || !config.enabled || metrics.nodes.size() < 2) {
+        return alerts;
+    }
+    
+    auto check = [&](const NumaNodeMetrics& node, double value, const ThresholdConfig& thresholds, const char* what) {
+        AlertLevel level = determine_level(value, thresholds);
+        if (level == AlertLevel::Normal) {
+            return;
+        }
+        Alert alert;
+        alert.category = "NUMA";
+        alert.level = level;
+        alert.timestamp = std::chrono::system_clock::now();
+        alert.monotonic = std::chrono::steady_clock::now();
+        alert.entity = "node " + std::to_string(node.node);
+        alert.value = value;
+        alert.threshold = level == AlertLevel::Critical ? thresholds.critical : thresholds.warning;
+        
+        std::ostringstream oss;
+        oss << "Node " << node.node << " " << what << ": " << std::fixed << std::setprecision(1) << value << "%"
+            << (level == AlertLevel::Critical ? " (critical threshold: " : " (warning threshold: ")
+            << alert.threshold << "%)";
+        alert.message = oss.str();
+        alerts.push_back(alert);
+    };
+    for (const auto& node : metrics.nodes) {
+        check(node, node.usage_percent, config.thresholds, "memory usage");
+        if (node.local_allocs_per_sec + node.remote_allocs_per_sec >= config.min_allocs_per_sec) {
+            check(node, node.remote_percent, config.remote_percent, "remote allocations");
+        }
     }
     
-    std::string level_str;
-    switch (alert.level) {
-        case AlertLevel::Warning:  level_str = "WARNING";  break;
-        case AlertLevel::Critical: level_str = "CRITICAL"; break;
-        default:                   level_str = "INFO";     break;
+    return alerts;
+}
+
+std::vector<Alert> AlertEngine::check_rules(const MetricSnapshot& snapshot) {
+    std::vector<Alert> alerts;
+    
+    if (!alert_config_.enabled) {
+        return alerts;
     }
     
-    log_file_ << "[" << format_timestamp(alert.timestamp) << "] "
-              << level_str << " - " << alert.category << ": " << alert.message << "\n";
-    log_file_.flush();
+    rule_engine_.evaluate(snapshot, alerts);
+    return alerts;
+}
+
+std::vector<Alert> AlertEngine::check_anomalies(const MetricSnapshot& snapshot, const SysMonConfig& config) {
+    std::vector<Alert> alerts;
+    
+    if (!alert_config_.enabled || !config.anomaly.enabled) {
+        return alerts;
+    }
+    
+    anomaly_detector_.observe_snapshot(snapshot, config, alerts);
+    return alerts;
+}
+
+void AlertEngine::log_alert(const Alert& alert) {
+    if (!alert_config_.log_to_file || !log_sink_) {
+        return;
+    }
+    
+    log_sink_->submit(alert);
+}
+
+uint64_t AlertEngine::log_records_dropped() const {
+    return closed_sinks_dropped_ + (log_sink_ ? log_sink_->dropped() : 0);
 }
 
 void AlertEngine::beep_if_enabled() {
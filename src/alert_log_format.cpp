@@ -0,0 +1,416 @@
+#include "sysmon/alert_log_format.hpp"
+#include "sysmon/alert_engine.hpp"
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+
+namespace sysmon {
+
+static_assert(std::endian::native == std::endian::little,
+              "binary alert log is written in host byte order, which must be little-endian");
+
+namespace {
+
+template<typename T>
+void put(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+template<typename T>
+T get(const char*& p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    p += sizeof(T);
+    return value;
+}
+
+} // namespace
+
+void append_json_string(std::string& out, std::string_view text) {
+    static const char hex[] = "0123456789abcdef";
+    out.push_back('"');
+    size_t run = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        out.append(text.data() + run, i - run);
+        run = i + 1;
+        switch (c) {
+            case '"':  out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\n': out.append("\\n"); break;
+            case '\t': out.append("\\t"); break;
+            case '\r': out.append("\\r"); break;
+            default:
+                out.append("\\u00");
+                out.push_back(hex[c >> 4]);
+                out.push_back(hex[c & 0xF]);
+        }
+    }
+    out.append(text.data() + run, text.size() - run);
+    out.push_back('"');
+}
+
+namespace {
+
+template<typename T>
+void append_number(std::string& out, T value) {
+    char buf[32];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr - buf);
+}
+
+void append_double(std::string& out, double value) {
+    if (!std::isfinite(value)) {
+        out.append("null");
+        return;
+    }
+    append_number(out, value);
+}
+
+void append_utf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+// Minimal scanner for the flat objects produced by append_jsonl()
+class JsonScanner {
+public:
+    JsonScanner(std::string_view text, std::string& scratch)
+        : p_(text.data()), end_(text.data() + text.size()), scratch_(scratch) {}
+
+    void skip_ws() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\r' || *p_ == '\n')) ++p_;
+    }
+
+    bool consume(char c) {
+        skip_ws();
+        if (p_ < end_ && *p_ == c) {
+            ++p_;
+            return true;
+        }
+        return false;
+    }
+
+    bool peek(char c) {
+        skip_ws();
+        return p_ < end_ && *p_ == c;
+    }
+
+    bool string(std::string_view& out) {
+        if (!consume('"')) return false;
+        const char* start = p_;
+        while (p_ < end_ && *p_ != '"' && *p_ != '\\') ++p_;
+        if (p_ >= end_) return false;
+        if (*p_ == '"') {
+            out = std::string_view(start, p_ - start);
+            ++p_;
+            return true;
+        }
+
+        // Escapes present: unescape into scratch (reserved up front, so
+        // earlier views into it stay valid)
+        size_t begin = scratch_.size();
+        scratch_.append(start, p_ - start);
+        while (p_ < end_ && *p_ != '"') {
+            if (*p_ != '\\') {
+                scratch_.push_back(*p_++);
+                continue;
+            }
+            if (++p_ >= end_) return false;
+            char e = *p_++;
+            switch (e) {
+                case '"':  scratch_.push_back('"'); break;
+                case '\\': scratch_.push_back('\\'); break;
+                case '/':  scratch_.push_back('/'); break;
+                case 'b':  scratch_.push_back('\b'); break;
+                case 'f':  scratch_.push_back('\f'); break;
+                case 'n':  scratch_.push_back('\n'); break;
+                case 'r':  scratch_.push_back('\r'); break;
+                case 't':  scratch_.push_back('\t'); break;
+                case 'u': {
+                    uint32_t cp;
+                    if (!hex4(cp)) return false;
+                    if (cp >= 0xD800 && cp < 0xDC00 && end_ - p_ >= 6 && p_[0] == '\\' && p_[1] == 'u') {
+                        p_ += 2;
+                        uint32_t low;
+                        if (!hex4(low)) return false;
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    append_utf8(scratch_, cp);
+                    break;
+                }
+                default: return false;
+            }
+        }
+        if (p_ >= end_) return false;
+        ++p_;
+        out = std::string_view(scratch_.data() + begin, scratch_.size() - begin);
+        return true;
+    }
+
+    template<typename T>
+    bool number(T& out) {
+        skip_ws();
+        if (end_ - p_ >= 4 && std::memcmp(p_, "null", 4) == 0) {
+            p_ += 4;
+            out = T{};
+            return true;
+        }
+        auto result = std::from_chars(p_, end_, out);
+        if (result.ec != std::errc()) return false;
+        p_ = result.ptr;
+        return true;
+    }
+
+    // Skip a value of a key we do not know about
+    bool skip_value() {
+        skip_ws();
+        if (peek('"')) {
+            std::string_view ignored;
+            return string(ignored);
+        }
+        while (p_ < end_ && *p_ != ',' && *p_ != '}') ++p_;
+        return p_ < end_;
+    }
+
+private:
+    bool hex4(uint32_t& out) {
+        if (end_ - p_ < 4) return false;
+        auto result = std::from_chars(p_, p_ + 4, out, 16);
+        if (result.ptr != p_ + 4) return false;
+        p_ += 4;
+        return true;
+    }
+
+    const char* p_;
+    const char* end_;
+    std::string& scratch_;
+};
+
+bool iequals(std::string_view a, std::string_view b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+} // namespace
+
+bool parse_log_format(const std::string& name, LogFormat& out) {
+    if (name == "text") {
+        out = LogFormat::Text;
+    } else if (name == "jsonl" || name == "json") {
+        out = LogFormat::JsonLines;
+    } else if (name == "binary") {
+        out = LogFormat::Binary;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool has_binary_log_magic(const char* data, size_t size) {
+    return size >= sizeof(kBinaryLogMagic) && std::memcmp(data, kBinaryLogMagic, sizeof(kBinaryLogMagic)) == 0;
+}
+
+LogFormat detect_log_format(const char* data, size_t size) {
+    if (has_binary_log_magic(data, size)) {
+        return LogFormat::Binary;
+    }
+    return size > 0 && data[0] == '{' ? LogFormat::JsonLines : LogFormat::Text;
+}
+
+const char* log_level_name(AlertLevel level) {
+    switch (level) {
+        case AlertLevel::Warning:  return "WARNING";
+        case AlertLevel::Critical: return "CRITICAL";
+        default:                   return "INFO";
+    }
+}
+
+bool parse_log_level(std::string_view name, AlertLevel& out) {
+    if (iequals(name, "warning")) {
+        out = AlertLevel::Warning;
+    } else if (iequals(name, "critical")) {
+        out = AlertLevel::Critical;
+    } else if (iequals(name, "info") || iequals(name, "normal")) {
+        out = AlertLevel::Normal;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string_view TimestampFormatter::prefix(int64_t timestamp_us) {
+    int64_t second = timestamp_us / 1000000;
+    if (second != second_) {
+        std::time_t time_t = static_cast<std::time_t>(second);
+        std::tm tm;
+#ifdef _WIN32
+        localtime_s(&tm, &time_t);
+#else
+        localtime_r(&time_t, &tm);
+#endif
+        length_ = std::strftime(buffer_, sizeof(buffer_), "[%Y-%m-%d %H:%M:%S] ", &tm);
+        second_ = second;
+    }
+    return std::string_view(buffer_, length_);
+}
+
+void append_text(std::string& out, const AlertLogEntry& entry, TimestampFormatter& timestamps) {
+    out.append(timestamps.prefix(entry.timestamp_us));
+    out.append(log_level_name(entry.level));
+    out.append(" - ");
+    out.append(entry.category);
+    out.append(": ");
+    out.append(entry.message);
+    out.push_back('\n');
+}
+
+void append_jsonl(std::string& out, const AlertLogEntry& entry) {
+    out.append("{\"ts_us\":");
+    append_number(out, entry.timestamp_us);
+    out.append(",\"mono_ns\":");
+    append_number(out, entry.monotonic_ns);
+    out.append(",\"level\":\"");
+    out.append(log_level_name(entry.level));
+    out.append("\",\"category\":");
+    append_json_string(out, entry.category);
+    out.append(",\"entity\":");
+    append_json_string(out, entry.entity);
+    out.append(",\"value\":");
+    append_double(out, entry.value);
+    out.append(",\"threshold\":");
+    append_double(out, entry.threshold);
+    out.append(",\"message\":");
+    append_json_string(out, entry.message);
+    out.append("}\n");
+}
+
+void append_binary(std::string& out, const AlertLogEntry& entry) {
+    size_t category_len = std::min<size_t>(entry.category.size(), UINT8_MAX);
+    size_t entity_len = std::min<size_t>(entry.entity.size(), UINT8_MAX);
+    size_t message_len = std::min<size_t>(entry.message.size(),
+                                          UINT16_MAX - kBinaryLogFixedBytes - category_len - entity_len);
+
+    put<uint16_t>(out, static_cast<uint16_t>(kBinaryLogFixedBytes + category_len + entity_len + message_len));
+    put<int64_t>(out, entry.timestamp_us);
+    put<int64_t>(out, entry.monotonic_ns);
+    put<double>(out, entry.value);
+    put<double>(out, entry.threshold);
+    put<uint8_t>(out, static_cast<uint8_t>(entry.level));
+    put<uint8_t>(out, static_cast<uint8_t>(category_len));
+    put<uint8_t>(out, static_cast<uint8_t>(entity_len));
+    put<uint16_t>(out, static_cast<uint16_t>(message_len));
+    out.append(entry.category.data(), category_len);
+    out.append(entry.entity.data(), entity_len);
+    out.append(entry.message.data(), message_len);
+}
+
+size_t decode_binary(const char* data, size_t size, AlertLogEntry& out) {
+    if (size < sizeof(uint16_t)) {
+        return 0;
+    }
+    const char* p = data;
+    size_t payload = get<uint16_t>(p);
+    if (payload < kBinaryLogFixedBytes) {
+        return SIZE_MAX;
+    }
+    if (size < sizeof(uint16_t) + payload) {
+        return 0;
+    }
+
+    out.timestamp_us = get<int64_t>(p);
+    out.monotonic_ns = get<int64_t>(p);
+    out.value = get<double>(p);
+    out.threshold = get<double>(p);
+    uint8_t level = get<uint8_t>(p);
+    size_t category_len = get<uint8_t>(p);
+    size_t entity_len = get<uint8_t>(p);
+    size_t message_len = get<uint16_t>(p);
+    if (level > static_cast<uint8_t>(AlertLevel::Critical) ||
+        kBinaryLogFixedBytes + category_len + entity_len + message_len != payload) {
+        return SIZE_MAX;
+    }
+
+    out.level = static_cast<AlertLevel>(level);
+    out.category = std::string_view(p, category_len);
+    p += category_len;
+    out.entity = std::string_view(p, entity_len);
+    p += entity_len;
+    out.message = std::string_view(p, message_len);
+    return sizeof(uint16_t) + payload;
+}
+
+bool decode_jsonl(std::string_view line, AlertLogEntry& out, std::string& scratch) {
+    scratch.clear();
+    scratch.reserve(line.size());
+    out = AlertLogEntry{};
+    out.level = AlertLevel::Normal;
+
+    JsonScanner json(line, scratch);
+    if (!json.consume('{')) {
+        return false;
+    }
+    if (json.consume('}')) {
+        return true;
+    }
+
+    do {
+        std::string_view key;
+        if (!json.string(key) || !json.consume(':')) {
+            return false;
+        }
+
+        bool ok = true;
+        if (key == "ts_us") {
+            ok = json.number(out.timestamp_us);
+        } else if (key == "mono_ns") {
+            ok = json.number(out.monotonic_ns);
+        } else if (key == "value") {
+            ok = json.number(out.value);
+        } else if (key == "threshold") {
+            ok = json.number(out.threshold);
+        } else if (key == "level") {
+            std::string_view level;
+            ok = json.string(level) && parse_log_level(level, out.level);
+        } else if (key == "category") {
+            ok = json.string(out.category);
+        } else if (key == "entity") {
+            ok = json.string(out.entity);
+        } else if (key == "message") {
+            ok = json.string(out.message);
+        } else {
+            ok = json.skip_value();
+        }
+        if (!ok) {
+            return false;
+        }
+    } while (json.consume(','));
+
+    return json.consume('}');
+}
+
+} // namespace sysmon
@@ -0,0 +1,26 @@
+#include "sysmon/self_stats.hpp"
+#include <cstdlib>
+#include <new>
+
+// Replaceable global allocation functions that count allocations per thread
+// for SelfStats and the benchmarks' allocs/iter. Linked into the sysmon
+// executable and sysmon_bench, not the tests.
+
+namespace {
+
+void* counted_alloc(std::size_t size) {
+    ++sysmon::detail::t_heap_allocations;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return counted_alloc(size); }
+void* operator new[](std::size_t size) { return counted_alloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
@@ -0,0 +1,343 @@
+#include "sysmon/anomaly_detector.hpp"
+#include "sysmon/alert_engine.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace sysmon {
+
+namespace {
+
+// Scale factor turning a MAD into a standard deviation for normal data
+constexpr double kMadToSigma = 1.4826;
+
+// Weight of the newest cycle when folding a finished bucket into the
+// seasonal baseline (per cycle, not per sample)
+constexpr double kSeasonAlpha = 0.3;
+
+// Floor on the spread so flat series do not divide by zero; min_deviation
+// keeps them from firing on noise
+constexpr double kMinSigma = 1e-6;
+
+double z_score(double x, double baseline, double sigma) {
+    return std::fabs(x - baseline) / std::max(sigma, kMinSigma);
+}
+
+} // namespace
+
+bool parse_anomaly_method(const std::string& name, AnomalyMethod& out) {
+    if (name == "ewma") {
+        out = AnomalyMethod::Ewma;
+    } else if (name == "mad") {
+        out = AnomalyMethod::Mad;
+    } else if (name == "seasonal") {
+        out = AnomalyMethod::Seasonal;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool AnomalyConfig::validate() const {
+    AnomalyMethod parsed;
+    return parse_anomaly_method(method, parsed) &&
+           ewma_alpha > 0.0 && ewma_alpha <= 1.0 &&
+           z_warning > 0.0 && z_warning <= z_critical &&
+           min_deviation >= 0.0 && warmup_samples > 0 &&
+           seasonal_period_minutes > 0 && seasonal_buckets > 0 && max_series > 0;
+}
+
+std::string SeriesKey::display_name() const {
+    if (!name.empty()) {
+        return group + " " + name;
+    }
+    if (group == "core") {
+        return group + " " + std::to_string(index);
+    }
+    return group;
+}
+
+size_t SeriesKeyHash::operator()(const SeriesKey& key) const {
+    size_t h = std::hash<std::string>{}(key.group);
+    h ^= std::hash<uint32_t>{}(key.index) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    h ^= std::hash<std::string>{}(key.name) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    return h;
+}
+
+SeriesStats::Score SeriesStats::observe(double x, int64_t wall_seconds, AnomalyMethod method,
+                                        const AnomalyConfig& config) {
+    Score score;
+    switch (method) {
+        case AnomalyMethod::Ewma:
+            score = score_ewma(x, config);
+            update_ewma(x, config.ewma_alpha);
+            break;
+        case AnomalyMethod::Mad:
+            score = score_mad(x, config);
+            update_window(x);
+            break;
+        case AnomalyMethod::Seasonal: {
+            int64_t period = static_cast<int64_t>(config.seasonal_period_minutes) * 60;
+            int buckets = std::clamp(config.seasonal_buckets, 1, static_cast<int>(kMaxSeasonBuckets));
+            int64_t bucket_len = std::max<int64_t>(period / buckets, 1);
+            int64_t cycle = wall_seconds / period;
+            int bucket = static_cast<int>(std::min<int64_t>((wall_seconds % period) / bucket_len, buckets - 1));
+            score = score_seasonal(x, bucket);
+            update_seasonal(x, bucket, cycle, kSeasonAlpha);
+            break;
+        }
+    }
+    return score;
+}
+
+SeriesStats::Score SeriesStats::score_ewma(double x, const AnomalyConfig& config) const {
+    Score score;
+    if (count_ < static_cast<uint32_t>(config.warmup_samples)) {
+        return score;
+    }
+    score.ready = true;
+    score.baseline = mean_;
+    score.z = z_score(x, mean_, std::sqrt(var_));
+    return score;
+}
+
+SeriesStats::Score SeriesStats::score_mad(double x, const AnomalyConfig& config) {
+    Score score;
+    size_t needed = std::min<size_t>(static_cast<size_t>(config.warmup_samples), kWindow);
+    if (filled_ < needed) {
+        return score;
+    }
+
+    size_t n = filled_;
+    double median = n % 2 ? sorted_[n / 2] : 0.5 * (sorted_[n / 2 - 1] + sorted_[n / 2]);
+
+    std::array<float, kWindow> deviations{};
+    for (size_t i = 0; i < n; ++i) {
+        deviations[i] = static_cast<float>(std::fabs(sorted_[i] - median));
+    }
+    auto mid = deviations.begin() + n / 2;
+    std::nth_element(deviations.begin(), mid, deviations.begin() + n);
+    double mad = *mid;
+
+    score.ready = true;
+    score.baseline = median;
+    score.z = z_score(x, median, kMadToSigma * mad);
+    return score;
+}
+
+SeriesStats::Score SeriesStats::score_seasonal(double x, int bucket) const {
+    Score score;
+    if (season_cycles_[bucket] == 0) {
+        return score;
+    }
+    score.ready = true;
+    score.baseline = season_mean_[bucket];
+    score.z = z_score(x, score.baseline, std::sqrt(season_var_[bucket]));
+    return score;
+}
+
+void SeriesStats::update_ewma(double x, double alpha) {
+    if (count_ == 0) {
+        mean_ = x;
+        var_ = 0.0;
+    } else {
+        // Incremental exponentially weighted mean and variance
+        double diff = x - mean_;
+        double incr = alpha * diff;
+        mean_ += incr;
+        var_ = (1.0 - alpha) * (var_ + diff * incr);
+    }
+    if (count_ < UINT32_MAX) {
+        ++count_;
+    }
+}
+
+void SeriesStats::update_window(double x) {
+    float value = static_cast<float>(x);
+
+    if (filled_ == kWindow) {
+        // Evict the oldest sample from the sorted copy
+        float oldest = ring_[ring_pos_];
+        auto it = std::lower_bound(sorted_.begin(), sorted_.begin() + filled_, oldest);
+        std::copy(it + 1, sorted_.begin() + filled_, it);
+        --filled_;
+    }
+
+    auto it = std::upper_bound(sorted_.begin(), sorted_.begin() + filled_, value);
+    std::copy_backward(it, sorted_.begin() + filled_, sorted_.begin() + filled_ + 1);
+    *it = value;
+    ++filled_;
+
+    ring_[ring_pos_] = value;
+    ring_pos_ = static_cast<uint8_t>((ring_pos_ + 1) % kWindow);
+}
+
+void SeriesStats::update_seasonal(double x, int bucket, int64_t cycle, double alpha) {
+    if (bucket != current_bucket_ || cycle != current_cycle_) {
+        // The previous bucket is complete: fold its mean into the baseline
+        if (current_bucket_ >= 0 && bucket_n_ > 0) {
+            double m = bucket_sum_ / bucket_n_;
+            double v = std::max(bucket_sumsq_ / bucket_n_ - m * m, 0.0);
+            auto& cycles = season_cycles_[current_bucket_];
+            float& mean = season_mean_[current_bucket_];
+            float& var = season_var_[current_bucket_];
+            if (cycles == 0) {
+                mean = static_cast<float>(m);
+                var = static_cast<float>(v);
+            } else {
+                // Spread combines within-bucket noise and cycle-to-cycle drift
+                double d = m - mean;
+                mean = static_cast<float>(mean + alpha * d);
+                var = static_cast<float>((1.0 - alpha) * var + alpha * (v + d * d));
+            }
+            if (cycles < UINT16_MAX) {
+                ++cycles;
+            }
+        }
+        current_bucket_ = bucket;
+        current_cycle_ = cycle;
+        bucket_sum_ = 0.0;
+        bucket_sumsq_ = 0.0;
+        bucket_n_ = 0;
+    }
+    bucket_sum_ += x;
+    bucket_sumsq_ += x * x;
+    ++bucket_n_;
+}
+
+void AnomalyDetector::configure(const AnomalyConfig& config) {
+    AnomalyMethod method;
+    if (!parse_anomaly_method(config.method, method)) {
+        method = AnomalyMethod::Mad;
+    }
+    if (method != method_ ||
+        config.seasonal_period_minutes != config_.seasonal_period_minutes ||
+        config.seasonal_buckets != config_.seasonal_buckets) {
+        reset();
+    }
+    method_ = method;
+    config_ = config;
+}
+
+// A series that missed the previous tick (gone from the host), if any
+size_t AnomalyDetector::stale_slot() const {
+    for (size_t i = 0; i < series_.size(); ++i) {
+        if (series_[i].last_tick + 1 < tick_) {
+            return i;
+        }
+    }
+    return series_.size();
+}
+
+AnomalyDetector::Series* AnomalyDetector::find(const SeriesKey& key) {
+    // Fast path: same order as the previous tick
+    if (cursor_ < series_.size() && series_[cursor_].key == key) {
+        return &series_[cursor_++];
+    }
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        cursor_ = it->second + 1;
+        return &series_[it->second];
+    }
+
+    size_t slot = series_.size();
+    if (series_.size() >= static_cast<size_t>(config_.max_series)) {
+        slot = stale_slot();
+        if (slot == series_.size()) {
+            if (dropped_++ == 0) {
+                std::cerr << "Warning: anomaly detection tracks at most " << config_.max_series
+                          << " series; new series are not tracked (raise anomaly.max_series)\n";
+            }
+            return nullptr;
+        }
+        index_.erase(series_[slot].key);
+        series_[slot] = Series{key, SeriesStats{}, tick_};
+    } else {
+        series_.push_back(Series{key, SeriesStats{}, tick_});
+    }
+    index_.emplace(key, slot);
+    cursor_ = slot + 1;
+    return &series_[slot];
+}
+
+void AnomalyDetector::observe(const SeriesKey& key, double value, std::chrono::system_clock::time_point wall_time,
+                              std::vector<Alert>& alerts) {
+    Series* series = find(key);
+    if (!series) {
+        return;
+    }
+    series->last_tick = tick_;
+
+    const AnomalyConfig& config = config_;
+    int64_t wall_seconds = std::chrono::duration_cast<std::chrono::seconds>(wall_time.time_since_epoch()).count();
+    auto score = series->stats.observe(value, wall_seconds, method_, config);
+    if (!score.ready) {
+        return;
+    }
+
+    double deviation = std::fabs(value - score.baseline);
+    if (deviation < config.min_deviation || score.z < config.z_warning) {
+        return;
+    }
+
+    Alert alert;
+    alert.category = "Anomaly";
+    alert.level = score.z >= config.z_critical ? AlertLevel::Critical : AlertLevel::Warning;
+    alert.timestamp = std::chrono::system_clock::now();
+    alert.monotonic = std::chrono::steady_clock::now();
+    alert.entity = key.display_name();
+    alert.value = value;
+    alert.threshold = score.baseline;
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1);
+    oss << alert.entity << " is " << value << ", expected ~" << score.baseline
+        << " (" << score.z << " sigma)";
+    alert.message = oss.str();
+
+    alerts.push_back(alert);
+}
+
+void AnomalyDetector::observe_snapshot(const MetricSnapshot& snapshot, const SysMonConfig& config,
+                                       std::vector<Alert>& alerts) {
+    if (!(config.anomaly == config_)) {
+        configure(config.anomaly);
+    }
+    auto wall = snapshot.wall_time;
+    cursor_ = 0;
+    ++tick_;
+
+    if (config.cpu.enabled) {
+        observe({"cpu", 0, {}}, snapshot.cpu.overall_usage, wall, alerts);
+        if (config_.per_core) {
+            for (size_t i = 0; i < snapshot.cpu.per_core_usage.size(); ++i) {
+                observe({"core", static_cast<uint32_t>(i), {}}, snapshot.cpu.per_core_usage[i], wall, alerts);
+            }
+        }
+    }
+
+    if (config.memory.enabled) {
+        observe({"memory", 0, {}}, snapshot.memory.usage_percent, wall, alerts);
+    }
+
+    for (const auto& disk : snapshot.disks) {
+        observe({"disk", 0, disk.mount_point}, disk.usage_percent, wall, alerts);
+    }
+
+    for (const auto& net : snapshot.network) {
+        observe({"net.rx", 0, net.interface_name}, net.download_mbps, wall, alerts);
+        observe({"net.tx", 0, net.interface_name}, net.upload_mbps, wall, alerts);
+    }
+}
+
+void AnomalyDetector::reset() {
+    series_.clear();
+    index_.clear();
+    cursor_ = 0;
+}
+
+} // namespace sysmon
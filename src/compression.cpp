@@ -0,0 +1,175 @@
+#include "sysmon/compression.hpp"
+
+#ifdef SYSMON_HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef SYSMON_HAVE_LZ4
+#include <lz4.h>
+#endif
+#ifdef SYSMON_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace sysmon {
+
+namespace {
+
+// Fast settings: batches are small and shipping runs every few seconds
+constexpr int kZstdLevel = 3;
+constexpr int kZlibLevel = 1;
+
+} // namespace
+
+bool parse_codec(const std::string& name, Codec& out) {
+    if (name == "none") {
+        out = Codec::None;
+    } else if (name == "zstd") {
+        out = Codec::Zstd;
+    } else if (name == "lz4") {
+        out = Codec::Lz4;
+    } else if (name == "zlib") {
+        out = Codec::Zlib;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* codec_name(Codec codec) {
+    switch (codec) {
+        case Codec::None: return "none";
+        case Codec::Zstd: return "zstd";
+        case Codec::Lz4:  return "lz4";
+        case Codec::Zlib: return "zlib";
+    }
+    return "unknown";
+}
+
+bool codec_available(Codec codec) {
+    switch (codec) {
+        case Codec::None:
+            return true;
+        case Codec::Zstd:
+#ifdef SYSMON_HAVE_ZSTD
+            return true;
+#else
+            return false;
+#endif
+        case Codec::Lz4:
+#ifdef SYSMON_HAVE_LZ4
+            return true;
+#else
+            return false;
+#endif
+        case Codec::Zlib:
+#ifdef SYSMON_HAVE_ZLIB
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+bool compress_block(Codec codec, std::string_view input, std::string& out) {
+    size_t start = out.size();
+    switch (codec) {
+        case Codec::None:
+            out.append(input);
+            return true;
+#ifdef SYSMON_HAVE_ZSTD
+        case Codec::Zstd: {
+            out.resize(start + ZSTD_compressBound(input.size()));
+            size_t n = ZSTD_compress(&out[start], out.size() - start, input.data(), input.size(), kZstdLevel);
+            if (ZSTD_isError(n)) {
+                out.resize(start);
+                return false;
+            }
+            out.resize(start + n);
+            return true;
+        }
+#endif
+#ifdef SYSMON_HAVE_LZ4
+        case Codec::Lz4: {
+            out.resize(start + LZ4_compressBound(static_cast<int>(input.size())));
+            int n = LZ4_compress_default(input.data(), &out[start], static_cast<int>(input.size()),
+                                         static_cast<int>(out.size() - start));
+            if (n <= 0) {
+                out.resize(start);
+                return false;
+            }
+            out.resize(start + n);
+            return true;
+        }
+#endif
+#ifdef SYSMON_HAVE_ZLIB
+        case Codec::Zlib: {
+            uLongf len = compressBound(static_cast<uLong>(input.size()));
+            out.resize(start + len);
+            int rc = compress2(reinterpret_cast<Bytef*>(&out[start]), &len,
+                               reinterpret_cast<const Bytef*>(input.data()), static_cast<uLong>(input.size()),
+                               kZlibLevel);
+            if (rc != Z_OK) {
+                out.resize(start);
+                return false;
+            }
+            out.resize(start + len);
+            return true;
+        }
+#endif
+        default:
+            return false;
+    }
+}
+
+bool decompress_block(Codec codec, std::string_view input, size_t raw_size, std::string& out) {
+    size_t start = out.size();
+    switch (codec) {
+        case Codec::None:
+            if (input.size() != raw_size) {
+                return false;
+            }
+            out.append(input);
+            return true;
+#ifdef SYSMON_HAVE_ZSTD
+        case Codec::Zstd: {
+            out.resize(start + raw_size);
+            size_t n = ZSTD_decompress(&out[start], raw_size, input.data(), input.size());
+            if (ZSTD_isError(n) || n != raw_size) {
+                out.resize(start);
+                return false;
+            }
+            return true;
+        }
+#endif
+#ifdef SYSMON_HAVE_LZ4
+        case Codec::Lz4: {
+            out.resize(start + raw_size);
+            int n = LZ4_decompress_safe(input.data(), &out[start], static_cast<int>(input.size()),
+                                        static_cast<int>(raw_size));
+            if (n < 0 || static_cast<size_t>(n) != raw_size) {
+                out.resize(start);
+                return false;
+            }
+            return true;
+        }
+#endif
+#ifdef SYSMON_HAVE_ZLIB
+        case Codec::Zlib: {
+            out.resize(start + raw_size);
+            uLongf len = static_cast<uLongf>(raw_size);
+            int rc = uncompress(reinterpret_cast<Bytef*>(&out[start]), &len,
+                                reinterpret_cast<const Bytef*>(input.data()), static_cast<uLong>(input.size()));
+            if (rc != Z_OK || len != raw_size) {
+                out.resize(start);
+                return false;
+            }
+            return true;
+        }
+#endif
+        default:
+            return false;
+    }
+}
+
+} // namespace sysmon
@@ -7,11 +7,13 @@ namespace sysmon {
 
 ConfigManager::ConfigManager(const std::string& config_path)
     : config_path_(config_path)
+    , config_(std::make_shared<const SysMonConfig>())
     , last_modified_{}
+    , watcher_(config_path)
 {
 }
 
-bool ConfigManager::load() {
+ConfigSnapshot ConfigManager::parse() {
     try {
         // Update last modified time
         if (std::filesystem::exists(config_path_)) {
@@ -20,40 +22,127 @@ bool ConfigManager::load() {
         
         // Use Typiconf to load the YAML config
         Typiconf::ConfigLoader loader;
-        config_ = loader.from_file(config_path_).load<SysMonConfig>();
-        
-        return true;
+        return std::make_shared<const SysMonConfig>(loader.from_file(config_path_).load<SysMonConfig>());
     } catch (const Typiconf::ConfigError& e) {
         std::cerr << "Config error: " << e.what() << "\n";
-        return false;
+        return nullptr;
     } catch (const std::exception& e) {
         std::cerr << "Error loading config: " << e.what() << "\n";
+        return nullptr;
+    }
+}
+
+bool ConfigManager::load() {
+    ConfigSnapshot config = parse();
+    if (!config) {
+        return false;
+    }
+    config_.store(std::move(config), std::memory_order_release);
+    return true;
+}
+
+bool ConfigManager::reload() {
+    std::cout << "Config file changed, reloading...\n";
+    ConfigSnapshot config = parse();
+    if (!config) {
+        std::cerr << "Warning: keeping the previous configuration\n";
+        return false;
+    }
+    if (!config->validate()) {
+        std::vector<std::string> errors;
+        config->alerts.validate(&errors);
+        for (const auto& error : errors) {
+            std::cerr << "Config error: alert " << error << "\n";
+        }
+        std::cerr << "Warning: " << config_path_ << " failed validation, keeping the previous configuration\n";
         return false;
     }
+    config_.store(std::move(config), std::memory_order_release);
+    return true;
 }
 
 bool ConfigManager::check_and_reload() {
+    // With inotify, changes were already seen by wait_for_change()
+    if (watcher_.is_active()) {
+        if (!watcher_.take_change()) {
+            return false;
+        }
+        return reload();
+    }
+    
     if (!std::filesystem::exists(config_path_)) {
         return false;
     }
     
     auto current_modified = std::filesystem::last_write_time(config_path_);
     if (current_modified != last_modified_) {
-        std::cout << "Config file changed, reloading...\n";
-        return load();
+        return reload();
     }
     
     return false;
 }
 
 bool ConfigManager::validate_config(std::string& error_msg) const {
-    if (!config_.validate()) {
-        error_msg = "Configuration validation failed";
+    ConfigSnapshot config = snapshot();
+    if (!config->validate()) {
+        std::vector<std::string> errors;
+        config->alerts.validate(&errors);
+        error_msg = errors.empty() ? "Configuration validation failed" : "alert " + errors.front();
         return false;
     }
     return true;
 }
 
+ConfigDiff diff_configs(const SysMonConfig& before, const SysMonConfig& after) {
+    ConfigDiff diff;
+    auto check = [&](const char* section, const auto& a, const auto& b, bool ConfigDiff::*flag) {
+        if (!(a == b)) {
+            diff.sections.push_back(section);
+            if (flag) {
+                diff.*flag = true;
+            }
+        }
+    };
+    // Sections without a flag are read from the snapshot every tick (history
+    // is trimmed to history_size in place), so publishing them is enough.
+    // The exception is aggregator: --aggregate reads it once at startup and
+    // only warns when it changes.
+    check("version", before.version, after.version, nullptr);
+    check("update_interval", before.update_interval, after.update_interval, nullptr);
+    check("history_size", before.history_size, after.history_size, nullptr);
+    check("debug_logging", before.debug_logging, after.debug_logging, nullptr);
+    check("trace_path", before.trace_path, after.trace_path, nullptr);
+    check("fs_root", before.fs_root, after.fs_root, &ConfigDiff::collector);
+    check("cpu", before.cpu, after.cpu, nullptr);
+    check("memory", before.memory, after.memory, nullptr);
+    check("disk", before.disk, after.disk, nullptr);
+    check("network", before.network, after.network, nullptr);
+    check("scheduler", before.scheduler, after.scheduler, nullptr);
+    check("interrupts", before.interrupts, after.interrupts, nullptr);
+    check("numa", before.numa, after.numa, nullptr);
+    check("perf", before.perf, after.perf, nullptr);
+    check("display", before.display, after.display, &ConfigDiff::display);
+    check("alerts", before.alerts, after.alerts, &ConfigDiff::alerts);
+    check("anomaly", before.anomaly, after.anomaly, nullptr);
+    check("quantiles", before.quantiles, after.quantiles, &ConfigDiff::services);
+    check("exporter", before.exporter, after.exporter, &ConfigDiff::services);
+    check("query", before.query, after.query, &ConfigDiff::services);
+    check("shm", before.shm, after.shm, &ConfigDiff::services);
+    check("push", before.push, after.push, &ConfigDiff::services);
+    check("flight_recorder", before.flight_recorder, after.flight_recorder, &ConfigDiff::services);
+    check("aggregator", before.aggregator, after.aggregator, nullptr);
+    return diff;
+}
+
+const ThresholdConfig& DiskConfig::thresholds_for(const std::string& mount_point) const {
+    for (const auto& mp : mount_points) {
+        if (mp.path == mount_point) {
+            return mp.inherits_thresholds() ? thresholds : mp.thresholds;
+        }
+    }
+    return thresholds;
+}
+
 bool SysMonConfig::validate() const {
     if (update_interval <= 0) {
         return false;
@@ -61,7 +150,7 @@ bool SysMonConfig::validate() const {
     if (history_size <= 0) {
         return false;
     }
-    if (!cpu.thresholds.validate()) {
+    if (!cpu.validate()) {
         return false;
     }
     if (!memory.thresholds.validate()) {
@@ -70,6 +159,56 @@ bool SysMonConfig::validate() const {
     if (!disk.thresholds.validate()) {
         return false;
     }
+    // A half-set or inverted per-mount pair is an error, not a silent fallback
+    for (const auto& mp : disk.mount_points) {
+        if (!mp.validate()) {
+            return false;
+        }
+    }
+    if (disk.forecast_horizon_hours < 0.0 || disk.forecast_critical_hours < 0.0 ||
+        disk.forecast_window_minutes <= 0) {
+        return false;
+    }
+    // Critical must be the nearer deadline, or no forecast would ever warn first
+    if (disk.forecast_horizon_hours > 0.0 && disk.forecast_critical_hours > disk.forecast_horizon_hours) {
+        return false;
+    }
+    if (!scheduler.validate()) {
+        return false;
+    }
+    if (!interrupts.validate()) {
+        return false;
+    }
+    if (!numa.validate()) {
+        return false;
+    }
+    if (!anomaly.validate()) {
+        return false;
+    }
+    if (!alerts.validate()) {
+        return false;
+    }
+    if (!quantiles.validate()) {
+        return false;
+    }
+    if (!exporter.validate()) {
+        return false;
+    }
+    if (!query.validate()) {
+        return false;
+    }
+    if (!shm.validate()) {
+        return false;
+    }
+    if (!push.validate()) {
+        return false;
+    }
+    if (!flight_recorder.validate()) {
+        return false;
+    }
+    if (!aggregator.validate()) {
+        return false;
+    }
     return true;
 }
 
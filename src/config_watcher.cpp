@@ -0,0 +1,152 @@
+#include "sysmon/config_watcher.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace sysmon {
+
+bool ConfigWatcher::take_change() {
+    bool changed = pending_;
+    pending_ = false;
+    return changed;
+}
+
+#ifdef __linux__
+
+namespace {
+
+// Completed writes and renames; not IN_MODIFY, which fires for every write()
+// of a partially written file. IN_CREATE only catches `ln -sf` retargeting.
+constexpr uint32_t kWatchMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+
+} // namespace
+
+ConfigWatcher::ConfigWatcher(const std::string& path) : path_(path) {
+    std::filesystem::path file(path);
+    name_ = file.filename().string();
+    std::string directory = file.parent_path().empty() ? "." : file.parent_path().string();
+
+    fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd_ < 0) {
+        std::cerr << "Warning: inotify unavailable (" << std::strerror(errno) << "), polling " << path << "\n";
+        return;
+    }
+    link_wd_ = ::inotify_add_watch(fd_, directory.c_str(), kWatchMask);
+    if (link_wd_ < 0) {
+        std::cerr << "Warning: cannot watch " << directory << " (" << std::strerror(errno) << "), polling " << path << "\n";
+        ::close(fd_);
+        fd_ = -1;
+        return;
+    }
+    retarget();   // the initial target is not a change
+}
+
+bool ConfigWatcher::retarget() {
+    std::error_code ec;
+    auto resolved = std::filesystem::canonical(path_, ec);
+    if (ec || resolved.string() == target_) {
+        return false;   // unchanged, or briefly dangling mid-swap: the next event retries
+    }
+    target_ = resolved.string();
+    target_name_ = resolved.filename().string();
+
+    if (target_wd_ >= 0) {
+        ::inotify_rm_watch(fd_, target_wd_);   // fails harmlessly if the directory is gone
+        target_wd_ = -1;
+    }
+    // The same directory under another name gets link_wd_ back
+    int wd = ::inotify_add_watch(fd_, resolved.parent_path().c_str(), kWatchMask);
+    if (wd < 0) {
+        std::cerr << "Warning: cannot watch " << resolved.parent_path().string() << " ("
+                  << std::strerror(errno) << "), edits to " << target_ << " are not seen\n";
+    } else if (wd != link_wd_) {
+        target_wd_ = wd;
+    }
+    return true;
+}
+
+ConfigWatcher::~ConfigWatcher() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+bool ConfigWatcher::wait(std::chrono::milliseconds timeout) {
+    if (fd_ < 0) {
+        std::this_thread::sleep_for(timeout);
+        return false;
+    }
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    for (;;) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        pollfd pfd{fd_, POLLIN, 0};
+        int ready = ::poll(&pfd, 1, static_cast<int>(std::max<int64_t>(0, left.count())));
+        if (ready <= 0) {
+            return false;   // timeout, or EINTR so the caller can check for shutdown
+        }
+        // Events for other files in the directory keep waiting
+        if (drain()) {
+            return true;
+        }
+    }
+}
+
+bool ConfigWatcher::drain() {
+    alignas(inotify_event) char buffer[4096];
+    bool matched = false;
+    bool link_event = false;
+    for (;;) {
+        ssize_t n = ::read(fd_, buffer, sizeof(buffer));
+        if (n <= 0) {
+            break;
+        }
+        for (ssize_t offset = 0; offset < n;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            bool from_link = event->wd == link_wd_;
+            bool from_target = event->wd == (target_wd_ >= 0 ? target_wd_ : link_wd_);
+            link_event = link_event || from_link;
+            if (event->len > 0 && (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) &&
+                ((from_link && name_ == event->name) || (from_target && target_name_ == event->name))) {
+                matched = true;
+            }
+            if (event->mask & IN_Q_OVERFLOW) {
+                matched = true;   // events were lost; assume the worst
+            }
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+        }
+    }
+    // Any entry in the link's directory may be one hop of the symlink chain
+    if (link_event && retarget()) {
+        matched = true;
+    }
+    pending_ = pending_ || matched;
+    return matched;
+}
+
+#else
+
+ConfigWatcher::ConfigWatcher(const std::string&) {}
+
+ConfigWatcher::~ConfigWatcher() {}
+
+bool ConfigWatcher::wait(std::chrono::milliseconds timeout) {
+    std::this_thread::sleep_for(timeout);
+    return false;
+}
+
+bool ConfigWatcher::drain() {
+    return false;
+}
+
+#endif
+
+} // namespace sysmon
@@ -0,0 +1,68 @@
+#include "sysmon/cpu_topology.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace sysmon {
+
+CpuTopology::CpuTopology(const std::vector<int>& package_ids, const std::vector<int>& core_ids) {
+    size_t threads = std::min(package_ids.size(), core_ids.size());
+    if (threads == 0) {
+        return;
+    }
+
+    // Number packages and cores in sysfs order, package by package; core ids
+    // repeat across packages and need not be contiguous
+    std::vector<int> packages(package_ids.begin(), package_ids.begin() + threads);
+    std::sort(packages.begin(), packages.end());
+    packages.erase(std::unique(packages.begin(), packages.end()), packages.end());
+
+    std::vector<std::pair<int, int>> cores;
+    cores.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        cores.emplace_back(package_ids[i], core_ids[i]);
+    }
+    std::sort(cores.begin(), cores.end());
+    cores.erase(std::unique(cores.begin(), cores.end()), cores.end());
+
+    core_of_.resize(threads);
+    package_of_.resize(threads);
+    core_threads_.assign(cores.size(), 0);
+    package_cores_.assign(packages.size(), 0);
+    package_threads_.assign(packages.size(), 0);
+    for (size_t i = 0; i < threads; ++i) {
+        auto core = std::lower_bound(cores.begin(), cores.end(), std::make_pair(package_ids[i], core_ids[i]));
+        auto package = std::lower_bound(packages.begin(), packages.end(), package_ids[i]);
+        core_of_[i] = static_cast<uint32_t>(core - cores.begin());
+        package_of_[i] = static_cast<uint32_t>(package - packages.begin());
+        ++core_threads_[core_of_[i]];
+        ++package_threads_[package_of_[i]];
+    }
+    for (const auto& [package_id, core_id] : cores) {
+        auto package = std::lower_bound(packages.begin(), packages.end(), package_id);
+        ++package_cores_[static_cast<size_t>(package - packages.begin())];
+    }
+    threads_per_core_ = *std::max_element(core_threads_.begin(), core_threads_.end());
+}
+
+void CpuTopology::aggregate(const std::vector<double>& per_thread_usage, CpuTopologyMetrics& out) const {
+    out.available = !empty() && per_thread_usage.size() == threads();
+    if (!out.available) {
+        return;
+    }
+    out.threads_per_core = threads_per_core_;
+    out.package_cores = package_cores_;
+    out.core_usage.assign(cores(), 0.0);
+    out.package_usage.assign(packages(), 0.0);
+    for (size_t i = 0; i < per_thread_usage.size(); ++i) {
+        out.core_usage[core_of_[i]] += per_thread_usage[i];
+        out.package_usage[package_of_[i]] += per_thread_usage[i];
+    }
+    for (size_t c = 0; c < out.core_usage.size(); ++c) {
+        out.core_usage[c] /= core_threads_[c];
+    }
+    for (size_t p = 0; p < out.package_usage.size(); ++p) {
+        out.package_usage[p] /= package_threads_[p];
+    }
+}
+
+} // namespace sysmon
@@ -0,0 +1,112 @@
+#include "sysmon/disk_forecast.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace sysmon {
+
+namespace {
+
+// Residuals beyond this many mean absolute deviations are clipped
+constexpr double kHuberK = 3.0;
+
+// A drop of more than this fraction of capacity in one sample means files
+// were deleted or rotated; the old trend no longer applies
+constexpr double kResetDropFraction = 0.01;
+
+} // namespace
+
+void CapacityTrend::add(double t_seconds, double used_bytes, double total_bytes, double window_seconds) {
+    if (samples_ > 0 && used_bytes + total_bytes * kResetDropFraction < last_y_) {
+        reset();
+    }
+
+    double decay = 0.0;
+    if (samples_ > 0) {
+        decay = std::exp(-std::max(t_seconds - last_t_, 0.0) / std::max(window_seconds, 1.0));
+    }
+
+    // Huber weight from the residual against the current fit
+    double w = 1.0;
+    if (samples_ >= 2) {
+        double residual = std::fabs(used_bytes - predict(t_seconds));
+        double clipped = residual;
+        if (samples_ >= kMinSamples && scale_ > 0.0 && residual > kHuberK * scale_) {
+            w = kHuberK * scale_ / residual;
+            clipped = kHuberK * scale_;
+        }
+        scale_weight_ = decay * scale_weight_ + 1.0;
+        scale_ += (clipped - scale_) / scale_weight_;
+    }
+
+    // Weighted Welford update with exponential forgetting
+    weight_ = decay * weight_ + w;
+    double dt = t_seconds - mean_t_;
+    double dy = used_bytes - mean_y_;
+    mean_t_ += (w / weight_) * dt;
+    mean_y_ += (w / weight_) * dy;
+    c_tt_ = decay * c_tt_ + w * dt * (t_seconds - mean_t_);
+    c_ty_ = decay * c_ty_ + w * dt * (used_bytes - mean_y_);
+
+    last_t_ = t_seconds;
+    last_y_ = used_bytes;
+    if (samples_ < UINT32_MAX) {
+        ++samples_;
+    }
+}
+
+double CapacityTrend::slope() const {
+    return c_tt_ > 0.0 ? c_ty_ / c_tt_ : 0.0;
+}
+
+double CapacityTrend::predict(double t_seconds) const {
+    return mean_y_ + slope() * (t_seconds - mean_t_);
+}
+
+double CapacityTrend::seconds_to_full(double t_seconds, double total_bytes) const {
+    if (samples_ < kMinSamples) {
+        return -1.0;
+    }
+    double rate = slope();
+    if (rate <= 0.0) {
+        return -1.0;
+    }
+    double remaining = total_bytes - predict(t_seconds);
+    if (remaining <= 0.0) {
+        return 0.0;
+    }
+    return remaining / rate;
+}
+
+void CapacityTrend::reset() {
+    *this = CapacityTrend{};
+}
+
+void DiskForecaster::update(std::vector<DiskMetrics>& disks, std::chrono::steady_clock::time_point now,
+                            const DiskConfig& config) {
+    if (tick_ == 0) {
+        origin_ = now;
+    }
+    ++tick_;
+
+    double t = std::chrono::duration<double>(now - origin_).count();
+    double window = config.forecast_window_minutes * 60.0;
+
+    for (auto& disk : disks) {
+        auto& entry = trends_[disk.mount_point];
+        entry.seen = tick_;
+        if (disk.total_bytes == 0) {
+            continue;
+        }
+        double total = static_cast<double>(disk.total_bytes);
+        entry.trend.add(t, static_cast<double>(disk.used_bytes), total, window);
+        disk.seconds_to_full = entry.trend.seconds_to_full(t, total);
+        disk.growth_bytes_per_sec = entry.trend.slope();
+    }
+
+    // Forget mounts that are no longer reported
+    if (trends_.size() > disks.size()) {
+        std::erase_if(trends_, [this](const auto& item) { return item.second.seen != tick_; });
+    }
+}
+
+} // namespace sysmon
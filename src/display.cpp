@@ -79,6 +79,35 @@ std::string format_bytes(uint64_t bytes) {
     return oss.str();
 }
 
+std::string format_rate(double per_second) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1);
+    if (per_second >= 1e9) {
+        oss << per_second / 1e9 << "G";
+    } else if (per_second >= 1e6) {
+        oss << per_second / 1e6 << "M";
+    } else if (per_second >= 1e3) {
+        oss << per_second / 1e3 << "k";
+    } else {
+        oss << std::setprecision(0) << per_second;
+    }
+    oss << "/s";
+    return oss.str();
+}
+
+std::string format_duration(double seconds) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(0);
+    if (seconds < 3600.0) {
+        oss << "~" << std::max(seconds / 60.0, 1.0) << "m";
+    } else if (seconds < 48 * 3600.0) {
+        oss << "~" << std::setprecision(1) << seconds / 3600.0 << "h";
+    } else {
+        oss << "~" << seconds / 86400.0 << "d";
+    }
+    return oss.str();
+}
+
 std::string alert_icon(AlertLevel level) {
     switch (level) {
         case AlertLevel::Normal:   return "✓";
@@ -136,9 +165,8 @@ std::string Display::create_graph(const std::deque<double>& data, int height) {
     return oss.str();
 }
 
-void Display::render_header() {
+void Display::render_header(const std::string& title) {
     const int box_width = 60;
-    const std::string title = "SYSMON";
     const int padding = (box_width - title.length()) / 2;
     
     std::cout << "╔";
@@ -177,8 +205,19 @@ void Display::render_cpu(const CpuMetrics& cpu, const CpuConfig& cpu_config) {
     }
     std::cout << "\n";
     
-    // Per-core display (only if enabled and reasonable number of cores)
-    if (cpu_config.show_per_core && !cpu.per_core_usage.empty() && cpu.per_core_usage.size() <= 32) {
+    // A bar per logical processor while they fit; beyond that a strip per
+    // socket of physical cores, or of threads when the topology is unknown
+    bool wide = cpu.per_core_usage.size() > 32;
+    if (cpu_config.show_per_core && wide && !cpu.topology.available) {
+        for (size_t first = 0; first < cpu.per_core_usage.size(); first += 64) {
+            std::cout << "    " << std::setw(4) << first << " "
+                      << create_usage_strip(cpu.per_core_usage, first, 64, cpu_config) << "\n";
+        }
+    }
+    if (cpu_config.show_per_core && cpu.topology.available && (wide || cpu.topology.package_cores.size() > 1)) {
+        render_topology(cpu.topology, cpu_config, wide);
+    }
+    if (cpu_config.show_per_core && !cpu.per_core_usage.empty() && !wide) {
         for (size_t i = 0; i < cpu.per_core_usage.size(); ++i) {
             AlertLevel core_level = get_alert_level(cpu.per_core_usage[i], cpu_config.thresholds);
             std::cout << "    Core " << std::setw(2) << i << ": ";
@@ -190,9 +229,125 @@ void Display::render_cpu(const CpuMetrics& cpu, const CpuConfig& cpu_config) {
             std::cout << "\n";
         }
     }
+    if (cpu.scheduler.available) {
+        render_scheduler(cpu.scheduler);
+    }
+    if (cpu.interrupts.available) {
+        render_interrupts(cpu.interrupts);
+    }
+    if (cpu.perf.available && cpu.perf.total.available) {
+        render_perf(cpu.perf);
+    }
     std::cout << "\n";
 }
 
+void Display::render_scheduler(const SchedulerMetrics& scheduler) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2)
+        << "  Load: " << scheduler.load1 << " " << scheduler.load5 << " " << scheduler.load15
+        << "  run queue " << scheduler.run_queue_per_core << "/core"
+        << "  blocked " << scheduler.procs_blocked
+        << "  ctx " << format_rate(scheduler.context_switches_per_sec)
+        << "  intr " << format_rate(scheduler.interrupts_per_sec)
+        << "  softirq " << format_rate(scheduler.softirqs_per_sec)
+        << "  forks " << format_rate(scheduler.forks_per_sec) << "\n";
+    std::cout << oss.str();
+}
+
+// Socket usage, and with per_core a strip of its physical cores, so a
+// 2-socket 256-thread host fits on a few lines
+void Display::render_topology(const CpuTopologyMetrics& topology, const CpuConfig& cpu_config, bool per_core) {
+    std::ostringstream oss;
+    size_t first = 0;
+    for (size_t p = 0; p < topology.package_cores.size(); ++p) {
+        size_t cores = topology.package_cores[p];
+        size_t saturated = 0;
+        for (size_t c = first; c < first + cores && c < topology.core_usage.size(); ++c) {
+            saturated += topology.core_usage[c] >= cpu_config.core_saturation;
+        }
+        AlertLevel level = get_alert_level(topology.package_usage[p], cpu_config.thresholds);
+        oss << "  Socket " << p << ": " << create_progress_bar(topology.package_usage[p], 20, level)
+            << "  " << std::setw(3) << static_cast<int>(topology.package_usage[p]) << "%"
+            << "  " << cores << " cores x " << topology.threads_per_core << " threads"
+            << "  " << saturated << " saturated";
+        if (level != AlertLevel::Normal) {
+            oss << "  " << colorize(alert_icon(level), level);
+        }
+        oss << "\n";
+        for (size_t line = 0; per_core && line < cores; line += 64) {
+            oss << "    " << std::setw(4) << first + line << " "
+                << create_usage_strip(topology.core_usage, first + line, std::min<size_t>(64, cores - line), cpu_config)
+                << "\n";
+        }
+        first += cores;
+    }
+    std::cout << oss.str();
+}
+
+// One cell per core from idle to full, saturated ones in the critical color
+std::string Display::create_usage_strip(const std::vector<double>& usage, size_t first, size_t count,
+                                        const CpuConfig& cpu_config) {
+    const char* blocks[] = {"·", "▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+    std::string strip;
+    for (size_t i = first; i < std::min(usage.size(), first + count); ++i) {
+        int index = std::clamp(static_cast<int>(std::ceil(usage[i] / 100.0 * 8)), 0, 8);
+        strip += usage[i] >= cpu_config.core_saturation ? colorize(blocks[index], AlertLevel::Critical) : blocks[index];
+    }
+    return strip;
+}
+
+// One cell per CPU, scaled to the busiest, so IRQs pinned to a few cores
+// stand out however many cores there are
+void Display::render_interrupts(const InterruptMetrics& interrupts) {
+    constexpr size_t kCellsPerLine = 64;
+    const char* blocks[] = {"·", "▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+    
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1)
+        << "  IRQ: " << format_rate(interrupts.irq_total)
+        << "  softirq " << format_rate(interrupts.softirq_total)
+        << "  net " << format_rate(interrupts.net_softirq_total);
+    if (interrupts.busiest_cpu >= 0) {
+        oss << "  imbalance " << interrupts.imbalance << "x (core " << interrupts.busiest_cpu << ")";
+    }
+    oss << "\n";
+    
+    const auto& rates = interrupts.irq_per_cpu;
+    double max_rate = rates.empty() ? 0.0 : *std::max_element(rates.begin(), rates.end());
+    for (size_t first = 0; first < rates.size() && max_rate > 0.0; first += kCellsPerLine) {
+        oss << "    " << std::setw(4) << first << " ";
+        for (size_t i = first; i < std::min(rates.size(), first + kCellsPerLine); ++i) {
+            int index = static_cast<int>(std::ceil(rates[i] / max_rate * 8));
+            oss << blocks[std::clamp(index, 0, 8)];
+        }
+        oss << "\n";
+    }
+    std::cout << oss.str();
+}
+
+// IPC and cache misses tell a CPU-bound host from one stalled on memory
+void Display::render_perf(const PerfMetrics& perf) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2);
+    if (perf.hardware) {
+        oss << "  Perf: IPC " << perf.total.ipc << std::setprecision(1)
+            << "  cache miss " << perf.total.cache_miss_percent << "%  cycles " << format_rate(perf.total.cycles) << "  ";
+    } else {
+        oss << "  Perf (software only): ";
+    }
+    oss << "ctx " << format_rate(perf.total.context_switches)
+        << "  migr " << format_rate(perf.total.cpu_migrations)
+        << "  faults " << format_rate(perf.total.page_faults) << "\n";
+    if (perf.hardware && perf.per_socket.size() > 1) {
+        for (size_t i = 0; i < perf.per_socket.size(); ++i) {
+            if (!perf.per_socket[i].available) continue;
+            oss << std::setprecision(2) << "    Socket " << i << ": IPC " << perf.per_socket[i].ipc
+                << std::setprecision(1) << "  cache miss " << perf.per_socket[i].cache_miss_percent << "%\n";
+        }
+    }
+    std::cout << oss.str();
+}
+
 void Display::render_memory(const MemoryMetrics& memory, const MemoryConfig& memory_config) {
     AlertLevel level = get_alert_level(memory.usage_percent, memory_config.thresholds);
     
@@ -213,14 +368,55 @@ void Display::render_memory(const MemoryMetrics& memory, const MemoryConfig& mem
     } else {
         std::cout << colorize(" OK", level);
     }
-    std::cout << "\n\n";
+    std::cout << "\n";
+    if (memory.numa.nodes.size() > 1) {
+        render_numa(memory.numa, memory_config.thresholds);
+    }
+    std::cout << "\n";
+}
+
+// One row per node: a node can run out while the host total looks fine
+void Display::render_numa(const NumaMetrics& numa, const ThresholdConfig& thresholds) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1);
+    for (const auto& node : numa.nodes) {
+        AlertLevel level = get_alert_level(node.usage_percent, thresholds);
+        oss << "    Node " << std::setw(2) << node.node << ": " << create_progress_bar(node.usage_percent, 20, level)
+            << "  " << std::setw(3) << static_cast<int>(node.usage_percent) << "%"
+            << " (" << format_bytes(node.used_bytes) << " / " << format_bytes(node.total_bytes) << ")"
+            << "  cpu " << std::setw(3) << static_cast<int>(node.cpu_usage) << "%"
+            << "  remote " << node.remote_percent << "%";
+        if (node.miss_allocs_per_sec > 0.0) {
+            oss << "  miss " << format_rate(node.miss_allocs_per_sec);
+        }
+        if (!node.cpus.empty()) {
+            // Contiguous runs as sysfs lists them: "0-15,32-47"
+            oss << "  cpus ";
+            for (size_t i = 0; i < node.cpus.size();) {
+                size_t j = i;
+                while (j + 1 < node.cpus.size() && node.cpus[j + 1] == node.cpus[j] + 1) {
+                    ++j;
+                }
+                oss << (i > 0 ? "," : "") << node.cpus[i];
+                if (j > i) {
+                    oss << "-" << node.cpus[j];
+                }
+                i = j + 1;
+            }
+        }
+        if (level != AlertLevel::Normal) {
+            oss << "  " << colorize(alert_icon(level), level);
+        }
+        oss << "\n";
+    }
+    std::cout << oss.str();
 }
 
 void Display::render_disks(const std::vector<DiskMetrics>& disks, const DiskConfig& disk_config) {
     std::cout << "[Disk]\n";
     
     for (const auto& disk : disks) {
-        AlertLevel level = get_alert_level(disk.usage_percent, disk_config.thresholds);
+        AlertLevel level = get_alert_level(disk.usage_percent, disk_config.thresholds_for(disk.mount_point));
         
         std::cout << "  " << disk.label << " (" << disk.mount_point << ")";
         if (disk_config.show_model_name) {
@@ -231,6 +427,19 @@ void Display::render_disks(const std::vector<DiskMetrics>& disks, const DiskConf
         std::cout << "  " << std::setw(3) << std::right << static_cast<int>(disk.usage_percent) << "%";
         std::cout << " (" << format_bytes(disk.used_bytes) << " / " << format_bytes(disk.total_bytes) << ")";
         std::cout << "  " << alert_icon(level);
+        
+        // Projected exhaustion, only when it is close enough to matter
+        double hours = disk.seconds_to_full / 3600.0;
+        if (disk_config.forecast_horizon_hours > 0.0 && disk.seconds_to_full >= 0.0 &&
+            hours <= 4.0 * disk_config.forecast_horizon_hours) {
+            AlertLevel eta_level = AlertLevel::Normal;
+            if (hours <= disk_config.forecast_critical_hours) {
+                eta_level = AlertLevel::Critical;
+            } else if (hours <= disk_config.forecast_horizon_hours) {
+                eta_level = AlertLevel::Warning;
+            }
+            std::cout << "  " << colorize("full in " + format_duration(disk.seconds_to_full), eta_level);
+        }
         std::cout << "\n";
     }
     std::cout << "\n";
@@ -291,7 +500,20 @@ void Display::render_alerts(const std::vector<Alert>& alerts) {
     std::cout << "\n";
 }
 
-void Display::render_history(const std::deque<double>& cpu_history, const std::deque<double>& memory_history, int update_interval) {
+void Display::render_percentiles(const std::string& label, const SeriesSketches& sketches, std::string_view series) {
+    QuantileSketch window(sketches.config().relative_accuracy, static_cast<size_t>(sketches.config().max_bins));
+    if (!sketches.window(series, window) || window.count() == 0) {
+        return;
+    }
+    std::cout << label << std::fixed << std::setprecision(1)
+              << "p50 " << window.quantile(0.50) << "%  "
+              << "p95 " << window.quantile(0.95) << "%  "
+              << "p99 " << window.quantile(0.99) << "%  "
+              << "max " << window.max() << "%\n";
+}
+
+void Display::render_history(const std::deque<double>& cpu_history, const std::deque<double>& memory_history, int update_interval,
+                             const SeriesSketches* sketches) {
     if (!config_.show_graphs || cpu_history.empty()) {
         return;
     }
@@ -300,13 +522,110 @@ void Display::render_history(const std::deque<double>& cpu_history, const std::d
     std::cout << "[History - Last " << total_seconds << "s]\n";
     std::cout << "CPU:  " << create_graph(cpu_history, config_.graph_height) << "\n";
     std::cout << "MEM:  " << create_graph(memory_history, config_.graph_height) << "\n";
+    
+    // Tail percentiles over the (longer) sketch window
+    if (sketches) {
+        std::cout << "[Percentiles - Last " << format_duration(sketches->config().window_seconds).substr(1) << "]\n";
+        render_percentiles("CPU:  ", *sketches, "cpu.usage");
+        render_percentiles("MEM:  ", *sketches, "memory.usage");
+    }
     std::cout << "\n";
 }
 
+void Display::render_self_stats(const SelfStats& stats) {
+    auto tick = stats.stage(Stage::Tick);
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1)
+        << "[SysMon] tick " << tick.last_ms << " ms (p99 " << tick.p99_ms << ")"
+        << " | CPU " << stats.cpu_percent() << "%"
+        << " | RSS " << static_cast<double>(stats.resident_bytes()) / (1024.0 * 1024.0) << " MB"
+        << " | " << std::setprecision(0) << tick.allocations_per_call << " allocs/tick";
+    std::cout << oss.str();
+    if (stats.missed_deadlines() > 0) {
+        std::cout << " | " << colorize(std::to_string(stats.missed_deadlines()) + " missed", AlertLevel::Warning);
+    }
+    if (stats.log_dropped() > 0) {
+        std::cout << " | " << colorize(std::to_string(stats.log_dropped()) + " log drops", AlertLevel::Warning);
+    }
+    std::cout << "\n\n";
+}
+
 void Display::render_footer() {
     std::cout << "Press Ctrl+C to quit, Config hot-reload enabled\n";
 }
 
+void Display::render_fleet_stats(const std::string& label, const FleetStats& stats, const ThresholdConfig& thresholds) {
+    std::cout << "  " << std::left << std::setw(6) << label << std::right;
+    for (double value : {stats.p50, stats.p90, stats.p99, stats.max, stats.mean}) {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(1) << value << "%";
+        std::cout << colorize(std::string(8 - std::min<size_t>(oss.str().size(), 7), ' ') + oss.str(),
+                              get_alert_level(value, thresholds));
+    }
+    std::cout << "\n";
+}
+
+void Display::render_fleet_hosts(const std::string& title, const std::vector<FleetHostRow>& rows,
+                                 float FleetSample::*metric, const ThresholdConfig& thresholds) {
+    if (rows.empty()) {
+        return;
+    }
+    std::cout << "[" << title << "]\n";
+    for (const auto& row : rows) {
+        double value = row.latest.*metric;
+        AlertLevel level = get_alert_level(value, thresholds);
+        std::string host = row.host.size() > 24 ? row.host.substr(0, 23) + "~" : row.host;
+        std::cout << "  " << std::left << std::setw(24) << host << std::right;
+        std::cout << " " << create_progress_bar(value, 20, level);
+        std::cout << "  " << colorize(std::to_string(static_cast<int>(value)) + "%", level);
+        std::cout << "  (cpu " << static_cast<int>(row.latest.cpu) << "%, mem " << static_cast<int>(row.latest.memory)
+                  << "%, disk " << static_cast<int>(row.latest.disk) << "%, net " << std::fixed << std::setprecision(1)
+                  << row.latest.net_mbps << " Mbps)\n";
+    }
+    std::cout << "\n";
+}
+
+void Display::render_fleet(const FleetSummary& fleet,
+                           const CpuConfig& cpu_config,
+                           const MemoryConfig& memory_config,
+                           const DiskConfig& disk_config)
+{
+    clear_screen();
+    
+    render_header("SYSMON FLEET");
+    
+    std::cout << "[Fleet] " << fleet.hosts_up << "/" << fleet.hosts_total << " hosts up";
+    if (fleet.hosts_up < fleet.hosts_total) {
+        std::cout << "  " << colorize(std::to_string(fleet.hosts_total - fleet.hosts_up) + " silent", AlertLevel::Warning);
+    }
+    std::cout << "  (" << fleet.samples << " samples)\n";
+    std::cout << "             p50     p90     p99     max    mean\n";
+    render_fleet_stats("CPU", fleet.cpu, cpu_config.thresholds);
+    render_fleet_stats("MEM", fleet.memory, memory_config.thresholds);
+    render_fleet_stats("DISK", fleet.disk, disk_config.thresholds);
+    if (fleet.window_seconds > 0) {
+        std::string window = format_duration(fleet.window_seconds).substr(1);
+        render_fleet_stats("CPU " + window, fleet.cpu_window, cpu_config.thresholds);
+        render_fleet_stats("MEM " + window, fleet.memory_window, memory_config.thresholds);
+    }
+    std::cout << "\n";
+    
+    render_fleet_hosts("Top CPU", fleet.top_cpu, &FleetSample::cpu, cpu_config.thresholds);
+    render_fleet_hosts("Top Memory", fleet.top_memory, &FleetSample::memory, memory_config.thresholds);
+    render_fleet_hosts("Top Disk", fleet.top_disk, &FleetSample::disk, disk_config.thresholds);
+    
+    if (!fleet.stale.empty()) {
+        std::cout << "[Silent Hosts]\n";
+        for (const auto& row : fleet.stale) {
+            std::cout << "  " << alert_icon(AlertLevel::Warning) << " " << std::left << std::setw(24) << row.host
+                      << std::right << " last seen " << format_duration(row.age_seconds) << " ago\n";
+        }
+        std::cout << "\n";
+    }
+    
+    render_footer();
+}
+
 void Display::render(const CpuMetrics& cpu,
                     const MemoryMetrics& memory,
                     const std::vector<DiskMetrics>& disks,
@@ -318,7 +637,9 @@ void Display::render(const CpuMetrics& cpu,
                     const MemoryConfig& memory_config,
                     const DiskConfig& disk_config,
                     const NetworkConfig& network_config,
-                    int update_interval)
+                    int update_interval,
+                    const SeriesSketches* sketches,
+                    const SelfStats* self_stats)
 {
     clear_screen();
     
@@ -332,7 +653,10 @@ void Display::render(const CpuMetrics& cpu,
     }
     
     render_alerts(active_alerts);
-    render_history(cpu_history, memory_history, update_interval);
+    render_history(cpu_history, memory_history, update_interval, sketches);
+    if (self_stats && config_.show_self_stats && self_stats->ticks() > 0) {
+        render_self_stats(*self_stats);
+    }
     render_footer();
 }
 
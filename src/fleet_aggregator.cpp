@@ -0,0 +1,308 @@
+#include "sysmon/fleet_aggregator.hpp"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace sysmon {
+
+namespace {
+
+constexpr size_t kReadChunk = 64 * 1024;
+constexpr size_t kMaxDatagram = 65536;
+constexpr uint64_t kListenId = UINT64_MAX;
+constexpr uint64_t kWakeId = UINT64_MAX - 1;
+constexpr uint64_t kUdpId = UINT64_MAX - 2;
+
+} // namespace
+
+FleetSummary FleetAggregator::summary() {
+    auto now = FleetState::Clock::now();
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    state_.expire(now);
+    return state_.summary(static_cast<size_t>(config_.top_n), now);
+}
+
+bool FleetAggregator::history(const std::string& host, std::vector<FleetSample>& out) {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    return state_.history(host, out);
+}
+
+#ifdef __linux__
+
+struct FleetAggregator::Connection {
+    int fd = -1;
+    std::string in;
+    size_t in_len = 0;
+};
+
+FleetAggregator::FleetAggregator(const AggregatorConfig& config, const QuantileConfig& quantiles)
+    : config_(config)
+    , state_(static_cast<size_t>(config.history_points), std::chrono::seconds(config.stale_seconds),
+             static_cast<size_t>(config.max_hosts), quantiles)
+{
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(config_.port));
+    if (::inet_pton(AF_INET, config_.listen_address.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "Warning: aggregator listen_address is not an IPv4 address: " << config_.listen_address << "\n";
+        return;
+    }
+
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        std::cerr << "Warning: aggregator socket failed: " << std::strerror(errno) << "\n";
+        return;
+    }
+    int one = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(listen_fd_, SOMAXCONN) < 0) {
+        std::cerr << "Warning: aggregator cannot listen on " << config_.listen_address << ":" << config_.port
+                  << ": " << std::strerror(errno) << "\n";
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return;
+    }
+    socklen_t len = sizeof(addr);
+    ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+
+    // UDP on the same port (the ephemeral one when port is 0)
+    udp_fd_ = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (udp_fd_ >= 0 && ::bind(udp_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        std::cerr << "Warning: aggregator cannot bind UDP port " << port_ << ": " << std::strerror(errno) << "\n";
+        ::close(udp_fd_);
+        udp_fd_ = -1;
+    }
+
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || wake_fd_ < 0) {
+        std::cerr << "Warning: aggregator epoll setup failed: " << std::strerror(errno) << "\n";
+        return;
+    }
+
+    connections_.resize(static_cast<size_t>(config_.max_connections));
+    for (size_t i = connections_.size(); i-- > 0;) {
+        free_connections_.push_back(i);
+    }
+    datagram_.resize(kMaxDatagram);
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = kListenId;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev);
+    ev.data.u64 = kWakeId;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+    if (udp_fd_ >= 0) {
+        ev.data.u64 = kUdpId;
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, udp_fd_, &ev);
+    }
+
+    server_ = std::thread(&FleetAggregator::server_loop, this);
+}
+
+FleetAggregator::~FleetAggregator() {
+    if (server_.joinable()) {
+        uint64_t one = 1;
+        [[maybe_unused]] auto n = ::write(wake_fd_, &one, sizeof(one));
+        server_.join();
+    }
+    for (auto& conn : connections_) {
+        if (conn.fd >= 0) {
+            ::close(conn.fd);
+        }
+    }
+    if (wake_fd_ >= 0) ::close(wake_fd_);
+    if (epoll_fd_ >= 0) ::close(epoll_fd_);
+    if (udp_fd_ >= 0) ::close(udp_fd_);
+    if (listen_fd_ >= 0) ::close(listen_fd_);
+}
+
+void FleetAggregator::server_loop() {
+    epoll_event events[64];
+    for (;;) {
+        int n = ::epoll_wait(epoll_fd_, events, 64, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Warning: aggregator epoll_wait failed: " << std::strerror(errno) << "\n";
+            return;
+        }
+        for (int i = 0; i < n; ++i) {
+            uint64_t id = events[i].data.u64;
+            if (id == kWakeId) {
+                return;
+            }
+            if (id == kListenId) {
+                accept_clients();
+                continue;
+            }
+            if (id == kUdpId) {
+                receive_datagrams();
+                continue;
+            }
+            Connection& conn = connections_[id];
+            if (conn.fd < 0) {
+                continue;
+            }
+            if (events[i].events & EPOLLIN) {
+                handle_readable(conn);
+            } else if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                close_connection(conn);
+            }
+        }
+    }
+}
+
+void FleetAggregator::accept_clients() {
+    for (;;) {
+        int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        if (free_connections_.empty()) {
+            ::close(fd);
+            continue;
+        }
+        size_t slot = free_connections_.back();
+        free_connections_.pop_back();
+
+        Connection& conn = connections_[slot];
+        conn.fd = fd;
+        conn.in_len = 0;
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = slot;
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+void FleetAggregator::handle_readable(Connection& conn) {
+    if (conn.in.size() - conn.in_len < kReadChunk) {
+        conn.in.resize(conn.in_len + kReadChunk);
+    }
+    ssize_t n = ::recv(conn.fd, &conn.in[conn.in_len], conn.in.size() - conn.in_len, 0);
+    if (n <= 0) {
+        if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+            return;
+        }
+        close_connection(conn);
+        return;
+    }
+    conn.in_len += static_cast<size_t>(n);
+
+    // Process every complete message; senders never wait for a reply
+    size_t pos = 0;
+    while (conn.in_len - pos >= kPushHeaderSize) {
+        PushHeader header;
+        if (!parse_push_header(conn.in.data() + pos, conn.in_len - pos, header)) {
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            close_connection(conn);
+            return;
+        }
+        size_t need = kPushHeaderSize + header.payload_size;
+        if (conn.in_len - pos < need) {
+            break;
+        }
+        if (!process_message(header, conn.in.data() + pos + kPushHeaderSize)) {
+            close_connection(conn);
+            return;
+        }
+        pos += need;
+    }
+    std::memmove(conn.in.data(), conn.in.data() + pos, conn.in_len - pos);
+    conn.in_len -= pos;
+
+    // Give back the space of an unusually large batch
+    if (conn.in_len == 0 && conn.in.capacity() > 4 * kReadChunk) {
+        std::string().swap(conn.in);
+    }
+}
+
+void FleetAggregator::receive_datagrams() {
+    for (;;) {
+        ssize_t n = ::recv(udp_fd_, datagram_.data(), datagram_.size(), 0);
+        if (n < 0) {
+            return;
+        }
+        PushHeader header;
+        if (!parse_push_header(datagram_.data(), static_cast<size_t>(n), header) ||
+            static_cast<size_t>(n) != kPushHeaderSize + header.payload_size) {
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        process_message(header, datagram_.data() + kPushHeaderSize);
+    }
+}
+
+// False if the stream is unusable and the connection should close
+bool FleetAggregator::process_message(const PushHeader& header, const char* payload) {
+    if (header.format != WireFormat::Binary) {
+        if (!warned_format_) {
+            std::cerr << "Warning: aggregator only accepts push.format: binary, ignoring line protocol\n";
+            warned_format_ = true;
+        }
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    raw_.clear();
+    decoded_.clear();
+    if (!decompress_block(header.codec, std::string_view(payload, header.payload_size), header.raw_size, raw_) ||
+        !decoder_.decode(raw_, host_, decoded_) || host_.empty()) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    auto now = FleetState::Clock::now();
+    bool accepted = true;
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        for (const auto& snapshot : decoded_) {
+            accepted = state_.ingest(host_, snapshot, now) && accepted;
+        }
+    }
+    if (!accepted && !warned_hosts_) {
+        std::cerr << "Warning: aggregator reached max_hosts (" << config_.max_hosts << "), ignoring new hosts\n";
+        warned_hosts_ = true;
+    }
+    messages_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void FleetAggregator::close_connection(Connection& conn) {
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn.fd, nullptr);
+    ::close(conn.fd);
+    conn.fd = -1;
+    conn.in_len = 0;
+    std::string().swap(conn.in);
+    free_connections_.push_back(static_cast<size_t>(&conn - connections_.data()));
+}
+
+#else
+
+struct FleetAggregator::Connection {};
+
+FleetAggregator::FleetAggregator(const AggregatorConfig& config, const QuantileConfig& quantiles)
+    : config_(config)
+    , state_(static_cast<size_t>(config.history_points), std::chrono::seconds(config.stale_seconds),
+             static_cast<size_t>(config.max_hosts), quantiles)
+{
+    std::cerr << "Warning: aggregator mode is only available on Linux\n";
+}
+
+FleetAggregator::~FleetAggregator() = default;
+
+#endif
+
+} // namespace sysmon
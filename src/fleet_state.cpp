@@ -0,0 +1,212 @@
+#include "sysmon/fleet_state.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace sysmon {
+
+namespace {
+
+// NaN would break the ordering of the rollup sets
+float sanitize(double value) {
+    return std::isfinite(value) ? static_cast<float>(value) : 0.0f;
+}
+
+FleetSample to_sample(const MetricSnapshot& snapshot) {
+    FleetSample s;
+    s.timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        snapshot.wall_time.time_since_epoch()).count();
+    s.cpu = sanitize(snapshot.cpu.overall_usage);
+    s.memory = sanitize(snapshot.memory.usage_percent);
+    for (const auto& disk : snapshot.disks) {
+        s.disk = std::max(s.disk, sanitize(disk.usage_percent));
+    }
+    for (const auto& net : snapshot.network) {
+        s.net_mbps += sanitize(net.download_mbps + net.upload_mbps);
+    }
+    return s;
+}
+
+FleetStats to_stats(const QuantileSketch& sketch) {
+    FleetStats stats;
+    stats.p50 = sketch.quantile(0.50);
+    stats.p90 = sketch.quantile(0.90);
+    stats.p99 = sketch.quantile(0.99);
+    stats.max = sketch.max();
+    stats.mean = sketch.mean();
+    return stats;
+}
+
+} // namespace
+
+size_t FleetState::Rollup::bucket(float value) {
+    if (!(value > 0.0f)) {
+        return 0;
+    }
+    return std::min(static_cast<size_t>(std::lround(value * 10.0f)), kBuckets - 1);
+}
+
+void FleetState::Rollup::insert(uint32_t host, float value) {
+    ++counts_[bucket(value)];
+    ordered_.emplace(value, host);
+    sum_ += value;
+}
+
+void FleetState::Rollup::remove(uint32_t host, float value) {
+    --counts_[bucket(value)];
+    ordered_.erase({value, host});
+    sum_ -= value;
+}
+
+FleetStats FleetState::Rollup::stats() const {
+    FleetStats stats;
+    size_t n = ordered_.size();
+    if (n == 0) {
+        return stats;
+    }
+    stats.max = ordered_.rbegin()->first;
+    stats.mean = sum_ / static_cast<double>(n);
+
+    // Nearest-rank percentiles over the histogram, one pass for all three
+    const double quantiles[] = {0.50, 0.90, 0.99};
+    double* outputs[] = {&stats.p50, &stats.p90, &stats.p99};
+    size_t q = 0;
+    size_t seen = 0;
+    for (size_t b = 0; b < kBuckets && q < 3; ++b) {
+        seen += counts_[b];
+        while (q < 3 && seen >= static_cast<size_t>(std::ceil(quantiles[q] * static_cast<double>(n)))) {
+            *outputs[q++] = b / 10.0;
+        }
+    }
+    return stats;
+}
+
+FleetState::FleetState(size_t history_points, std::chrono::seconds stale_after, size_t max_hosts,
+                       const QuantileConfig& quantiles)
+    : history_points_(std::max<size_t>(history_points, 1))
+    , stale_after_(stale_after)
+    , max_hosts_(max_hosts)
+    , quantiles_(quantiles)
+{
+}
+
+bool FleetState::ingest(const std::string& host, const MetricSnapshot& snapshot, Clock::time_point now) {
+    auto it = index_.find(host);
+    if (it == index_.end()) {
+        if (hosts_.size() >= max_hosts_) {
+            return false;
+        }
+        it = index_.emplace(host, static_cast<uint32_t>(hosts_.size())).first;
+        Host& h = hosts_.emplace_back();
+        h.name = host;
+        h.ring.resize(history_points_);
+        if (quantiles_.enabled) {
+            h.cpu_window.emplace(quantiles_);
+            h.memory_window.emplace(quantiles_);
+        }
+    }
+
+    uint32_t id = it->second;
+    Host& h = hosts_[id];
+    if (h.up) {
+        remove_from_rollups(id);
+    }
+
+    h.latest = to_sample(snapshot);
+    h.ring[h.head] = h.latest;
+    h.head = (h.head + 1) % h.ring.size();
+    h.size = std::min(h.size + 1, h.ring.size());
+    h.last_seen = now;
+    h.up = true;
+    if (h.cpu_window) {
+        h.cpu_window->add(h.latest.cpu, now);
+        h.memory_window->add(h.latest.memory, now);
+    }
+    add_to_rollups(id);
+    ++samples_;
+    return true;
+}
+
+void FleetState::expire(Clock::time_point now) {
+    for (uint32_t id = 0; id < hosts_.size(); ++id) {
+        if (hosts_[id].up && now - hosts_[id].last_seen > stale_after_) {
+            remove_from_rollups(id);
+            hosts_[id].up = false;
+        }
+    }
+}
+
+FleetSummary FleetState::summary(size_t top_n, Clock::time_point now) const {
+    FleetSummary summary;
+    summary.hosts_total = hosts_.size();
+    summary.hosts_up = cpu_.size();
+    summary.samples = samples_;
+    summary.cpu = cpu_.stats();
+    summary.memory = memory_.stats();
+    summary.disk = disk_.stats();
+    cpu_.top(top_n, [&](uint32_t id) { summary.top_cpu.push_back(row(id, now)); });
+    memory_.top(top_n, [&](uint32_t id) { summary.top_memory.push_back(row(id, now)); });
+    disk_.top(top_n, [&](uint32_t id) { summary.top_disk.push_back(row(id, now)); });
+
+    if (quantiles_.enabled) {
+        QuantileSketch cpu(quantiles_.relative_accuracy, static_cast<size_t>(quantiles_.max_bins));
+        QuantileSketch memory(quantiles_.relative_accuracy, static_cast<size_t>(quantiles_.max_bins));
+        for (const auto& h : hosts_) {
+            h.cpu_window->merge_into(cpu, now);
+            h.memory_window->merge_into(memory, now);
+        }
+        summary.window_seconds = quantiles_.window_seconds;
+        summary.cpu_window = to_stats(cpu);
+        summary.memory_window = to_stats(memory);
+    }
+
+    for (uint32_t id = 0; id < hosts_.size(); ++id) {
+        if (!hosts_[id].up) {
+            summary.stale.push_back(row(id, now));
+        }
+    }
+    std::sort(summary.stale.begin(), summary.stale.end(), [](const FleetHostRow& a, const FleetHostRow& b) {
+        return a.age_seconds > b.age_seconds;
+    });
+    if (summary.stale.size() > top_n) {
+        summary.stale.resize(top_n);
+    }
+    return summary;
+}
+
+bool FleetState::history(const std::string& host, std::vector<FleetSample>& out) const {
+    out.clear();
+    auto it = index_.find(host);
+    if (it == index_.end()) {
+        return false;
+    }
+    const Host& h = hosts_[it->second];
+    size_t start = (h.head + h.ring.size() - h.size) % h.ring.size();
+    for (size_t i = 0; i < h.size; ++i) {
+        out.push_back(h.ring[(start + i) % h.ring.size()]);
+    }
+    return true;
+}
+
+void FleetState::add_to_rollups(uint32_t id) {
+    const FleetSample& s = hosts_[id].latest;
+    cpu_.insert(id, s.cpu);
+    memory_.insert(id, s.memory);
+    disk_.insert(id, s.disk);
+}
+
+void FleetState::remove_from_rollups(uint32_t id) {
+    const FleetSample& s = hosts_[id].latest;
+    cpu_.remove(id, s.cpu);
+    memory_.remove(id, s.memory);
+    disk_.remove(id, s.disk);
+}
+
+FleetHostRow FleetState::row(uint32_t id, Clock::time_point now) const {
+    FleetHostRow row;
+    row.host = hosts_[id].name;
+    row.latest = hosts_[id].latest;
+    row.age_seconds = std::chrono::duration<double>(now - hosts_[id].last_seen).count();
+    return row;
+}
+
+} // namespace sysmon
@@ -0,0 +1,348 @@
+#include "sysmon/flight_recorder.hpp"
+#include "sysmon/recording.hpp"
+#include "sysmon/trace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+
+namespace sysmon {
+
+namespace {
+
+// Record layout: wall and steady time, memory counters, fixed point CPU
+// and memory percentages, scheduler rates and counts, interrupt totals,
+// then per core, per disk and per interface values in the shape's order
+constexpr size_t kHeaderBytes = 7 * 8 + 4 * 2 + 8 * 4 + 3 * 4 + 5 * 4;
+constexpr size_t kCoreBytes = 2;
+constexpr size_t kDiskBytes = 2 * 8 + 2 * 4 + 2;
+constexpr size_t kNicBytes = 2 * 8 + 2 * 4;
+
+uint16_t to_fixed(double percent) {
+    double scaled = std::round(percent * 100.0);
+    return static_cast<uint16_t>(std::clamp(scaled, 0.0, 65535.0));
+}
+
+double from_fixed(uint16_t value) {
+    return value / 100.0;
+}
+
+class Packer {
+public:
+    explicit Packer(unsigned char* out) : out_(out) {}
+
+    template<typename T>
+    void put(T value) {
+        std::memcpy(out_, &value, sizeof(value));
+        out_ += sizeof(value);
+    }
+
+private:
+    unsigned char* out_;
+};
+
+class Unpacker {
+public:
+    explicit Unpacker(const unsigned char* in) : in_(in) {}
+
+    template<typename T>
+    T get() {
+        T value;
+        std::memcpy(&value, in_, sizeof(value));
+        in_ += sizeof(value);
+        return value;
+    }
+
+private:
+    const unsigned char* in_;
+};
+
+size_t record_size(const MetricSnapshot& shape) {
+    return kHeaderBytes + shape.cpu.per_core_usage.size() * kCoreBytes +
+           shape.disks.size() * kDiskBytes + shape.network.size() * kNicBytes;
+}
+
+void encode(const MetricSnapshot& snapshot, unsigned char* record) {
+    Packer out(record);
+    out.put<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        snapshot.wall_time.time_since_epoch()).count());
+    out.put<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        snapshot.timestamp.time_since_epoch()).count());
+    out.put<uint64_t>(snapshot.memory.total_bytes);
+    out.put<uint64_t>(snapshot.memory.available_bytes);
+    out.put<uint64_t>(snapshot.memory.used_bytes);
+    out.put<uint64_t>(snapshot.memory.swap_total_bytes);
+    out.put<uint64_t>(snapshot.memory.swap_used_bytes);
+    out.put(to_fixed(snapshot.cpu.overall_usage));
+    out.put(to_fixed(snapshot.cpu.iowait_percent));
+    out.put(to_fixed(snapshot.memory.usage_percent));
+    out.put<uint16_t>(0);
+    const auto& sched = snapshot.cpu.scheduler;
+    for (double value : {sched.context_switches_per_sec, sched.interrupts_per_sec, sched.softirqs_per_sec,
+                         sched.forks_per_sec, sched.run_queue_per_core, sched.load1, sched.load5, sched.load15}) {
+        out.put(static_cast<float>(value));
+    }
+    out.put(sched.procs_running);
+    out.put(sched.procs_blocked);
+    out.put(sched.threads);
+    const auto& irq = snapshot.cpu.interrupts;
+    out.put(static_cast<float>(irq.irq_total));
+    out.put(static_cast<float>(irq.softirq_total));
+    out.put(static_cast<float>(irq.net_softirq_total));
+    out.put(static_cast<float>(irq.imbalance));
+    out.put<int32_t>(irq.busiest_cpu);
+    for (double usage : snapshot.cpu.per_core_usage) {
+        out.put(to_fixed(usage));
+    }
+    for (const auto& disk : snapshot.disks) {
+        out.put<uint64_t>(disk.total_bytes);
+        out.put<uint64_t>(disk.used_bytes);
+        out.put(static_cast<float>(disk.seconds_to_full));
+        out.put(static_cast<float>(disk.growth_bytes_per_sec));
+        out.put(to_fixed(disk.usage_percent));
+    }
+    for (const auto& net : snapshot.network) {
+        out.put<uint64_t>(net.bytes_received);
+        out.put<uint64_t>(net.bytes_sent);
+        out.put(static_cast<float>(net.download_mbps));
+        out.put(static_cast<float>(net.upload_mbps));
+    }
+}
+
+MetricSnapshot decode(const MetricSnapshot& shape, const unsigned char* record) {
+    MetricSnapshot snapshot = shape;
+    Unpacker in(record);
+    snapshot.wall_time = std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(in.get<int64_t>())));
+    snapshot.timestamp = std::chrono::steady_clock::time_point(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(in.get<int64_t>())));
+    snapshot.memory.total_bytes = in.get<uint64_t>();
+    snapshot.memory.available_bytes = in.get<uint64_t>();
+    snapshot.memory.used_bytes = in.get<uint64_t>();
+    snapshot.memory.swap_total_bytes = in.get<uint64_t>();
+    snapshot.memory.swap_used_bytes = in.get<uint64_t>();
+    snapshot.cpu.overall_usage = from_fixed(in.get<uint16_t>());
+    snapshot.cpu.iowait_percent = from_fixed(in.get<uint16_t>());
+    snapshot.memory.usage_percent = from_fixed(in.get<uint16_t>());
+    in.get<uint16_t>();
+    auto& sched = snapshot.cpu.scheduler;
+    for (double* value : {&sched.context_switches_per_sec, &sched.interrupts_per_sec, &sched.softirqs_per_sec,
+                          &sched.forks_per_sec, &sched.run_queue_per_core, &sched.load1, &sched.load5, &sched.load15}) {
+        *value = in.get<float>();
+    }
+    sched.procs_running = in.get<uint32_t>();
+    sched.procs_blocked = in.get<uint32_t>();
+    sched.threads = in.get<uint32_t>();
+    auto& irq = snapshot.cpu.interrupts;
+    irq.irq_total = in.get<float>();
+    irq.softirq_total = in.get<float>();
+    irq.net_softirq_total = in.get<float>();
+    irq.imbalance = in.get<float>();
+    irq.busiest_cpu = in.get<int32_t>();
+    for (double& usage : snapshot.cpu.per_core_usage) {
+        usage = from_fixed(in.get<uint16_t>());
+    }
+    for (auto& disk : snapshot.disks) {
+        disk.total_bytes = in.get<uint64_t>();
+        disk.used_bytes = in.get<uint64_t>();
+        disk.seconds_to_full = in.get<float>();
+        disk.growth_bytes_per_sec = in.get<float>();
+        disk.usage_percent = from_fixed(in.get<uint16_t>());
+    }
+    for (auto& net : snapshot.network) {
+        net.bytes_received = in.get<uint64_t>();
+        net.bytes_sent = in.get<uint64_t>();
+        net.download_mbps = in.get<float>();
+        net.upload_mbps = in.get<float>();
+    }
+    return snapshot;
+}
+
+std::string dump_path(const std::string& directory, const std::string& reason) {
+    std::time_t time_t = std::time(nullptr);
+    std::tm tm;
+#ifdef _WIN32
+    localtime_s(&tm, &time_t);
+#else
+    localtime_r(&time_t, &tm);
+#endif
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &tm);
+    std::string base = "sysmon-flight-" + std::string(stamp) + "-" + reason;
+
+    // A second dump in the same second gets -2, -3, ...; the previous dump's
+    // file already exists, since dump() waits for its writer
+    std::filesystem::path path = std::filesystem::path(directory) / (base + ".smr");
+    std::error_code ec;
+    for (int sequence = 2; std::filesystem::exists(path, ec); ++sequence) {
+        path = std::filesystem::path(directory) / (base + "-" + std::to_string(sequence) + ".smr");
+    }
+    return path.string();
+}
+
+} // namespace
+
+FlightRecorder::FlightRecorder(const FlightRecorderConfig& config, int update_interval_seconds)
+    : config_(config)
+    , update_interval_(update_interval_seconds)
+    , capacity_(static_cast<size_t>(std::max(1, config.minutes * 60 / std::max(1, update_interval_seconds))))
+{
+}
+
+FlightRecorder::~FlightRecorder() {
+    wait();
+}
+
+bool FlightRecorder::same_shape(const MetricSnapshot& snapshot) const {
+    if (snapshot.cpu.per_core_usage.size() != shape_.cpu.per_core_usage.size() ||
+        snapshot.cpu.model_name != shape_.cpu.model_name ||
+        snapshot.disks.size() != shape_.disks.size() ||
+        snapshot.network.size() != shape_.network.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < snapshot.disks.size(); ++i) {
+        if (snapshot.disks[i].mount_point != shape_.disks[i].mount_point ||
+            snapshot.disks[i].label != shape_.disks[i].label) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < snapshot.network.size(); ++i) {
+        if (snapshot.network[i].interface_name != shape_.network[i].interface_name) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FlightRecorder::reshape(const MetricSnapshot& snapshot) {
+    // Keep only the filled records of the old ring
+    if (count_ > 0) {
+        previous_.push_back(live_segment());
+        previous_count_ += count_;
+    }
+
+    shape_ = snapshot;
+    shape_.cpu.overall_usage = 0.0;
+    shape_.cpu.iowait_percent = 0.0;
+    shape_.cpu.perf = PerfMetrics{};     // not recorded
+    shape_.cpu.topology = CpuTopologyMetrics{};
+    shape_.cpu.interrupts = InterruptMetrics{};   // totals only
+    shape_.cpu.interrupts.available = snapshot.cpu.interrupts.available;
+    shape_.memory = MemoryMetrics{};
+    shape_.memory.model_name = snapshot.memory.model_name;
+    record_bytes_ = record_size(shape_);
+    ring_.assign(capacity_ * record_bytes_, 0);
+    head_ = 0;
+    count_ = 0;
+    SYSMON_TRACE(Info, "flight recorder reshaped: {} records of {} bytes", capacity_, record_bytes_);
+}
+
+void FlightRecorder::record(const MetricSnapshot& snapshot) {
+    if (ring_.empty() || !same_shape(snapshot)) {
+        reshape(snapshot);
+    }
+    encode(snapshot, ring_.data() + head_ * record_bytes_);
+    head_ = (head_ + 1) % capacity_;
+    count_ = std::min(count_ + 1, capacity_);
+
+    // The window holds capacity_ records across all segments
+    if (previous_count_ > 0 && count_ + previous_count_ > capacity_) {
+        Segment& oldest = previous_.front();
+        ++oldest.first;
+        --oldest.count;
+        --previous_count_;
+        if (oldest.count == 0) {
+            previous_.pop_front();
+        }
+    }
+}
+
+FlightRecorder::Segment FlightRecorder::live_segment() const {
+    Segment live;
+    live.shape = shape_;
+    live.record_bytes = record_bytes_;
+    live.records.resize(count_ * record_bytes_);
+    size_t first = (head_ + capacity_ - count_) % capacity_;
+    size_t tail = std::min(count_, capacity_ - first);
+    std::memcpy(live.records.data(), ring_.data() + first * record_bytes_, tail * record_bytes_);
+    std::memcpy(live.records.data() + tail * record_bytes_, ring_.data(), (count_ - tail) * record_bytes_);
+    live.count = count_;
+    return live;
+}
+
+std::vector<FlightRecorder::Segment> FlightRecorder::segments() const {
+    std::vector<Segment> result;
+    result.reserve(previous_.size() + 1);
+    for (const auto& segment : previous_) {
+        Segment copy;
+        copy.shape = segment.shape;
+        copy.record_bytes = segment.record_bytes;
+        auto begin = segment.records.begin() + static_cast<ptrdiff_t>(segment.first * segment.record_bytes);
+        copy.records.assign(begin, begin + static_cast<ptrdiff_t>(segment.count * segment.record_bytes));
+        copy.count = segment.count;
+        result.push_back(std::move(copy));
+    }
+    if (count_ > 0) {
+        result.push_back(live_segment());
+    }
+    return result;
+}
+
+std::vector<MetricSnapshot> FlightRecorder::snapshots() const {
+    std::vector<MetricSnapshot> result;
+    result.reserve(size());
+    for (const auto& segment : segments()) {
+        for (size_t i = 0; i < segment.count; ++i) {
+            result.push_back(decode(segment.shape, segment.records.data() + i * segment.record_bytes));
+        }
+    }
+    return result;
+}
+
+std::string FlightRecorder::dump(const std::string& reason) {
+    if (size() == 0 || writing_.load(std::memory_order_acquire)) {
+        return {};
+    }
+    wait();
+
+    // Copy the records oldest first; the worker decodes and compresses them
+    std::string path = dump_path(config_.directory, reason);
+    ++dumps_;
+    writing_.store(true, std::memory_order_release);
+    writer_ = std::thread([this, path, segments = segments()] {
+        RecordingWriter writer(path, preferred_recording_codec());
+        for (const auto& segment : segments) {
+            for (size_t i = 0; writer.is_open() && i < segment.count; ++i) {
+                writer.append(decode(segment.shape, segment.records.data() + i * segment.record_bytes));
+            }
+        }
+        if (writer.is_open() && writer.flush()) {
+            std::cout << "Flight recorder: wrote " << writer.frames() << " samples to " << path << "\n";
+        }
+        writing_.store(false, std::memory_order_release);
+    });
+    return path;
+}
+
+std::string FlightRecorder::dump_on_critical(std::chrono::steady_clock::time_point now) {
+    if (!config_.dump_on_critical ||
+        (have_last_critical_dump_ && now - last_critical_dump_ < std::chrono::seconds(config_.min_dump_interval_seconds))) {
+        return {};
+    }
+    std::string path = dump("critical");
+    if (!path.empty()) {
+        have_last_critical_dump_ = true;
+        last_critical_dump_ = now;
+    }
+    return path;
+}
+
+void FlightRecorder::wait() {
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+} // namespace sysmon
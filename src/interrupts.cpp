@@ -0,0 +1,132 @@
+#include "sysmon/interrupts.hpp"
+#include <bit>
+#include <cstring>
+
+namespace sysmon {
+
+namespace {
+
+// First byte at or after p that is not a space. Columns are padded to the
+// width of the largest count, so this is where the time goes.
+const char* skip_spaces(const char* p, const char* end) {
+    if constexpr (std::endian::native == std::endian::little) {
+        while (end - p >= 8) {
+            uint64_t word;
+            std::memcpy(&word, p, sizeof(word));
+            uint64_t other = word ^ 0x2020202020202020ull;
+            if (other != 0) {
+                return p + (std::countr_zero(other) >> 3);
+            }
+            p += 8;
+        }
+    }
+    while (p < end && *p == ' ') {
+        ++p;
+    }
+    return p;
+}
+
+bool is_digit(char c) {
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+void rates(const std::vector<uint64_t>& before, const std::vector<uint64_t>& after, double seconds,
+           std::vector<double>& out, double& total) {
+    out.assign(after.size(), 0.0);
+    if (before.size() != after.size() || seconds <= 0.0) {
+        return;
+    }
+    for (size_t i = 0; i < after.size(); ++i) {
+        // Counters of a CPU that went offline and came back start over
+        out[i] = after[i] >= before[i] ? static_cast<double>(after[i] - before[i]) / seconds : 0.0;
+        total += out[i];
+    }
+}
+
+} // namespace
+
+size_t parse_interrupt_matrix(std::string_view text, InterruptCounts& out) {
+    const char* p = text.data();
+    const char* end = p + text.size();
+
+    // "           CPU0       CPU1 ..."
+    const char* eol = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+    eol = eol ? eol : end;
+    size_t columns = 0;
+    for (const char* q = skip_spaces(p, eol); q < eol; q = skip_spaces(q, eol)) {
+        if (eol - q < 3 || std::memcmp(q, "CPU", 3) != 0) {
+            break;
+        }
+        ++columns;
+        while (q < eol && *q != ' ') {
+            ++q;
+        }
+    }
+    out.total.assign(columns, 0);
+    out.devices.assign(columns, 0);
+    out.net.assign(columns, 0);
+    if (columns == 0) {
+        return 0;
+    }
+
+    // "  24:   1234   5678  IR-PCI-MSI 524288-edge  eth0-TxRx-0", "NMI: ...", "NET_RX: ..."
+    for (p = eol; p < end; p = eol) {
+        ++p;
+        eol = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        eol = eol ? eol : end;
+        const char* label = skip_spaces(p, eol);
+        const char* colon = static_cast<const char*>(std::memchr(label, ':', static_cast<size_t>(eol - label)));
+        if (!colon) {
+            continue;
+        }
+        std::string_view name(label, static_cast<size_t>(colon - label));
+        bool device = !name.empty() && is_digit(name.front());
+        bool net = name == "NET_RX" || name == "NET_TX";
+
+        p = colon + 1;
+        for (size_t column = 0; column < columns; ++column) {
+            p = skip_spaces(p, eol);
+            if (p == eol || !is_digit(*p)) {
+                break;   // ERR and MIS have a single count; a description follows the counts
+            }
+            uint64_t value = 0;
+            while (p < eol && is_digit(*p)) {
+                value = value * 10 + static_cast<uint64_t>(*p - '0');
+                ++p;
+            }
+            out.total[column] += value;
+            if (device) {
+                out.devices[column] += value;
+            }
+            if (net) {
+                out.net[column] += value;
+            }
+        }
+    }
+    return columns;
+}
+
+InterruptMetrics interrupt_rates(const InterruptCounts& irq_before, const InterruptCounts& irq_after,
+                                 const InterruptCounts& softirq_before, const InterruptCounts& softirq_after,
+                                 double seconds) {
+    InterruptMetrics metrics;
+    metrics.available = true;
+    rates(irq_before.devices, irq_after.devices, seconds, metrics.irq_per_cpu, metrics.irq_total);
+    rates(softirq_before.total, softirq_after.total, seconds, metrics.softirq_per_cpu, metrics.softirq_total);
+    rates(softirq_before.net, softirq_after.net, seconds, metrics.net_softirq_per_cpu, metrics.net_softirq_total);
+
+    if (!metrics.irq_per_cpu.empty() && metrics.irq_total > 0.0) {
+        size_t busiest = 0;
+        for (size_t i = 1; i < metrics.irq_per_cpu.size(); ++i) {
+            if (metrics.irq_per_cpu[i] > metrics.irq_per_cpu[busiest]) {
+                busiest = i;
+            }
+        }
+        double mean = metrics.irq_total / static_cast<double>(metrics.irq_per_cpu.size());
+        metrics.imbalance = metrics.irq_per_cpu[busiest] / mean;
+        metrics.busiest_cpu = static_cast<int>(busiest);
+    }
+    return metrics;
+}
+
+} // namespace sysmon
@@ -0,0 +1,241 @@
+#include "sysmon/log_sink.hpp"
+#include "sysmon/alert_engine.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+#ifdef SYSMON_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace sysmon {
+
+namespace {
+
+template<size_t N>
+uint8_t copy_truncated(char (&dst)[N], const std::string& src) {
+    size_t len = std::min(src.size(), N);
+    std::memcpy(dst, src.data(), len);
+    return static_cast<uint8_t>(len);
+}
+
+#ifdef SYSMON_HAVE_ZLIB
+bool compress_file(const std::string& src, const std::string& dst) {
+    std::FILE* in = std::fopen(src.c_str(), "rb");
+    if (!in) {
+        return false;
+    }
+    gzFile out = gzopen(dst.c_str(), "wb6");
+    if (!out) {
+        std::fclose(in);
+        return false;
+    }
+
+    char chunk[64 * 1024];
+    bool ok = true;
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        if (gzwrite(out, chunk, static_cast<unsigned>(n)) != static_cast<int>(n)) {
+            ok = false;
+            break;
+        }
+    }
+    std::fclose(in);
+    return gzclose(out) == Z_OK && ok;
+}
+#endif
+
+} // namespace
+
+LogSink::LogSink(const LogSinkOptions& options)
+    : options_(options)
+    , queue_(options.queue_size)
+{
+    file_ = std::fopen(options_.path.c_str(), "ab");
+    if (!file_) {
+        return;
+    }
+
+    std::error_code ec;
+    auto size = std::filesystem::file_size(options_.path, ec);
+    file_bytes_ = ec ? 0 : size;
+
+    // After a log_format change, start a fresh file rather than append
+    // records that readers would decode with the old format
+    if (file_bytes_ > 0) {
+        char head[sizeof(kBinaryLogMagic)] = {};
+        size_t have = 0;
+        if (std::FILE* in = std::fopen(options_.path.c_str(), "rb")) {
+            have = std::fread(head, 1, sizeof(head), in);
+            std::fclose(in);
+        }
+        if (detect_log_format(head, have) != options_.format) {
+            rotate();
+            if (!file_) {
+                return;
+            }
+        }
+    }
+    buffer_.reserve(options_.flush_bytes + sizeof(LogRecord) * 2);
+    last_commit_ = std::chrono::steady_clock::now();
+
+    writer_ = std::thread(&LogSink::writer_loop, this);
+}
+
+LogSink::~LogSink() {
+    stopping_.store(true);
+    wake_.notify_one();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+    if (file_) {
+        std::fclose(file_);
+    }
+}
+
+bool LogSink::submit(const Alert& alert) {
+    if (!file_) {
+        return false;
+    }
+
+    LogRecord record;
+    record.timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        alert.timestamp.time_since_epoch()).count();
+    record.monotonic_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        alert.monotonic.time_since_epoch()).count();
+    record.value = alert.value;
+    record.threshold = alert.threshold;
+    record.level = alert.level;
+    record.category_len = copy_truncated(record.category, alert.category);
+    record.entity_len = copy_truncated(record.entity, alert.entity);
+    record.message_len = copy_truncated(record.message, alert.message);
+
+    if (!queue_.try_push(record)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Only wake the writer early under bursts; otherwise it runs on its timer
+    if (queue_.size_approx() >= queue_.capacity() / 2) {
+        wake_.notify_one();
+    }
+    return true;
+}
+
+void LogSink::writer_loop() {
+    while (!stopping_.load()) {
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_.wait_for(lock, options_.flush_interval, [this] {
+                return stopping_.load() || queue_.size_approx() >= queue_.capacity() / 2;
+            });
+        }
+
+        drain();
+
+        auto now = std::chrono::steady_clock::now();
+        if (buffer_.size() >= options_.flush_bytes ||
+            (!buffer_.empty() && now - last_commit_ >= options_.flush_interval)) {
+            commit();
+        }
+    }
+
+    // Final drain on shutdown
+    drain();
+    commit();
+}
+
+void LogSink::drain() {
+    LogRecord record;
+    while (queue_.try_pop(record)) {
+        encode_record(record);
+        if (buffer_.size() >= options_.flush_bytes) {
+            commit();
+        }
+    }
+    queue_.publish_head();
+}
+
+void LogSink::encode_record(const LogRecord& record) {
+    AlertLogEntry entry;
+    entry.timestamp_us = record.timestamp_us;
+    entry.monotonic_ns = record.monotonic_ns;
+    entry.value = record.value;
+    entry.threshold = record.threshold;
+    entry.level = record.level;
+    entry.category = std::string_view(record.category, record.category_len);
+    entry.entity = std::string_view(record.entity, record.entity_len);
+    entry.message = std::string_view(record.message, record.message_len);
+
+    switch (options_.format) {
+        case LogFormat::Text:      append_text(buffer_, entry, timestamps_); break;
+        case LogFormat::JsonLines: append_jsonl(buffer_, entry); break;
+        case LogFormat::Binary:    append_binary(buffer_, entry); break;
+    }
+}
+
+void LogSink::commit() {
+    if (buffer_.empty() || !file_) {
+        return;
+    }
+
+    if (options_.max_file_bytes > 0 && file_bytes_ > 0 &&
+        file_bytes_ + buffer_.size() > options_.max_file_bytes) {
+        rotate();
+        if (!file_) {
+            buffer_.clear();
+            return;
+        }
+    }
+
+    // Binary logs start with a magic header so readers can detect the format
+    if (file_bytes_ == 0 && options_.format == LogFormat::Binary) {
+        std::fwrite(kBinaryLogMagic, 1, sizeof(kBinaryLogMagic), file_);
+        file_bytes_ += sizeof(kBinaryLogMagic);
+    }
+    std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+    std::fflush(file_);
+    file_bytes_ += buffer_.size();
+    buffer_.clear();
+    last_commit_ = std::chrono::steady_clock::now();
+}
+
+void LogSink::rotate() {
+    std::fclose(file_);
+    file_ = nullptr;
+
+    bool compress = options_.compress_rotated;
+#ifndef SYSMON_HAVE_ZLIB
+    compress = false;
+#endif
+    auto rotated = [&](int index, bool gz) {
+        return options_.path + "." + std::to_string(index) + (gz ? ".gz" : "");
+    };
+
+    // sysmon.log.N-1 -> sysmon.log.N, ..., sysmon.log -> sysmon.log.1.
+    // A file that failed to compress stays in the chain uncompressed, so
+    // both suffixes are shifted and expired.
+    std::error_code ec;
+    int keep = std::max(1, options_.max_files);
+    for (bool gz : {false, true}) {
+        std::filesystem::remove(rotated(keep, gz), ec);
+        for (int i = keep - 1; i >= 1; --i) {
+            std::filesystem::rename(rotated(i, gz), rotated(i + 1, gz), ec);
+        }
+    }
+
+#ifdef SYSMON_HAVE_ZLIB
+    if (compress && compress_file(options_.path, rotated(1, true))) {
+        std::filesystem::remove(options_.path, ec);
+    } else {
+        std::filesystem::rename(options_.path, rotated(1, false), ec);
+    }
+#else
+    std::filesystem::rename(options_.path, rotated(1, false), ec);
+#endif
+
+    file_ = std::fopen(options_.path.c_str(), "ab");
+    file_bytes_ = 0;
+}
+
+} // namespace sysmon
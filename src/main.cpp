@@ -1,6 +1,7 @@
 #include "sysmon/system_monitor.hpp"
 #include <iostream>
 #include <csignal>
+#include <cstdlib>
 #include <memory>
 
 // Global pointer for signal handler
@@ -13,51 +14,127 @@ void signal_handler(int signal) {
             g_monitor->stop();
         }
     }
+#ifdef SIGUSR1
+    if (signal == SIGUSR1 && g_monitor) {
+        g_monitor->request_flight_dump();
+    }
+#endif
 }
 
 void print_usage(const char* program_name) {
-    std::cout << "Usage: " << program_name << " [config_file]\n";
+    std::cout << "Usage: " << program_name << " [--aggregate | --record <file> | --replay <file> [--speed N] [--replay-log <file>]] [--self-stats] [config_file]\n";
     std::cout << "\n";
     std::cout << "Options:\n";
     std::cout << "  config_file    Path to YAML configuration file (default: config/default_config.yaml)\n";
+    std::cout << "  --aggregate    Receive pushed snapshots from other instances and show the fleet\n";
+    std::cout << "  --record FILE  Also write every collected snapshot to FILE\n";
+    std::cout << "  --replay FILE  Run alerts and display over a recording instead of live metrics\n";
+    std::cout << "  --speed N      Replay N times faster than recorded (default: as fast as possible)\n";
+    std::cout << "  --replay-log FILE  Log replayed alerts to FILE (default: not logged)\n";
+    std::cout << "  --self-stats   Print sysmon's own per-stage timings and cost on exit\n";
     std::cout << "  -h, --help     Show this help message\n";
     std::cout << "\n";
     std::cout << "Examples:\n";
     std::cout << "  " << program_name << "\n";
     std::cout << "  " << program_name << " config/profiles/server.yaml\n";
     std::cout << "  " << program_name << " custom_config.yaml\n";
+    std::cout << "  " << program_name << " --aggregate config/profiles/server.yaml\n";
+    std::cout << "  " << program_name << " --record incident.smr\n";
+    std::cout << "  " << program_name << " --replay incident.smr tuned_rules.yaml\n";
     std::cout << "\n";
 }
 
 int main(int argc, char* argv[]) {
     // Parse command-line arguments
     std::string config_path = "config/default_config.yaml";
+    bool aggregate = false;
+    std::string record_path;
+    std::string replay_path;
+    std::string replay_log;
+    double speed = 0.0;
+    bool self_stats = false;
     
-    if (argc > 1) {
-        std::string arg = argv[1];
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
         if (arg == "-h" || arg == "--help") {
             print_usage(argv[0]);
             return 0;
         }
+        if (arg == "--aggregate") {
+            aggregate = true;
+            continue;
+        }
+        if (arg == "--self-stats") {
+            self_stats = true;
+            continue;
+        }
+        if (arg == "--record" || arg == "--replay" || arg == "--replay-log" || arg == "--speed") {
+            if (i + 1 >= argc) {
+                std::cerr << arg << " needs a value\n";
+                return 1;
+            }
+            std::string value = argv[++i];
+            if (arg == "--record") {
+                record_path = value;
+            } else if (arg == "--replay") {
+                replay_path = value;
+            } else if (arg == "--replay-log") {
+                replay_log = value;
+            } else {
+                char* end = nullptr;
+                speed = std::strtod(value.c_str(), &end);
+                if (*end != '\0' || speed < 0) {
+                    std::cerr << "--speed must be a non-negative number\n";
+                    return 1;
+                }
+            }
+            continue;
+        }
         config_path = arg;
     }
+    if (aggregate + !record_path.empty() + !replay_path.empty() > 1) {
+        std::cerr << "--aggregate, --record and --replay cannot be combined\n";
+        return 1;
+    }
+    if (!replay_log.empty() && replay_path.empty()) {
+        std::cerr << "--replay-log needs --replay\n";
+        return 1;
+    }
     
     // Setup signal handlers
     std::signal(SIGINT, signal_handler);
     std::signal(SIGTERM, signal_handler);
+#ifdef SIGUSR1
+    std::signal(SIGUSR1, signal_handler);   // dump the flight recorder
+#endif
     
     // Create and initialize system monitor
     auto monitor = std::make_unique<sysmon::SystemMonitor>(config_path);
     g_monitor = monitor.get();
     
-    if (!monitor->initialize()) {
+    auto mode = aggregate ? sysmon::RunMode::Aggregate
+              : !replay_path.empty() ? sysmon::RunMode::Replay
+              : sysmon::RunMode::Live;
+    if (!monitor->initialize(mode, replay_log)) {
         std::cerr << "Failed to initialize system monitor\n";
         return 1;
     }
     
     // Run monitoring loop
-    monitor->run();
+    if (aggregate) {
+        monitor->run_aggregator();
+    } else if (!replay_path.empty()) {
+        monitor->run_replay(replay_path, speed);
+    } else {
+        if (!record_path.empty() && !monitor->start_recording(record_path)) {
+            return 1;
+        }
+        monitor->run();
+    }
     
     std::cout << "SysMon stopped.\n";
+    if (self_stats) {
+        monitor->dump_self_stats(std::cout);
+    }
     return 0;
 }
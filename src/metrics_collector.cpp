@@ -7,21 +7,21 @@ namespace sysmon {
 #ifdef _WIN32
     // Forward declare Windows implementation
     class WindowsMetricsCollector;
-    std::unique_ptr<MetricsCollector> create_metrics_collector() {
+    std::unique_ptr<MetricsCollector> create_metrics_collector(const std::string& /*fs_root*/) {
         extern std::unique_ptr<MetricsCollector> create_windows_metrics_collector();
         return create_windows_metrics_collector();
     }
 #elif __linux__
     // Forward declare Linux implementation
     class LinuxMetricsCollector;
-    std::unique_ptr<MetricsCollector> create_metrics_collector() {
-        extern std::unique_ptr<MetricsCollector> create_linux_metrics_collector();
-        return create_linux_metrics_collector();
+    std::unique_ptr<MetricsCollector> create_metrics_collector(const std::string& fs_root) {
+        extern std::unique_ptr<MetricsCollector> create_linux_metrics_collector(const std::string& fs_root);
+        return create_linux_metrics_collector(fs_root);
     }
 #elif __APPLE__
     // Forward declare macOS implementation
     class MacOSMetricsCollector;
-    std::unique_ptr<MetricsCollector> create_metrics_collector() {
+    std::unique_ptr<MetricsCollector> create_metrics_collector(const std::string& /*fs_root*/) {
         extern std::unique_ptr<MetricsCollector> create_macos_metrics_collector();
         return create_macos_metrics_collector();
     }
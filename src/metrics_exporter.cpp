@@ -0,0 +1,775 @@
+#include "sysmon/metrics_exporter.hpp"
+#include "sysmon/alert_engine.hpp"
+#include "sysmon/quantile_sketch.hpp"
+#include "sysmon/self_stats.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace sysmon {
+
+namespace {
+
+constexpr std::string_view kContentType = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+void append_number(std::string& out, double value) {
+    if (std::isnan(value)) {
+        out += "NaN";
+        return;
+    }
+    if (std::isinf(value)) {
+        out += value > 0 ? "+Inf" : "-Inf";
+        return;
+    }
+    char buf[32];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, res.ptr);
+}
+
+void append_number(std::string& out, uint64_t value) {
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, res.ptr);
+}
+
+void append_label_value(std::string& out, std::string_view value) {
+    for (char c : value) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '"':  out += "\\\""; break;
+            case '\n': out += "\\n"; break;
+            default:   out += c; break;
+        }
+    }
+}
+
+void append_family(std::string& out, std::string_view name, std::string_view type, std::string_view help) {
+    out += "# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += "\n# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += '\n';
+}
+
+// name{label="value"} number
+template<typename T>
+void append_sample(std::string& out, std::string_view name, std::string_view label,
+                   std::string_view label_value, T value) {
+    out += name;
+    if (!label.empty()) {
+        out += '{';
+        out += label;
+        out += "=\"";
+        append_label_value(out, label_value);
+        out += "\"}";
+    }
+    out += ' ';
+    append_number(out, value);
+    out += '\n';
+}
+
+template<typename T>
+void append_sample(std::string& out, std::string_view name, T value) {
+    append_sample(out, name, {}, {}, value);
+}
+
+} // namespace
+
+void render_openmetrics(std::string& out, const MetricSnapshot& snapshot, const std::vector<Alert>& alerts,
+                        const SeriesSketches* sketches, const SelfStats* self) {
+    const auto& cpu = snapshot.cpu;
+    if (cpu.core_count > 0) {
+        append_family(out, "sysmon_cpu_usage_percent", "gauge", "Overall CPU usage.");
+        append_sample(out, "sysmon_cpu_usage_percent", cpu.overall_usage);
+        append_family(out, "sysmon_cpu_iowait_percent", "gauge", "CPU time idle waiting on I/O.");
+        append_sample(out, "sysmon_cpu_iowait_percent", cpu.iowait_percent);
+        append_family(out, "sysmon_cpu_logical_processors", "gauge", "Number of logical processors.");
+        append_sample(out, "sysmon_cpu_logical_processors", static_cast<uint64_t>(cpu.core_count));
+
+        if (!cpu.per_core_usage.empty()) {
+            append_family(out, "sysmon_cpu_core_usage_percent", "gauge", "Usage per logical processor.");
+            char core[16];
+            for (size_t i = 0; i < cpu.per_core_usage.size(); ++i) {
+                auto res = std::to_chars(core, core + sizeof(core), i);
+                append_sample(out, "sysmon_cpu_core_usage_percent", "core",
+                              std::string_view(core, res.ptr - core), cpu.per_core_usage[i]);
+            }
+        }
+
+        const auto& topology = cpu.topology;
+        if (topology.available) {
+            char index[16];
+            append_family(out, "sysmon_cpu_threads_per_core", "gauge", "SMT threads per physical core.");
+            append_sample(out, "sysmon_cpu_threads_per_core", static_cast<uint64_t>(topology.threads_per_core));
+            append_family(out, "sysmon_cpu_socket_usage_percent", "gauge", "Usage per package.");
+            for (size_t p = 0; p < topology.package_usage.size(); ++p) {
+                auto res = std::to_chars(index, index + sizeof(index), p);
+                append_sample(out, "sysmon_cpu_socket_usage_percent", "socket",
+                              std::string_view(index, res.ptr - index), topology.package_usage[p]);
+            }
+            append_family(out, "sysmon_cpu_physical_core_usage_percent", "gauge",
+                          "Mean usage of each physical core's threads, numbered socket by socket.");
+            for (size_t c = 0; c < topology.core_usage.size(); ++c) {
+                auto res = std::to_chars(index, index + sizeof(index), c);
+                append_sample(out, "sysmon_cpu_physical_core_usage_percent", "core",
+                              std::string_view(index, res.ptr - index), topology.core_usage[c]);
+            }
+        }
+    }
+
+    const auto& sched = cpu.scheduler;
+    if (sched.available) {
+        append_family(out, "sysmon_load_average", "gauge", "Run queue length averaged over 1, 5 and 15 minutes.");
+        append_sample(out, "sysmon_load_average", "period", "1m", sched.load1);
+        append_sample(out, "sysmon_load_average", "period", "5m", sched.load5);
+        append_sample(out, "sysmon_load_average", "period", "15m", sched.load15);
+        append_family(out, "sysmon_sched_procs_running", "gauge", "Runnable tasks.");
+        append_sample(out, "sysmon_sched_procs_running", static_cast<uint64_t>(sched.procs_running));
+        append_family(out, "sysmon_sched_procs_blocked", "gauge", "Tasks in uninterruptible sleep.");
+        append_sample(out, "sysmon_sched_procs_blocked", static_cast<uint64_t>(sched.procs_blocked));
+        append_family(out, "sysmon_sched_threads", "gauge", "Scheduling entities in existence.");
+        append_sample(out, "sysmon_sched_threads", static_cast<uint64_t>(sched.threads));
+        append_family(out, "sysmon_sched_run_queue_per_core", "gauge", "Runnable tasks per logical processor.");
+        append_sample(out, "sysmon_sched_run_queue_per_core", sched.run_queue_per_core);
+        append_family(out, "sysmon_sched_events_per_second", "gauge", "Kernel scheduling and interrupt activity.");
+        append_sample(out, "sysmon_sched_events_per_second", "event", "context_switches", sched.context_switches_per_sec);
+        append_sample(out, "sysmon_sched_events_per_second", "event", "interrupts", sched.interrupts_per_sec);
+        append_sample(out, "sysmon_sched_events_per_second", "event", "softirqs", sched.softirqs_per_sec);
+        append_sample(out, "sysmon_sched_events_per_second", "event", "forks", sched.forks_per_sec);
+    }
+
+    const auto& irq = cpu.interrupts;
+    if (irq.available) {
+        append_family(out, "sysmon_interrupts_per_second", "gauge", "Host-wide device interrupt and softirq rates.");
+        append_sample(out, "sysmon_interrupts_per_second", "kind", "irq", irq.irq_total);
+        append_sample(out, "sysmon_interrupts_per_second", "kind", "softirq", irq.softirq_total);
+        append_sample(out, "sysmon_interrupts_per_second", "kind", "net_softirq", irq.net_softirq_total);
+        append_family(out, "sysmon_irq_imbalance", "gauge", "Busiest CPU's device interrupt rate over the mean.");
+        append_sample(out, "sysmon_irq_imbalance", irq.imbalance);
+
+        char core[16];
+        auto per_core = [&](std::string_view name, const char* help, const std::vector<double>& rates) {
+            if (rates.empty()) {
+                return;
+            }
+            append_family(out, name, "gauge", help);
+            for (size_t i = 0; i < rates.size(); ++i) {
+                auto res = std::to_chars(core, core + sizeof(core), i);
+                append_sample(out, name, "core", std::string_view(core, res.ptr - core), rates[i]);
+            }
+        };
+        per_core("sysmon_irq_per_second", "Device interrupts per logical processor.", irq.irq_per_cpu);
+        per_core("sysmon_net_softirq_per_second", "NET_RX and NET_TX softirqs per logical processor.",
+                 irq.net_softirq_per_cpu);
+    }
+
+    // Counters that never ran during the tick are left out, not reported as zero
+    const auto& perf = cpu.perf;
+    if (perf.available && perf.total.available) {
+        append_family(out, "sysmon_perf_events_per_second", "gauge", "Host-wide perf event rates.");
+        struct Rate {
+            const char* event;
+            double value;
+            bool hardware;
+        };
+        const Rate rates[] = {
+            {"cycles", perf.total.cycles, true},
+            {"instructions", perf.total.instructions, true},
+            {"cache_references", perf.total.cache_references, true},
+            {"cache_misses", perf.total.cache_misses, true},
+            {"context_switches", perf.total.context_switches, false},
+            {"cpu_migrations", perf.total.cpu_migrations, false},
+            {"page_faults", perf.total.page_faults, false},
+        };
+        for (const auto& rate : rates) {
+            if (perf.hardware || !rate.hardware) {
+                append_sample(out, "sysmon_perf_events_per_second", "event", rate.event, rate.value);
+            }
+        }
+    }
+    if (perf.available && perf.hardware) {
+        char index[16];
+        append_family(out, "sysmon_perf_ipc", "gauge", "Instructions per cycle per logical processor.");
+        for (size_t i = 0; i < perf.per_cpu.size(); ++i) {
+            if (!perf.per_cpu[i].available) continue;
+            auto res = std::to_chars(index, index + sizeof(index), i);
+            append_sample(out, "sysmon_perf_ipc", "core", std::string_view(index, res.ptr - index), perf.per_cpu[i].ipc);
+        }
+        append_family(out, "sysmon_perf_socket_ipc", "gauge", "Instructions per cycle per socket.");
+        for (size_t i = 0; i < perf.per_socket.size(); ++i) {
+            if (!perf.per_socket[i].available) continue;
+            auto res = std::to_chars(index, index + sizeof(index), i);
+            append_sample(out, "sysmon_perf_socket_ipc", "socket", std::string_view(index, res.ptr - index),
+                          perf.per_socket[i].ipc);
+        }
+        append_family(out, "sysmon_perf_socket_cache_miss_percent", "gauge", "Cache misses per cache reference, per socket.");
+        for (size_t i = 0; i < perf.per_socket.size(); ++i) {
+            if (!perf.per_socket[i].available) continue;
+            auto res = std::to_chars(index, index + sizeof(index), i);
+            append_sample(out, "sysmon_perf_socket_cache_miss_percent", "socket", std::string_view(index, res.ptr - index),
+                          perf.per_socket[i].cache_miss_percent);
+        }
+    }
+
+    const auto& mem = snapshot.memory;
+    if (mem.total_bytes > 0) {
+        append_family(out, "sysmon_memory_total_bytes", "gauge", "Physical memory.");
+        append_sample(out, "sysmon_memory_total_bytes", mem.total_bytes);
+        append_family(out, "sysmon_memory_used_bytes", "gauge", "Memory in use.");
+        append_sample(out, "sysmon_memory_used_bytes", mem.used_bytes);
+        append_family(out, "sysmon_memory_available_bytes", "gauge", "Memory available for new allocations.");
+        append_sample(out, "sysmon_memory_available_bytes", mem.available_bytes);
+        append_family(out, "sysmon_memory_usage_percent", "gauge", "Memory usage.");
+        append_sample(out, "sysmon_memory_usage_percent", mem.usage_percent);
+        append_family(out, "sysmon_swap_total_bytes", "gauge", "Swap space.");
+        append_sample(out, "sysmon_swap_total_bytes", mem.swap_total_bytes);
+        append_family(out, "sysmon_swap_used_bytes", "gauge", "Swap in use.");
+        append_sample(out, "sysmon_swap_used_bytes", mem.swap_used_bytes);
+    }
+
+    const auto& numa = mem.numa;
+    if (numa.available) {
+        char node[16];
+        auto per_node = [&](std::string_view name, const char* help, auto field) {
+            append_family(out, name, "gauge", help);
+            for (const auto& metrics : numa.nodes) {
+                auto res = std::to_chars(node, node + sizeof(node), metrics.node);
+                append_sample(out, name, "node", std::string_view(node, res.ptr - node), metrics.*field);
+            }
+        };
+        per_node("sysmon_numa_memory_total_bytes", "Memory on the NUMA node.", &NumaNodeMetrics::total_bytes);
+        per_node("sysmon_numa_memory_available_bytes", "Free and reclaimable memory on the NUMA node.",
+                 &NumaNodeMetrics::available_bytes);
+        per_node("sysmon_numa_memory_usage_percent", "Memory usage of the NUMA node.", &NumaNodeMetrics::usage_percent);
+        per_node("sysmon_numa_cpu_usage_percent", "Mean usage of the NUMA node's logical processors.",
+                 &NumaNodeMetrics::cpu_usage);
+        per_node("sysmon_numa_local_allocations_per_second", "Pages allocated on the node by tasks on it.",
+                 &NumaNodeMetrics::local_allocs_per_sec);
+        per_node("sysmon_numa_remote_allocations_per_second", "Pages allocated on the node by tasks on other nodes.",
+                 &NumaNodeMetrics::remote_allocs_per_sec);
+        per_node("sysmon_numa_miss_allocations_per_second", "Pages meant for the node that were allocated elsewhere.",
+                 &NumaNodeMetrics::miss_allocs_per_sec);
+    }
+
+    if (!snapshot.disks.empty()) {
+        append_family(out, "sysmon_disk_total_bytes", "gauge", "Filesystem size.");
+        for (const auto& disk : snapshot.disks) {
+            append_sample(out, "sysmon_disk_total_bytes", "mount", disk.mount_point, disk.total_bytes);
+        }
+        append_family(out, "sysmon_disk_used_bytes", "gauge", "Filesystem space in use.");
+        for (const auto& disk : snapshot.disks) {
+            append_sample(out, "sysmon_disk_used_bytes", "mount", disk.mount_point, disk.used_bytes);
+        }
+        append_family(out, "sysmon_disk_usage_percent", "gauge", "Filesystem usage.");
+        for (const auto& disk : snapshot.disks) {
+            append_sample(out, "sysmon_disk_usage_percent", "mount", disk.mount_point, disk.usage_percent);
+        }
+        append_family(out, "sysmon_disk_seconds_to_full", "gauge", "Projected time until the filesystem is full.");
+        for (const auto& disk : snapshot.disks) {
+            if (disk.seconds_to_full >= 0.0) {
+                append_sample(out, "sysmon_disk_seconds_to_full", "mount", disk.mount_point, disk.seconds_to_full);
+            }
+        }
+    }
+
+    if (!snapshot.network.empty()) {
+        append_family(out, "sysmon_network_receive_bytes", "counter", "Bytes received.");
+        for (const auto& net : snapshot.network) {
+            append_sample(out, "sysmon_network_receive_bytes_total", "interface", net.interface_name, net.bytes_received);
+        }
+        append_family(out, "sysmon_network_transmit_bytes", "counter", "Bytes sent.");
+        for (const auto& net : snapshot.network) {
+            append_sample(out, "sysmon_network_transmit_bytes_total", "interface", net.interface_name, net.bytes_sent);
+        }
+        append_family(out, "sysmon_network_receive_mbps", "gauge", "Download rate in megabits per second.");
+        for (const auto& net : snapshot.network) {
+            append_sample(out, "sysmon_network_receive_mbps", "interface", net.interface_name, net.download_mbps);
+        }
+        append_family(out, "sysmon_network_transmit_mbps", "gauge", "Upload rate in megabits per second.");
+        for (const auto& net : snapshot.network) {
+            append_sample(out, "sysmon_network_transmit_mbps", "interface", net.interface_name, net.upload_mbps);
+        }
+    }
+
+    if (sketches) {
+        append_family(out, "sysmon_series_window", "summary", "Percentiles of each series over the quantiles window.");
+        sketches->for_each_window([&](const std::string& name, const QuantileSketch& window) {
+            if (window.count() == 0) {
+                return;
+            }
+            for (auto [q, label] : {std::pair{0.5, "0.5"}, std::pair{0.95, "0.95"}, std::pair{0.99, "0.99"}}) {
+                out += "sysmon_series_window{series=\"";
+                append_label_value(out, name);
+                out += "\",quantile=\"";
+                out += label;
+                out += "\"} ";
+                append_number(out, window.quantile(q));
+                out += '\n';
+            }
+            append_sample(out, "sysmon_series_window_count", "series", name, window.count());
+            append_sample(out, "sysmon_series_window_sum", "series", name, window.sum());
+        });
+    }
+
+    uint64_t warnings = 0;
+    uint64_t criticals = 0;
+    for (const auto& alert : alerts) {
+        if (alert.level == AlertLevel::Critical) {
+            ++criticals;
+        } else if (alert.level == AlertLevel::Warning) {
+            ++warnings;
+        }
+    }
+    append_family(out, "sysmon_alerts_active", "gauge", "Alerts raised in the latest update.");
+    append_sample(out, "sysmon_alerts_active", "level", "warning", warnings);
+    append_sample(out, "sysmon_alerts_active", "level", "critical", criticals);
+
+    if (self) {
+        append_family(out, "sysmon_self_stage_seconds", "summary", "Time sysmon spends in each stage of a tick.");
+        for (size_t i = 0; i < static_cast<size_t>(Stage::Count); ++i) {
+            auto stage = static_cast<Stage>(i);
+            auto stats = self->stage(stage);
+            if (stats.calls == 0) {
+                continue;
+            }
+            for (auto [ms, label] : {std::pair{stats.p50_ms, "0.5"}, std::pair{stats.p99_ms, "0.99"}}) {
+                out += "sysmon_self_stage_seconds{stage=\"";
+                out += stage_name(stage);
+                out += "\",quantile=\"";
+                out += label;
+                out += "\"} ";
+                append_number(out, ms / 1000.0);
+                out += '\n';
+            }
+            append_sample(out, "sysmon_self_stage_seconds_count", "stage", stage_name(stage), stats.calls);
+            append_sample(out, "sysmon_self_stage_seconds_sum", "stage", stage_name(stage), stats.total_seconds);
+        }
+        append_family(out, "sysmon_self_cpu_seconds", "counter", "CPU time used by sysmon.");
+        append_sample(out, "sysmon_self_cpu_seconds_total", self->cpu_seconds());
+        append_family(out, "sysmon_self_resident_bytes", "gauge", "Resident set size of sysmon.");
+        append_sample(out, "sysmon_self_resident_bytes", self->resident_bytes());
+        append_family(out, "sysmon_self_allocations", "counter", "Heap allocations made by the sampling thread.");
+        append_sample(out, "sysmon_self_allocations_total", self->allocations());
+        append_family(out, "sysmon_self_missed_deadlines", "counter", "Ticks that took longer than the update interval.");
+        append_sample(out, "sysmon_self_missed_deadlines_total", self->missed_deadlines());
+        append_family(out, "sysmon_self_alert_log_dropped", "counter", "Alerts the log writer dropped on a full queue.");
+        append_sample(out, "sysmon_self_alert_log_dropped_total", self->log_dropped());
+    }
+
+    out += "# EOF\n";
+}
+
+#ifdef __linux__
+
+namespace {
+
+constexpr size_t kRequestBuffer = 4096;
+
+constexpr std::string_view kNotFound =
+    "HTTP/1.1 404 Not Found\r\nContent-Type: text/plain\r\nContent-Length: 10\r\n\r\nNot found\n";
+constexpr std::string_view kBadMethod =
+    "HTTP/1.1 405 Method Not Allowed\r\nAllow: GET, HEAD\r\nContent-Length: 0\r\n\r\n";
+constexpr std::string_view kBadRequest =
+    "HTTP/1.1 400 Bad Request\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+constexpr std::string_view kUnavailable =
+    "HTTP/1.1 503 Service Unavailable\r\nRetry-After: 1\r\nContent-Length: 0\r\n\r\n";
+
+bool iequals(std::string_view a, std::string_view b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+} // namespace
+
+struct MetricsExporter::Connection {
+    int fd = -1;
+    char in[kRequestBuffer];
+    size_t in_len = 0;
+
+    // Response in flight: header then body (body may be empty)
+    std::shared_ptr<const Page> page;
+    std::string_view out_head;
+    std::string_view out_body;
+    size_t sent = 0;
+    bool writing = false;
+    bool close_after = false;
+};
+
+MetricsExporter::MetricsExporter(const ExporterConfig& config)
+    : config_(config)
+{
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        std::cerr << "Warning: exporter socket failed: " << std::strerror(errno) << "\n";
+        return;
+    }
+
+    int one = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(config_.port));
+    if (::inet_pton(AF_INET, config_.listen_address.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "Warning: exporter listen_address is not an IPv4 address: " << config_.listen_address << "\n";
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return;
+    }
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(listen_fd_, SOMAXCONN) < 0) {
+        std::cerr << "Warning: exporter cannot listen on " << config_.listen_address << ":" << config_.port
+                  << ": " << std::strerror(errno) << "\n";
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return;
+    }
+    socklen_t len = sizeof(addr);
+    ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || wake_fd_ < 0) {
+        std::cerr << "Warning: exporter epoll setup failed: " << std::strerror(errno) << "\n";
+        return;
+    }
+
+    // Connection slots are allocated once; data.u64 is the slot index, with
+    // the two top values reserved for the listening socket and the wake fd
+    connections_.resize(static_cast<size_t>(config_.max_connections));
+    for (size_t i = connections_.size(); i-- > 0;) {
+        free_connections_.push_back(i);
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = UINT64_MAX;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev);
+    ev.data.u64 = UINT64_MAX - 1;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+
+    server_ = std::thread(&MetricsExporter::server_loop, this);
+}
+
+MetricsExporter::~MetricsExporter() {
+    if (server_.joinable()) {
+        uint64_t one = 1;
+        [[maybe_unused]] auto n = ::write(wake_fd_, &one, sizeof(one));
+        server_.join();
+    }
+    for (auto& conn : connections_) {
+        if (conn.fd >= 0) {
+            ::close(conn.fd);
+        }
+    }
+    if (wake_fd_ >= 0) ::close(wake_fd_);
+    if (epoll_fd_ >= 0) ::close(epoll_fd_);
+    if (listen_fd_ >= 0) ::close(listen_fd_);
+}
+
+void MetricsExporter::publish(const MetricSnapshot& snapshot, const std::vector<Alert>& alerts,
+                              const SeriesSketches* sketches, const SelfStats* self) {
+    if (!is_running()) {
+        return;
+    }
+
+    std::shared_ptr<Page> page = spare_ ? std::move(spare_) : std::make_shared<Page>();
+    page->body.clear();
+    render_openmetrics(page->body, snapshot, alerts, sketches, self);
+
+    page->header.clear();
+    page->header += "HTTP/1.1 200 OK\r\nContent-Type: ";
+    page->header += kContentType;
+    page->header += "\r\nContent-Length: ";
+    append_number(page->header, static_cast<uint64_t>(page->body.size()));
+    page->header += "\r\n\r\n";
+
+    std::shared_ptr<Page> previous;
+    {
+        std::lock_guard<std::mutex> lock(page_mutex_);
+        previous = std::move(page_);
+        page_ = std::move(page);
+    }
+    // Reuse the old buffers unless a slow client is still sending them
+    if (previous && previous.use_count() == 1) {
+        spare_ = std::move(previous);
+    }
+}
+
+void MetricsExporter::server_loop() {
+    epoll_event events[64];
+    for (;;) {
+        int n = ::epoll_wait(epoll_fd_, events, 64, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Warning: exporter epoll_wait failed: " << std::strerror(errno) << "\n";
+            return;
+        }
+        for (int i = 0; i < n; ++i) {
+            uint64_t id = events[i].data.u64;
+            if (id == UINT64_MAX - 1) {
+                return;
+            }
+            if (id == UINT64_MAX) {
+                accept_clients();
+                continue;
+            }
+            Connection& conn = connections_[id];
+            if (conn.fd < 0) {
+                continue;
+            }
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                close_connection(conn);
+                continue;
+            }
+            if (conn.writing && (events[i].events & EPOLLOUT)) {
+                if (!flush_response(conn) || (!conn.writing && !process_requests(conn))) {
+                    close_connection(conn);
+                    continue;
+                }
+            }
+            if (events[i].events & EPOLLIN) {
+                handle_readable(conn);
+            }
+        }
+    }
+}
+
+void MetricsExporter::accept_clients() {
+    for (;;) {
+        int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        if (free_connections_.empty()) {
+            [[maybe_unused]] auto n = ::send(fd, kUnavailable.data(), kUnavailable.size(), MSG_NOSIGNAL);
+            ::close(fd);
+            continue;
+        }
+        size_t slot = free_connections_.back();
+        free_connections_.pop_back();
+
+        Connection& conn = connections_[slot];
+        conn.fd = fd;
+        conn.in_len = 0;
+        conn.writing = false;
+        conn.close_after = false;
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = slot;
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+void MetricsExporter::handle_readable(Connection& conn) {
+    if (conn.writing) {
+        // Pipelined data waits until the current response is out
+        return;
+    }
+    ssize_t n = ::recv(conn.fd, conn.in + conn.in_len, sizeof(conn.in) - conn.in_len, 0);
+    if (n <= 0) {
+        if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+            return;
+        }
+        close_connection(conn);
+        return;
+    }
+    conn.in_len += static_cast<size_t>(n);
+    if (!process_requests(conn)) {
+        close_connection(conn);
+    }
+}
+
+// Answer every complete request in the input buffer; false closes the connection
+bool MetricsExporter::process_requests(Connection& conn) {
+    while (!conn.writing) {
+        std::string_view buffered(conn.in, conn.in_len);
+        size_t end = buffered.find("\r\n\r\n");
+        if (end == std::string_view::npos) {
+            if (conn.in_len == sizeof(conn.in)) {
+                conn.out_head = kBadRequest;
+                conn.out_body = {};
+                conn.close_after = true;
+                conn.in_len = 0;
+                conn.sent = 0;
+                return flush_response(conn);
+            }
+            return !conn.close_after;
+        }
+        std::string_view request = buffered.substr(0, end);
+        size_t consumed = end + 4;
+
+        // Request line
+        size_t line_end = request.find("\r\n");
+        std::string_view line = request.substr(0, line_end);
+        size_t sp1 = line.find(' ');
+        size_t sp2 = sp1 == std::string_view::npos ? sp1 : line.find(' ', sp1 + 1);
+        if (sp2 == std::string_view::npos) {
+            conn.out_head = kBadRequest;
+            conn.out_body = {};
+            conn.close_after = true;
+        } else {
+            std::string_view method = line.substr(0, sp1);
+            std::string_view target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+            std::string_view version = line.substr(sp2 + 1);
+            target = target.substr(0, target.find('?'));
+
+            // HTTP/1.1 keeps the connection open unless told otherwise
+            conn.close_after = version != "HTTP/1.1";
+            std::string_view headers = line_end == std::string_view::npos ? std::string_view{}
+                                                                           : request.substr(line_end + 2);
+            while (!headers.empty()) {
+                size_t eol = headers.find("\r\n");
+                std::string_view header = headers.substr(0, eol);
+                headers = eol == std::string_view::npos ? std::string_view{} : headers.substr(eol + 2);
+                size_t colon = header.find(':');
+                if (colon != std::string_view::npos && iequals(trim(header.substr(0, colon)), "connection")) {
+                    std::string_view value = trim(header.substr(colon + 1));
+                    if (iequals(value, "close")) {
+                        conn.close_after = true;
+                    } else if (iequals(value, "keep-alive")) {
+                        conn.close_after = false;
+                    }
+                }
+            }
+
+            bool head = method == "HEAD";
+            if (method != "GET" && !head) {
+                conn.out_head = kBadMethod;
+                conn.out_body = {};
+            } else if (target != config_.path) {
+                conn.out_head = kNotFound;
+                conn.out_body = {};
+            } else {
+                {
+                    std::lock_guard<std::mutex> lock(page_mutex_);
+                    conn.page = page_;
+                }
+                if (!conn.page) {
+                    conn.out_head = kUnavailable;
+                    conn.out_body = {};
+                } else {
+                    conn.out_head = conn.page->header;
+                    conn.out_body = head ? std::string_view{} : std::string_view(conn.page->body);
+                    scrapes_.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        std::memmove(conn.in, conn.in + consumed, conn.in_len - consumed);
+        conn.in_len -= consumed;
+        conn.sent = 0;
+        if (!flush_response(conn)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Write as much of the pending response as the socket takes; false closes
+bool MetricsExporter::flush_response(Connection& conn) {
+    size_t total = conn.out_head.size() + conn.out_body.size();
+    while (conn.sent < total) {
+        iovec iov[2];
+        int count = 0;
+        if (conn.sent < conn.out_head.size()) {
+            iov[count++] = {const_cast<char*>(conn.out_head.data() + conn.sent), conn.out_head.size() - conn.sent};
+            if (!conn.out_body.empty()) {
+                iov[count++] = {const_cast<char*>(conn.out_body.data()), conn.out_body.size()};
+            }
+        } else {
+            size_t offset = conn.sent - conn.out_head.size();
+            iov[count++] = {const_cast<char*>(conn.out_body.data() + offset), conn.out_body.size() - offset};
+        }
+
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = static_cast<size_t>(count);
+        ssize_t n = ::sendmsg(conn.fd, &msg, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN) {
+                if (!conn.writing) {
+                    conn.writing = true;
+                    epoll_event ev{};
+                    // Pipelined requests wait in the socket until the
+                    // response drains; EPOLLIN here would fire nonstop
+                    ev.events = EPOLLOUT;
+                    ev.data.u64 = static_cast<uint64_t>(&conn - connections_.data());
+                    ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn.fd, &ev);
+                }
+                return true;
+            }
+            return false;
+        }
+        conn.sent += static_cast<size_t>(n);
+    }
+
+    // Response complete: drop the page reference so it can be reused
+    conn.page.reset();
+    conn.out_head = {};
+    conn.out_body = {};
+    if (conn.writing) {
+        conn.writing = false;
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = static_cast<uint64_t>(&conn - connections_.data());
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn.fd, &ev);
+    }
+    return !conn.close_after;
+}
+
+void MetricsExporter::close_connection(Connection& conn) {
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn.fd, nullptr);
+    ::close(conn.fd);
+    conn.fd = -1;
+    conn.page.reset();
+    conn.in_len = 0;
+    conn.writing = false;
+    free_connections_.push_back(static_cast<size_t>(&conn - connections_.data()));
+}
+
+#else
+
+struct MetricsExporter::Connection {};
+
+MetricsExporter::MetricsExporter(const ExporterConfig& config)
+    : config_(config)
+{
+    std::cerr << "Warning: the metrics exporter is only available on Linux\n";
+}
+
+MetricsExporter::~MetricsExporter() = default;
+
+void MetricsExporter::publish(const MetricSnapshot&, const std::vector<Alert>&, const SeriesSketches*, const SelfStats*) {}
+
+#endif
+
+} // namespace sysmon
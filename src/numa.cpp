@@ -0,0 +1,111 @@
+#include "sysmon/numa.hpp"
+#include <algorithm>
+#include <charconv>
+
+namespace sysmon {
+
+namespace {
+
+// Value of "key value" or "Node N key: value kB" lines, split on whitespace
+template<typename Fn>
+void for_each_field(std::string_view text, Fn&& fn) {
+    while (!text.empty()) {
+        size_t eol = text.find('\n');
+        std::string_view line = text.substr(0, eol);
+        text = eol == std::string_view::npos ? std::string_view{} : text.substr(eol + 1);
+
+        if (line.starts_with("Node ")) {
+            size_t space = line.find(' ', 5);
+            line = space == std::string_view::npos ? std::string_view{} : line.substr(space + 1);
+        }
+        size_t key_end = line.find_first_of(" :");
+        if (key_end == std::string_view::npos || key_end == 0) {
+            continue;
+        }
+        size_t value_begin = line.find_first_not_of(" :", key_end);
+        if (value_begin == std::string_view::npos) {
+            continue;
+        }
+        uint64_t value = 0;
+        if (std::from_chars(line.data() + value_begin, line.data() + line.size(), value).ec == std::errc{}) {
+            fn(line.substr(0, key_end), value);
+        }
+    }
+}
+
+double rate(uint64_t before, uint64_t after, double seconds) {
+    return after > before ? static_cast<double>(after - before) / seconds : 0.0;
+}
+
+} // namespace
+
+bool parse_node_meminfo(std::string_view text, NumaNodeMetrics& node) {
+    bool found = false;
+    uint64_t free = 0;
+    uint64_t reclaimable = 0;
+    for_each_field(text, [&](std::string_view key, uint64_t kb) {
+        uint64_t bytes = kb * 1024;
+        if (key == "MemTotal") {
+            node.total_bytes = bytes;
+            found = true;
+        } else if (key == "MemFree") {
+            free = bytes;
+        } else if (key == "Active(file)" || key == "Inactive(file)" || key == "SReclaimable") {
+            reclaimable += bytes;
+        }
+    });
+    node.available_bytes = std::min(node.total_bytes, free + reclaimable);
+    node.used_bytes = node.total_bytes - node.available_bytes;
+    node.usage_percent = node.total_bytes > 0 ? 100.0 * node.used_bytes / node.total_bytes : 0.0;
+    return found;
+}
+
+NumaCounts parse_numastat(std::string_view text) {
+    NumaCounts counts;
+    for_each_field(text, [&](std::string_view key, uint64_t value) {
+        if (key == "local_node") {
+            counts.local = value;
+        } else if (key == "other_node") {
+            counts.remote = value;
+        } else if (key == "numa_miss") {
+            counts.miss = value;
+        }
+    });
+    return counts;
+}
+
+void numa_rates(NumaNodeMetrics& node, const NumaCounts& before, const NumaCounts& after, double seconds) {
+    if (seconds <= 0.0) {
+        return;
+    }
+    node.local_allocs_per_sec = rate(before.local, after.local, seconds);
+    node.remote_allocs_per_sec = rate(before.remote, after.remote, seconds);
+    node.miss_allocs_per_sec = rate(before.miss, after.miss, seconds);
+    double allocs = node.local_allocs_per_sec + node.remote_allocs_per_sec;
+    node.remote_percent = allocs > 0.0 ? 100.0 * node.remote_allocs_per_sec / allocs : 0.0;
+}
+
+void numa_cpu_usage(NumaMetrics& numa, const std::vector<double>& per_core_usage,
+                    const std::vector<int>& online_cpus) {
+    for (auto& node : numa.nodes) {
+        double sum = 0.0;
+        size_t count = 0;
+        for (int cpu : node.cpus) {
+            size_t index = static_cast<size_t>(cpu);
+            if (!online_cpus.empty()) {
+                auto it = std::lower_bound(online_cpus.begin(), online_cpus.end(), cpu);
+                if (it == online_cpus.end() || *it != cpu) {
+                    continue;   // offline
+                }
+                index = static_cast<size_t>(it - online_cpus.begin());
+            }
+            if (cpu >= 0 && index < per_core_usage.size()) {
+                sum += per_core_usage[index];
+                ++count;
+            }
+        }
+        node.cpu_usage = count > 0 ? sum / count : 0.0;
+    }
+}
+
+} // namespace sysmon
@@ -0,0 +1,283 @@
+#include "sysmon/perf_events.hpp"
+#include "sysmon/trace.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace sysmon {
+
+PerfCounters perf_rates(const PerfCounts& before, const PerfCounts& after, double seconds) {
+    PerfCounters rates;
+    if (seconds <= 0.0) {
+        return rates;
+    }
+    auto rate = [&](PerfEvent event) {
+        size_t i = static_cast<size_t>(event);
+        return after[i] > before[i] ? static_cast<double>(after[i] - before[i]) / seconds : 0.0;
+    };
+    rates.cycles = rate(PerfEvent::Cycles);
+    rates.instructions = rate(PerfEvent::Instructions);
+    rates.cache_references = rate(PerfEvent::CacheReferences);
+    rates.cache_misses = rate(PerfEvent::CacheMisses);
+    rates.context_switches = rate(PerfEvent::ContextSwitches);
+    rates.cpu_migrations = rate(PerfEvent::CpuMigrations);
+    rates.page_faults = rate(PerfEvent::PageFaults);
+    add_perf_rates(rates, {});
+    return rates;
+}
+
+bool perf_interval(const PerfReading& before, const PerfReading& after, PerfCounts& out) {
+    out.fill(0);
+    if (after.running <= before.running) {
+        return false;
+    }
+    uint64_t running = after.running - before.running;
+    uint64_t enabled = after.enabled > before.enabled ? after.enabled - before.enabled : running;
+    double scale = running < enabled ? static_cast<double>(enabled) / running : 1.0;
+    for (size_t i = 0; i < out.size(); ++i) {
+        if (after.values[i] > before.values[i]) {
+            out[i] = static_cast<uint64_t>(static_cast<double>(after.values[i] - before.values[i]) * scale);
+        }
+    }
+    return true;
+}
+
+void add_perf_rates(PerfCounters& sum, const PerfCounters& part) {
+    sum.available = true;
+    sum.cycles += part.cycles;
+    sum.instructions += part.instructions;
+    sum.cache_references += part.cache_references;
+    sum.cache_misses += part.cache_misses;
+    sum.context_switches += part.context_switches;
+    sum.cpu_migrations += part.cpu_migrations;
+    sum.page_faults += part.page_faults;
+    sum.ipc = sum.cycles > 0.0 ? sum.instructions / sum.cycles : 0.0;
+    sum.cache_miss_percent = sum.cache_references > 0.0 ? 100.0 * sum.cache_misses / sum.cache_references : 0.0;
+}
+
+std::vector<int> parse_cpu_list(std::string_view list) {
+    std::vector<int> cpus;
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        std::string_view range = list.substr(0, comma);
+        list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+
+        while (!range.empty() && (range.front() == ' ' || range.front() == '\n')) {
+            range.remove_prefix(1);
+        }
+        while (!range.empty() && (range.back() == ' ' || range.back() == '\n')) {
+            range.remove_suffix(1);
+        }
+        int first = 0;
+        auto res = std::from_chars(range.data(), range.data() + range.size(), first);
+        if (res.ec != std::errc{}) {
+            continue;
+        }
+        int last = first;
+        if (res.ptr < range.data() + range.size() && *res.ptr == '-') {
+            if (std::from_chars(res.ptr + 1, range.data() + range.size(), last).ec != std::errc{}) {
+                continue;
+            }
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+#ifdef __linux__
+
+namespace {
+
+struct EventSpec {
+    uint32_t type;
+    uint64_t config;
+};
+
+EventSpec event_spec(PerfEvent event) {
+    switch (event) {
+        case PerfEvent::Cycles: return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES};
+        case PerfEvent::Instructions: return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS};
+        case PerfEvent::CacheReferences: return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES};
+        case PerfEvent::CacheMisses: return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES};
+        case PerfEvent::ContextSwitches: return {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES};
+        case PerfEvent::CpuMigrations: return {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS};
+        case PerfEvent::PageFaults: return {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS};
+        case PerfEvent::Count: break;
+    }
+    return {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_CLOCK};
+}
+
+int open_event(EventSpec spec, int cpu, int group_fd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = spec.type;
+    attr.config = spec.config;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+                       PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.disabled = group_fd == -1;     // the leader starts the group
+    attr.exclude_hv = 1;
+    return static_cast<int>(::syscall(SYS_perf_event_open, &attr, -1, cpu, group_fd, PERF_FLAG_FD_CLOEXEC));
+}
+
+} // namespace
+
+PerfEventGroups::PerfEventGroups(const std::vector<int>& cpus, const std::vector<int>& packages) {
+    std::vector<int> ids(packages.begin(), packages.begin() + std::min(packages.size(), cpus.size()));
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    std::vector<int> sockets(cpus.size(), 0);
+    for (size_t i = 0; i < cpus.size() && i < packages.size(); ++i) {
+        sockets[i] = static_cast<int>(std::lower_bound(ids.begin(), ids.end(), packages[i]) - ids.begin());
+    }
+    sockets_ = std::max<int>(1, static_cast<int>(ids.size()));
+
+    // Hardware groups on every CPU or none: a partial set is closed again
+    hardware_ = open_all(cpus, sockets, true);
+    if (!hardware_) {
+        close_all();
+        open_all(cpus, sockets, false);
+    }
+    buffer_.resize(3 + 2 * (kPerfEventCount + 1));
+    SYSMON_TRACE(Info, "perf counters open on {} cpus, hardware {}", groups_.size(), hardware_);
+}
+
+PerfEventGroups::~PerfEventGroups() {
+    close_all();
+}
+
+// False as soon as a group fails to open; software groups carry on past
+// CPUs that refuse them, unless none opens at all
+bool PerfEventGroups::open_all(const std::vector<int>& cpus, const std::vector<int>& sockets, bool hardware) {
+    for (size_t i = 0; i < cpus.size(); ++i) {
+        Group group;
+        group.cpu = cpus[i];
+        group.package = sockets[i];
+        if (!open_group(group, hardware)) {
+            if (hardware) {
+                SYSMON_TRACE(Info, "no PMU on cpu {}: errno {}, counting software events only", group.cpu, errno);
+                return false;
+            }
+            if (groups_.empty()) {
+                std::cerr << "Warning: cannot open perf counters on cpu " << group.cpu << ": " << std::strerror(errno)
+                          << " (needs CAP_PERFMON or kernel.perf_event_paranoid <= 0)\n";
+                return false;
+            }
+            continue;
+        }
+        groups_.push_back(std::move(group));
+    }
+    return !groups_.empty();
+}
+
+void PerfEventGroups::close_all() {
+    for (auto& group : groups_) {
+        for (int fd : group.fds) {
+            ::close(fd);
+        }
+    }
+    groups_.clear();
+}
+
+bool PerfEventGroups::open_group(Group& group, bool hardware) {
+    int leader = open_event(hardware ? event_spec(PerfEvent::Cycles) : event_spec(PerfEvent::Count), group.cpu, -1);
+    if (leader < 0) {
+        return false;
+    }
+    group.fds.push_back(leader);
+    group.ids.fill(0);
+    for (size_t i = 0; i < kPerfEventCount; ++i) {
+        EventSpec spec = event_spec(static_cast<PerfEvent>(i));
+        int fd = leader;
+        if (hardware && i == static_cast<size_t>(PerfEvent::Cycles)) {
+            // The leader itself
+        } else if (spec.type == PERF_TYPE_HARDWARE && !hardware) {
+            continue;
+        } else if ((fd = open_event(spec, group.cpu, leader)) < 0) {
+            SYSMON_TRACE(Debug, "perf event {} unavailable on cpu {}: errno {}", i, group.cpu, errno);
+            continue;
+        } else {
+            group.fds.push_back(fd);
+        }
+        uint64_t id = 0;
+        if (::ioctl(fd, PERF_EVENT_IOC_ID, &id) == 0) {
+            group.ids[i] = id;
+        }
+    }
+    ::ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ::ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+PerfMetrics PerfEventGroups::read() {
+    PerfMetrics metrics;
+    if (groups_.empty()) {
+        return metrics;
+    }
+    metrics.available = true;
+    metrics.hardware = hardware_;
+    metrics.per_cpu.reserve(groups_.size());
+    metrics.per_socket.resize(static_cast<size_t>(sockets_));
+
+    auto now = std::chrono::steady_clock::now();
+    double seconds = primed_ ? std::chrono::duration<double>(now - last_read_).count() : 0.0;
+    metrics.total.available = false;
+    for (auto& socket : metrics.per_socket) {
+        socket.available = false;
+    }
+    for (auto& group : groups_) {
+        // { nr, time_enabled, time_running, { value, id } * nr }
+        ssize_t n = ::read(group.fds.front(), buffer_.data(), buffer_.size() * sizeof(uint64_t));
+        PerfReading reading = group.last;
+        if (n >= static_cast<ssize_t>(3 * sizeof(uint64_t))) {
+            uint64_t nr = std::min<uint64_t>(buffer_[0], (static_cast<size_t>(n) / sizeof(uint64_t) - 3) / 2);
+            reading.enabled = buffer_[1];
+            reading.running = buffer_[2];
+            for (uint64_t k = 0; k < nr; ++k) {
+                uint64_t value = buffer_[3 + 2 * k];
+                uint64_t id = buffer_[4 + 2 * k];
+                for (size_t i = 0; i < kPerfEventCount; ++i) {
+                    if (group.ids[i] == id && id != 0) {
+                        reading.values[i] = value;
+                    }
+                }
+            }
+        }
+        PerfCounts counts;
+        PerfCounters rates;
+        if (perf_interval(group.last, reading, counts)) {
+            rates = perf_rates(PerfCounts{}, counts, seconds);
+            add_perf_rates(metrics.total, rates);
+            add_perf_rates(metrics.per_socket[static_cast<size_t>(group.package)], rates);
+        } else {
+            rates.available = false;
+        }
+        group.last = reading;
+        metrics.per_cpu.push_back(rates);
+    }
+    last_read_ = now;
+    primed_ = true;
+    return metrics;
+}
+
+#else
+
+PerfEventGroups::PerfEventGroups(const std::vector<int>&, const std::vector<int>&) {}
+PerfEventGroups::~PerfEventGroups() = default;
+bool PerfEventGroups::open_group(Group&, bool) { return false; }
+PerfMetrics PerfEventGroups::read() { return {}; }
+
+#endif
+
+} // namespace sysmon
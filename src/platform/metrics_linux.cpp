@@ -1,34 +1,44 @@
 #include "sysmon/metrics_collector.hpp"
 #include "sysmon/config_manager.hpp"
+#include "sysmon/cpu_topology.hpp"
+#include "sysmon/interrupts.hpp"
+#include "sysmon/numa.hpp"
+#include "sysmon/perf_events.hpp"
+#include "sysmon/trace.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <utility>
+#include <fcntl.h>
 #include <sys/statvfs.h>
 #include <unistd.h>
 
 namespace sysmon {
 
-// Initialize static member
-bool DebugLogger::enabled_ = false;
-
 class LinuxMetricsCollector : public MetricsCollector {
 public:
-    LinuxMetricsCollector() {
-        core_count_ = sysconf(_SC_NPROCESSORS_ONLN);
-        // Get initial CPU stats
-        read_cpu_stats(prev_total_, prev_idle_);
+    explicit LinuxMetricsCollector(const std::string& fs_root)
+        : root_(fs_root == "/" ? "" : fs_root)
+    {
+        // Get initial CPU stats (and the online cores listed with them)
+        read_cpu_stats(prev_times_, prev_sched_);
+        core_count_ = prev_times_.size() > 1 ? static_cast<uint32_t>(prev_times_.size() - 1)
+                                             : static_cast<uint32_t>(sysconf(_SC_NPROCESSORS_ONLN));
+        read_topology();
         
         // Get hardware model names (cache them)
         cpu_model_ = get_cpu_model();
         memory_model_ = get_memory_model();
     }
     
-    void set_config(const SysMonConfig* config) override {
-        config_ = config;
-        if (config_) {
-            DebugLogger::set_enabled(config_->debug_logging);
-        }
+    void set_config(ConfigSnapshot config) override {
+        config_ = std::move(config);
     }
     
     CpuMetrics collect_cpu() override {
@@ -36,40 +46,33 @@ public:
         metrics.core_count = core_count_;
         metrics.model_name = cpu_model_;
         
-        // Read current stats
-        unsigned long long total, idle;
-        read_cpu_stats(total, idle);
-        
-        // Calculate usage
-        unsigned long long total_diff = total - prev_total_;
-        unsigned long long idle_diff = idle - prev_idle_;
-        
-        if (total_diff > 0) {
-            metrics.overall_usage = 100.0 * (1.0 - static_cast<double>(idle_diff) / total_diff);
+        // Read current stats; usage is the share of non-idle time since the last call
+        read_cpu_stats(times_, sched_);
+        if (!times_.empty() && !prev_times_.empty()) {
+            metrics.scheduler = scheduler_metrics(times_[0].total - prev_times_[0].total);
         }
-        
-        prev_total_ = total;
-        prev_idle_ = idle;
-        
-        // Read per-core stats
-        std::ifstream stat_file("/proc/stat");
-        std::string line;
-        std::getline(stat_file, line); // Skip first line (total)
-        
-        while (std::getline(stat_file, line)) {
-            if (line.substr(0, 3) != "cpu") break;
-            
-            std::istringstream iss(line);
-            std::string cpu;
-            unsigned long long user, nice, system, idle, iowait, irq, softirq, steal;
-            iss >> cpu >> user >> nice >> system >> idle >> iowait >> irq >> softirq >> steal;
-            
-            unsigned long long total_time = user + nice + system + idle + iowait + irq + softirq + steal;
-            unsigned long long idle_time = idle + iowait;
-            
-            double usage = 100.0 * (1.0 - static_cast<double>(idle_time) / total_time);
-            metrics.per_core_usage.push_back(usage);
+        prev_sched_ = sched_;
+        for (size_t i = 0; i < times_.size(); ++i) {
+            const CpuTimes& cur = times_[i];
+            CpuTimes prev = i < prev_times_.size() ? prev_times_[i] : CpuTimes{};
+            double usage = 0.0;
+            double iowait = 0.0;
+            if (cur.total > prev.total && cur.idle >= prev.idle) {
+                double total_diff = static_cast<double>(cur.total - prev.total);
+                usage = 100.0 * (1.0 - static_cast<double>(cur.idle - prev.idle) / total_diff);
+                if (cur.iowait >= prev.iowait) {
+                    iowait = 100.0 * static_cast<double>(cur.iowait - prev.iowait) / total_diff;
+                }
+            }
+            if (i == 0) {
+                metrics.overall_usage = usage;
+                metrics.iowait_percent = iowait;
+            } else {
+                metrics.per_core_usage.push_back(usage);
+            }
         }
+        std::swap(prev_times_, times_);
+        topology_.aggregate(metrics.per_core_usage, metrics.topology);
         
         return metrics;
     }
@@ -78,7 +81,7 @@ public:
         MemoryMetrics metrics;
         metrics.model_name = memory_model_;
         
-        std::ifstream meminfo("/proc/meminfo");
+        std::ifstream meminfo(path("/proc/meminfo"));
         std::string line;
         
         while (std::getline(meminfo, line)) {
@@ -121,12 +124,14 @@ public:
             disk.model_name = get_disk_model(mount_point);
             
             struct statvfs stat;
-            if (statvfs(mount_point.c_str(), &stat) == 0) {
+            if (statvfs(path(mount_point).c_str(), &stat) == 0) {
                 disk.total_bytes = stat.f_blocks * stat.f_frsize;
                 disk.used_bytes = (stat.f_blocks - stat.f_bfree) * stat.f_frsize;
                 if (disk.total_bytes > 0) {
                     disk.usage_percent = static_cast<double>(disk.used_bytes) / disk.total_bytes * 100.0;
                 }
+            } else {
+                SYSMON_TRACE(Debug, "statvfs {} failed: errno {}", mount_point, errno);
             }
             
             metrics.push_back(disk);
@@ -137,7 +142,7 @@ public:
     
     std::vector<NetworkMetrics> collect_network(const std::vector<std::string>& interfaces) override {
         std::vector<NetworkMetrics> network_metrics;
-        std::ifstream net_file("/proc/net/dev");
+        std::ifstream net_file(path("/proc/net/dev"));
         std::string line;
         
         // Skip header lines
@@ -158,8 +163,9 @@ public:
             if (if_name == "lo") continue;
             
             // Parse statistics
+            uint64_t skip;
             iss >> rx_bytes >> rx_packets >> rx_errs >> rx_drop;
-            iss.ignore(256, ' '); // Skip remaining RX fields
+            iss >> skip >> skip >> skip >> skip; // fifo frame compressed multicast
             iss >> tx_bytes >> tx_packets >> tx_errs >> tx_drop;
             
             // Filter by requested interfaces if specified
@@ -186,24 +192,235 @@ public:
         return network_metrics;
     }
     
+    InterruptMetrics collect_interrupts() override {
+        auto now = std::chrono::steady_clock::now();
+        if (parse_interrupt_matrix(read_file(path("/proc/interrupts"), file_buffer_), irq_counts_) == 0) {
+            return {};
+        }
+        parse_interrupt_matrix(read_file(path("/proc/softirqs"), file_buffer_), softirq_counts_);
+        double seconds = irq_read_ ? std::chrono::duration<double>(now - last_irq_read_).count() : 0.0;
+        InterruptMetrics metrics = interrupt_rates(prev_irq_counts_, irq_counts_, prev_softirq_counts_, softirq_counts_, seconds);
+        std::swap(prev_irq_counts_, irq_counts_);
+        std::swap(prev_softirq_counts_, softirq_counts_);
+        last_irq_read_ = now;
+        irq_read_ = true;
+        return metrics;
+    }
+    
+    const std::vector<int>& online_cpus() const override {
+        return online_cpus_;
+    }
+    
+    NumaMetrics collect_numa() override {
+        if (!numa_probed_) {
+            probe_numa_nodes();
+        }
+        NumaMetrics metrics;
+        auto now = std::chrono::steady_clock::now();
+        double seconds = numa_read_ ? std::chrono::duration<double>(now - last_numa_read_).count() : 0.0;
+        for (auto& known : numa_nodes_) {
+            NumaNodeMetrics node;
+            node.node = known.id;
+            node.cpus = known.cpus;
+            std::string dir = "/sys/devices/system/node/node" + std::to_string(known.id);
+            if (!parse_node_meminfo(read_file(path(dir + "/meminfo"), file_buffer_), node)) {
+                continue;
+            }
+            NumaCounts counts = parse_numastat(read_file(path(dir + "/numastat"), file_buffer_));
+            numa_rates(node, known.last, counts, seconds);
+            known.last = counts;
+            metrics.nodes.push_back(std::move(node));
+        }
+        metrics.available = !metrics.nodes.empty();
+        last_numa_read_ = now;
+        numa_read_ = true;
+        return metrics;
+    }
+    
+    PerfMetrics collect_perf() override {
+        if (!config_ || !config_->perf.enabled) {
+            perf_.reset();
+            return {};
+        }
+        if (!perf_) {
+            perf_ = open_perf_groups();
+        }
+        return perf_->read();
+    }
+    
 private:
-    void read_cpu_stats(unsigned long long& total, unsigned long long& idle) {
-        std::ifstream stat_file("/proc/stat");
+    // Paths below the configured root (fs_root); mount points too, since
+    // they are named as the monitored system sees them
+    std::string path(const std::string& absolute) const {
+        return root_ + absolute;
+    }
+    
+    struct CpuTimes {
+        unsigned long long total = 0;
+        unsigned long long idle = 0;        // idle + iowait
+        unsigned long long iowait = 0;
+    };
+    
+    // The /proc/stat lines after the cpu lines
+    struct SchedCounters {
+        unsigned long long context_switches = 0;
+        unsigned long long interrupts = 0;
+        unsigned long long softirqs = 0;
+        unsigned long long forks = 0;
+        unsigned long long running = 0;
+        unsigned long long blocked = 0;
+    };
+    
+    // The aggregate "cpu" line first, then one entry per online core; the
+    // same pass picks up the scheduler counters that follow them
+    void read_cpu_stats(std::vector<CpuTimes>& out, SchedCounters& sched) {
+        out.clear();
+        std::ifstream stat_file(path("/proc/stat"));
         std::string line;
-        std::getline(stat_file, line);
         
-        std::istringstream iss(line);
-        std::string cpu;
-        unsigned long long user, nice, system, idle_val, iowait, irq, softirq, steal;
-        iss >> cpu >> user >> nice >> system >> idle_val >> iowait >> irq >> softirq >> steal;
+        while (std::getline(stat_file, line)) {
+            if (line.compare(0, 3, "cpu") != 0) {
+                for (const auto& [key, counter] : kSchedFields) {
+                    if (stat_field(line, key, sched.*counter)) {
+                        break;
+                    }
+                }
+                continue;
+            }
+            std::istringstream iss(line);
+            std::string cpu;
+            unsigned long long user = 0, nice = 0, system = 0, idle = 0, iowait = 0, irq = 0, softirq = 0, steal = 0;
+            iss >> cpu >> user >> nice >> system >> idle >> iowait >> irq >> softirq >> steal;
+            
+            out.push_back({user + nice + system + idle + iowait + irq + softirq + steal, idle + iowait, iowait});
+        }
+        SYSMON_TRACE(Debug, "read {} cpu lines from {}", out.size(), root_.empty() ? "/proc/stat" : root_);
+    }
+    
+    // Only the totals of intr and softirq, whose lines go on per source
+    static constexpr std::pair<std::string_view, unsigned long long SchedCounters::*> kSchedFields[] = {
+        {"intr", &SchedCounters::interrupts},
+        {"ctxt", &SchedCounters::context_switches},
+        {"processes", &SchedCounters::forks},
+        {"procs_running", &SchedCounters::running},
+        {"procs_blocked", &SchedCounters::blocked},
+        {"softirq", &SchedCounters::softirqs},
+    };
+    
+    // "key value ..."
+    static bool stat_field(const std::string& line, std::string_view key, unsigned long long& value) {
+        if (line.size() <= key.size() || line.compare(0, key.size(), key) != 0 || line[key.size()] != ' ') {
+            return false;
+        }
+        std::from_chars(line.data() + key.size() + 1, line.data() + line.size(), value);
+        return true;
+    }
+    
+    // Rates over the jiffies that passed on every core since the last read,
+    // which is the tick's length as the kernel counted it
+    SchedulerMetrics scheduler_metrics(unsigned long long total_jiffies) {
+        SchedulerMetrics metrics;
+        metrics.available = true;
+        metrics.procs_running = static_cast<uint32_t>(sched_.running);
+        metrics.procs_blocked = static_cast<uint32_t>(sched_.blocked);
+        if (core_count_ > 0 && sched_.running > 0) {
+            // Not counting sysmon, which is running while it reads
+            metrics.run_queue_per_core = static_cast<double>(sched_.running - 1) / core_count_;
+        }
+        double seconds = core_count_ > 0 ? static_cast<double>(total_jiffies) / core_count_ / clock_ticks_ : 0.0;
+        if (seconds > 0.0) {
+            auto rate = [&](unsigned long long SchedCounters::*counter) {
+                return sched_.*counter >= prev_sched_.*counter
+                    ? static_cast<double>(sched_.*counter - prev_sched_.*counter) / seconds : 0.0;
+            };
+            metrics.context_switches_per_sec = rate(&SchedCounters::context_switches);
+            metrics.interrupts_per_sec = rate(&SchedCounters::interrupts);
+            metrics.softirqs_per_sec = rate(&SchedCounters::softirqs);
+            metrics.forks_per_sec = rate(&SchedCounters::forks);
+        }
         
-        total = user + nice + system + idle_val + iowait + irq + softirq + steal;
-        idle = idle_val + iowait;
+        // "0.52 0.58 0.59 2/1234 56789"
+        std::ifstream loadavg(path("/proc/loadavg"));
+        std::string entities;
+        loadavg >> metrics.load1 >> metrics.load5 >> metrics.load15 >> entities;
+        size_t slash = entities.find('/');
+        if (slash != std::string::npos) {
+            std::from_chars(entities.data() + slash + 1, entities.data() + entities.size(), metrics.threads);
+        }
+        return metrics;
+    }
+    
+    // The whole file with one open and a few reads, into a buffer kept
+    // between calls; /proc/interrupts runs to hundreds of KB on big hosts
+    static std::string_view read_file(const std::string& file, std::string& buffer) {
+        int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return {};
+        }
+        size_t length = 0;
+        for (;;) {
+            if (length == buffer.size()) {
+                buffer.resize(std::max<size_t>(buffer.size() * 2, 16384));
+            }
+            ssize_t n = ::read(fd, buffer.data() + length, buffer.size() - length);
+            if (n <= 0) {
+                break;
+            }
+            length += static_cast<size_t>(n);
+        }
+        ::close(fd);
+        return std::string_view(buffer.data(), length);
+    }
+    
+    // Nodes with memory and the CPUs on each; neither changes short of hotplug
+    void probe_numa_nodes() {
+        numa_probed_ = true;
+        std::string online;
+        std::ifstream(path("/sys/devices/system/node/has_memory")) >> online;
+        if (online.empty()) {
+            std::ifstream(path("/sys/devices/system/node/online")) >> online;
+        }
+        for (int id : parse_cpu_list(online)) {
+            std::string cpus;
+            std::ifstream(path("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist")) >> cpus;
+            numa_nodes_.push_back({id, parse_cpu_list(cpus), {}});
+        }
+    }
+    
+    // A group on every online CPU, which are numbered as in /proc/stat
+    std::unique_ptr<PerfEventGroups> open_perf_groups() {
+        return std::make_unique<PerfEventGroups>(online_cpus_, package_ids_);
+    }
+    
+    // Online CPUs, which /proc/stat lists in the same order, and the package
+    // and core of each. Without sysfs every CPU is its own core
+    void read_topology() {
+        std::string online;
+        std::ifstream(path("/sys/devices/system/cpu/online")) >> online;
+        online_cpus_ = parse_cpu_list(online);
+        if (online_cpus_.empty()) {
+            for (uint32_t i = 0; i < core_count_; ++i) {
+                online_cpus_.push_back(static_cast<int>(i));
+            }
+        }
+        std::vector<int> core_ids;
+        for (int cpu : online_cpus_) {
+            std::string dir = path("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/");
+            int package = -1;
+            int core = -1;
+            std::ifstream(dir + "physical_package_id") >> package;
+            std::ifstream(dir + "core_id") >> core;
+            package_ids_.push_back(std::max(0, package));
+            core_ids.push_back(core < 0 ? cpu : core);
+        }
+        topology_ = CpuTopology(package_ids_, core_ids);
+        SYSMON_TRACE(Info, "cpu topology: {} packages, {} cores, {} threads",
+                     topology_.packages(), topology_.cores(), topology_.threads());
     }
     
     // Helper function to get CPU model from /proc/cpuinfo
     std::string get_cpu_model() {
-        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::ifstream cpuinfo(path("/proc/cpuinfo"));
         std::string line;
         
         while (std::getline(cpuinfo, line)) {
@@ -228,13 +445,13 @@ private:
     std::string get_memory_model() {
         // Try to get memory information from dmidecode (requires root/sudo)
         // For non-root users, we'll provide a generic description
-        std::ifstream dmidecode_check("/sys/firmware/dmi/tables/DMI");
+        std::ifstream dmidecode_check(path("/sys/firmware/dmi/tables/DMI"));
         if (!dmidecode_check.good()) {
             return "System Memory";
         }
         
         // Try reading DMI information from sysfs
-        std::ifstream dmi_type("/sys/firmware/dmi/entries/17-0/raw");
+        std::ifstream dmi_type(path("/sys/firmware/dmi/entries/17-0/raw"));
         if (dmi_type.good()) {
             // DMI type 17 is Memory Device, but parsing raw DMI is complex
             // For simplicity, return a generic name
@@ -247,7 +464,7 @@ private:
     // Helper function to get disk model for a mount point
     std::string get_disk_model(const std::string& mount_point) {
         // Find the device for this mount point
-        std::ifstream mounts("/proc/mounts");
+        std::ifstream mounts(path("/proc/mounts"));
         std::string line;
         std::string device;
         
@@ -274,7 +491,7 @@ private:
         }
         
         // Try to read model from /sys/block/*/device/model
-        std::string model_path = "/sys/block/" + base_device + "/device/model";
+        std::string model_path = path("/sys/block/" + base_device + "/device/model");
         std::ifstream model_file(model_path);
         if (model_file.good()) {
             std::string model;
@@ -293,7 +510,7 @@ private:
     // Helper function to get network adapter model
     std::string get_network_model(const std::string& interface_name) {
         // Try to read from /sys/class/net/<interface>/device/modalias or uevent
-        std::string device_path = "/sys/class/net/" + interface_name + "/device/uevent";
+        std::string device_path = path("/sys/class/net/" + interface_name + "/device/uevent");
         std::ifstream uevent_file(device_path);
         
         if (uevent_file.good()) {
@@ -316,16 +533,40 @@ private:
         return interface_name + " Adapter";
     }
     
+    std::string root_;
     uint32_t core_count_;
-    unsigned long long prev_total_ = 0;
-    unsigned long long prev_idle_ = 0;
+    std::vector<CpuTimes> prev_times_;
+    std::vector<CpuTimes> times_;
+    SchedCounters prev_sched_;
+    SchedCounters sched_;
+    double clock_ticks_ = static_cast<double>(sysconf(_SC_CLK_TCK));
     std::string cpu_model_;
     std::string memory_model_;
-    const SysMonConfig* config_ = nullptr;
+    ConfigSnapshot config_;
+    std::unique_ptr<PerfEventGroups> perf_;
+    std::vector<int> online_cpus_;
+    std::vector<int> package_ids_;
+    CpuTopology topology_;
+    std::string file_buffer_;
+    InterruptCounts irq_counts_;
+    InterruptCounts prev_irq_counts_;
+    InterruptCounts softirq_counts_;
+    InterruptCounts prev_softirq_counts_;
+    std::chrono::steady_clock::time_point last_irq_read_;
+    bool irq_read_ = false;
+    struct NumaNode {
+        int id = 0;
+        std::vector<int> cpus;
+        NumaCounts last;
+    };
+    std::vector<NumaNode> numa_nodes_;
+    bool numa_probed_ = false;
+    std::chrono::steady_clock::time_point last_numa_read_;
+    bool numa_read_ = false;
 };
 
-std::unique_ptr<MetricsCollector> create_linux_metrics_collector() {
-    return std::make_unique<LinuxMetricsCollector>();
+std::unique_ptr<MetricsCollector> create_linux_metrics_collector(const std::string& fs_root) {
+    return std::make_unique<LinuxMetricsCollector>(fs_root);
 }
 
 } // namespace sysmon
@@ -13,6 +13,7 @@
 
 #include "sysmon/metrics_collector.hpp"
 #include "sysmon/config_manager.hpp"
+#include "sysmon/trace.hpp"
 
 #include <windows.h>
 #include <psapi.h>
@@ -35,8 +36,6 @@
 
 namespace sysmon {
 
-bool DebugLogger::enabled_ = false;
-
 class WMIHelper {
 public:
     WMIHelper() {
@@ -107,17 +106,17 @@ public:
     std::vector<std::string> query_multiple_properties(const wchar_t* wql_query, 
         const std::vector<const wchar_t*>& properties) {
         std::vector<std::string> results;
-        DebugLogger::log("WMIHelper::query_multiple_properties] Starting query");
+        SYSMON_TRACE(Debug, "WMIHelper::query_multiple_properties] Starting query");
         if (!services_) {
-            DebugLogger::log("WMIHelper::query_multiple_properties] services_ is NULL!");
+            SYSMON_TRACE(Debug, "WMIHelper::query_multiple_properties] services_ is NULL!");
             return results;
         }
         IEnumWbemClassObject* enumerator = nullptr;
         HRESULT hr = services_->ExecQuery(bstr_t("WQL"), bstr_t(wql_query),
             WBEM_FLAG_FORWARD_ONLY | WBEM_FLAG_RETURN_IMMEDIATELY, nullptr, &enumerator);
-        DebugLogger::log("WMIHelper::query_multiple_properties] ExecQuery HRESULT: 0x", std::hex, hr, std::dec);
+        SYSMON_TRACE(Debug, "WMIHelper::query_multiple_properties] ExecQuery HRESULT: 0x{x}", static_cast<uint32_t>(hr));
         if (FAILED(hr) || !enumerator) {
-            DebugLogger::log("WMIHelper::query_multiple_properties] Query failed or enumerator is NULL");
+            SYSMON_TRACE(Debug, "WMIHelper::query_multiple_properties] Query failed or enumerator is NULL");
             return results;
         }
         IWbemClassObject* obj = nullptr;
@@ -125,48 +124,48 @@ public:
         int object_count = 0;
         while (enumerator->Next(WBEM_INFINITE, 1, &obj, &returned) == WBEM_S_NO_ERROR) {
             object_count++;
-            DebugLogger::log("WMIHelper::query_multiple_properties] Processing object ", object_count);
+            SYSMON_TRACE(Debug, "WMIHelper::query_multiple_properties] Processing object {}", object_count);
             for (const auto& prop : properties) {
                 VARIANT vtProp;
                 VariantInit(&vtProp);
                 hr = obj->Get(prop, 0, &vtProp, 0, 0);
                 std::string prop_name = prop ? std::string((const char*)_bstr_t(prop)) : "(null)";
-                DebugLogger::log("WMIHelper::query_multiple_properties] Property '", prop_name, "' Get HRESULT: 0x", std::hex, hr, std::dec, ", VT type: ", vtProp.vt);
+                SYSMON_TRACE(Debug, "WMIHelper::query_multiple_properties] Property '{}' Get HRESULT: 0x{x}, VT type: {}", prop_name, static_cast<uint32_t>(hr), vtProp.vt);
 
                 switch (vtProp.vt) {
                     case VT_BSTR:
                         if (vtProp.bstrVal) {
                             _bstr_t bstr(vtProp.bstrVal);
                             std::string value = (const char*)bstr;
-                            DebugLogger::log("WMIHelper::query_multiple_properties] VT_BSTR value: '", value, "'");
+                            SYSMON_TRACE(Debug, "WMIHelper::query_multiple_properties] VT_BSTR value: '{}'", value);
                             results.push_back(value);
                         } else {
-                            DebugLogger::log("WMIHelper::query_multiple_properties] VT_BSTR but value is NULL");
+                            SYSMON_TRACE(Debug, "WMIHelper::query_multiple_properties] VT_BSTR but value is NULL");
                             results.push_back("");
                         }
                         break;
                     case VT_NULL:
-                        DebugLogger::log("WMIHelper::query_multiple_properties] VT_NULL");
+                        SYSMON_TRACE(Debug, "WMIHelper::query_multiple_properties] VT_NULL");
                         results.push_back("");
                         break;
                     case VT_I4:
-                        DebugLogger::log("WMIHelper::query_multiple_properties] VT_I4 value: ", vtProp.lVal);
+                        SYSMON_TRACE(Debug, "WMIHelper::query_multiple_properties] VT_I4 value: {}", vtProp.lVal);
                         results.push_back(std::to_string(vtProp.lVal));
                         break;
                     case VT_UI4:
-                        DebugLogger::log("WMIHelper::query_multiple_properties] VT_UI4 value: ", vtProp.ulVal);
+                        SYSMON_TRACE(Debug, "WMIHelper::query_multiple_properties] VT_UI4 value: {}", vtProp.ulVal);
                         results.push_back(std::to_string(vtProp.ulVal));
                         break;
                     case VT_I8:
-                        DebugLogger::log("WMIHelper::query_multiple_properties] VT_I8 value: ", vtProp.llVal);
+                        SYSMON_TRACE(Debug, "WMIHelper::query_multiple_properties] VT_I8 value: {}", vtProp.llVal);
                         results.push_back(std::to_string(vtProp.llVal));
                         break;
                     case VT_UI8:
-                        DebugLogger::log("WMIHelper::query_multiple_properties] VT_UI8 value: ", vtProp.ullVal);
+                        SYSMON_TRACE(Debug, "WMIHelper::query_multiple_properties] VT_UI8 value: {}", vtProp.ullVal);
                         results.push_back(std::to_string(vtProp.ullVal));
                         break;
                     default:
-                        DebugLogger::log("WMIHelper::query_multiple_properties] Unhandled VT type: ", vtProp.vt);
+                        SYSMON_TRACE(Debug, "WMIHelper::query_multiple_properties] Unhandled VT type: {}", vtProp.vt);
                         results.push_back("");
                         break;
                 }
@@ -174,7 +173,7 @@ public:
             }
             obj->Release();
         }
-        DebugLogger::log("WMIHelper::query_multiple_properties] Total objects (modules) found: ", object_count);
+        SYSMON_TRACE(Debug, "WMIHelper::query_multiple_properties] Total objects (modules) found: {}", object_count);
         enumerator->Release();
         return results;
     }
@@ -221,11 +220,8 @@ public:
         }
     }
     
-    void set_config(const SysMonConfig* config) override {
-        config_ = config;
-        if (config_) {
-            DebugLogger::set_enabled(config_->debug_logging);
-        }
+    void set_config(ConfigSnapshot config) override {
+        config_ = std::move(config);
     }
     
     CpuMetrics collect_cpu() override {
@@ -373,7 +369,7 @@ private:
     std::string cpu_model_;
     std::string memory_model_;
     std::unique_ptr<WMIHelper> wmi_;
-    const SysMonConfig* config_ = nullptr;
+    ConfigSnapshot config_;
     
     // Helper function to get CPU model using WMI (more reliable than registry)
     std::string get_cpu_model() {
@@ -414,17 +410,17 @@ private:
     // Helper function to get memory manufacturer/model using WMI
     std::string get_memory_model() {
         if (!wmi_) {
-            DebugLogger::log("WMI not initialized for memory query");
+            SYSMON_TRACE(Debug, "WMI not initialized for memory query");
             return "System Memory";
         }
-        DebugLogger::log("Querying WMI for memory information...");
+        SYSMON_TRACE(Debug, "Querying WMI for memory information...");
         
         // First try traditional manufacturer/part number properties
         std::vector<const wchar_t*> props = {L"Manufacturer", L"PartNumber", L"BankLabel", L"SerialNumber"};
         auto results = wmi_->query_multiple_properties(
             L"SELECT Manufacturer, PartNumber, BankLabel, SerialNumber FROM Win32_PhysicalMemory",
             props);
-        DebugLogger::log("WMI query returned ", results.size(), " results");
+        SYSMON_TRACE(Debug, "WMI query returned {} results", results.size());
         
         // Try to build a model string from available info
         std::string manufacturer, part_number;
@@ -446,16 +442,16 @@ private:
         
         if (!manufacturer.empty() && !part_number.empty()) {
             std::string result = manufacturer + " " + part_number;
-            DebugLogger::log("Returning: '", result, "'");
+            SYSMON_TRACE(Debug, "Returning: '{}'", result);
             return result;
         } else if (!manufacturer.empty()) {
             std::string result = manufacturer + " RAM";
-            DebugLogger::log("Returning (manufacturer only): '", result, "'");
+            SYSMON_TRACE(Debug, "Returning (manufacturer only): '{}'", result);
             return result;
         }
         
         // If manufacturer/part number are empty, try fallback properties that usually have data
-        DebugLogger::log("Manufacturer/PartNumber empty, trying fallback properties");
+        SYSMON_TRACE(Debug, "Manufacturer/PartNumber empty, trying fallback properties");
         std::vector<const wchar_t*> fallback_props = {L"Caption", L"Capacity", L"Speed", L"Tag"};
         auto fallback_results = wmi_->query_multiple_properties(
             L"SELECT Caption, Capacity, Speed, Tag FROM Win32_PhysicalMemory",
@@ -472,24 +468,24 @@ private:
             trim(speed);
             trim(tag);
             
-            DebugLogger::log("Fallback - Caption: '", caption, "'");
-            DebugLogger::log("Fallback - Capacity: '", capacity, "'"); 
-            DebugLogger::log("Fallback - Speed: '", speed, "'");
-            DebugLogger::log("Fallback - Tag: '", tag, "'");
+            SYSMON_TRACE(Debug, "Fallback - Caption: '{}'", caption);
+            SYSMON_TRACE(Debug, "Fallback - Capacity: '{}'", capacity); 
+            SYSMON_TRACE(Debug, "Fallback - Speed: '{}'", speed);
+            SYSMON_TRACE(Debug, "Fallback - Tag: '{}'", tag);
             
             // Try to create a meaningful name from available data
             if (!speed.empty() && speed != "0") {
                 std::string result = "DDR Memory " + speed + "MHz";
-                DebugLogger::log("Returning (fallback speed): '", result, "'");
+                SYSMON_TRACE(Debug, "Returning (fallback speed): '{}'", result);
                 return result;
             } else if (!caption.empty() && caption != "Physical Memory") {
                 std::string result = caption;
-                DebugLogger::log("Returning (fallback caption): '", result, "'");
+                SYSMON_TRACE(Debug, "Returning (fallback caption): '{}'", result);
                 return result;
             }
         }
         
-        DebugLogger::log("Falling back to 'System Memory'");
+        SYSMON_TRACE(Debug, "Falling back to 'System Memory'");
         return "System Memory";
     }
     
@@ -0,0 +1,377 @@
+#include "sysmon/push_sink.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace sysmon {
+
+namespace {
+
+// Keep UDP messages inside a single datagram
+constexpr size_t kMaxUdpBatch = 60000;
+constexpr size_t kMaxTcpBatch = 4u << 20;
+constexpr int kConnectTimeoutMs = 2000;
+constexpr int kSendTimeoutSec = 5;
+constexpr std::chrono::milliseconds kMaxRetryDelay{30000};
+
+} // namespace
+
+#ifdef __linux__
+
+PushSink::PushSink(const PushConfig& config)
+    : config_(config)
+    , batch_interval_(config.batch_interval_ms)
+    , max_batch_bytes_(config.transport == "udp" ? kMaxUdpBatch : kMaxTcpBatch)
+    , spool_limit_(static_cast<uint64_t>(config.spool_max_mb) << 20)
+    , queue_(static_cast<size_t>(config.queue_size))
+{
+    parse_wire_format(config_.format, format_);
+    parse_codec(config_.compression, codec_);
+    if (!codec_available(codec_)) {
+        std::cerr << "Warning: push compression '" << config_.compression
+                  << "' is not available in this build, sending uncompressed\n";
+        codec_ = Codec::None;
+    }
+    udp_ = config_.transport == "udp";
+
+    host_ = config_.host;
+    if (host_.empty()) {
+        char name[256] = {};
+        if (::gethostname(name, sizeof(name) - 1) == 0) {
+            host_ = name;
+        }
+    }
+
+    // Messages spooled by a previous run are replayed first
+    std::error_code ec;
+    auto size = std::filesystem::file_size(config_.spool_path, ec);
+    spool_bytes_.store(ec ? 0 : size);
+
+    raw_.reserve(64 * 1024);
+    io_thread_ = std::thread(&PushSink::io_loop, this);
+}
+
+PushSink::~PushSink() {
+    stopping_.store(true);
+    wake_.notify_one();
+    if (io_thread_.joinable()) {
+        io_thread_.join();
+    }
+    disconnect();
+}
+
+bool PushSink::submit(const MetricSnapshot& snapshot) {
+    if (!queue_.try_push(snapshot)) {
+        dropped_samples_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    if (queue_.size_approx() >= queue_.capacity() / 2) {
+        wake_.notify_one();
+    }
+    return true;
+}
+
+void PushSink::io_loop() {
+    while (!stopping_.load()) {
+        auto timeout = batch_interval_;
+        if (batch_frames_ > 0) {
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - batch_start_);
+            timeout = std::max(std::chrono::milliseconds(0), batch_interval_ - elapsed);
+        }
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_.wait_for(lock, timeout, [this] {
+                return stopping_.load() || queue_.size_approx() >= queue_.capacity() / 2;
+            });
+        }
+
+        drain();
+
+        if (batch_frames_ > 0 && std::chrono::steady_clock::now() - batch_start_ >= batch_interval_) {
+            flush_batch();
+        }
+    }
+
+    // Final batch on shutdown; spooled if the receiver is down
+    drain();
+    if (batch_frames_ > 0) {
+        flush_batch();
+    }
+}
+
+void PushSink::drain() {
+    MetricSnapshot snapshot;
+    while (queue_.try_pop(snapshot)) {
+        if (batch_frames_ == 0) {
+            batch_start_ = std::chrono::steady_clock::now();
+            if (format_ == WireFormat::Binary) {
+                encoder_.begin(raw_, host_);
+            }
+        }
+        if (format_ == WireFormat::Binary) {
+            encoder_.append(raw_, snapshot);
+        } else {
+            append_line_protocol(raw_, host_, snapshot);
+        }
+        ++batch_frames_;
+
+        if (raw_.size() >= max_batch_bytes_) {
+            flush_batch();
+        }
+    }
+    queue_.publish_head();
+}
+
+void PushSink::flush_batch() {
+    message_.clear();
+    if (encode_push_message(message_, format_, codec_, raw_)) {
+        deliver();
+    } else {
+        std::cerr << "Warning: push batch compression failed, batch dropped\n";
+        dropped_messages_.fetch_add(1, std::memory_order_relaxed);
+    }
+    raw_.clear();
+    batch_frames_ = 0;
+}
+
+// Keeps ordering: nothing new is sent while older messages are spooled
+void PushSink::deliver() {
+    if (spool_bytes_.load() > 0 && !replay_spool()) {
+        append_spool();
+        return;
+    }
+    if (send_message(message_.data(), message_.size())) {
+        sent_messages_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    append_spool();
+}
+
+// While the receiver is down, attempts back off from one batch interval
+// up to kMaxRetryDelay; batches in between go straight to the spool
+// instead of each waiting out a connect timeout
+bool PushSink::connect() {
+    auto now = std::chrono::steady_clock::now();
+    if (now < retry_at_) {
+        return false;
+    }
+    auto fail = [&] {
+        reachable_ = false;
+        retry_delay_ = std::min(kMaxRetryDelay, std::max(batch_interval_, retry_delay_ * 2));
+        retry_at_ = std::chrono::steady_clock::now() + retry_delay_;
+        return false;
+    };
+
+    std::string host = config_.endpoint.substr(0, config_.endpoint.rfind(':'));
+    std::string port = config_.endpoint.substr(config_.endpoint.rfind(':') + 1);
+    if (host.size() > 2 && host.front() == '[' && host.back() == ']') {
+        host = host.substr(1, host.size() - 2);
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = udp_ ? SOCK_DGRAM : SOCK_STREAM;
+    addrinfo* result = nullptr;
+    int rc = ::getaddrinfo(host.c_str(), port.c_str(), &hints, &result);
+    if (rc != 0) {
+        if (reachable_) {
+            std::cerr << "Warning: push endpoint " << config_.endpoint << " does not resolve: "
+                      << ::gai_strerror(rc) << "\n";
+        }
+        return fail();
+    }
+
+    int err = 0;
+    for (addrinfo* ai = result; ai && fd_ < 0; ai = ai->ai_next) {
+        int fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) {
+            err = errno;
+            continue;
+        }
+        if (::connect(fd, ai->ai_addr, ai->ai_addrlen) < 0) {
+            err = errno;
+            if (err == EINPROGRESS) {
+                pollfd pfd{fd, POLLOUT, 0};
+                socklen_t len = sizeof(err);
+                if (::poll(&pfd, 1, kConnectTimeoutMs) == 1 &&
+                    ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err == 0) {
+                    fd_ = fd;
+                    break;
+                }
+                if (err == EINPROGRESS) {
+                    err = ETIMEDOUT;
+                }
+            }
+            ::close(fd);
+            continue;
+        }
+        fd_ = fd;
+    }
+    ::freeaddrinfo(result);
+
+    if (fd_ < 0) {
+        if (reachable_) {
+            std::cerr << "Warning: push endpoint " << config_.endpoint << " unreachable ("
+                      << std::strerror(err) << "), spooling to " << config_.spool_path << "\n";
+        }
+        return fail();
+    }
+
+    // Blocking sends with a timeout from here on; this is the I/O thread
+    ::fcntl(fd_, F_SETFL, ::fcntl(fd_, F_GETFL) & ~O_NONBLOCK);
+    timeval tv{kSendTimeoutSec, 0};
+    ::setsockopt(fd_, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    reachable_ = true;
+    retry_delay_ = std::chrono::milliseconds(0);
+    return true;
+}
+
+void PushSink::disconnect() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool PushSink::send_message(const char* data, size_t size) {
+    if (fd_ >= 0 && !udp_) {
+        // The receiver never writes; a readable hangup means it went away
+        // and a send would only land in a dead socket buffer
+        pollfd pfd{fd_, POLLRDHUP, 0};
+        if (::poll(&pfd, 1, 0) == 1 && (pfd.revents & (POLLRDHUP | POLLHUP | POLLERR))) {
+            disconnect();
+        }
+    }
+    if (fd_ < 0 && !connect()) {
+        return false;
+    }
+    size_t sent = 0;
+    while (sent < size) {
+        ssize_t n = ::send(fd_, data + sent, size - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            // A partial TCP message cannot be resumed; the receiver drops it
+            // with the connection and the whole message is spooled
+            disconnect();
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool PushSink::replay_spool() {
+    std::FILE* in = std::fopen(config_.spool_path.c_str(), "rb");
+    if (!in) {
+        spool_bytes_.store(0);
+        return true;
+    }
+
+    std::string message;
+    long offset = 0;
+    bool delivered = true;
+    for (;;) {
+        char header[kPushHeaderSize];
+        size_t n = std::fread(header, 1, sizeof(header), in);
+        PushHeader parsed;
+        if (n == 0) {
+            break;
+        }
+        if (n < sizeof(header) || !parse_push_header(header, n, parsed)) {
+            std::cerr << "Warning: push spool " << config_.spool_path << " is corrupt, discarding the rest\n";
+            break;
+        }
+        message.assign(header, sizeof(header));
+        message.resize(sizeof(header) + parsed.payload_size);
+        if (std::fread(&message[sizeof(header)], 1, parsed.payload_size, in) != parsed.payload_size) {
+            break;  // torn final write
+        }
+        if (!send_message(message.data(), message.size())) {
+            delivered = false;
+            break;
+        }
+        sent_messages_.fetch_add(1, std::memory_order_relaxed);
+        offset += static_cast<long>(message.size());
+    }
+
+    if (delivered) {
+        std::fclose(in);
+        std::remove(config_.spool_path.c_str());
+        spool_bytes_.store(0);
+        return true;
+    }
+
+    if (offset > 0) {
+        // Keep only the undelivered tail
+        std::string tmp = config_.spool_path + ".tmp";
+        std::FILE* out = std::fopen(tmp.c_str(), "wb");
+        if (out) {
+            std::fseek(in, offset, SEEK_SET);
+            char chunk[64 * 1024];
+            size_t got;
+            while ((got = std::fread(chunk, 1, sizeof(chunk), in)) > 0) {
+                std::fwrite(chunk, 1, got, out);
+            }
+            std::fclose(out);
+        }
+        std::fclose(in);
+        std::error_code ec;
+        std::filesystem::rename(tmp, config_.spool_path, ec);
+        auto size = std::filesystem::file_size(config_.spool_path, ec);
+        spool_bytes_.store(ec ? 0 : size);
+        return false;
+    }
+    std::fclose(in);
+    return false;
+}
+
+void PushSink::append_spool() {
+    uint64_t spooled = spool_bytes_.load();
+    if (spooled + message_.size() > spool_limit_) {
+        dropped_messages_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    std::FILE* out = std::fopen(config_.spool_path.c_str(), "ab");
+    if (!out) {
+        dropped_messages_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    size_t written = std::fwrite(message_.data(), 1, message_.size(), out);
+    std::fclose(out);
+    spool_bytes_.store(spooled + written);
+}
+
+#else
+
+PushSink::PushSink(const PushConfig& config)
+    : config_(config)
+    , batch_interval_(config.batch_interval_ms)
+    , max_batch_bytes_(kMaxTcpBatch)
+    , spool_limit_(0)
+    , queue_(1)
+{
+    std::cerr << "Warning: push shipping is only available on Linux\n";
+}
+
+PushSink::~PushSink() = default;
+
+bool PushSink::submit(const MetricSnapshot&) { return false; }
+
+#endif
+
+} // namespace sysmon
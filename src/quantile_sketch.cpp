@@ -0,0 +1,220 @@
+#include "sysmon/quantile_sketch.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace sysmon {
+
+namespace {
+
+// Smallest value with its own bin; anything below counts as zero
+constexpr double kMinIndexable = 1e-9;
+
+} // namespace
+
+QuantileSketch::QuantileSketch(double relative_accuracy, size_t max_bins)
+    : relative_accuracy_(relative_accuracy)
+    , gamma_((1.0 + relative_accuracy) / (1.0 - relative_accuracy))
+    , log_gamma_(std::log(gamma_))
+    , max_bins_(std::max<size_t>(max_bins, 1))
+{
+}
+
+int QuantileSketch::key(double value) const {
+    return static_cast<int>(std::ceil(std::log(value) / log_gamma_));
+}
+
+// Midpoint of the bin, within relative_accuracy of every value in it
+double QuantileSketch::value(int key) const {
+    return 2.0 * std::pow(gamma_, key) / (gamma_ + 1.0);
+}
+
+// Index of the bin for key, growing (or collapsing) the bin range
+size_t QuantileSketch::slot(int key) {
+    if (bins_.empty()) {
+        offset_ = key;
+        bins_.assign(1, 0);
+        return 0;
+    }
+    if (key < offset_) {
+        if (static_cast<size_t>(offset_ - key) + bins_.size() > max_bins_) {
+            // Below the collapsed range: lands in the lowest bin
+            size_t room = max_bins_ - bins_.size();
+            bins_.insert(bins_.begin(), room, 0);
+            offset_ -= static_cast<int>(room);
+            return 0;
+        }
+        bins_.insert(bins_.begin(), static_cast<size_t>(offset_ - key), 0);
+        offset_ = key;
+        return 0;
+    }
+    size_t index = static_cast<size_t>(key - offset_);
+    if (index >= bins_.size()) {
+        bins_.resize(index + 1, 0);
+        if (bins_.size() > max_bins_) {
+            // Collapse the lowest bins into the first one kept
+            size_t excess = bins_.size() - max_bins_;
+            uint64_t collapsed = std::accumulate(bins_.begin(), bins_.begin() + excess + 1, uint64_t{0});
+            bins_.erase(bins_.begin(), bins_.begin() + excess);
+            bins_[0] = collapsed;
+            offset_ += static_cast<int>(excess);
+            index -= excess;
+        }
+    }
+    return index;
+}
+
+void QuantileSketch::add(double value, uint64_t count) {
+    if (count == 0 || std::isnan(value)) {
+        return;
+    }
+    value = std::max(value, 0.0);
+    if (count_ == 0) {
+        min_ = max_ = value;
+    } else {
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+    count_ += count;
+    sum_ += value * static_cast<double>(count);
+
+    if (value < kMinIndexable) {
+        zero_count_ += count;
+    } else {
+        bins_[slot(key(value))] += count;
+    }
+}
+
+bool QuantileSketch::merge(const QuantileSketch& other) {
+    if (other.relative_accuracy_ != relative_accuracy_) {
+        return false;
+    }
+    if (other.count_ == 0) {
+        return true;
+    }
+    if (count_ == 0) {
+        min_ = other.min_;
+        max_ = other.max_;
+    } else {
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    zero_count_ += other.zero_count_;
+
+    if (!other.bins_.empty()) {
+        // Size the range once from both ends, then add counts
+        slot(other.offset_ + static_cast<int>(other.bins_.size()) - 1);
+        slot(other.offset_);
+        for (size_t i = 0; i < other.bins_.size(); ++i) {
+            if (other.bins_[i]) {
+                int k = other.offset_ + static_cast<int>(i);
+                size_t index = k < offset_ ? 0 : static_cast<size_t>(k - offset_);
+                bins_[index] += other.bins_[i];
+            }
+        }
+    }
+    return true;
+}
+
+double QuantileSketch::quantile(double q) const {
+    if (count_ == 0) {
+        return 0.0;
+    }
+    q = std::clamp(q, 0.0, 1.0);
+    double rank = q * static_cast<double>(count_ - 1);
+
+    double seen = static_cast<double>(zero_count_);
+    if (rank < seen) {
+        return min_;
+    }
+    for (size_t i = 0; i < bins_.size(); ++i) {
+        seen += static_cast<double>(bins_[i]);
+        if (rank < seen) {
+            return std::clamp(value(offset_ + static_cast<int>(i)), min_, max_);
+        }
+    }
+    return max_;
+}
+
+void QuantileSketch::clear() {
+    bins_.clear();
+    offset_ = 0;
+    zero_count_ = 0;
+    count_ = 0;
+    sum_ = 0.0;
+    min_ = 0.0;
+    max_ = 0.0;
+}
+
+WindowedSketch::WindowedSketch(const QuantileConfig& config)
+    : slot_length_(std::chrono::seconds(config.window_seconds) / std::max(config.window_slots, 1))
+    , slots_(static_cast<size_t>(std::max(config.window_slots, 1)),
+             QuantileSketch(config.relative_accuracy, static_cast<size_t>(config.max_bins)))
+    , slot_epochs_(slots_.size(), -1)
+{
+    if (slot_length_.count() <= 0) {
+        slot_length_ = std::chrono::seconds(1);
+    }
+}
+
+int64_t WindowedSketch::epoch(Clock::time_point now) const {
+    return now.time_since_epoch() / slot_length_;
+}
+
+void WindowedSketch::add(double value, Clock::time_point now) {
+    int64_t e = epoch(now);
+    size_t i = static_cast<size_t>(e % static_cast<int64_t>(slots_.size()));
+    if (slot_epochs_[i] != e) {
+        slots_[i].clear();
+        slot_epochs_[i] = e;
+    }
+    slots_[i].add(value);
+}
+
+void WindowedSketch::merge_into(QuantileSketch& out, Clock::time_point now) const {
+    int64_t e = epoch(now);
+    int64_t span = static_cast<int64_t>(slots_.size());
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        if (slot_epochs_[i] >= 0 && slot_epochs_[i] <= e && e - slot_epochs_[i] < span) {
+            out.merge(slots_[i]);
+        }
+    }
+}
+
+SeriesSketches::SeriesSketches(const QuantileConfig& config)
+    : config_(config)
+{
+}
+
+void SeriesSketches::observe(const MetricSnapshot& snapshot, WindowedSketch::Clock::time_point now) {
+    last_observed_ = now;
+    for_each_series(snapshot, key_, [&](const std::string& name, double value) {
+        auto it = series_.find(name);
+        if (it == series_.end()) {
+            it = series_.emplace(name, WindowedSketch(config_)).first;
+        }
+        it->second.add(value, now);
+    });
+}
+
+bool SeriesSketches::window(std::string_view name, QuantileSketch& out) const {
+    auto it = series_.find(name);
+    if (it == series_.end()) {
+        return false;
+    }
+    it->second.merge_into(out, last_observed_);
+    return true;
+}
+
+std::vector<std::string> SeriesSketches::names() const {
+    std::vector<std::string> result;
+    result.reserve(series_.size());
+    for (const auto& item : series_) {
+        result.push_back(item.first);
+    }
+    return result;
+}
+
+} // namespace sysmon
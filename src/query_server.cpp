@@ -0,0 +1,783 @@
+#include "sysmon/query_server.hpp"
+#include "sysmon/alert_log_format.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace sysmon {
+
+namespace {
+
+template<typename T>
+void put(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+// Bounds-checked reader over a payload
+class Reader {
+public:
+    explicit Reader(std::string_view data) : p_(data.data()), end_(data.data() + data.size()) {}
+
+    template<typename T>
+    bool get(T& value) {
+        if (static_cast<size_t>(end_ - p_) < sizeof(T)) return false;
+        std::memcpy(&value, p_, sizeof(T));
+        p_ += sizeof(T);
+        return true;
+    }
+
+    bool get_string(size_t len, std::string& out) {
+        if (static_cast<size_t>(end_ - p_) < len) return false;
+        out.assign(p_, len);
+        p_ += len;
+        return true;
+    }
+
+    std::string_view rest() const { return std::string_view(p_, end_ - p_); }
+
+private:
+    const char* p_;
+    const char* end_;
+};
+
+void put_short_string(std::string& out, const std::string& text) {
+    size_t len = std::min<size_t>(text.size(), UINT8_MAX);
+    put<uint8_t>(out, static_cast<uint8_t>(len));
+    out.append(text.data(), len);
+}
+
+template<typename T>
+void append_number(std::string& out, T value) {
+    char buf[32];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr - buf);
+}
+
+void append_double(std::string& out, double value) {
+    if (!std::isfinite(value)) {
+        out.append("null");
+        return;
+    }
+    append_number(out, value);
+}
+
+int64_t to_ms(std::chrono::system_clock::time_point tp) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(tp.time_since_epoch()).count();
+}
+
+AlertLogEntry to_entry(const Alert& alert) {
+    AlertLogEntry entry;
+    entry.timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        alert.timestamp.time_since_epoch()).count();
+    entry.monotonic_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        alert.monotonic.time_since_epoch()).count();
+    entry.value = alert.value;
+    entry.threshold = alert.threshold;
+    entry.level = alert.level;
+    entry.category = alert.category;
+    entry.entity = alert.entity;
+    entry.message = alert.message;
+    return entry;
+}
+
+void append_error_json(std::string& out, const char* message) {
+    out.append("{\"error\":\"");
+    out.append(message);
+    out.append("\"}\n");
+}
+
+} // namespace
+
+void encode_snapshot(std::string& out, const MetricSnapshot& snapshot) {
+    put<int64_t>(out, to_ms(snapshot.wall_time));
+
+    const auto& cpu = snapshot.cpu;
+    put<double>(out, cpu.overall_usage);
+    put<double>(out, cpu.iowait_percent);
+    size_t cores = std::min<size_t>(cpu.per_core_usage.size(), UINT16_MAX);
+    put<uint16_t>(out, static_cast<uint16_t>(cores));
+    for (size_t i = 0; i < cores; ++i) {
+        put<double>(out, cpu.per_core_usage[i]);
+    }
+
+    const auto& mem = snapshot.memory;
+    put<uint64_t>(out, mem.total_bytes);
+    put<uint64_t>(out, mem.used_bytes);
+    put<uint64_t>(out, mem.available_bytes);
+    put<double>(out, mem.usage_percent);
+    put<uint64_t>(out, mem.swap_total_bytes);
+    put<uint64_t>(out, mem.swap_used_bytes);
+
+    size_t disks = std::min<size_t>(snapshot.disks.size(), UINT16_MAX);
+    put<uint16_t>(out, static_cast<uint16_t>(disks));
+    for (size_t i = 0; i < disks; ++i) {
+        const auto& disk = snapshot.disks[i];
+        put_short_string(out, disk.mount_point);
+        put<uint64_t>(out, disk.total_bytes);
+        put<uint64_t>(out, disk.used_bytes);
+        put<double>(out, disk.usage_percent);
+        put<double>(out, disk.seconds_to_full);
+    }
+
+    size_t nics = std::min<size_t>(snapshot.network.size(), UINT16_MAX);
+    put<uint16_t>(out, static_cast<uint16_t>(nics));
+    for (size_t i = 0; i < nics; ++i) {
+        const auto& net = snapshot.network[i];
+        put_short_string(out, net.interface_name);
+        put<uint64_t>(out, net.bytes_received);
+        put<uint64_t>(out, net.bytes_sent);
+        put<double>(out, net.download_mbps);
+        put<double>(out, net.upload_mbps);
+    }
+}
+
+bool decode_snapshot(std::string_view payload, MetricSnapshot& out) {
+    Reader in(payload);
+    int64_t ms;
+    if (!in.get(ms)) return false;
+    out.wall_time = std::chrono::system_clock::time_point(std::chrono::milliseconds(ms));
+
+    uint16_t count;
+    auto& cpu = out.cpu;
+    if (!in.get(cpu.overall_usage) || !in.get(cpu.iowait_percent) || !in.get(count)) return false;
+    cpu.per_core_usage.resize(count);
+    cpu.core_count = count;
+    for (auto& usage : cpu.per_core_usage) {
+        if (!in.get(usage)) return false;
+    }
+
+    auto& mem = out.memory;
+    if (!in.get(mem.total_bytes) || !in.get(mem.used_bytes) || !in.get(mem.available_bytes) ||
+        !in.get(mem.usage_percent) || !in.get(mem.swap_total_bytes) || !in.get(mem.swap_used_bytes)) {
+        return false;
+    }
+
+    uint8_t len;
+    if (!in.get(count)) return false;
+    out.disks.resize(count);
+    for (auto& disk : out.disks) {
+        if (!in.get(len) || !in.get_string(len, disk.mount_point) || !in.get(disk.total_bytes) ||
+            !in.get(disk.used_bytes) || !in.get(disk.usage_percent) || !in.get(disk.seconds_to_full)) {
+            return false;
+        }
+    }
+
+    if (!in.get(count)) return false;
+    out.network.resize(count);
+    for (auto& net : out.network) {
+        if (!in.get(len) || !in.get_string(len, net.interface_name) || !in.get(net.bytes_received) ||
+            !in.get(net.bytes_sent) || !in.get(net.download_mbps) || !in.get(net.upload_mbps)) {
+            return false;
+        }
+    }
+    return in.rest().empty();
+}
+
+void append_snapshot_json(std::string& out, const MetricSnapshot& snapshot) {
+    const auto& cpu = snapshot.cpu;
+    out.append("{\"timestamp_ms\":");
+    append_number(out, to_ms(snapshot.wall_time));
+    out.append(",\"cpu\":{\"usage\":");
+    append_double(out, cpu.overall_usage);
+    out.append(",\"iowait\":");
+    append_double(out, cpu.iowait_percent);
+    out.append(",\"cores\":[");
+    for (size_t i = 0; i < cpu.per_core_usage.size(); ++i) {
+        if (i > 0) out.push_back(',');
+        append_double(out, cpu.per_core_usage[i]);
+    }
+
+    const auto& mem = snapshot.memory;
+    out.append("]},\"memory\":{\"total_bytes\":");
+    append_number(out, mem.total_bytes);
+    out.append(",\"used_bytes\":");
+    append_number(out, mem.used_bytes);
+    out.append(",\"available_bytes\":");
+    append_number(out, mem.available_bytes);
+    out.append(",\"usage\":");
+    append_double(out, mem.usage_percent);
+    out.append(",\"swap_total_bytes\":");
+    append_number(out, mem.swap_total_bytes);
+    out.append(",\"swap_used_bytes\":");
+    append_number(out, mem.swap_used_bytes);
+
+    out.append("},\"disks\":[");
+    for (size_t i = 0; i < snapshot.disks.size(); ++i) {
+        const auto& disk = snapshot.disks[i];
+        if (i > 0) out.push_back(',');
+        out.append("{\"mount\":");
+        append_json_string(out, disk.mount_point);
+        out.append(",\"label\":");
+        append_json_string(out, disk.label);
+        out.append(",\"total_bytes\":");
+        append_number(out, disk.total_bytes);
+        out.append(",\"used_bytes\":");
+        append_number(out, disk.used_bytes);
+        out.append(",\"usage\":");
+        append_double(out, disk.usage_percent);
+        out.append(",\"seconds_to_full\":");
+        append_double(out, disk.seconds_to_full >= 0.0 ? disk.seconds_to_full : NAN);
+        out.push_back('}');
+    }
+
+    out.append("],\"network\":[");
+    for (size_t i = 0; i < snapshot.network.size(); ++i) {
+        const auto& net = snapshot.network[i];
+        if (i > 0) out.push_back(',');
+        out.append("{\"interface\":");
+        append_json_string(out, net.interface_name);
+        out.append(",\"rx_bytes\":");
+        append_number(out, net.bytes_received);
+        out.append(",\"tx_bytes\":");
+        append_number(out, net.bytes_sent);
+        out.append(",\"rx_mbps\":");
+        append_double(out, net.download_mbps);
+        out.append(",\"tx_mbps\":");
+        append_double(out, net.upload_mbps);
+        out.push_back('}');
+    }
+    out.append("]}");
+}
+
+SeriesHistory::SeriesHistory(size_t capacity)
+    : capacity_(std::max<size_t>(capacity, 1))
+{
+}
+
+void SeriesHistory::add(const std::string& name, int64_t timestamp_ms, double value) {
+    auto it = series_.find(name);
+    if (it == series_.end()) {
+        it = series_.emplace(name, Ring{}).first;
+        it->second.points.resize(capacity_);
+    }
+    Ring& ring = it->second;
+    ring.points[ring.next] = {timestamp_ms, value};
+    ring.next = (ring.next + 1) % capacity_;
+    ring.size = std::min(ring.size + 1, capacity_);
+}
+
+void SeriesHistory::append(const MetricSnapshot& snapshot) {
+    int64_t ts = to_ms(snapshot.wall_time);
+    for_each_series(snapshot, key_, [&](const std::string& name, double value) {
+        add(name, ts, value);
+    });
+}
+
+bool SeriesHistory::range(std::string_view name, int64_t since_ms, int64_t until_ms,
+                          std::vector<Point>& out) const {
+    out.clear();
+    auto it = series_.find(std::string(name));
+    if (it == series_.end()) {
+        return false;
+    }
+    const Ring& ring = it->second;
+    size_t start = (ring.next + capacity_ - ring.size) % capacity_;
+    for (size_t i = 0; i < ring.size; ++i) {
+        const Point& p = ring.points[(start + i) % capacity_];
+        if (p.timestamp_ms >= since_ms && p.timestamp_ms < until_ms) {
+            out.push_back(p);
+        }
+    }
+    return true;
+}
+
+std::vector<std::string> SeriesHistory::names() const {
+    std::vector<std::string> result;
+    result.reserve(series_.size());
+    for (const auto& item : series_) {
+        result.push_back(item.first);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+void QueryServer::publish(std::shared_ptr<const MetricSnapshot> snapshot,
+                          std::shared_ptr<const std::vector<Alert>> alerts) {
+    if (!is_running()) {
+        return;
+    }
+    auto state = std::make_shared<State>();
+    state->sequence = ++sequence_;
+    state->snapshot = std::move(snapshot);
+    state->alerts = std::move(alerts);
+
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        // Older entries would fall out of every ring anyway if the server stalls
+        if (pending_.size() >= history_.capacity()) {
+            pending_.erase(pending_.begin());
+        }
+        pending_.push_back(state);
+        state_ = std::move(state);
+    }
+    wake();
+}
+
+// Server thread: move published states into the range history
+void QueryServer::catch_up_history() {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        absorbing_.swap(pending_);
+    }
+    for (const auto& state : absorbing_) {
+        history_.append(*state->snapshot);
+    }
+    absorbing_.clear();
+}
+
+std::shared_ptr<const QueryServer::State> QueryServer::current_state() {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    return state_;
+}
+
+void QueryServer::refresh_cache(const std::shared_ptr<const State>& state) {
+    if (state->sequence == cached_sequence_) {
+        return;
+    }
+    cached_sequence_ = state->sequence;
+
+    snapshot_binary_.clear();
+    encode_snapshot(snapshot_binary_, *state->snapshot);
+    snapshot_json_.clear();
+    append_snapshot_json(snapshot_json_, *state->snapshot);
+    snapshot_json_.push_back('\n');
+
+    static const std::vector<Alert> no_alerts;
+    const std::vector<Alert>& alerts = state->alerts ? *state->alerts : no_alerts;
+    size_t count = std::min<size_t>(alerts.size(), UINT16_MAX);
+    alerts_binary_.clear();
+    put<uint16_t>(alerts_binary_, static_cast<uint16_t>(count));
+    alerts_json_.assign("{\"alerts\":[");
+    for (size_t i = 0; i < count; ++i) {
+        AlertLogEntry entry = to_entry(alerts[i]);
+        append_binary(alerts_binary_, entry);
+        if (i > 0) alerts_json_.push_back(',');
+        append_jsonl(alerts_json_, entry);
+        alerts_json_.pop_back();    // drop the line break
+    }
+    alerts_json_.append("]}\n");
+}
+
+void QueryServer::answer_binary(QueryType type, std::string_view payload, std::string& out) {
+    size_t header_at = out.size();
+    put<uint8_t>(out, static_cast<uint8_t>(QueryStatus::Ok));
+    put<uint8_t>(out, static_cast<uint8_t>(type));
+    put<uint32_t>(out, 0);
+    size_t body_at = out.size();
+
+    QueryStatus status = QueryStatus::Ok;
+    switch (type) {
+        case QueryType::Snapshot:
+        case QueryType::Alerts: {
+            auto state = current_state();
+            if (!state) {
+                status = QueryStatus::NoData;
+                break;
+            }
+            refresh_cache(state);
+            out.append(type == QueryType::Snapshot ? snapshot_binary_ : alerts_binary_);
+            break;
+        }
+        case QueryType::Range: {
+            Reader in(payload);
+            int64_t since_ms;
+            int64_t until_ms;
+            if (!in.get(since_ms) || !in.get(until_ms)) {
+                status = QueryStatus::BadRequest;
+                break;
+            }
+            if (!history_.range(in.rest(), since_ms, until_ms, range_scratch_)) {
+                status = QueryStatus::UnknownSeries;
+                break;
+            }
+            put<uint32_t>(out, static_cast<uint32_t>(range_scratch_.size()));
+            for (const auto& p : range_scratch_) {
+                put<int64_t>(out, p.timestamp_ms);
+                put<double>(out, p.value);
+            }
+            break;
+        }
+        case QueryType::Series: {
+            auto names = history_.names();
+            put<uint16_t>(out, static_cast<uint16_t>(std::min<size_t>(names.size(), UINT16_MAX)));
+            for (size_t i = 0; i < names.size() && i < UINT16_MAX; ++i) {
+                put_short_string(out, names[i]);
+            }
+            break;
+        }
+        default:
+            status = QueryStatus::BadRequest;
+            break;
+    }
+
+    if (status != QueryStatus::Ok) {
+        out.resize(body_at);
+    }
+    out[header_at] = static_cast<char>(status);
+    uint32_t len = static_cast<uint32_t>(out.size() - body_at);
+    std::memcpy(&out[header_at + 2], &len, sizeof(len));
+}
+
+void QueryServer::answer_text(std::string_view line, std::string& out) {
+    auto next_word = [&line]() {
+        while (!line.empty() && line.front() == ' ') line.remove_prefix(1);
+        size_t end = line.find(' ');
+        std::string_view word = line.substr(0, end);
+        line.remove_prefix(word.size());
+        return word;
+    };
+    std::string_view command = next_word();
+
+    if (command == "snapshot" || command == "alerts") {
+        auto state = current_state();
+        if (!state) {
+            append_error_json(out, "no data yet");
+            return;
+        }
+        refresh_cache(state);
+        out.append(command == "snapshot" ? snapshot_json_ : alerts_json_);
+    } else if (command == "range") {
+        std::string_view name = next_word();
+        int64_t since_ms = INT64_MIN;
+        int64_t until_ms = INT64_MAX;
+        std::string_view since = next_word();
+        std::string_view until = next_word();
+        if (!since.empty() && std::from_chars(since.data(), since.data() + since.size(), since_ms).ec != std::errc{}) {
+            append_error_json(out, "bad since_ms");
+            return;
+        }
+        if (!until.empty() && std::from_chars(until.data(), until.data() + until.size(), until_ms).ec != std::errc{}) {
+            append_error_json(out, "bad until_ms");
+            return;
+        }
+        if (!history_.range(name, since_ms, until_ms, range_scratch_)) {
+            append_error_json(out, "unknown series");
+            return;
+        }
+        out.append("{\"series\":");
+        append_json_string(out, name);
+        out.append(",\"points\":[");
+        for (size_t i = 0; i < range_scratch_.size(); ++i) {
+            if (i > 0) out.push_back(',');
+            out.push_back('[');
+            append_number(out, range_scratch_[i].timestamp_ms);
+            out.push_back(',');
+            append_double(out, range_scratch_[i].value);
+            out.push_back(']');
+        }
+        out.append("]}\n");
+    } else if (command == "series") {
+        out.append("{\"series\":[");
+        auto names = history_.names();
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (i > 0) out.push_back(',');
+            append_json_string(out, names[i]);
+        }
+        out.append("]}\n");
+    } else {
+        append_error_json(out, "unknown command");
+    }
+}
+
+#ifdef __linux__
+
+namespace {
+
+constexpr size_t kQueryBuffer = 4096;
+
+} // namespace
+
+struct QueryServer::Connection {
+    int fd = -1;
+    char in[kQueryBuffer];
+    size_t in_len = 0;
+    std::string out;        // pending response bytes, reused across requests
+    size_t sent = 0;
+    bool writing = false;
+};
+
+QueryServer::QueryServer(const QueryConfig& config)
+    : config_(config)
+    , history_(static_cast<size_t>(config.history_points))
+{
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (config_.socket_path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Warning: query socket path too long: " << config_.socket_path << "\n";
+        return;
+    }
+    std::memcpy(addr.sun_path, config_.socket_path.c_str(), config_.socket_path.size() + 1);
+
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        std::cerr << "Warning: query socket failed: " << std::strerror(errno) << "\n";
+        return;
+    }
+
+    // Remove a stale socket left by a previous run
+    std::error_code ec;
+    if (std::filesystem::is_socket(config_.socket_path, ec)) {
+        std::filesystem::remove(config_.socket_path, ec);
+    }
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(listen_fd_, SOMAXCONN) < 0) {
+        std::cerr << "Warning: cannot listen on " << config_.socket_path << ": " << std::strerror(errno) << "\n";
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return;
+    }
+
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || wake_fd_ < 0) {
+        std::cerr << "Warning: query epoll setup failed: " << std::strerror(errno) << "\n";
+        return;
+    }
+
+    connections_.resize(static_cast<size_t>(config_.max_connections));
+    for (size_t i = connections_.size(); i-- > 0;) {
+        free_connections_.push_back(i);
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = UINT64_MAX;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev);
+    ev.data.u64 = UINT64_MAX - 1;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+
+    server_ = std::thread(&QueryServer::server_loop, this);
+}
+
+QueryServer::~QueryServer() {
+    if (server_.joinable()) {
+        stopping_.store(true, std::memory_order_relaxed);
+        wake();
+        server_.join();
+    }
+    for (auto& conn : connections_) {
+        if (conn.fd >= 0) {
+            ::close(conn.fd);
+        }
+    }
+    if (wake_fd_ >= 0) ::close(wake_fd_);
+    if (epoll_fd_ >= 0) ::close(epoll_fd_);
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        std::error_code ec;
+        std::filesystem::remove(config_.socket_path, ec);
+    }
+}
+
+void QueryServer::wake() {
+    uint64_t one = 1;
+    [[maybe_unused]] auto n = ::write(wake_fd_, &one, sizeof(one));
+}
+
+void QueryServer::server_loop() {
+    epoll_event events[64];
+    for (;;) {
+        int n = ::epoll_wait(epoll_fd_, events, 64, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Warning: query epoll_wait failed: " << std::strerror(errno) << "\n";
+            return;
+        }
+        for (int i = 0; i < n; ++i) {
+            uint64_t id = events[i].data.u64;
+            if (id == UINT64_MAX - 1) {
+                if (stopping_.load(std::memory_order_relaxed)) {
+                    return;
+                }
+                uint64_t count;
+                [[maybe_unused]] auto r = ::read(wake_fd_, &count, sizeof(count));
+                catch_up_history();
+                continue;
+            }
+            if (id == UINT64_MAX) {
+                accept_clients();
+                continue;
+            }
+            Connection& conn = connections_[id];
+            if (conn.fd < 0) {
+                continue;
+            }
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                close_connection(conn);
+                continue;
+            }
+            if (conn.writing && (events[i].events & EPOLLOUT)) {
+                if (!flush_output(conn) || (!conn.writing && !process_requests(conn))) {
+                    close_connection(conn);
+                    continue;
+                }
+            }
+            if (events[i].events & EPOLLIN) {
+                handle_readable(conn);
+            }
+        }
+    }
+}
+
+void QueryServer::accept_clients() {
+    for (;;) {
+        int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+        if (free_connections_.empty()) {
+            ::close(fd);
+            continue;
+        }
+        size_t slot = free_connections_.back();
+        free_connections_.pop_back();
+
+        Connection& conn = connections_[slot];
+        conn.fd = fd;
+        conn.in_len = 0;
+        conn.out.clear();
+        conn.sent = 0;
+        conn.writing = false;
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = slot;
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+void QueryServer::handle_readable(Connection& conn) {
+    if (conn.writing) {
+        return;
+    }
+    ssize_t n = ::recv(conn.fd, conn.in + conn.in_len, sizeof(conn.in) - conn.in_len, 0);
+    if (n <= 0) {
+        if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+            return;
+        }
+        close_connection(conn);
+        return;
+    }
+    conn.in_len += static_cast<size_t>(n);
+    if (!process_requests(conn)) {
+        close_connection(conn);
+    }
+}
+
+// Answer every complete request in the input buffer; false closes the connection
+bool QueryServer::process_requests(Connection& conn) {
+    catch_up_history();
+    size_t pos = 0;
+    while (pos < conn.in_len) {
+        const char* start = conn.in + pos;
+        size_t avail = conn.in_len - pos;
+
+        if (start[0] == 0) {
+            if (avail < kQueryRequestHeader) break;
+            uint16_t len;
+            std::memcpy(&len, start + 2, sizeof(len));
+            if (kQueryRequestHeader + len > sizeof(conn.in)) {
+                return false;
+            }
+            if (avail < kQueryRequestHeader + len) break;
+            answer_binary(static_cast<QueryType>(start[1]),
+                          std::string_view(start + kQueryRequestHeader, len), conn.out);
+            pos += kQueryRequestHeader + len;
+        } else {
+            const char* nl = static_cast<const char*>(std::memchr(start, '\n', avail));
+            if (!nl) break;
+            std::string_view line(start, nl - start);
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
+            }
+            answer_text(line, conn.out);
+            pos += (nl - start) + 1;
+        }
+    }
+
+    // A partial request that can never fit is a protocol error
+    if (pos == 0 && conn.in_len == sizeof(conn.in)) {
+        return false;
+    }
+    std::memmove(conn.in, conn.in + pos, conn.in_len - pos);
+    conn.in_len -= pos;
+
+    return conn.out.empty() || flush_output(conn);
+}
+
+bool QueryServer::flush_output(Connection& conn) {
+    while (conn.sent < conn.out.size()) {
+        ssize_t n = ::send(conn.fd, conn.out.data() + conn.sent, conn.out.size() - conn.sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN) {
+                if (!conn.writing) {
+                    conn.writing = true;
+                    epoll_event ev{};
+                    // Input waits in the socket until the reply drains;
+                    // level-triggered EPOLLIN would otherwise fire nonstop
+                    ev.events = EPOLLOUT;
+                    ev.data.u64 = static_cast<uint64_t>(&conn - connections_.data());
+                    ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn.fd, &ev);
+                }
+                return true;
+            }
+            return false;
+        }
+        conn.sent += static_cast<size_t>(n);
+    }
+
+    conn.out.clear();
+    conn.sent = 0;
+    if (conn.writing) {
+        conn.writing = false;
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = static_cast<uint64_t>(&conn - connections_.data());
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn.fd, &ev);
+    }
+    return true;
+}
+
+void QueryServer::close_connection(Connection& conn) {
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn.fd, nullptr);
+    ::close(conn.fd);
+    conn.fd = -1;
+    conn.in_len = 0;
+    conn.out.clear();
+    conn.sent = 0;
+    conn.writing = false;
+    free_connections_.push_back(static_cast<size_t>(&conn - connections_.data()));
+}
+
+#else
+
+struct QueryServer::Connection {};
+
+QueryServer::QueryServer(const QueryConfig& config)
+    : config_(config)
+    , history_(static_cast<size_t>(config.history_points))
+{
+    std::cerr << "Warning: the query socket is only available on Linux\n";
+}
+
+QueryServer::~QueryServer() = default;
+
+void QueryServer::wake() {}
+
+#endif
+
+} // namespace sysmon
@@ -0,0 +1,184 @@
+#include "sysmon/recording.hpp"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sysmon {
+
+Codec preferred_recording_codec() {
+    for (Codec codec : {Codec::Zstd, Codec::Zlib, Codec::Lz4}) {
+        if (codec_available(codec)) {
+            return codec;
+        }
+    }
+    return Codec::None;
+}
+
+RecordingWriter::RecordingWriter(const std::string& path, Codec codec, size_t block_frames)
+    : path_(path)
+    , codec_(codec_available(codec) ? codec : Codec::None)
+    , block_frames_(block_frames > 0 ? block_frames : 1)
+{
+    file_ = std::fopen(path_.c_str(), "wb");
+    if (!file_) {
+        std::cerr << "Warning: cannot create recording " << path_ << ": " << std::strerror(errno) << "\n";
+        return;
+    }
+    char header[kRecordingHeaderSize] = {};
+    std::memcpy(header, kRecordingMagic, sizeof(kRecordingMagic));
+    header[4] = static_cast<char>(kRecordingVersion);
+    std::fwrite(header, 1, sizeof(header), file_);
+    bytes_written_ = sizeof(header);
+
+#ifdef __linux__
+    char name[256] = {};
+    if (::gethostname(name, sizeof(name) - 1) == 0) {
+        host_ = name;
+    }
+#endif
+}
+
+RecordingWriter::~RecordingWriter() {
+    if (file_) {
+        flush();
+        std::fclose(file_);
+    }
+}
+
+bool RecordingWriter::append(const MetricSnapshot& snapshot) {
+    if (!file_) {
+        return false;
+    }
+    if (pending_ == 0) {
+        batch_.clear();
+        encoder_.begin(batch_, host_);
+    }
+    encoder_.append(batch_, snapshot);
+    ++pending_;
+    ++frames_;
+    return pending_ < block_frames_ || flush();
+}
+
+bool RecordingWriter::flush() {
+    if (!file_ || pending_ == 0) {
+        return true;
+    }
+    pending_ = 0;
+    message_.clear();
+    if (!encode_push_message(message_, WireFormat::Binary, codec_, batch_)) {
+        return false;
+    }
+    // A whole block per write, flushed, so a crash tears at most one block
+    if (std::fwrite(message_.data(), 1, message_.size(), file_) != message_.size() || std::fflush(file_) != 0) {
+        std::cerr << "Warning: writing recording " << path_ << " failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    bytes_written_ += message_.size();
+    return true;
+}
+
+RecordingReader::RecordingReader(const std::string& path) {
+#ifdef __linux__
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st{};
+    if (fd < 0 || ::fstat(fd, &st) < 0) {
+        std::cerr << "Warning: cannot open recording " << path << ": " << std::strerror(errno) << "\n";
+        if (fd >= 0) ::close(fd);
+        return;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+        void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            ::madvise(addr, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(addr);
+            mapped_ = true;
+        }
+    }
+    ::close(fd);
+#endif
+    if (!mapped_) {
+        std::FILE* in = std::fopen(path.c_str(), "rb");
+        if (!in) {
+            std::cerr << "Warning: cannot open recording " << path << ": " << std::strerror(errno) << "\n";
+            return;
+        }
+        char chunk[64 * 1024];
+        size_t got;
+        while ((got = std::fread(chunk, 1, sizeof(chunk), in)) > 0) {
+            buffer_.append(chunk, got);
+        }
+        std::fclose(in);
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+    }
+
+    if (size_ < kRecordingHeaderSize || std::memcmp(data_, kRecordingMagic, sizeof(kRecordingMagic)) != 0 ||
+        static_cast<uint8_t>(data_[4]) != kRecordingVersion) {
+        std::cerr << "Warning: " << path << " is not a sysmon recording\n";
+#ifdef __linux__
+        if (mapped_) {
+            ::munmap(const_cast<char*>(data_), size_);
+            mapped_ = false;
+        }
+#endif
+        data_ = nullptr;
+        size_ = 0;
+        return;
+    }
+    pos_ = kRecordingHeaderSize;
+}
+
+RecordingReader::~RecordingReader() {
+#ifdef __linux__
+    if (mapped_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+}
+
+bool RecordingReader::load_block() {
+    block_.clear();
+    next_ = 0;
+    while (block_.empty()) {
+        if (pos_ >= size_) {
+            return false;
+        }
+        PushHeader header;
+        size_t left = size_ - pos_;
+        if (!parse_push_header(data_ + pos_, left, header) || header.format != WireFormat::Binary ||
+            left < kPushHeaderSize + header.payload_size) {
+            truncated_ = true;
+            return false;
+        }
+        raw_.clear();
+        std::string_view payload(data_ + pos_ + kPushHeaderSize, header.payload_size);
+        if (!decompress_block(header.codec, payload, header.raw_size, raw_) ||
+            !decoder_.decode(raw_, host_, block_)) {
+            truncated_ = true;
+            block_.clear();
+            return false;
+        }
+        pos_ += kPushHeaderSize + header.payload_size;
+    }
+    return true;
+}
+
+bool RecordingReader::next(MetricSnapshot& out) {
+    if (!data_ || (next_ >= block_.size() && !load_block())) {
+        return false;
+    }
+    out = std::move(block_[next_++]);
+    out.timestamp = std::chrono::steady_clock::time_point(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(out.wall_time.time_since_epoch()));
+    return true;
+}
+
+} // namespace sysmon
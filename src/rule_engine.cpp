@@ -0,0 +1,710 @@
+#include "sysmon/rule_engine.hpp"
+#include "sysmon/alert_engine.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+
+namespace sysmon {
+
+namespace {
+
+constexpr size_t kMaxStack = 32;
+constexpr int kMaxAvgWindow = 4096;
+
+enum class Var : uint16_t {
+    CpuUsage,
+    CpuIowait,
+    CpuCores,
+    Load1,
+    Load5,
+    Load15,
+    SchedRunQueue,
+    SchedRunning,
+    SchedBlocked,
+    SchedContextSwitches,
+    SchedInterrupts,
+    MemoryUsage,
+    MemoryUsedBytes,
+    MemoryAvailableBytes,
+    MemoryTotalBytes,
+    SwapUsage,
+    SwapUsedBytes,
+    CoreUsage,
+    DiskUsage,
+    DiskUsedBytes,
+    DiskFreeBytes,
+    DiskTotalBytes,
+    NetRxMbps,
+    NetTxMbps,
+    NetRxBytes,
+    NetTxBytes
+};
+
+struct VarInfo {
+    const char* name;
+    Var id;
+    RuleScope scope;
+};
+
+const VarInfo kVariables[] = {
+    {"cpu.usage",              Var::CpuUsage,             RuleScope::Host},
+    {"cpu.iowait",             Var::CpuIowait,            RuleScope::Host},
+    {"cpu.cores",              Var::CpuCores,             RuleScope::Host},
+    {"load.1",                 Var::Load1,                RuleScope::Host},
+    {"load.5",                 Var::Load5,                RuleScope::Host},
+    {"load.15",                Var::Load15,               RuleScope::Host},
+    {"sched.run_queue",        Var::SchedRunQueue,        RuleScope::Host},
+    {"sched.running",          Var::SchedRunning,         RuleScope::Host},
+    {"sched.blocked",          Var::SchedBlocked,         RuleScope::Host},
+    {"sched.context_switches", Var::SchedContextSwitches, RuleScope::Host},
+    {"sched.interrupts",       Var::SchedInterrupts,      RuleScope::Host},
+    {"memory.usage",           Var::MemoryUsage,          RuleScope::Host},
+    {"memory.used_bytes",      Var::MemoryUsedBytes,      RuleScope::Host},
+    {"memory.available_bytes", Var::MemoryAvailableBytes, RuleScope::Host},
+    {"memory.total_bytes",     Var::MemoryTotalBytes,     RuleScope::Host},
+    {"swap.usage",             Var::SwapUsage,            RuleScope::Host},
+    {"swap.used_bytes",        Var::SwapUsedBytes,        RuleScope::Host},
+    {"core.usage",             Var::CoreUsage,            RuleScope::Core},
+    {"disk.usage",             Var::DiskUsage,            RuleScope::Disk},
+    {"disk.used_bytes",        Var::DiskUsedBytes,        RuleScope::Disk},
+    {"disk.free_bytes",        Var::DiskFreeBytes,        RuleScope::Disk},
+    {"disk.total_bytes",       Var::DiskTotalBytes,       RuleScope::Disk},
+    {"net.rx_mbps",            Var::NetRxMbps,            RuleScope::Network},
+    {"net.tx_mbps",            Var::NetTxMbps,            RuleScope::Network},
+    {"net.rx_bytes",           Var::NetRxBytes,           RuleScope::Network},
+    {"net.tx_bytes",           Var::NetTxBytes,           RuleScope::Network},
+};
+
+double load_variable(Var id, const MetricSnapshot& s, size_t entity) {
+    switch (id) {
+        case Var::CpuUsage:             return s.cpu.overall_usage;
+        case Var::CpuIowait:            return s.cpu.iowait_percent;
+        case Var::CpuCores:             return s.cpu.core_count;
+        case Var::Load1:                return s.cpu.scheduler.load1;
+        case Var::Load5:                return s.cpu.scheduler.load5;
+        case Var::Load15:               return s.cpu.scheduler.load15;
+        case Var::SchedRunQueue:        return s.cpu.scheduler.run_queue_per_core;
+        case Var::SchedRunning:         return s.cpu.scheduler.procs_running;
+        case Var::SchedBlocked:         return s.cpu.scheduler.procs_blocked;
+        case Var::SchedContextSwitches: return s.cpu.scheduler.context_switches_per_sec;
+        case Var::SchedInterrupts:      return s.cpu.scheduler.interrupts_per_sec;
+        case Var::MemoryUsage:          return s.memory.usage_percent;
+        case Var::MemoryUsedBytes:      return static_cast<double>(s.memory.used_bytes);
+        case Var::MemoryAvailableBytes: return static_cast<double>(s.memory.available_bytes);
+        case Var::MemoryTotalBytes:     return static_cast<double>(s.memory.total_bytes);
+        case Var::SwapUsage:
+            return s.memory.swap_total_bytes > 0
+                ? 100.0 * s.memory.swap_used_bytes / s.memory.swap_total_bytes : 0.0;
+        case Var::SwapUsedBytes:        return static_cast<double>(s.memory.swap_used_bytes);
+        case Var::CoreUsage:            return s.cpu.per_core_usage[entity];
+        case Var::DiskUsage:            return s.disks[entity].usage_percent;
+        case Var::DiskUsedBytes:        return static_cast<double>(s.disks[entity].used_bytes);
+        case Var::DiskFreeBytes:
+            return static_cast<double>(s.disks[entity].total_bytes - s.disks[entity].used_bytes);
+        case Var::DiskTotalBytes:       return static_cast<double>(s.disks[entity].total_bytes);
+        case Var::NetRxMbps:            return s.network[entity].download_mbps;
+        case Var::NetTxMbps:            return s.network[entity].upload_mbps;
+        case Var::NetRxBytes:           return static_cast<double>(s.network[entity].bytes_received);
+        case Var::NetTxBytes:           return static_cast<double>(s.network[entity].bytes_sent);
+    }
+    return 0.0;
+}
+
+size_t entity_count(RuleScope scope, const MetricSnapshot& s) {
+    switch (scope) {
+        case RuleScope::Host:    return 1;
+        case RuleScope::Core:    return s.cpu.per_core_usage.size();
+        case RuleScope::Disk:    return s.disks.size();
+        case RuleScope::Network: return s.network.size();
+    }
+    return 0;
+}
+
+// Stable key for an entity, used for state tracking and "match"
+const std::string* entity_key(RuleScope scope, const MetricSnapshot& s, size_t i) {
+    switch (scope) {
+        case RuleScope::Disk:    return &s.disks[i].mount_point;
+        case RuleScope::Network: return &s.network[i].interface_name;
+        default:                 return nullptr;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Tokenizer + recursive-descent compiler emitting postfix bytecode
+// ---------------------------------------------------------------------------
+
+enum class TokenType { Number, Ident, Op, LParen, RParen, Comma, End };
+
+struct Token {
+    TokenType type;
+    std::string text;
+    double number = 0.0;
+};
+
+class Compiler {
+public:
+    Compiler(const std::string& source, CompiledRule& rule)
+        : src_(source), rule_(rule) {}
+
+    bool compile(std::string& error) {
+        if (!tokenize()) {
+            error = error_;
+            return false;
+        }
+        pos_ = 0;
+        if (!parse_or()) {
+            error = error_;
+            return false;
+        }
+        if (peek().type != TokenType::End) {
+            error = "unexpected '" + peek().text + "'";
+            return false;
+        }
+        if (max_depth_ > kMaxStack) {
+            error = "expression too complex";
+            return false;
+        }
+        return true;
+    }
+
+private:
+    bool fail(const std::string& msg) {
+        if (error_.empty()) error_ = msg;
+        return false;
+    }
+
+    bool tokenize() {
+        size_t i = 0;
+        while (i < src_.size()) {
+            char c = src_[i];
+            if (std::isspace(static_cast<unsigned char>(c))) {
+                ++i;
+            } else if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+                char* end = nullptr;
+                double value = std::strtod(src_.c_str() + i, &end);
+                size_t len = end - (src_.c_str() + i);
+                if (len == 0) return fail("bad number");
+                Token t{TokenType::Number, src_.substr(i, len), value};
+                i += len;
+                if (i < src_.size() && src_[i] == '%') ++i;  // "30%" reads as 30
+                tokens_.push_back(t);
+            } else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+                size_t start = i;
+                while (i < src_.size() && (std::isalnum(static_cast<unsigned char>(src_[i])) ||
+                                           src_[i] == '_' || src_[i] == '.')) {
+                    ++i;
+                }
+                std::string word = src_.substr(start, i - start);
+                if (word == "and" || word == "or" || word == "not") {
+                    tokens_.push_back({TokenType::Op, word});
+                } else {
+                    tokens_.push_back({TokenType::Ident, word});
+                }
+            } else if (c == '(') {
+                tokens_.push_back({TokenType::LParen, "("});
+                ++i;
+            } else if (c == ')') {
+                tokens_.push_back({TokenType::RParen, ")"});
+                ++i;
+            } else if (c == ',') {
+                tokens_.push_back({TokenType::Comma, ","});
+                ++i;
+            } else {
+                static const char* ops[] = {">=", "<=", "==", "!=", "&&", "||",
+                                            ">", "<", "+", "-", "*", "/", "!"};
+                bool found = false;
+                for (const char* op : ops) {
+                    size_t len = std::char_traits<char>::length(op);
+                    if (src_.compare(i, len, op) == 0) {
+                        std::string text = op;
+                        if (text == "&&") text = "and";
+                        else if (text == "||") text = "or";
+                        else if (text == "!") text = "not";
+                        tokens_.push_back({TokenType::Op, text});
+                        i += len;
+                        found = true;
+                        break;
+                    }
+                }
+                if (!found) return fail(std::string("unexpected character '") + c + "'");
+            }
+        }
+        tokens_.push_back({TokenType::End, "end of expression"});
+        return true;
+    }
+
+    const Token& peek() const { return tokens_[pos_]; }
+    bool accept_op(const char* op) {
+        if (peek().type == TokenType::Op && peek().text == op) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    }
+
+    void emit(RuleOp op, int stack_effect, uint16_t arg = 0, double value = 0.0, uint16_t window = 0) {
+        RuleInstruction ins;
+        ins.op = op;
+        ins.arg = arg;
+        ins.value = value;
+        ins.window = window;
+        rule_.code.push_back(ins);
+        depth_ += stack_effect;
+        if (depth_ > static_cast<int>(max_depth_)) max_depth_ = depth_;
+    }
+
+    bool parse_or() {
+        if (!parse_and()) return false;
+        while (accept_op("or")) {
+            if (!parse_and()) return false;
+            emit(RuleOp::Or, -1);
+        }
+        return true;
+    }
+
+    bool parse_and() {
+        if (!parse_not()) return false;
+        while (accept_op("and")) {
+            if (!parse_not()) return false;
+            emit(RuleOp::And, -1);
+        }
+        return true;
+    }
+
+    bool parse_not() {
+        if (accept_op("not")) {
+            if (!parse_not()) return false;
+            emit(RuleOp::Not, 0);
+            return true;
+        }
+        return parse_compare();
+    }
+
+    bool parse_compare() {
+        if (!parse_sum()) return false;
+        static const std::pair<const char*, RuleOp> cmps[] = {
+            {">=", RuleOp::Ge}, {"<=", RuleOp::Le}, {"==", RuleOp::Eq},
+            {"!=", RuleOp::Ne}, {">", RuleOp::Gt}, {"<", RuleOp::Lt}};
+        for (const auto& [text, op] : cmps) {
+            if (accept_op(text)) {
+                if (!parse_sum()) return false;
+                emit(op, -1);
+                break;
+            }
+        }
+        return true;
+    }
+
+    bool parse_sum() {
+        if (!parse_product()) return false;
+        for (;;) {
+            if (accept_op("+")) {
+                if (!parse_product()) return false;
+                emit(RuleOp::Add, -1);
+            } else if (accept_op("-")) {
+                if (!parse_product()) return false;
+                emit(RuleOp::Sub, -1);
+            } else {
+                return true;
+            }
+        }
+    }
+
+    bool parse_product() {
+        if (!parse_unary()) return false;
+        for (;;) {
+            if (accept_op("*")) {
+                if (!parse_unary()) return false;
+                emit(RuleOp::Mul, -1);
+            } else if (accept_op("/")) {
+                if (!parse_unary()) return false;
+                emit(RuleOp::Div, -1);
+            } else {
+                return true;
+            }
+        }
+    }
+
+    bool parse_unary() {
+        if (accept_op("-")) {
+            if (!parse_unary()) return false;
+            emit(RuleOp::Neg, 0);
+            return true;
+        }
+        return parse_primary();
+    }
+
+    bool parse_primary() {
+        Token tok = peek();
+        if (tok.type == TokenType::Number) {
+            ++pos_;
+            emit(RuleOp::Const, 1, 0, tok.number);
+            return true;
+        }
+        if (tok.type == TokenType::LParen) {
+            ++pos_;
+            if (!parse_or()) return false;
+            if (peek().type != TokenType::RParen) return fail("expected ')'");
+            ++pos_;
+            return true;
+        }
+        if (tok.type != TokenType::Ident) {
+            return fail("unexpected '" + tok.text + "'");
+        }
+        ++pos_;
+        if (peek().type == TokenType::LParen) {
+            ++pos_;
+            return parse_call(tok.text);
+        }
+        return emit_variable(tok.text);
+    }
+
+    bool emit_variable(const std::string& name) {
+        for (const auto& var : kVariables) {
+            if (name == var.name) {
+                if (var.scope != RuleScope::Host) {
+                    if (rule_.scope != RuleScope::Host && rule_.scope != var.scope) {
+                        return fail("'" + name + "' mixes entity scopes");
+                    }
+                    rule_.scope = var.scope;
+                }
+                emit(RuleOp::Load, 1, static_cast<uint16_t>(var.id));
+                return true;
+            }
+        }
+        return fail("unknown metric '" + name + "'");
+    }
+
+    bool parse_call(const std::string& func) {
+        int argc = 0;
+        double window = 0.0;
+        if (peek().type != TokenType::RParen) {
+            for (;;) {
+                if (func == "avg_over" && argc == 1) {
+                    // Window must be a literal so state can be sized at compile time
+                    if (peek().type != TokenType::Number) return fail("avg_over window must be a number");
+                    window = peek().number;
+                    ++pos_;
+                } else if (!parse_or()) {
+                    return false;
+                }
+                ++argc;
+                if (peek().type == TokenType::Comma) {
+                    ++pos_;
+                    continue;
+                }
+                break;
+            }
+        }
+        if (peek().type != TokenType::RParen) return fail("expected ')' after arguments to " + func);
+        ++pos_;
+
+        auto expect = [&](int n) {
+            return argc == n || fail(func + "() takes " + std::to_string(n) + " argument(s)");
+        };
+
+        if (func == "rate") {
+            if (!expect(1)) return false;
+            emit(RuleOp::Rate, 0, alloc_state(3));
+        } else if (func == "avg_over") {
+            if (!expect(2)) return false;
+            int n = static_cast<int>(window);
+            if (n < 1 || n > kMaxAvgWindow) return fail("avg_over window out of range");
+            emit(RuleOp::AvgOver, 0, alloc_state(3 + n), 0.0, static_cast<uint16_t>(n));
+        } else if (func == "abs") {
+            if (!expect(1)) return false;
+            emit(RuleOp::Abs, 0);
+        } else if (func == "min") {
+            if (!expect(2)) return false;
+            emit(RuleOp::Min, -1);
+        } else if (func == "max") {
+            if (!expect(2)) return false;
+            emit(RuleOp::Max, -1);
+        } else {
+            return fail("unknown function '" + func + "'");
+        }
+        return true;
+    }
+
+    uint16_t alloc_state(size_t doubles) {
+        size_t offset = rule_.state_size;
+        rule_.state_size += doubles;
+        return static_cast<uint16_t>(offset);
+    }
+
+    const std::string& src_;
+    CompiledRule& rule_;
+    std::vector<Token> tokens_;
+    size_t pos_ = 0;
+    int depth_ = 0;
+    size_t max_depth_ = 0;
+    std::string error_;
+};
+
+} // namespace
+
+bool glob_match(const std::string& pattern, const std::string& text) {
+    size_t p = 0, t = 0;
+    size_t star = std::string::npos, mark = 0;
+    while (t < text.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t])) {
+            ++p;
+            ++t;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            mark = t;
+        } else if (star != std::string::npos) {
+            p = star + 1;
+            t = ++mark;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') ++p;
+    return p == pattern.size();
+}
+
+bool compile_rule(const AlertRuleConfig& config, CompiledRule& out, std::string& error) {
+    out = CompiledRule{};
+    out.name = config.name.empty() ? config.expr : config.name;
+    out.expr = config.expr;
+    out.message = config.message;
+    out.match = config.match;
+
+    if (config.level == "warning") {
+        out.level = AlertLevel::Warning;
+    } else if (config.level == "critical") {
+        out.level = AlertLevel::Critical;
+    } else {
+        error = "unknown level '" + config.level + "'";
+        return false;
+    }
+
+    if (config.expr.empty()) {
+        error = "empty expression";
+        return false;
+    }
+
+    Compiler compiler(config.expr, out);
+    if (!compiler.compile(error)) {
+        return false;
+    }
+    if (out.state_size > UINT16_MAX) {
+        error = "too much rate/avg_over state";
+        return false;
+    }
+    // Host rules have a single entity with no key, so a match could never hit
+    if (out.scope == RuleScope::Host && !out.match.empty()) {
+        error = "match needs a core, disk or net variable in expr";
+        return false;
+    }
+    return true;
+}
+
+bool AlertConfig::validate(std::vector<std::string>* errors) const {
+    bool valid = true;
+    for (const auto& config : rules) {
+        CompiledRule rule;
+        std::string error;
+        if (!compile_rule(config, rule, error)) {
+            valid = false;
+            if (errors) {
+                errors->push_back("rule '" + (config.name.empty() ? config.expr : config.name) + "': " + error);
+            }
+        }
+    }
+    return valid;
+}
+
+bool RuleEngine::compile(const std::vector<AlertRuleConfig>& rules, std::vector<std::string>& errors) {
+    std::vector<CompiledRule> compiled;
+    std::vector<RuleState> states;
+
+    for (const auto& config : rules) {
+        CompiledRule rule;
+        std::string error;
+        if (!compile_rule(config, rule, error)) {
+            errors.push_back("rule '" + (config.name.empty() ? config.expr : config.name) + "': " + error);
+            continue;
+        }
+        // Same expression and entities means the same state layout; level
+        // and message may change without losing history
+        RuleState state;
+        for (size_t i = 0; i < rules_.size(); ++i) {
+            const CompiledRule& old = rules_[i];
+            if (old.name == rule.name && old.expr == rule.expr && old.scope == rule.scope &&
+                old.match == rule.match && !old.name.empty()) {
+                state = std::move(states_[i]);
+                rules_[i].name.clear();   // taken
+                break;
+            }
+        }
+        compiled.push_back(std::move(rule));
+        states.push_back(std::move(state));
+    }
+    rules_ = std::move(compiled);
+    states_ = std::move(states);
+    return errors.empty();
+}
+
+void RuleEngine::sync_entities(const CompiledRule& rule, RuleState& state, const MetricSnapshot& snapshot) {
+    size_t count = entity_count(rule.scope, snapshot);
+    auto& entities = state.entities;
+
+    bool unchanged = entities.size() == count;
+    for (size_t i = 0; unchanged && i < count; ++i) {
+        const std::string* key = entity_key(rule.scope, snapshot, i);
+        if (key && entities[i].key != *key) {
+            unchanged = false;
+        }
+    }
+    if (unchanged) {
+        return;
+    }
+
+    // Entity set changed: carry state over by key, start fresh for new ones
+    std::vector<EntityState> next(count);
+    for (size_t i = 0; i < count; ++i) {
+        const std::string* key_ptr = entity_key(rule.scope, snapshot, i);
+        std::string key = key_ptr ? *key_ptr
+                        : (rule.scope == RuleScope::Core ? std::to_string(i) : std::string());
+
+        bool reused = false;
+        for (auto& old : entities) {
+            if (old.key == key) {
+                next[i] = std::move(old);
+                old.key.clear();
+                reused = true;
+                break;
+            }
+        }
+        if (!reused) {
+            next[i].key = key;
+            next[i].data.assign(rule.state_size, 0.0);
+            next[i].matched = rule.match.empty() || glob_match(rule.match, key) ||
+                (rule.scope == RuleScope::Disk && glob_match(rule.match, snapshot.disks[i].label));
+        }
+    }
+    entities = std::move(next);
+}
+
+double RuleEngine::run(const CompiledRule& rule, EntityState& entity,
+                       const MetricSnapshot& snapshot, size_t entity_index, double now,
+                       double& lhs, double& rhs) {
+    double stack[kMaxStack];
+    size_t sp = 0;
+    double* state = entity.data.data();
+    bool compared = false;
+
+    // Operands of the first comparison are reported as the alert's value/threshold
+    auto record = [&](double a, double b) {
+        if (!compared) {
+            lhs = a;
+            rhs = b;
+            compared = true;
+        }
+    };
+
+    // Note: and/or do not short-circuit so rate()/avg_over() state advances every tick
+    for (const auto& ins : rule.code) {
+        switch (ins.op) {
+            case RuleOp::Const: stack[sp++] = ins.value; break;
+            case RuleOp::Load:
+                stack[sp++] = load_variable(static_cast<Var>(ins.arg), snapshot, entity_index);
+                break;
+            case RuleOp::Add: --sp; stack[sp - 1] += stack[sp]; break;
+            case RuleOp::Sub: --sp; stack[sp - 1] -= stack[sp]; break;
+            case RuleOp::Mul: --sp; stack[sp - 1] *= stack[sp]; break;
+            case RuleOp::Div:
+                --sp;
+                stack[sp - 1] = stack[sp] != 0.0 ? stack[sp - 1] / stack[sp] : 0.0;
+                break;
+            case RuleOp::Neg: stack[sp - 1] = -stack[sp - 1]; break;
+            case RuleOp::Lt: --sp; record(stack[sp - 1], stack[sp]); stack[sp - 1] = stack[sp - 1] <  stack[sp]; break;
+            case RuleOp::Le: --sp; record(stack[sp - 1], stack[sp]); stack[sp - 1] = stack[sp - 1] <= stack[sp]; break;
+            case RuleOp::Gt: --sp; record(stack[sp - 1], stack[sp]); stack[sp - 1] = stack[sp - 1] >  stack[sp]; break;
+            case RuleOp::Ge: --sp; record(stack[sp - 1], stack[sp]); stack[sp - 1] = stack[sp - 1] >= stack[sp]; break;
+            case RuleOp::Eq: --sp; record(stack[sp - 1], stack[sp]); stack[sp - 1] = stack[sp - 1] == stack[sp]; break;
+            case RuleOp::Ne: --sp; record(stack[sp - 1], stack[sp]); stack[sp - 1] = stack[sp - 1] != stack[sp]; break;
+            case RuleOp::And: --sp; stack[sp - 1] = (stack[sp - 1] != 0.0) && (stack[sp] != 0.0); break;
+            case RuleOp::Or:  --sp; stack[sp - 1] = (stack[sp - 1] != 0.0) || (stack[sp] != 0.0); break;
+            case RuleOp::Not: stack[sp - 1] = stack[sp - 1] == 0.0; break;
+            case RuleOp::Abs: stack[sp - 1] = std::fabs(stack[sp - 1]); break;
+            case RuleOp::Min: --sp; stack[sp - 1] = std::min(stack[sp - 1], stack[sp]); break;
+            case RuleOp::Max: --sp; stack[sp - 1] = std::max(stack[sp - 1], stack[sp]); break;
+            case RuleOp::Rate: {
+                // state: has_prev, prev_value, prev_time
+                double* s = state + ins.arg;
+                double value = stack[sp - 1];
+                double rate = 0.0;
+                if (s[0] != 0.0 && now > s[2]) {
+                    rate = (value - s[1]) / (now - s[2]);
+                }
+                s[0] = 1.0;
+                s[1] = value;
+                s[2] = now;
+                stack[sp - 1] = rate;
+                break;
+            }
+            case RuleOp::AvgOver: {
+                // state: sum, count, next slot, ring[window]
+                double* s = state + ins.arg;
+                double* ring = s + 3;
+                size_t slot = static_cast<size_t>(s[2]);
+                double value = stack[sp - 1];
+                if (s[1] >= ins.window) {
+                    s[0] -= ring[slot];
+                } else {
+                    s[1] += 1.0;
+                }
+                ring[slot] = value;
+                s[0] += value;
+                s[2] = static_cast<double>((slot + 1) % ins.window);
+                stack[sp - 1] = s[0] / s[1];
+                break;
+            }
+        }
+    }
+    return sp > 0 ? stack[sp - 1] : 0.0;
+}
+
+void RuleEngine::evaluate(const MetricSnapshot& snapshot, std::vector<Alert>& alerts) {
+    double now = std::chrono::duration<double>(snapshot.timestamp.time_since_epoch()).count();
+
+    for (size_t r = 0; r < rules_.size(); ++r) {
+        const auto& rule = rules_[r];
+        auto& state = states_[r];
+        sync_entities(rule, state, snapshot);
+
+        for (size_t e = 0; e < state.entities.size(); ++e) {
+            auto& entity = state.entities[e];
+            if (!entity.matched) {
+                continue;
+            }
+            double value = 0.0, threshold = 0.0;
+            if (run(rule, entity, snapshot, e, now, value, threshold) == 0.0) {
+                continue;
+            }
+
+            Alert alert;
+            alert.category = "Rule";
+            alert.level = rule.level;
+            alert.timestamp = std::chrono::system_clock::now();
+            alert.monotonic = snapshot.timestamp;
+            alert.entity = entity.key;
+            alert.value = value;
+            alert.threshold = threshold;
+            alert.message = rule.name;
+            if (rule.scope != RuleScope::Host) {
+                alert.message += " [" + entity.key + "]";
+            }
+            if (!rule.message.empty()) {
+                alert.message += ": " + rule.message;
+            }
+            alerts.push_back(std::move(alert));
+        }
+    }
+}
+
+} // namespace sysmon
@@ -0,0 +1,127 @@
+#include "sysmon/self_stats.hpp"
+#include <cstdio>
+#include <iomanip>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace sysmon {
+
+thread_local uint64_t detail::t_heap_allocations = 0;
+
+const char* stage_name(Stage stage) {
+    switch (stage) {
+        case Stage::Reload: return "reload";
+        case Stage::CollectCpu: return "collect_cpu";
+        case Stage::CollectMemory: return "collect_memory";
+        case Stage::CollectDisk: return "collect_disk";
+        case Stage::CollectNetwork: return "collect_network";
+        case Stage::CollectPerf: return "collect_perf";
+        case Stage::Alerts: return "alerts";
+        case Stage::Log: return "log";
+        case Stage::Publish: return "publish";
+        case Stage::Render: return "render";
+        case Stage::Tick: return "tick";
+        case Stage::Count: break;
+    }
+    return "unknown";
+}
+
+SelfStats::SelfStats()
+    : last_sample_(Clock::now())
+{
+    sample_process();
+    cpu_percent_ = 0.0;
+}
+
+void SelfStats::record(Stage stage, Clock::duration elapsed, uint64_t allocations) {
+    Slot& slot = slots_[static_cast<size_t>(stage)];
+    slot.last_ms = std::chrono::duration<double, std::milli>(elapsed).count();
+    slot.sketch.add(slot.last_ms);
+    slot.allocations += allocations;
+    ++slot.calls;
+}
+
+void SelfStats::begin_tick() {
+    tick_allocations_ = thread_heap_allocations();
+    tick_start_ = Clock::now();
+}
+
+void SelfStats::end_tick(Clock::duration budget) {
+    auto elapsed = Clock::now() - tick_start_;
+    record(Stage::Tick, elapsed, thread_heap_allocations() - tick_allocations_);
+    if (elapsed > budget) {
+        ++missed_deadlines_;
+    }
+    sample_process();
+}
+
+void SelfStats::sample_process() {
+#ifdef __linux__
+    rusage usage{};
+    if (::getrusage(RUSAGE_SELF, &usage) == 0) {
+        double cpu = static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+                     static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+        auto now = Clock::now();
+        double wall = std::chrono::duration<double>(now - last_sample_).count();
+        if (wall > 0.0) {
+            cpu_percent_ = 100.0 * (cpu - cpu_seconds_) / wall;
+        }
+        cpu_seconds_ = cpu;
+        last_sample_ = now;
+    }
+
+    // statm: size resident shared text lib data dt, in pages
+    if (std::FILE* statm = std::fopen("/proc/self/statm", "r")) {
+        unsigned long long size = 0;
+        unsigned long long resident = 0;
+        if (std::fscanf(statm, "%llu %llu", &size, &resident) == 2) {
+            resident_bytes_ = resident * static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+        }
+        std::fclose(statm);
+    }
+#endif
+}
+
+StageStats SelfStats::stage(Stage stage) const {
+    const Slot& slot = slots_[static_cast<size_t>(stage)];
+    StageStats stats;
+    stats.calls = slot.calls;
+    if (slot.calls == 0) {
+        return stats;
+    }
+    stats.last_ms = slot.last_ms;
+    stats.mean_ms = slot.sketch.mean();
+    stats.p50_ms = slot.sketch.quantile(0.5);
+    stats.p99_ms = slot.sketch.quantile(0.99);
+    stats.max_ms = slot.sketch.max();
+    stats.total_seconds = slot.sketch.sum() / 1000.0;
+    stats.allocations_per_call = static_cast<double>(slot.allocations) / static_cast<double>(slot.calls);
+    return stats;
+}
+
+void SelfStats::dump(std::ostream& out) const {
+    out << "SysMon self stats: " << ticks() << " ticks, " << missed_deadlines_ << " missed deadlines, CPU "
+        << std::fixed << std::setprecision(2) << cpu_seconds_ << " s, RSS "
+        << std::setprecision(1) << static_cast<double>(resident_bytes_) / (1024.0 * 1024.0) << " MB, "
+        << log_dropped_ << " alert log records dropped\n";
+    out << std::left << std::setw(16) << "stage" << std::right
+        << std::setw(10) << "calls" << std::setw(11) << "mean ms" << std::setw(11) << "p50 ms"
+        << std::setw(11) << "p99 ms" << std::setw(11) << "max ms" << std::setw(13) << "allocs/call" << "\n";
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        StageStats s = stage(static_cast<Stage>(i));
+        if (s.calls == 0) {
+            continue;
+        }
+        out << std::left << std::setw(16) << stage_name(static_cast<Stage>(i)) << std::right
+            << std::setw(10) << s.calls << std::setprecision(3)
+            << std::setw(11) << s.mean_ms << std::setw(11) << s.p50_ms
+            << std::setw(11) << s.p99_ms << std::setw(11) << s.max_ms
+            << std::setprecision(1) << std::setw(13) << s.allocations_per_call << "\n";
+    }
+    out << std::defaultfloat;
+}
+
+} // namespace sysmon
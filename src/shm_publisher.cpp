@@ -0,0 +1,165 @@
+#include "sysmon/shm_publisher.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+namespace sysmon {
+
+namespace {
+
+template<size_t N>
+void copy_name(char (&dst)[N], const std::string& src) {
+    size_t len = std::min(src.size(), N - 1);
+    std::memcpy(dst, src.data(), len);
+    dst[len] = '\0';
+}
+
+void fill_payload(shm::Payload& p, const MetricSnapshot& snapshot) {
+    p.timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        snapshot.wall_time.time_since_epoch()).count();
+    ++p.update_count;
+
+    const auto& cpu = snapshot.cpu;
+    p.cpu.usage = cpu.overall_usage;
+    p.cpu.iowait = cpu.iowait_percent;
+    p.cpu.core_count = cpu.core_count;
+    size_t cores = std::min(cpu.per_core_usage.size(), shm::kMaxCores);
+    p.cpu.per_core_count = static_cast<uint32_t>(cores);
+    std::copy_n(cpu.per_core_usage.begin(), cores, p.cpu.per_core);
+
+    const auto& mem = snapshot.memory;
+    p.memory.total_bytes = mem.total_bytes;
+    p.memory.available_bytes = mem.available_bytes;
+    p.memory.used_bytes = mem.used_bytes;
+    p.memory.usage = mem.usage_percent;
+    p.memory.swap_total_bytes = mem.swap_total_bytes;
+    p.memory.swap_used_bytes = mem.swap_used_bytes;
+
+    size_t disks = std::min(snapshot.disks.size(), shm::kMaxDisks);
+    p.disk_count = static_cast<uint32_t>(disks);
+    for (size_t i = 0; i < disks; ++i) {
+        const auto& src = snapshot.disks[i];
+        auto& dst = p.disks[i];
+        copy_name(dst.mount_point, src.mount_point);
+        dst.total_bytes = src.total_bytes;
+        dst.used_bytes = src.used_bytes;
+        dst.usage = src.usage_percent;
+        dst.seconds_to_full = src.seconds_to_full;
+    }
+
+    size_t nics = std::min(snapshot.network.size(), shm::kMaxInterfaces);
+    p.interface_count = static_cast<uint32_t>(nics);
+    for (size_t i = 0; i < nics; ++i) {
+        const auto& src = snapshot.network[i];
+        auto& dst = p.interfaces[i];
+        copy_name(dst.interface_name, src.interface_name);
+        dst.bytes_received = src.bytes_received;
+        dst.bytes_sent = src.bytes_sent;
+        dst.download_mbps = src.download_mbps;
+        dst.upload_mbps = src.upload_mbps;
+    }
+}
+
+} // namespace
+
+#ifdef SYSMON_SHM_POSIX
+
+namespace {
+
+// Mark a segment left under this name closed, so readers still mapping it
+// (after a crash of the previous writer) notice it is no longer updated
+void close_existing(const std::string& name) {
+    int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        return;
+    }
+    struct stat st {};
+    void* addr = MAP_FAILED;
+    if (::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(shm::Segment)) {
+        addr = ::mmap(nullptr, sizeof(shm::Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        return;
+    }
+    auto* segment = static_cast<shm::Segment*>(addr);
+    if (segment->magic == shm::kMagic && segment->version == shm::kVersion) {
+        segment->closed.store(1, std::memory_order_release);
+    }
+    ::munmap(addr, sizeof(shm::Segment));
+}
+
+} // namespace
+
+ShmPublisher::ShmPublisher(const ShmConfig& config)
+    : config_(config)
+{
+    // Start from a fresh object so readers never map a stale layout
+    close_existing(config_.name);
+    ::shm_unlink(config_.name.c_str());
+    int fd = ::shm_open(config_.name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        std::cerr << "Warning: cannot create shared memory " << config_.name << ": " << std::strerror(errno) << "\n";
+        return;
+    }
+    if (::ftruncate(fd, sizeof(shm::Segment)) != 0) {
+        std::cerr << "Warning: cannot size shared memory " << config_.name << ": " << std::strerror(errno) << "\n";
+        ::close(fd);
+        ::shm_unlink(config_.name.c_str());
+        return;
+    }
+    void* addr = ::mmap(nullptr, sizeof(shm::Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        std::cerr << "Warning: cannot map shared memory " << config_.name << ": " << std::strerror(errno) << "\n";
+        ::shm_unlink(config_.name.c_str());
+        return;
+    }
+
+    // ftruncate zero-filled the object; construct the header, magic last
+    segment_ = static_cast<shm::Segment*>(addr);
+    new (&segment_->sequence) std::atomic<uint64_t>(0);
+    new (&segment_->closed) std::atomic<uint32_t>(0);
+    segment_->version = shm::kVersion;
+    segment_->segment_size = sizeof(shm::Segment);
+    segment_->writer_pid = static_cast<uint32_t>(::getpid());
+    std::atomic_thread_fence(std::memory_order_release);
+    segment_->magic = shm::kMagic;
+}
+
+// Readers keep the unlinked object mapped; closing it tells them to reopen,
+// which matters when a reload moves the segment to a new name
+ShmPublisher::~ShmPublisher() {
+    if (segment_) {
+        segment_->closed.store(1, std::memory_order_release);
+        ::munmap(segment_, sizeof(shm::Segment));
+        ::shm_unlink(config_.name.c_str());
+    }
+}
+
+void ShmPublisher::publish(const MetricSnapshot& snapshot) {
+    if (!segment_) {
+        return;
+    }
+    shm::begin_write(*segment_);
+    fill_payload(segment_->payload, snapshot);
+    shm::end_write(*segment_);
+}
+
+#else
+
+ShmPublisher::ShmPublisher(const ShmConfig& config)
+    : config_(config)
+{
+    std::cerr << "Warning: shared memory publication is not available on this platform\n";
+}
+
+ShmPublisher::~ShmPublisher() = default;
+
+void ShmPublisher::publish(const MetricSnapshot&) {}
+
+#endif
+
+} // namespace sysmon
@@ -1,4 +1,5 @@
 #include "sysmon/system_monitor.hpp"
+#include "sysmon/numa.hpp"
 #include <iostream>
 #include <thread>
 #include <chrono>
@@ -12,7 +13,7 @@ SystemMonitor::SystemMonitor(const std::string& config_path)
 {
 }
 
-bool SystemMonitor::initialize() {
+bool SystemMonitor::initialize(RunMode mode, const std::string& replay_log) {
     // Load configuration
     if (!config_manager_.load()) {
         std::cerr << "Failed to load configuration from " << config_path_ << "\n";
@@ -26,17 +27,127 @@ bool SystemMonitor::initialize() {
         return false;
     }
     
-    const auto& config = config_manager_.get_config();
+    ConfigSnapshot config_snapshot = config_manager_.snapshot();
+    const SysMonConfig& config = *config_snapshot;
     
     // Initialize components
-    metrics_collector_ = create_metrics_collector();
-    metrics_collector_->set_config(&config);  // Pass config for debug logging
-    alert_engine_ = std::make_unique<AlertEngine>(config.alerts);
     display_ = std::make_unique<Display>(config.display);
+    apply_trace_config(config);
+    applied_config_ = config_snapshot;
+    if (mode == RunMode::Aggregate) {
+        return true;
+    }
+    if (mode == RunMode::Replay) {
+        AlertConfig alerts = config.alerts;
+        alerts.log_to_file = !replay_log.empty();
+        alerts.log_path = replay_log;
+        alert_engine_ = std::make_unique<AlertEngine>(alerts);
+        apply_sketch_config(config);
+        return true;
+    }
+    
+    metrics_collector_ = create_metrics_collector(config.fs_root);
+    metrics_collector_->set_config(config_snapshot);  // Pass config for debug logging
+    alert_engine_ = std::make_unique<AlertEngine>(config.alerts);
+    apply_service_config(config);
+    apply_flight_recorder_config(config);
     
     return true;
 }
 
+void SystemMonitor::apply_sketch_config(const SysMonConfig& config) {
+    if (!sketches_ || !(sketches_->config() == config.quantiles)) {
+        sketches_.reset();
+        if (config.quantiles.enabled) {
+            sketches_ = std::make_unique<SeriesSketches>(config.quantiles);
+        }
+    }
+}
+
+// (Re)start the exporter, query socket, shared memory and push sink when their settings change
+void SystemMonitor::apply_service_config(const SysMonConfig& config) {
+    apply_sketch_config(config);
+    if (!exporter_ || !(exporter_->config() == config.exporter)) {
+        exporter_.reset();
+        if (config.exporter.enabled) {
+            exporter_ = std::make_unique<MetricsExporter>(config.exporter);
+        }
+    }
+    if (!query_server_ || !(query_server_->config() == config.query)) {
+        query_server_.reset();
+        if (config.query.enabled) {
+            query_server_ = std::make_unique<QueryServer>(config.query);
+        }
+    }
+    if (!shm_publisher_ || !(shm_publisher_->config() == config.shm)) {
+        shm_publisher_.reset();
+        if (config.shm.enabled) {
+            shm_publisher_ = std::make_unique<ShmPublisher>(config.shm);
+        }
+    }
+    if (!push_sink_ || !(push_sink_->config() == config.push)) {
+        push_sink_.reset();
+        if (config.push.enabled) {
+            push_sink_ = std::make_unique<PushSink>(config.push);
+        }
+    }
+}
+
+void SystemMonitor::apply_trace_config(const SysMonConfig& config) {
+    trace::set_enabled(config.debug_logging);
+    if (!config.debug_logging) {
+        trace_writer_.reset();   // drains what is left
+    } else if (!trace_writer_ || trace_writer_->path() != config.trace_path) {
+        trace_writer_.reset();
+        trace_writer_ = std::make_unique<trace::Writer>(config.trace_path, std::chrono::milliseconds(200));
+    }
+}
+
+// Its ring is sized in ticks, so a new update interval resizes it too
+void SystemMonitor::apply_flight_recorder_config(const SysMonConfig& config) {
+    if (flight_recorder_ && flight_recorder_->config() == config.flight_recorder &&
+        flight_recorder_->update_interval() == config.update_interval) {
+        return;
+    }
+    flight_recorder_.reset();
+    if (config.flight_recorder.enabled) {
+        flight_recorder_ = std::make_unique<FlightRecorder>(config.flight_recorder, config.update_interval);
+    }
+}
+
+void SystemMonitor::apply_reload(const ConfigSnapshot& config) {
+    ConfigDiff diff = diff_configs(*applied_config_, *config);
+    applied_config_ = config;
+    apply_trace_config(*config);
+    apply_flight_recorder_config(*config);
+    SYSMON_TRACE(Info, "reload changed {} sections", diff.sections.size());
+    if (diff.empty()) {
+        std::cout << "Config reloaded, nothing changed\n";
+        return;
+    }
+    std::cout << "Config reloaded, changed:";
+    for (const auto& section : diff.sections) {
+        std::cout << " " << section;
+    }
+    std::cout << "\n";
+    
+    // Sections read from the snapshot every tick need nothing here. A new
+    // fs_root needs a new collector, which starts its CPU deltas afresh.
+    if (diff.collector) {
+        metrics_collector_ = create_metrics_collector(config->fs_root);
+    }
+    metrics_collector_->set_config(config);
+    if (diff.display) {
+        display_->update_config(config->display);
+    }
+    if (diff.alerts) {
+        alert_engine_->update_config(config->alerts);
+    }
+    if (diff.services) {
+        apply_service_config(*config);
+    }
+}
+
 void SystemMonitor::run() {
     if (!metrics_collector_ || !alert_engine_ || !display_) {
         std::cerr << "System monitor not initialized. Call initialize() first.\n";
@@ -47,13 +158,120 @@ void SystemMonitor::run() {
     monitoring_loop();
 }
 
+void SystemMonitor::run_aggregator() {
+    if (!display_) {
+        std::cerr << "System monitor not initialized. Call initialize() first.\n";
+        return;
+    }
+    
+    ConfigSnapshot initial = config_manager_.snapshot();
+    FleetAggregator aggregator(initial->aggregator, initial->quantiles);
+    if (!aggregator.is_running()) {
+        return;
+    }
+    std::cout << "SysMon aggregator listening on port " << aggregator.port() << " (TCP and UDP)\n";
+    
+    running_ = true;
+    while (running_) {
+        if (config_manager_.check_and_reload()) {
+            const SysMonConfig& reloaded = config_manager_.get_config();
+            display_->update_config(reloaded.display);
+            if (!(reloaded.aggregator == initial->aggregator) || !(reloaded.quantiles == initial->quantiles)) {
+                std::cerr << "Warning: aggregator and quantiles settings take effect on restart\n";
+            }
+        }
+        ConfigSnapshot config_snapshot = config_manager_.snapshot();
+        const SysMonConfig& config = *config_snapshot;
+        
+        display_->render_fleet(aggregator.summary(), config.cpu, config.memory, config.disk);
+        config_manager_.wait_for_change(std::chrono::seconds(config.update_interval));
+    }
+}
+
+bool SystemMonitor::start_recording(const std::string& path) {
+    recorder_ = std::make_unique<RecordingWriter>(path, preferred_recording_codec());
+    if (!recorder_->is_open()) {
+        recorder_.reset();
+        return false;
+    }
+    return true;
+}
+
+void SystemMonitor::run_replay(const std::string& path, double speed) {
+    if (!alert_engine_ || !display_) {
+        std::cerr << "System monitor not initialized. Call initialize() first.\n";
+        return;
+    }
+    
+    RecordingReader reader(path);
+    if (!reader.is_open()) {
+        return;
+    }
+    
+    ConfigSnapshot config_snapshot = config_manager_.snapshot();
+    const SysMonConfig& config = *config_snapshot;
+    auto started = std::chrono::steady_clock::now();
+    auto last_render = std::chrono::steady_clock::time_point{};
+    std::chrono::system_clock::time_point first_sample;
+    std::chrono::system_clock::time_point previous_sample;
+    uint64_t samples = 0;
+    uint64_t warnings = 0;
+    uint64_t criticals = 0;
+    bool rendered = false;
+    
+    MetricSnapshot snapshot;
+    running_ = true;
+    while (running_ && reader.next(snapshot)) {
+        if (samples == 0) {
+            first_sample = snapshot.wall_time;
+        } else if (speed > 0 && snapshot.wall_time > previous_sample) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(
+                std::chrono::duration<double>(snapshot.wall_time - previous_sample).count() / speed));
+        }
+        previous_sample = snapshot.wall_time;
+        ++samples;
+        
+        // Labels are configuration, not part of the recording
+        for (auto& disk : snapshot.disks) {
+            for (const auto& mp : config.disk.mount_points) {
+                if (mp.path == disk.mount_point) {
+                    disk.label = mp.label;
+                }
+            }
+        }
+        
+        evaluate(snapshot, config);
+        for (const auto& alert : *active_alerts_) {
+            (alert.level == AlertLevel::Critical ? criticals : warnings)++;
+        }
+        
+        // Unthrottled replay only shows a frame every 100 ms
+        auto now = std::chrono::steady_clock::now();
+        rendered = speed > 0 || now - last_render >= std::chrono::milliseconds(100);
+        if (rendered) {
+            render(snapshot, config);
+            last_render = now;
+        }
+    }
+    if (samples > 0 && !rendered) {
+        render(snapshot, config);
+    }
+    
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    double recorded = std::chrono::duration<double>(previous_sample - first_sample).count();
+    std::cout << "\nReplayed " << samples << " samples from " << (reader.host().empty() ? "unknown host" : reader.host())
+              << " (" << static_cast<int64_t>(recorded) << " s recorded) in " << elapsed << " s: "
+              << warnings << " warning and " << criticals << " critical alerts\n";
+    if (reader.truncated()) {
+        std::cerr << "Warning: " << path << " ends with a corrupt or incomplete block\n";
+    }
+}
+
 void SystemMonitor::stop() {
     running_ = false;
 }
 
 void SystemMonitor::monitoring_loop() {
-    const auto& config = config_manager_.get_config();
-    
     std::cout << "SysMon started. Monitoring system with config: " << config_path_ << "\n";
     std::cout << "Press Ctrl+C to exit.\n\n";
     
@@ -61,29 +279,48 @@ void SystemMonitor::monitoring_loop() {
     
     while (running_) {
         auto loop_start = std::chrono::steady_clock::now();
+        self_stats_.begin_tick();
         
         // Hot-reload configuration if changed
-        if (config_manager_.check_and_reload()) {
-            const auto& new_config = config_manager_.get_config();
-            display_->update_config(new_config.display);
-            alert_engine_->update_config(new_config.alerts);
+        {
+            SelfStats::Scope timed(&self_stats_, Stage::Reload);
+            if (config_manager_.check_and_reload()) {
+                apply_reload(config_manager_.snapshot());
+            }
         }
         
-        const auto& current_config = config_manager_.get_config();
+        // One snapshot for the whole tick, however reloads interleave
+        ConfigSnapshot config_snapshot = config_manager_.snapshot();
+        const SysMonConfig& current_config = *config_snapshot;
         
-        // Collect metrics
-        CpuMetrics cpu_metrics;
-        MemoryMetrics memory_metrics;
-        std::vector<DiskMetrics> disk_metrics;
-        std::vector<NetworkMetrics> network_metrics;
+        // Collect metrics; the query server keeps the snapshot after publish
+        auto shared_snapshot = std::make_shared<MetricSnapshot>();
+        MetricSnapshot& snapshot = *shared_snapshot;
+        snapshot.timestamp = loop_start;
+        snapshot.wall_time = std::chrono::system_clock::now();
+        CpuMetrics& cpu_metrics = snapshot.cpu;
+        MemoryMetrics& memory_metrics = snapshot.memory;
+        std::vector<DiskMetrics>& disk_metrics = snapshot.disks;
+        std::vector<NetworkMetrics>& network_metrics = snapshot.network;
         
         if (current_config.cpu.enabled) {
+            SelfStats::Scope timed(&self_stats_, Stage::CollectCpu);
             cpu_metrics = metrics_collector_->collect_cpu();
+            if (current_config.interrupts.enabled) {
+                cpu_metrics.interrupts = metrics_collector_->collect_interrupts();
+            }
         }
         if (current_config.memory.enabled) {
+            SelfStats::Scope timed(&self_stats_, Stage::CollectMemory);
             memory_metrics = metrics_collector_->collect_memory();
+            if (current_config.numa.enabled) {
+                memory_metrics.numa = metrics_collector_->collect_numa();
+                numa_cpu_usage(memory_metrics.numa, cpu_metrics.per_core_usage,
+                               metrics_collector_->online_cpus());
+            }
         }
         if (current_config.disk.enabled) {
+            SelfStats::Scope timed(&self_stats_, Stage::CollectDisk);
             std::vector<std::string> mount_points;
             for (const auto& mp : current_config.disk.mount_points) {
                 mount_points.push_back(mp.path);
@@ -94,8 +331,10 @@ void SystemMonitor::monitoring_loop() {
             for (size_t i = 0; i < disk_metrics.size() && i < current_config.disk.mount_points.size(); ++i) {
                 disk_metrics[i].label = current_config.disk.mount_points[i].label;
             }
+            disk_forecaster_.update(disk_metrics, loop_start, current_config.disk);
         }
         if (current_config.network.enabled) {
+            SelfStats::Scope timed(&self_stats_, Stage::CollectNetwork);
             network_metrics = metrics_collector_->collect_network(current_config.network.interfaces);
             
             // Calculate bandwidth rates from previous samples
@@ -123,53 +362,128 @@ void SystemMonitor::monitoring_loop() {
                 prev_samples[net.interface_name] = {net.bytes_received, net.bytes_sent, now};
             }
         }
-        
-        // Update history
-        cpu_history_.push_back(cpu_metrics.overall_usage);
-        memory_history_.push_back(memory_metrics.usage_percent);
-        if (cpu_history_.size() > static_cast<size_t>(current_config.history_size)) {
-            cpu_history_.pop_front();
-            memory_history_.pop_front();
+        {
+            // Also closes the counters once the perf section is disabled
+            SelfStats::Scope timed(current_config.perf.enabled ? &self_stats_ : nullptr, Stage::CollectPerf);
+            cpu_metrics.perf = metrics_collector_->collect_perf();
         }
         
-        active_alerts_.clear();
-        if (current_config.cpu.enabled) {
-            auto cpu_alerts = alert_engine_->check_cpu(cpu_metrics, current_config.cpu);
-            active_alerts_.insert(active_alerts_.end(), cpu_alerts.begin(), cpu_alerts.end());
-        }
-        if (current_config.memory.enabled) {
-            auto mem_alerts = alert_engine_->check_memory(memory_metrics, current_config.memory);
-            active_alerts_.insert(active_alerts_.end(), mem_alerts.begin(), mem_alerts.end());
-        }
-        if (current_config.disk.enabled) {
-            auto disk_alerts = alert_engine_->check_disk(disk_metrics, current_config.disk);
-            active_alerts_.insert(active_alerts_.end(), disk_alerts.begin(), disk_alerts.end());
-        }
-        
-        // Log
-        for (const auto& alert : active_alerts_) {
-            alert_engine_->log_alert(alert);
+        evaluate(snapshot, current_config);
+        bool critical = false;
+        for (const auto& alert : *active_alerts_) {
             if (alert.level == AlertLevel::Critical) {
                 alert_engine_->beep_if_enabled();
+                critical = true;
+            }
+        }
+        
+        {
+            SelfStats::Scope timed(&self_stats_, Stage::Publish);
+            if (exporter_) {
+                exporter_->publish(snapshot, *active_alerts_, sketches_.get(), &self_stats_);
+            }
+            if (query_server_) {
+                query_server_->publish(shared_snapshot, active_alerts_);
+            }
+            if (shm_publisher_) {
+                shm_publisher_->publish(snapshot);
+            }
+            if (push_sink_) {
+                push_sink_->submit(snapshot);
+            }
+            if (recorder_) {
+                recorder_->append(snapshot);
+            }
+            if (flight_recorder_) {
+                flight_recorder_->record(snapshot);
+                if (flight_dump_requested_.exchange(false, std::memory_order_relaxed)) {
+                    flight_recorder_->dump("signal");
+                } else if (critical) {
+                    flight_recorder_->dump_on_critical(loop_start);
+                }
             }
         }
         
-        display_->render(cpu_metrics, memory_metrics, disk_metrics, network_metrics, active_alerts_, 
-                        cpu_history_, memory_history_,
-                        current_config.cpu,
-                        current_config.memory,
-                        current_config.disk,
-                        current_config.network,
-                        current_config.update_interval);
+        render(snapshot, current_config);
+        self_stats_.end_tick(std::chrono::seconds(current_config.update_interval));
         
         auto loop_end = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(loop_end - loop_start);
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(loop_end - loop_start);
         auto sleep_duration = std::chrono::seconds(current_config.update_interval) - elapsed;
         
+        // A config change ends the wait; the next tick starts by applying it
         if (sleep_duration.count() > 0) {
-            std::this_thread::sleep_for(sleep_duration);
+            config_manager_.wait_for_change(sleep_duration);
         }
     }
 }
 
+// Update history and sketches, then check and log alerts for one snapshot
+void SystemMonitor::evaluate(const MetricSnapshot& snapshot, const SysMonConfig& config) {
+    cpu_history_.push_back(snapshot.cpu.overall_usage);
+    memory_history_.push_back(snapshot.memory.usage_percent);
+    while (cpu_history_.size() > static_cast<size_t>(config.history_size)) {
+        cpu_history_.pop_front();
+        memory_history_.pop_front();
+    }
+    if (sketches_) {
+        sketches_->observe(snapshot, snapshot.timestamp);
+    }
+    
+    std::vector<Alert> alerts;
+    {
+        SelfStats::Scope timed(&self_stats_, Stage::Alerts);
+        if (config.cpu.enabled) {
+            auto cpu_alerts = alert_engine_->check_cpu(snapshot.cpu, config.cpu);
+            alerts.insert(alerts.end(), cpu_alerts.begin(), cpu_alerts.end());
+            auto topology_alerts = alert_engine_->check_topology(snapshot.cpu.topology, config.cpu);
+            alerts.insert(alerts.end(), topology_alerts.begin(), topology_alerts.end());
+        }
+        if (config.memory.enabled) {
+            auto mem_alerts = alert_engine_->check_memory(snapshot.memory, config.memory);
+            alerts.insert(alerts.end(), mem_alerts.begin(), mem_alerts.end());
+            auto numa_alerts = alert_engine_->check_numa(snapshot.memory.numa, config.numa);
+            alerts.insert(alerts.end(), numa_alerts.begin(), numa_alerts.end());
+        }
+        if (config.disk.enabled) {
+            auto disk_alerts = alert_engine_->check_disk(snapshot.disks, config.disk);
+            alerts.insert(alerts.end(), disk_alerts.begin(), disk_alerts.end());
+        }
+        if (config.cpu.enabled) {
+            auto sched_alerts = alert_engine_->check_scheduler(snapshot.cpu.scheduler, config.scheduler);
+            alerts.insert(alerts.end(), sched_alerts.begin(), sched_alerts.end());
+            auto irq_alerts = alert_engine_->check_interrupts(snapshot.cpu.interrupts, config.interrupts);
+            alerts.insert(alerts.end(), irq_alerts.begin(), irq_alerts.end());
+        }
+        auto rule_alerts = alert_engine_->check_rules(snapshot);
+        alerts.insert(alerts.end(), rule_alerts.begin(), rule_alerts.end());
+        auto anomaly_alerts = alert_engine_->check_anomalies(snapshot, config);
+        alerts.insert(alerts.end(), anomaly_alerts.begin(), anomaly_alerts.end());
+    }
+    
+    // Stamp alerts with the sample's time so replayed alerts log when they happened
+    SelfStats::Scope timed(&self_stats_, Stage::Log);
+    for (auto& alert : alerts) {
+        alert.timestamp = snapshot.wall_time;
+        alert.monotonic = snapshot.timestamp;
+        alert_engine_->log_alert(alert);
+    }
+    self_stats_.set_log_dropped(alert_engine_->log_records_dropped());
+    // A fresh list each tick, so the query server can keep the old one
+    active_alerts_ = std::make_shared<const std::vector<Alert>>(std::move(alerts));
+}
+
+void SystemMonitor::render(const MetricSnapshot& snapshot, const SysMonConfig& config) {
+    SelfStats::Scope timed(&self_stats_, Stage::Render);
+    display_->render(snapshot.cpu, snapshot.memory, snapshot.disks, snapshot.network, *active_alerts_,
+                    cpu_history_, memory_history_,
+                    config.cpu,
+                    config.memory,
+                    config.disk,
+                    config.network,
+                    config.update_interval,
+                    sketches_.get(),
+                    &self_stats_);
+}
+
 } // namespace sysmon
@@ -0,0 +1,305 @@
+#include "sysmon/trace.hpp"
+#include <cinttypes>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace sysmon::trace {
+
+namespace {
+
+struct Site {
+    Level level;
+    const char* file;
+    int line;
+    const char* format;
+};
+
+// Sites only grow. Rings are handed out to threads and come back to the
+// free list once their thread has exited and drain() has read them out.
+// Both are touched under the mutex at registration and drain time, never
+// on the write path.
+struct Registry {
+    std::mutex mutex;
+    std::deque<Site> sites;
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::vector<Ring*> active;
+    std::vector<Ring*> free;
+    uint32_t next_thread = 0;
+    std::mutex drain_mutex;
+    int64_t epoch_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+};
+
+Registry& registry() {
+    static Registry* instance = new Registry();   // outlives threads tracing during exit
+    return *instance;
+}
+
+const char* level_name(Level level) {
+    switch (level) {
+        case Level::Debug: return "DEBUG";
+        case Level::Info: return "INFO";
+        case Level::Warn: return "WARN";
+    }
+    return "?";
+}
+
+const char* base_name(const char* path) {
+    const char* name = path;
+    for (const char* p = path; *p; ++p) {
+        if (*p == '/' || *p == '\\') {
+            name = p + 1;
+        }
+    }
+    return name;
+}
+
+// Append the record's arguments into the site's format string
+void format_record(std::string& line, const char* format, const Record& record) {
+    size_t offset = 0;
+    size_t arg = 0;
+    auto next = [&](bool hex) {
+        if (arg >= record.count) {
+            line += "{?}";
+            return;
+        }
+        auto kind = static_cast<ArgKind>((record.kinds >> (4 * arg)) & 0xF);
+        ++arg;
+        char buffer[32];
+        int64_t i;
+        uint64_t u;
+        double d;
+        switch (kind) {
+            case ArgKind::Int:
+                std::memcpy(&i, record.slots + offset, 8);
+                std::snprintf(buffer, sizeof(buffer), hex ? "%" PRIx64 : "%" PRId64, i);
+                line += buffer;
+                offset += 8;
+                break;
+            case ArgKind::Uint:
+                std::memcpy(&u, record.slots + offset, 8);
+                std::snprintf(buffer, sizeof(buffer), hex ? "%" PRIx64 : "%" PRIu64, u);
+                line += buffer;
+                offset += 8;
+                break;
+            case ArgKind::Double:
+                std::memcpy(&d, record.slots + offset, 8);
+                std::snprintf(buffer, sizeof(buffer), "%g", d);
+                line += buffer;
+                offset += 8;
+                break;
+            case ArgKind::String: {
+                size_t length = record.slots[offset];
+                line.append(reinterpret_cast<const char*>(record.slots + offset + 1), length);
+                offset += (1 + length + 7) / 8 * 8;
+                break;
+            }
+            case ArgKind::None:
+                break;
+        }
+    };
+    for (const char* p = format; *p; ++p) {
+        if (p[0] == '{' && p[1] == '}') {
+            next(false);
+            ++p;
+        } else if (p[0] == '{' && p[1] == 'x' && p[2] == '}') {
+            next(true);
+            p += 2;
+        } else {
+            line += *p;
+        }
+    }
+}
+
+} // namespace
+
+namespace detail {
+
+std::atomic<bool> g_enabled{false};
+
+Ring* register_ring() {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    Ring* ring;
+    if (!reg.free.empty()) {
+        // Fully drained, so head == tail and the sequence carries on
+        ring = reg.free.back();
+        reg.free.pop_back();
+        ring->retired.store(false, std::memory_order_relaxed);
+    } else {
+        reg.rings.push_back(std::make_unique<Ring>());
+        ring = reg.rings.back().get();
+    }
+    ring->thread = reg.next_thread++;
+    reg.active.push_back(ring);
+    return ring;
+}
+
+void retire_ring(Ring* ring) {
+    ring->retired.store(true, std::memory_order_release);
+}
+
+} // namespace detail
+
+size_t ring_count() {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    return reg.rings.size();
+}
+
+namespace detail {
+
+} // namespace detail
+
+void set_enabled(bool on) {
+    detail::g_enabled.store(on, std::memory_order_relaxed);
+}
+
+uint16_t register_site(Level level, const char* file, int line, const char* format) {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    if (reg.sites.size() >= UINT16_MAX) {
+        return UINT16_MAX;   // reported as an unknown site
+    }
+    reg.sites.push_back({level, base_name(file), line, format});
+    return static_cast<uint16_t>(reg.sites.size() - 1);
+}
+
+size_t drain(std::ostream& out) {
+    auto& reg = registry();
+    std::lock_guard<std::mutex> drain_lock(reg.drain_mutex);
+
+    struct Entry {
+        Record record;
+        uint32_t thread;
+    };
+    std::vector<Entry> entries;
+    std::vector<std::pair<uint32_t, uint64_t>> lost;
+    std::vector<Ring*> rings;
+    std::vector<Ring*> drained;
+    {
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        rings = reg.active;
+    }
+
+    for (Ring* ring : rings) {
+        // Read before head: a retired owner wrote its last record already
+        bool retired = ring->retired.load(std::memory_order_acquire);
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        if (head - ring->tail > kRingRecords) {
+            lost.emplace_back(ring->thread, head - kRingRecords - ring->tail);
+            ring->tail = head - kRingRecords;
+        }
+        // Records the owner overwrites while they are copied are dropped
+        uint64_t overwritten = 0;
+        for (uint64_t i = ring->tail; i < head; ++i) {
+            Record& record = ring->records[i % kRingRecords];
+            std::atomic_ref<uint64_t> seq(record.seq);
+            if (seq.load(std::memory_order_acquire) != i + 1) {
+                ++overwritten;
+                continue;
+            }
+            Entry entry{record, ring->thread};
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq.load(std::memory_order_relaxed) != i + 1) {
+                ++overwritten;
+                continue;
+            }
+            entries.push_back(entry);
+        }
+        if (overwritten > 0) {
+            lost.emplace_back(ring->thread, overwritten);
+        }
+        ring->tail = head;
+        if (retired) {
+            drained.push_back(ring);
+        }
+    }
+
+    if (!drained.empty()) {
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (Ring* ring : drained) {
+            reg.active.erase(std::find(reg.active.begin(), reg.active.end(), ring));
+            reg.free.push_back(ring);
+        }
+    }
+
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.record.time_ns < b.record.time_ns;
+    });
+
+    std::vector<Site> sites;
+    {
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        sites.assign(reg.sites.begin(), reg.sites.end());
+    }
+
+    std::string line;
+    for (const auto& [thread, count] : lost) {
+        out << "[WARN] trace: " << count << " records lost on thread t" << thread << " (ring full)\n";
+    }
+    for (const auto& entry : entries) {
+        const Record& record = entry.record;
+        line.clear();
+        char prefix[64];
+        double seconds = static_cast<double>(record.time_ns - reg.epoch_ns) / 1e9;
+        if (record.site < sites.size()) {
+            const Site& site = sites[record.site];
+            std::snprintf(prefix, sizeof(prefix), "[%s] +%.6f t%u ", level_name(site.level), seconds, entry.thread);
+            line += prefix;
+            line += site.file;
+            line += ':';
+            line += std::to_string(site.line);
+            line += ' ';
+            format_record(line, site.format, record);
+        } else {
+            std::snprintf(prefix, sizeof(prefix), "[?] +%.6f t%u unknown trace site", seconds, entry.thread);
+            line += prefix;
+        }
+        line += '\n';
+        out << line;
+    }
+    out.flush();
+    return entries.size();
+}
+
+Writer::Writer(const std::string& path, std::chrono::milliseconds interval)
+    : path_(path)
+    , out_(&std::cerr)
+    , interval_(interval)
+{
+    if (!path.empty()) {
+        file_.open(path, std::ios::app);
+        if (file_) {
+            out_ = &file_;
+        } else {
+            std::cerr << "Warning: cannot open trace file " << path << ", tracing to stderr\n";
+        }
+    }
+    thread_ = std::thread(&Writer::run, this);
+}
+
+Writer::~Writer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    thread_.join();
+    drain(*out_);
+}
+
+void Writer::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        wake_.wait_for(lock, interval_, [this] { return stopping_; });
+        lock.unlock();
+        drain(*out_);
+        lock.lock();
+    }
+}
+
+} // namespace sysmon::trace
@@ -0,0 +1,529 @@
+#include "sysmon/wire_format.hpp"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+namespace sysmon {
+
+namespace {
+
+int64_t centi(double percent) {
+    return std::llround(percent * 100.0);
+}
+
+int64_t kbps(double mbps) {
+    return std::llround(mbps * 1000.0);
+}
+
+int64_t count(uint32_t value) {
+    return static_cast<int64_t>(value);
+}
+
+constexpr uint8_t kLayout = 1;
+constexpr uint8_t kScheduler = 2;
+constexpr uint8_t kInterrupts = 4;
+constexpr uint8_t kCoreInterrupts = 8;
+
+// Fill f from s; returns which optional sections s carries
+uint8_t quantize(const MetricSnapshot& s, WireFrame& f) {
+    f.timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(s.wall_time.time_since_epoch()).count();
+    f.cpu = centi(s.cpu.overall_usage);
+    f.iowait = centi(s.cpu.iowait_percent);
+    f.cores.resize(s.cpu.per_core_usage.size());
+    for (size_t i = 0; i < f.cores.size(); ++i) {
+        f.cores[i] = centi(s.cpu.per_core_usage[i]);
+    }
+    const auto& m = s.memory;
+    f.memory = {static_cast<int64_t>(m.total_bytes), static_cast<int64_t>(m.used_bytes),
+                static_cast<int64_t>(m.available_bytes), centi(m.usage_percent),
+                static_cast<int64_t>(m.swap_total_bytes), static_cast<int64_t>(m.swap_used_bytes)};
+    f.disks.resize(s.disks.size());
+    for (size_t i = 0; i < f.disks.size(); ++i) {
+        const auto& d = s.disks[i];
+        int64_t eta = d.seconds_to_full >= 0.0 ? std::llround(d.seconds_to_full) : -1;
+        f.disks[i] = {static_cast<int64_t>(d.total_bytes), static_cast<int64_t>(d.used_bytes),
+                      centi(d.usage_percent), eta, std::llround(d.growth_bytes_per_sec)};
+    }
+    f.nics.resize(s.network.size());
+    for (size_t i = 0; i < f.nics.size(); ++i) {
+        const auto& n = s.network[i];
+        f.nics[i] = {static_cast<int64_t>(n.bytes_received), static_cast<int64_t>(n.bytes_sent),
+                     kbps(n.download_mbps), kbps(n.upload_mbps)};
+    }
+
+    uint8_t sections = 0;
+    const auto& sched = s.cpu.scheduler;
+    if (sched.available) {
+        sections |= kScheduler;
+        f.scheduler = {centi(sched.context_switches_per_sec), centi(sched.interrupts_per_sec),
+                       centi(sched.softirqs_per_sec), centi(sched.forks_per_sec),
+                       count(sched.procs_running), count(sched.procs_blocked), count(sched.threads),
+                       centi(sched.run_queue_per_core), centi(sched.load1), centi(sched.load5),
+                       centi(sched.load15)};
+    } else {
+        f.scheduler = {};
+    }
+    const auto& irq = s.cpu.interrupts;
+    if (irq.available) {
+        sections |= kInterrupts;
+        f.interrupts = {centi(irq.irq_total), centi(irq.softirq_total), centi(irq.net_softirq_total),
+                        centi(irq.imbalance), irq.busiest_cpu};
+    } else {
+        f.interrupts = {};
+    }
+    size_t cores = f.cores.size();
+    bool per_cpu = irq.available && irq.irq_per_cpu.size() == cores &&
+                   irq.softirq_per_cpu.size() == cores && irq.net_softirq_per_cpu.size() == cores;
+    f.core_interrupts.resize(cores);
+    for (size_t i = 0; i < cores; ++i) {
+        f.core_interrupts[i] = per_cpu ? std::array<int64_t, 3>{centi(irq.irq_per_cpu[i]),
+                                                                 centi(irq.softirq_per_cpu[i]),
+                                                                 centi(irq.net_softirq_per_cpu[i])}
+                                       : std::array<int64_t, 3>{};
+    }
+    if (per_cpu && cores > 0) {
+        sections |= kCoreInterrupts;
+    }
+    return sections;
+}
+
+void put_delta(std::string& out, int64_t value, int64_t prev) {
+    put_varint(out, zigzag(value - prev));
+}
+
+void put_name(std::string& out, const std::string& name) {
+    put_varint(out, name.size());
+    out.append(name);
+}
+
+bool get_delta(const char*& p, const char* end, int64_t& value) {
+    uint64_t raw;
+    if (!get_varint(p, end, raw)) return false;
+    value += unzigzag(raw);
+    return true;
+}
+
+bool get_name(const char*& p, const char* end, std::string& out) {
+    uint64_t len;
+    if (!get_varint(p, end, len) || len > static_cast<uint64_t>(end - p)) return false;
+    out.assign(p, len);
+    p += len;
+    return true;
+}
+
+// Line protocol tag values escape commas, spaces and equals signs
+void append_tag(std::string& out, std::string_view key, std::string_view value) {
+    out.push_back(',');
+    out.append(key);
+    out.push_back('=');
+    for (char c : value) {
+        if (c == ',' || c == ' ' || c == '=') out.push_back('\\');
+        out.push_back(c);
+    }
+}
+
+template<typename T>
+void append_number(std::string& out, T value) {
+    char buf[32];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr - buf);
+}
+
+void append_field(std::string& out, bool& first, std::string_view key, double value) {
+    out.push_back(first ? ' ' : ',');
+    first = false;
+    out.append(key);
+    out.push_back('=');
+    append_number(out, std::isfinite(value) ? value : 0.0);
+}
+
+void append_field(std::string& out, bool& first, std::string_view key, uint64_t value) {
+    out.push_back(first ? ' ' : ',');
+    first = false;
+    out.append(key);
+    out.push_back('=');
+    append_number(out, value);
+    out.push_back('u');
+}
+
+template<typename T>
+void put(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+} // namespace
+
+bool parse_wire_format(const std::string& name, WireFormat& out) {
+    if (name == "binary") {
+        out = WireFormat::Binary;
+    } else if (name == "line") {
+        out = WireFormat::LineProtocol;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void put_varint(std::string& out, uint64_t value) {
+    char buf[10];
+    size_t n = 0;
+    while (value >= 0x80) {
+        buf[n++] = static_cast<char>(value | 0x80);
+        value >>= 7;
+    }
+    buf[n++] = static_cast<char>(value);
+    out.append(buf, n);
+}
+
+bool get_varint(const char*& p, const char* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t byte = static_cast<uint8_t>(*p++);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void WireEncoder::begin(std::string& out, std::string_view host) {
+    out.append(kWireMagic, sizeof(kWireMagic));
+    put_varint(out, host.size());
+    out.append(host);
+    prev_ = WireFrame{};
+    disk_names_.clear();
+    nic_names_.clear();
+    frames_ = 0;
+}
+
+void WireEncoder::append(std::string& out, const MetricSnapshot& snapshot) {
+    uint8_t sections = quantize(snapshot, cur_);
+
+    bool layout = frames_ == 0 || cur_.cores.size() != prev_.cores.size() ||
+                  snapshot.disks.size() != disk_names_.size() || snapshot.network.size() != nic_names_.size();
+    for (size_t i = 0; !layout && i < disk_names_.size(); ++i) {
+        layout = snapshot.disks[i].mount_point != disk_names_[i];
+    }
+    for (size_t i = 0; !layout && i < nic_names_.size(); ++i) {
+        layout = snapshot.network[i].interface_name != nic_names_[i];
+    }
+
+    put_delta(out, cur_.timestamp_ms, prev_.timestamp_ms);
+    out.push_back(static_cast<char>(sections | (layout ? kLayout : 0)));
+    if (layout) {
+        // Entity values restart from zero under a new layout
+        prev_.cores.assign(cur_.cores.size(), 0);
+        prev_.disks.assign(cur_.disks.size(), {});
+        prev_.nics.assign(cur_.nics.size(), {});
+        prev_.core_interrupts.assign(cur_.cores.size(), {});
+        disk_names_.resize(snapshot.disks.size());
+        nic_names_.resize(snapshot.network.size());
+
+        put_varint(out, cur_.cores.size());
+        put_varint(out, snapshot.disks.size());
+        for (size_t i = 0; i < snapshot.disks.size(); ++i) {
+            disk_names_[i] = snapshot.disks[i].mount_point;
+            put_name(out, disk_names_[i]);
+        }
+        put_varint(out, snapshot.network.size());
+        for (size_t i = 0; i < snapshot.network.size(); ++i) {
+            nic_names_[i] = snapshot.network[i].interface_name;
+            put_name(out, nic_names_[i]);
+        }
+    }
+
+    put_delta(out, cur_.cpu, prev_.cpu);
+    put_delta(out, cur_.iowait, prev_.iowait);
+    for (size_t i = 0; i < cur_.cores.size(); ++i) {
+        put_delta(out, cur_.cores[i], prev_.cores[i]);
+    }
+    for (size_t i = 0; i < cur_.memory.size(); ++i) {
+        put_delta(out, cur_.memory[i], prev_.memory[i]);
+    }
+    for (size_t d = 0; d < cur_.disks.size(); ++d) {
+        for (size_t i = 0; i < cur_.disks[d].size(); ++i) {
+            put_delta(out, cur_.disks[d][i], prev_.disks[d][i]);
+        }
+    }
+    for (size_t n = 0; n < cur_.nics.size(); ++n) {
+        for (size_t i = 0; i < 4; ++i) {
+            put_delta(out, cur_.nics[n][i], prev_.nics[n][i]);
+        }
+    }
+    // Absent sections are zero on both sides, so deltas stay in step
+    if (sections & kScheduler) {
+        for (size_t i = 0; i < cur_.scheduler.size(); ++i) {
+            put_delta(out, cur_.scheduler[i], prev_.scheduler[i]);
+        }
+    }
+    if (sections & kInterrupts) {
+        for (size_t i = 0; i < cur_.interrupts.size(); ++i) {
+            put_delta(out, cur_.interrupts[i], prev_.interrupts[i]);
+        }
+    }
+    if (sections & kCoreInterrupts) {
+        for (size_t c = 0; c < cur_.core_interrupts.size(); ++c) {
+            for (size_t i = 0; i < 3; ++i) {
+                put_delta(out, cur_.core_interrupts[c][i], prev_.core_interrupts[c][i]);
+            }
+        }
+    }
+
+    std::swap(prev_, cur_);
+    ++frames_;
+}
+
+bool WireDecoder::decode(std::string_view batch, std::string& host, std::vector<MetricSnapshot>& out) {
+    const char* p = batch.data();
+    const char* end = p + batch.size();
+    if (batch.size() < sizeof(kWireMagic)) {
+        return false;
+    }
+    bool v1 = std::memcmp(p, kWireMagicV1, sizeof(kWireMagicV1)) == 0;
+    if (!v1 && std::memcmp(p, kWireMagic, sizeof(kWireMagic)) != 0) {
+        return false;
+    }
+    p += sizeof(kWireMagic);
+    if (!get_name(p, end, host)) {
+        return false;
+    }
+
+    prev_ = WireFrame{};
+    bool have_layout = false;
+    while (p < end) {
+        WireFrame& f = prev_;
+        if (!get_delta(p, end, f.timestamp_ms) || p >= end) return false;
+        uint8_t flags = static_cast<uint8_t>(*p++);
+        if (v1 && (flags & ~kLayout)) return false;
+        if (flags & kLayout) {
+            uint64_t count;
+            if (!get_varint(p, end, count) || count > batch.size()) return false;
+            f.cores.assign(count, 0);
+            if (!get_varint(p, end, count) || count > batch.size()) return false;
+            disk_names_.resize(count);
+            for (auto& name : disk_names_) {
+                if (!get_name(p, end, name)) return false;
+            }
+            if (!get_varint(p, end, count) || count > batch.size()) return false;
+            nic_names_.resize(count);
+            for (auto& name : nic_names_) {
+                if (!get_name(p, end, name)) return false;
+            }
+            f.disks.assign(disk_names_.size(), {});
+            f.nics.assign(nic_names_.size(), {});
+            f.core_interrupts.assign(f.cores.size(), {});
+            have_layout = true;
+        }
+        if (!have_layout) return false;
+
+        if (!get_delta(p, end, f.cpu) || !get_delta(p, end, f.iowait)) return false;
+        for (auto& core : f.cores) {
+            if (!get_delta(p, end, core)) return false;
+        }
+        for (auto& value : f.memory) {
+            if (!get_delta(p, end, value)) return false;
+        }
+        for (auto& disk : f.disks) {
+            for (size_t i = 0; i < (v1 ? 4 : disk.size()); ++i) {
+                if (!get_delta(p, end, disk[i])) return false;
+            }
+        }
+        for (auto& nic : f.nics) {
+            for (auto& value : nic) {
+                if (!get_delta(p, end, value)) return false;
+            }
+        }
+        if (!(flags & kScheduler)) {
+            f.scheduler = {};
+        }
+        for (auto& value : f.scheduler) {
+            if ((flags & kScheduler) && !get_delta(p, end, value)) return false;
+        }
+        if (!(flags & kInterrupts)) {
+            f.interrupts = {};
+        }
+        for (auto& value : f.interrupts) {
+            if ((flags & kInterrupts) && !get_delta(p, end, value)) return false;
+        }
+        for (auto& core : f.core_interrupts) {
+            for (auto& value : core) {
+                if (!(flags & kCoreInterrupts)) {
+                    value = 0;
+                } else if (!get_delta(p, end, value)) {
+                    return false;
+                }
+            }
+        }
+
+        MetricSnapshot& s = out.emplace_back();
+        s.wall_time = std::chrono::system_clock::time_point(std::chrono::milliseconds(f.timestamp_ms));
+        s.cpu.overall_usage = f.cpu / 100.0;
+        s.cpu.iowait_percent = f.iowait / 100.0;
+        s.cpu.core_count = static_cast<uint32_t>(f.cores.size());
+        s.cpu.per_core_usage.resize(f.cores.size());
+        for (size_t i = 0; i < f.cores.size(); ++i) {
+            s.cpu.per_core_usage[i] = f.cores[i] / 100.0;
+        }
+        s.memory.total_bytes = static_cast<uint64_t>(f.memory[0]);
+        s.memory.used_bytes = static_cast<uint64_t>(f.memory[1]);
+        s.memory.available_bytes = static_cast<uint64_t>(f.memory[2]);
+        s.memory.usage_percent = f.memory[3] / 100.0;
+        s.memory.swap_total_bytes = static_cast<uint64_t>(f.memory[4]);
+        s.memory.swap_used_bytes = static_cast<uint64_t>(f.memory[5]);
+        s.disks.resize(f.disks.size());
+        for (size_t i = 0; i < f.disks.size(); ++i) {
+            auto& d = s.disks[i];
+            d.mount_point = disk_names_[i];
+            d.total_bytes = static_cast<uint64_t>(f.disks[i][0]);
+            d.used_bytes = static_cast<uint64_t>(f.disks[i][1]);
+            d.usage_percent = f.disks[i][2] / 100.0;
+            d.seconds_to_full = static_cast<double>(f.disks[i][3]);
+            d.growth_bytes_per_sec = static_cast<double>(f.disks[i][4]);
+        }
+        s.network.resize(f.nics.size());
+        for (size_t i = 0; i < f.nics.size(); ++i) {
+            auto& n = s.network[i];
+            n.interface_name = nic_names_[i];
+            n.bytes_received = static_cast<uint64_t>(f.nics[i][0]);
+            n.bytes_sent = static_cast<uint64_t>(f.nics[i][1]);
+            n.download_mbps = f.nics[i][2] / 1000.0;
+            n.upload_mbps = f.nics[i][3] / 1000.0;
+        }
+        if (flags & kScheduler) {
+            auto& sched = s.cpu.scheduler;
+            sched.available = true;
+            sched.context_switches_per_sec = f.scheduler[0] / 100.0;
+            sched.interrupts_per_sec = f.scheduler[1] / 100.0;
+            sched.softirqs_per_sec = f.scheduler[2] / 100.0;
+            sched.forks_per_sec = f.scheduler[3] / 100.0;
+            sched.procs_running = static_cast<uint32_t>(f.scheduler[4]);
+            sched.procs_blocked = static_cast<uint32_t>(f.scheduler[5]);
+            sched.threads = static_cast<uint32_t>(f.scheduler[6]);
+            sched.run_queue_per_core = f.scheduler[7] / 100.0;
+            sched.load1 = f.scheduler[8] / 100.0;
+            sched.load5 = f.scheduler[9] / 100.0;
+            sched.load15 = f.scheduler[10] / 100.0;
+        }
+        if (flags & kInterrupts) {
+            auto& irq = s.cpu.interrupts;
+            irq.available = true;
+            irq.irq_total = f.interrupts[0] / 100.0;
+            irq.softirq_total = f.interrupts[1] / 100.0;
+            irq.net_softirq_total = f.interrupts[2] / 100.0;
+            irq.imbalance = f.interrupts[3] / 100.0;
+            irq.busiest_cpu = static_cast<int>(f.interrupts[4]);
+            if (flags & kCoreInterrupts) {
+                size_t cores = f.core_interrupts.size();
+                irq.irq_per_cpu.resize(cores);
+                irq.softirq_per_cpu.resize(cores);
+                irq.net_softirq_per_cpu.resize(cores);
+                for (size_t i = 0; i < cores; ++i) {
+                    irq.irq_per_cpu[i] = f.core_interrupts[i][0] / 100.0;
+                    irq.softirq_per_cpu[i] = f.core_interrupts[i][1] / 100.0;
+                    irq.net_softirq_per_cpu[i] = f.core_interrupts[i][2] / 100.0;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void append_line_protocol(std::string& out, std::string_view host, const MetricSnapshot& snapshot) {
+    char ts[24];
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(snapshot.wall_time.time_since_epoch()).count();
+    std::string_view timestamp(ts, std::to_chars(ts, ts + sizeof(ts), ns).ptr - ts);
+    bool first;
+
+    if (snapshot.cpu.core_count > 0) {
+        out.append("sysmon_cpu");
+        append_tag(out, "host", host);
+        first = true;
+        append_field(out, first, "usage", snapshot.cpu.overall_usage);
+        append_field(out, first, "iowait", snapshot.cpu.iowait_percent);
+        out.push_back(' ');
+        out.append(timestamp);
+        out.push_back('\n');
+    }
+
+    const auto& m = snapshot.memory;
+    if (m.total_bytes > 0) {
+        out.append("sysmon_memory");
+        append_tag(out, "host", host);
+        first = true;
+        append_field(out, first, "total_bytes", m.total_bytes);
+        append_field(out, first, "used_bytes", m.used_bytes);
+        append_field(out, first, "available_bytes", m.available_bytes);
+        append_field(out, first, "usage", m.usage_percent);
+        append_field(out, first, "swap_total_bytes", m.swap_total_bytes);
+        append_field(out, first, "swap_used_bytes", m.swap_used_bytes);
+        out.push_back(' ');
+        out.append(timestamp);
+        out.push_back('\n');
+    }
+
+    for (const auto& d : snapshot.disks) {
+        out.append("sysmon_disk");
+        append_tag(out, "host", host);
+        append_tag(out, "mount", d.mount_point);
+        first = true;
+        append_field(out, first, "total_bytes", d.total_bytes);
+        append_field(out, first, "used_bytes", d.used_bytes);
+        append_field(out, first, "usage", d.usage_percent);
+        if (d.seconds_to_full >= 0.0) {
+            append_field(out, first, "seconds_to_full", d.seconds_to_full);
+        }
+        out.push_back(' ');
+        out.append(timestamp);
+        out.push_back('\n');
+    }
+
+    for (const auto& n : snapshot.network) {
+        out.append("sysmon_net");
+        append_tag(out, "host", host);
+        append_tag(out, "interface", n.interface_name);
+        first = true;
+        append_field(out, first, "rx_bytes", n.bytes_received);
+        append_field(out, first, "tx_bytes", n.bytes_sent);
+        append_field(out, first, "rx_mbps", n.download_mbps);
+        append_field(out, first, "tx_mbps", n.upload_mbps);
+        out.push_back(' ');
+        out.append(timestamp);
+        out.push_back('\n');
+    }
+}
+
+bool encode_push_message(std::string& out, WireFormat format, Codec codec, std::string_view raw) {
+    size_t start = out.size();
+    out.append(kPushMagic, sizeof(kPushMagic));
+    out.push_back(static_cast<char>(kPushVersion));
+    out.push_back(static_cast<char>(format));
+    out.push_back(static_cast<char>(codec));
+    out.push_back('\0');
+    put<uint32_t>(out, static_cast<uint32_t>(raw.size()));
+    put<uint32_t>(out, 0);
+
+    if (!compress_block(codec, raw, out)) {
+        out.resize(start);
+        return false;
+    }
+    uint32_t payload = static_cast<uint32_t>(out.size() - start - kPushHeaderSize);
+    std::memcpy(&out[start + 12], &payload, sizeof(payload));
+    return true;
+}
+
+bool parse_push_header(const char* data, size_t size, PushHeader& out) {
+    if (size < kPushHeaderSize || std::memcmp(data, kPushMagic, sizeof(kPushMagic)) != 0 ||
+        static_cast<uint8_t>(data[4]) != kPushVersion) {
+        return false;
+    }
+    out.format = static_cast<WireFormat>(data[5]);
+    out.codec = static_cast<Codec>(data[6]);
+    std::memcpy(&out.raw_size, data + 8, sizeof(uint32_t));
+    std::memcpy(&out.payload_size, data + 12, sizeof(uint32_t));
+    return out.raw_size <= kMaxPushPayload && out.payload_size <= kMaxPushPayload;
+}
+
+} // namespace sysmon
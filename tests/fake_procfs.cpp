@@ -0,0 +1,271 @@
+#include "fake_procfs.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+namespace sysmon::testing {
+
+namespace fs = std::filesystem;
+
+FakeProcfs::FakeProcfs(const FakeProcfsSpec& spec)
+    : spec_(spec)
+    , cores_(static_cast<size_t>(spec.cores))
+    , rx_(static_cast<size_t>(spec.interfaces))
+    , tx_(static_cast<size_t>(spec.interfaces))
+    , device_irqs_(static_cast<size_t>(spec.cores), 5000)
+    , net_rx_(static_cast<size_t>(spec.cores), 2000)
+    , timer_(100000)
+    , node_allocations_(static_cast<size_t>(spec.numa_nodes))
+{
+    root_ = (fs::temp_directory_path() / ("sysmon_procfs_" + std::to_string(std::random_device{}()))).string();
+    fs::create_directories(root_);
+
+    // Some uptime so that since-boot ratios differ from per-tick ones
+    for (size_t i = 0; i < cores_.size(); ++i) {
+        cores_[i] = {1000 + 10 * i, 500, 100000, 200};
+    }
+    for (size_t i = 0; i < rx_.size(); ++i) {
+        rx_[i] = 1000000 * (i + 1);
+        tx_[i] = 500000 * (i + 1);
+    }
+    write_net_dev();
+    write_interrupts();
+    set_memory(spec_.memory_kb / 2);
+    set_load(0.5, 0.4, 0.3, running_, blocked_);
+
+    std::string cpuinfo;
+    for (int i = 0; i < spec_.cores; ++i) {
+        cpuinfo += "processor\t: " + std::to_string(i) + "\nmodel name\t: Fake CPU @ 3.00GHz\n\n";
+    }
+    write("proc/cpuinfo", cpuinfo);
+
+    std::string mounts = "proc /proc proc rw 0 0\n";
+    for (int i = 0; i < spec_.disks; ++i) {
+        std::string dev(1, static_cast<char>('a' + i % 26));
+        mounts += "/dev/sd" + dev + "1 /mnt/disk" + std::to_string(i) + " ext4 rw 0 0\n";
+        fs::create_directories(root_ + "/mnt/disk" + std::to_string(i));
+        write("sys/block/sd" + dev + "/device/model", "FAKE SSD " + std::to_string(i) + "   \n");
+    }
+    write("proc/mounts", mounts);
+
+    if (spec_.packages > 0) {
+        write("sys/devices/system/cpu/online", "0-" + std::to_string(spec_.cores - 1) + "\n");
+        int physical = std::max(1, spec_.cores / std::max(1, spec_.threads_per_core));
+        int per_package = std::max(1, physical / spec_.packages);
+        for (int cpu = 0; cpu < spec_.cores; ++cpu) {
+            int core = cpu % physical;
+            std::string dir = "sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+            write(dir + "physical_package_id", std::to_string(core / per_package) + "\n");
+            // Core ids within a package are sparse on real hardware
+            write(dir + "core_id", std::to_string(2 * (core % per_package)) + "\n");
+        }
+    }
+
+    if (spec_.numa_nodes > 0) {
+        write("sys/devices/system/node/has_memory", spec_.numa_nodes == 1 ? "0\n" :
+              "0-" + std::to_string(spec_.numa_nodes - 1) + "\n");
+        int per_node = std::max(1, spec_.cores / spec_.numa_nodes);
+        for (int node = 0; node < spec_.numa_nodes; ++node) {
+            std::string dir = "sys/devices/system/node/node" + std::to_string(node);
+            write(dir + "/cpulist", std::to_string(node * per_node) + "-" + std::to_string((node + 1) * per_node - 1) + "\n");
+            set_node_memory(node, spec_.memory_kb / spec_.numa_nodes / 2);
+        }
+        write_numastat();
+    }
+
+    for (int i = 0; i < spec_.interfaces; ++i) {
+        write("sys/class/net/eth" + std::to_string(i) + "/device/uevent", "DRIVER=fakenet\nPCI_ID=8086:1533\n");
+    }
+}
+
+FakeProcfs::~FakeProcfs() {
+    std::error_code ec;
+    fs::remove_all(root_, ec);
+}
+
+std::vector<std::string> FakeProcfs::mount_points() const {
+    std::vector<std::string> result;
+    for (int i = 0; i < spec_.disks; ++i) {
+        result.push_back("/mnt/disk" + std::to_string(i));
+    }
+    return result;
+}
+
+void FakeProcfs::tick(double busy_percent, uint64_t rx_bytes, uint64_t tx_bytes) {
+    auto busy = static_cast<uint64_t>(busy_percent + 0.5);
+    for (auto& core : cores_) {
+        core.user += busy;
+        core.iowait += (100 - busy) / 10;
+        core.idle += 100 - busy - (100 - busy) / 10;
+    }
+    for (size_t i = 0; i < rx_.size(); ++i) {
+        rx_[i] += rx_bytes;
+        tx_[i] += tx_bytes;
+    }
+    context_switches_ += 5000;
+    interrupts_ += 2000;
+    softirqs_ += 1000;
+    forks_ += 10;
+    uint64_t cores = cores_.size();
+    for (size_t i = 0; i < cores; ++i) {
+        if (irq_core_ < 0) {
+            device_irqs_[i] += 1000;
+            net_rx_[i] += 500;
+        } else if (i == static_cast<size_t>(irq_core_)) {
+            device_irqs_[i] += 1000 * cores;
+            net_rx_[i] += 500 * cores;
+        }
+    }
+    timer_ += 250;
+    for (auto& node : node_allocations_) {
+        node.local += node.local_per_tick;
+        node.remote += node.remote_per_tick;
+    }
+    write_stat();
+    write_net_dev();
+    write_interrupts();
+    write_numastat();
+}
+
+void FakeProcfs::set_memory(uint64_t available_kb, uint64_t swap_total_kb, uint64_t swap_free_kb) {
+    auto line = [](const char* key, uint64_t kb) {
+        std::string padded = std::to_string(kb);
+        return std::string(key) + std::string(16 - std::min<size_t>(15, padded.size()), ' ') + padded + " kB\n";
+    };
+    write("proc/meminfo",
+          line("MemTotal:", spec_.memory_kb) +
+          line("MemFree:", available_kb / 2) +
+          line("MemAvailable:", available_kb) +
+          line("Buffers:", 1024) +
+          line("Cached:", available_kb / 4) +
+          line("SwapCached:", 0) +
+          line("SwapTotal:", swap_total_kb) +
+          line("SwapFree:", swap_free_kb));
+}
+
+void FakeProcfs::set_load(double load1, double load5, double load15, int running, int blocked) {
+    running_ = running;
+    blocked_ = blocked;
+    char loadavg[96];
+    std::snprintf(loadavg, sizeof(loadavg), "%.2f %.2f %.2f %d/%d 56789\n", load1, load5, load15, running, 300 + running);
+    write("proc/loadavg", loadavg);
+    write_stat();
+}
+
+void FakeProcfs::set_node_memory(int node, uint64_t free_kb) {
+    auto line = [node](const char* key, uint64_t kb) {
+        std::string padded = std::to_string(kb);
+        return "Node " + std::to_string(node) + " " + key +
+               std::string(16 - std::min<size_t>(15, padded.size()), ' ') + padded + " kB\n";
+    };
+    uint64_t total_kb = spec_.memory_kb / static_cast<uint64_t>(spec_.numa_nodes);
+    uint64_t cache_kb = 1ull << 20;
+    write("sys/devices/system/node/node" + std::to_string(node) + "/meminfo",
+          line("MemTotal:", total_kb) +
+          line("MemFree:", free_kb) +
+          line("MemUsed:", total_kb - free_kb) +
+          line("Active(file):", cache_kb / 2) +
+          line("Inactive(file):", cache_kb / 2) +
+          line("FilePages:", cache_kb) +
+          line("SReclaimable:", 0) +
+          line("HugePages_Total:", 0));
+}
+
+void FakeProcfs::set_node_allocations(int node, uint64_t local, uint64_t remote) {
+    node_allocations_[static_cast<size_t>(node)].local_per_tick = local;
+    node_allocations_[static_cast<size_t>(node)].remote_per_tick = remote;
+}
+
+void FakeProcfs::write_numastat() {
+    for (size_t node = 0; node < node_allocations_.size(); ++node) {
+        const auto& a = node_allocations_[node];
+        write("sys/devices/system/node/node" + std::to_string(node) + "/numastat",
+              "numa_hit " + std::to_string(a.local + a.remote) + "\nnuma_miss 0\nnuma_foreign 0\n"
+              "interleave_hit 1025\nlocal_node " + std::to_string(a.local) +
+              "\nother_node " + std::to_string(a.remote) + "\n");
+    }
+}
+
+void FakeProcfs::write(const std::string& relative, const std::string& content) {
+    fs::path path = fs::path(root_) / relative;
+    fs::create_directories(path.parent_path());
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+}
+
+void FakeProcfs::write_stat() {
+    auto times = [](const std::string& name, const CoreTimes& t) {
+        return name + " " + std::to_string(t.user) + " 0 " + std::to_string(t.system) + " " +
+               std::to_string(t.idle) + " " + std::to_string(t.iowait) + " 0 0 0 0 0\n";
+    };
+    CoreTimes total;
+    for (const auto& core : cores_) {
+        total.user += core.user;
+        total.system += core.system;
+        total.idle += core.idle;
+        total.iowait += core.iowait;
+    }
+    std::string stat = times("cpu ", total);
+    for (size_t i = 0; i < cores_.size(); ++i) {
+        stat += times("cpu" + std::to_string(i), cores_[i]);
+    }
+    stat += "intr " + std::to_string(interrupts_) + " 0 0\nctxt " + std::to_string(context_switches_) +
+            "\nbtime 1700000000\nprocesses " + std::to_string(forks_) +
+            "\nprocs_running " + std::to_string(running_) + "\nprocs_blocked " + std::to_string(blocked_) +
+            "\nsoftirq " + std::to_string(softirqs_) + " 0 0 0 0 0 0 0 0 0 0\n";
+    write("proc/stat", stat);
+}
+
+// Two device IRQs splitting each core's count, then the architecture rows
+void FakeProcfs::write_interrupts() {
+    auto header = [this] {
+        std::string line = "     ";
+        for (size_t i = 0; i < cores_.size(); ++i) {
+            std::string name = "CPU" + std::to_string(i);
+            line += std::string(11 - name.size(), ' ') + name;
+        }
+        return line + "\n";
+    };
+    auto row = [this](const std::string& label, auto value, const std::string& description) {
+        std::string line = std::string(4 - std::min<size_t>(3, label.size()), ' ') + label + ":";
+        for (size_t i = 0; i < cores_.size(); ++i) {
+            std::string count = std::to_string(value(i));
+            line += std::string(11 - std::min<size_t>(10, count.size()), ' ') + count;
+        }
+        return line + "  " + description + "\n";
+    };
+    auto timer = [this](size_t) { return timer_; };
+
+    std::string interrupts = header();
+    interrupts += row("0", [](size_t) { return uint64_t{40}; }, "IO-APIC   2-edge      timer");
+    interrupts += row("24", [this](size_t i) { return device_irqs_[i] / 2; }, "PCI-MSI 524288-edge      eth0-TxRx-0");
+    interrupts += row("25", [this](size_t i) { return device_irqs_[i] - device_irqs_[i] / 2; },
+                      "PCI-MSI 524289-edge      eth0-TxRx-1");
+    interrupts += row("LOC", timer, "Local timer interrupts");
+    interrupts += row("RES", [](size_t) { return uint64_t{300}; }, "Rescheduling interrupts");
+    interrupts += "ERR:          0\nMIS:          0\n";
+    write("proc/interrupts", interrupts);
+
+    std::string softirqs = header();
+    softirqs += row("HI", [](size_t) { return uint64_t{1}; }, "");
+    softirqs += row("TIMER", timer, "");
+    softirqs += row("NET_TX", [](size_t) { return uint64_t{10}; }, "");
+    softirqs += row("NET_RX", [this](size_t i) { return net_rx_[i]; }, "");
+    softirqs += row("SCHED", timer, "");
+    write("proc/softirqs", softirqs);
+}
+
+void FakeProcfs::write_net_dev() {
+    std::string dev =
+        "Inter-|   Receive                                                |  Transmit\n"
+        " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n"
+        "    lo: 4096 32 0 0 0 0 0 0 4096 32 0 0 0 0 0 0\n";
+    for (size_t i = 0; i < rx_.size(); ++i) {
+        dev += "  eth" + std::to_string(i) + ": " + std::to_string(rx_[i]) + " 1000 0 0 0 0 0 0 " +
+               std::to_string(tx_[i]) + " 800 0 0 0 0 0 0\n";
+    }
+    write("proc/net/dev", dev);
+}
+
+} // namespace sysmon::testing
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sysmon::testing {
+
+// Shape of a synthetic machine
+struct FakeProcfsSpec {
+    int cores = 4;
+    int disks = 1;          // mounted at /mnt/disk<i>, device sd<a+i>1
+    int interfaces = 2;     // eth<i>, plus lo
+    uint64_t memory_kb = 16ull << 20;
+    int numa_nodes = 1;     // cores and memory split evenly between them
+    int packages = 1;       // sockets in sysfs topology, 0 for none
+    int threads_per_core = 1;   // SMT siblings, numbered as Linux does: cpu i and i + cores / threads
+};
+
+// A throwaway /proc and /sys tree under a temporary directory, laid out like
+// the kernel's, for pointing a collector at via fs_root. Counters start at
+// plausible boot-time values and advance with tick(). Removed on destruction.
+class FakeProcfs {
+public:
+    explicit FakeProcfs(const FakeProcfsSpec& spec = {});
+    ~FakeProcfs();
+
+    FakeProcfs(const FakeProcfs&) = delete;
+    FakeProcfs& operator=(const FakeProcfs&) = delete;
+
+    const std::string& root() const { return root_; }
+    const FakeProcfsSpec& spec() const { return spec_; }
+
+    // Mount points as the collector is configured with them
+    std::vector<std::string> mount_points() const;
+
+    // Advance every core by 100 jiffies (one second), busy_percent of them
+    // non-idle and a tenth of the rest in iowait, every interface by the
+    // given bytes, and the kernel counters by 5000 context switches, 2000
+    // interrupts, 1000 softirqs and 10 forks. /proc/interrupts gains 1000
+    // device interrupts per core and /proc/softirqs 500 NET_RX per core,
+    // spread evenly or all on the core given to steer_irqs()
+    void tick(double busy_percent, uint64_t rx_bytes = 0, uint64_t tx_bytes = 0);
+    
+    // Deliver device interrupts and network softirqs to one core; -1 spreads them
+    void steer_irqs(int core) { irq_core_ = core; }
+    
+    // Rewrite /proc/loadavg and the run queue lines of /proc/stat
+    void set_load(double load1, double load5, double load15, int running, int blocked);
+
+    // Rewrite /proc/meminfo
+    void set_memory(uint64_t available_kb, uint64_t swap_total_kb = 0, uint64_t swap_free_kb = 0);
+    
+    // Rewrite a node's meminfo, free_kb of its memory free and 1 GB in the page cache
+    void set_node_memory(int node, uint64_t free_kb);
+    
+    // Pages each tick() adds to a node's local_node and other_node counters
+    // (default 10000 and 100)
+    void set_node_allocations(int node, uint64_t local, uint64_t remote);
+
+    // Write a file below the root, creating its directories
+    void write(const std::string& relative, const std::string& content);
+
+private:
+    void write_stat();
+    void write_net_dev();
+    void write_interrupts();
+    void write_numastat();
+
+    FakeProcfsSpec spec_;
+    std::string root_;
+    struct CoreTimes {
+        uint64_t user = 0;
+        uint64_t system = 0;
+        uint64_t idle = 0;
+        uint64_t iowait = 0;
+    };
+    std::vector<CoreTimes> cores_;
+    std::vector<uint64_t> rx_;
+    std::vector<uint64_t> tx_;
+    uint64_t context_switches_ = 987654;
+    uint64_t interrupts_ = 123456;
+    uint64_t softirqs_ = 1000;
+    uint64_t forks_ = 4242;
+    int running_ = 2;
+    int blocked_ = 0;
+    std::vector<uint64_t> device_irqs_;     // per core
+    std::vector<uint64_t> net_rx_;          // per core
+    uint64_t timer_ = 0;                    // per core, LOC and TIMER alike
+    int irq_core_ = -1;
+    struct NodeAllocations {
+        uint64_t local = 500000;
+        uint64_t remote = 2000;
+        uint64_t local_per_tick = 10000;
+        uint64_t remote_per_tick = 100;
+    };
+    std::vector<NodeAllocations> node_allocations_;
+};
+
+} // namespace sysmon::testing
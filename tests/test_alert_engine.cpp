@@ -1,5 +1,6 @@
 #include <catch2/catch_test_macros.hpp>
 #include "sysmon/alert_engine.hpp"
+#include <filesystem>
 
 TEST_CASE("AlertEngine triggers warnings correctly", "[alerts]") {
     sysmon::AlertConfig alert_config;
@@ -78,6 +79,125 @@ TEST_CASE("AlertEngine checks memory correctly", "[alerts]") {
     }
 }
 
+TEST_CASE("AlertEngine checks sockets and saturated physical cores", "[alerts]") {
+    sysmon::AlertConfig alert_config;
+    alert_config.log_to_file = false;
+    sysmon::AlertEngine engine(alert_config);
+    sysmon::CpuConfig config;
+    
+    sysmon::CpuTopologyMetrics metrics;
+    metrics.threads_per_core = 2;
+    metrics.package_cores = {4, 4};
+    metrics.core_usage = {100.0, 100.0, 96.0, 20.0, 10.0, 10.0, 10.0, 10.0};
+    metrics.package_usage = {79.0, 10.0};
+    REQUIRE(engine.check_topology(metrics, config).empty());   // not collected
+    
+    metrics.available = true;
+    auto alerts = engine.check_topology(metrics, config);
+    REQUIRE(alerts.size() == 2);
+    REQUIRE(alerts[0].entity == "socket 0");
+    REQUIRE(alerts[0].level == sysmon::AlertLevel::Warning);
+    REQUIRE(alerts[0].message == "Socket 0 CPU usage: 79.0% (warning threshold: 70.0%)");
+    REQUIRE(alerts[1].level == sysmon::AlertLevel::Warning);
+    REQUIRE(alerts[1].value == 75.0);
+    REQUIRE(alerts[1].message == "Socket 0 saturated cores: 3 of 4 physical cores at 95%+ (warning threshold: 50%)");
+    
+    // A single socket is the host: only saturation is reported
+    metrics.package_cores = {8};
+    metrics.package_usage = {45.0};
+    alerts = engine.check_topology(metrics, config);
+    REQUIRE(alerts.empty());
+    metrics.core_usage = {100.0, 100.0, 100.0, 100.0, 100.0, 100.0, 100.0, 10.0};
+    alerts = engine.check_topology(metrics, config);
+    REQUIRE(alerts.size() == 1);
+    REQUIRE(alerts[0].level == sysmon::AlertLevel::Critical);
+}
+
+TEST_CASE("AlertEngine checks run queue and blocked tasks", "[alerts]") {
+    sysmon::AlertConfig alert_config;
+    alert_config.log_to_file = false;
+    sysmon::AlertEngine engine(alert_config);
+    sysmon::SchedulerConfig config;
+    
+    sysmon::SchedulerMetrics metrics;
+    metrics.procs_blocked = 40;
+    REQUIRE(engine.check_scheduler(metrics, config).empty());   // not collected here
+    
+    metrics.available = true;
+    metrics.run_queue_per_core = 2.5;
+    auto alerts = engine.check_scheduler(metrics, config);
+    REQUIRE(alerts.size() == 2);
+    REQUIRE(alerts[0].category == "Scheduler");
+    REQUIRE(alerts[0].level == sysmon::AlertLevel::Warning);
+    REQUIRE(alerts[0].threshold == 2.0);
+    REQUIRE(alerts[1].level == sysmon::AlertLevel::Critical);
+    REQUIRE(alerts[1].message == "Blocked tasks: 40 (critical threshold: 32)");
+    
+    config.enabled = false;
+    REQUIRE(engine.check_scheduler(metrics, config).empty());
+}
+
+TEST_CASE("AlertEngine checks interrupt imbalance", "[alerts]") {
+    sysmon::AlertConfig alert_config;
+    alert_config.log_to_file = false;
+    sysmon::AlertEngine engine(alert_config);
+    sysmon::InterruptConfig config;
+    
+    sysmon::InterruptMetrics metrics;
+    metrics.available = true;
+    metrics.irq_per_cpu = {500.0, 500.0, 500.0, 8500.0};
+    metrics.irq_total = 10000.0;
+    metrics.imbalance = 3.4;
+    metrics.busiest_cpu = 3;
+    REQUIRE(engine.check_interrupts(metrics, config).empty());
+    
+    metrics.imbalance = 5.0;
+    auto alerts = engine.check_interrupts(metrics, config);
+    REQUIRE(alerts.size() == 1);
+    REQUIRE(alerts[0].category == "Interrupts");
+    REQUIRE(alerts[0].level == sysmon::AlertLevel::Warning);
+    REQUIRE(alerts[0].entity == "core 3");
+    REQUIRE(alerts[0].message == "IRQ imbalance: core 3 takes 5.0x the mean interrupt rate (8500/s)");
+    
+    // A quiet host's few interrupts landing on one core are not a problem
+    metrics.irq_total = 2000.0;
+    REQUIRE(engine.check_interrupts(metrics, config).empty());
+}
+
+TEST_CASE("AlertEngine checks each NUMA node", "[alerts]") {
+    sysmon::AlertConfig alert_config;
+    alert_config.log_to_file = false;
+    sysmon::AlertEngine engine(alert_config);
+    sysmon::NumaConfig config;
+    
+    sysmon::NumaMetrics metrics;
+    metrics.available = true;
+    metrics.nodes.resize(1);
+    metrics.nodes[0].usage_percent = 99.0;
+    REQUIRE(engine.check_numa(metrics, config).empty());   // one node is the host
+    
+    metrics.nodes.resize(2);
+    metrics.nodes[1].node = 1;
+    metrics.nodes[1].usage_percent = 40.0;
+    metrics.nodes[1].local_allocs_per_sec = 400.0;
+    metrics.nodes[1].remote_allocs_per_sec = 400.0;
+    metrics.nodes[1].remote_percent = 50.0;
+    auto alerts = engine.check_numa(metrics, config);
+    REQUIRE(alerts.size() == 1);     // too few allocations on node 1 to judge locality
+    REQUIRE(alerts[0].category == "NUMA");
+    REQUIRE(alerts[0].entity == "node 0");
+    REQUIRE(alerts[0].level == sysmon::AlertLevel::Critical);
+    REQUIRE(alerts[0].message == "Node 0 memory usage: 99.0% (critical threshold: 95.0%)");
+    
+    metrics.nodes[1].local_allocs_per_sec = 4000.0;
+    metrics.nodes[1].remote_allocs_per_sec = 4000.0;
+    alerts = engine.check_numa(metrics, config);
+    REQUIRE(alerts.size() == 2);
+    REQUIRE(alerts[1].entity == "node 1");
+    REQUIRE(alerts[1].level == sysmon::AlertLevel::Warning);
+    REQUIRE(alerts[1].message == "Node 1 remote allocations: 50.0% (warning threshold: 30.0%)");
+}
+
 TEST_CASE("AlertEngine can be disabled", "[alerts]") {
     sysmon::AlertConfig alert_config;
     alert_config.enabled = false;
@@ -94,3 +214,40 @@ TEST_CASE("AlertEngine can be disabled", "[alerts]") {
     auto alerts = engine.check_cpu(metrics, cpu_config);
     REQUIRE(alerts.empty());
 }
+
+TEST_CASE("AlertEngine reloads keep rule state and the open log", "[alerts]") {
+    auto path = (std::filesystem::temp_directory_path() / "sysmon_test_reload.log").string();
+    std::filesystem::remove(path);
+    sysmon::AlertConfig alert_config;
+    alert_config.log_path = path;
+    sysmon::AlertRuleConfig rule;
+    rule.name = "rising";
+    rule.expr = "rate(memory.usage) > 1";
+    alert_config.rules = {rule};
+    sysmon::AlertEngine engine(alert_config);
+    REQUIRE(std::filesystem::exists(path));
+
+    sysmon::MetricSnapshot snapshot;
+    snapshot.memory.usage_percent = 40.0;
+    REQUIRE(engine.check_rules(snapshot).empty());   // no rate yet
+
+    // Unrelated change: the rate baseline and the log file stay
+    std::filesystem::remove(path);
+    alert_config.beep_on_critical = true;
+    engine.update_config(alert_config);
+    REQUIRE_FALSE(std::filesystem::exists(path));
+    snapshot.timestamp += std::chrono::seconds(2);
+    snapshot.memory.usage_percent = 46.0;
+    REQUIRE(engine.check_rules(snapshot).size() == 1);
+
+    // Changed rules start over; a changed log path opens the new file
+    alert_config.rules[0].expr = "rate(memory.usage) > 2";
+    alert_config.log_path = path + ".new";
+    engine.update_config(alert_config);
+    REQUIRE(std::filesystem::exists(path + ".new"));
+    snapshot.timestamp += std::chrono::seconds(2);
+    snapshot.memory.usage_percent = 56.0;
+    REQUIRE(engine.check_rules(snapshot).empty());
+
+    std::filesystem::remove(path + ".new");
+}
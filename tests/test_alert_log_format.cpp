@@ -0,0 +1,67 @@
+#include <catch2/catch_test_macros.hpp>
+#include "sysmon/alert_engine.hpp"
+#include "sysmon/alert_log_format.hpp"
+
+namespace {
+
+sysmon::AlertLogEntry make_entry() {
+    sysmon::AlertLogEntry entry;
+    entry.timestamp_us = 1700000000123456;
+    entry.monotonic_ns = 987654321;
+    entry.value = 93.25;
+    entry.threshold = 90.0;
+    entry.level = sysmon::AlertLevel::Critical;
+    entry.category = "Disk";
+    entry.entity = "/var/log";
+    entry.message = "Var (/var/log) usage: \"93%\"\tnow";
+    return entry;
+}
+
+void require_same(const sysmon::AlertLogEntry& a, const sysmon::AlertLogEntry& b) {
+    REQUIRE(a.timestamp_us == b.timestamp_us);
+    REQUIRE(a.monotonic_ns == b.monotonic_ns);
+    REQUIRE(a.value == b.value);
+    REQUIRE(a.threshold == b.threshold);
+    REQUIRE(a.level == b.level);
+    REQUIRE(a.category == b.category);
+    REQUIRE(a.entity == b.entity);
+    REQUIRE(a.message == b.message);
+}
+
+} // namespace
+
+TEST_CASE("JSON Lines alert records round-trip", "[log]") {
+    auto entry = make_entry();
+    std::string line;
+    sysmon::append_jsonl(line, entry);
+    REQUIRE(line.back() == '\n');
+    REQUIRE(line.find("\\\"93%\\\"\\t") != std::string::npos);
+
+    sysmon::AlertLogEntry decoded;
+    std::string scratch;
+    REQUIRE(sysmon::decode_jsonl(std::string_view(line).substr(0, line.size() - 1), decoded, scratch));
+    require_same(entry, decoded);
+
+    REQUIRE_FALSE(sysmon::decode_jsonl("[2024-01-01 00:00:00] WARNING - CPU: text", decoded, scratch));
+}
+
+TEST_CASE("Binary alert records round-trip", "[log]") {
+    auto entry = make_entry();
+    std::string data;
+    sysmon::append_binary(data, entry);
+    sysmon::append_binary(data, entry);
+
+    sysmon::AlertLogEntry decoded;
+    size_t used = sysmon::decode_binary(data.data(), data.size(), decoded);
+    REQUIRE(used == data.size() / 2);
+    require_same(entry, decoded);
+
+    // Partial record needs more data
+    REQUIRE(sysmon::decode_binary(data.data(), used - 1, decoded) == 0);
+
+    // Length that disagrees with the field lengths is corrupt
+    std::string corrupt = data.substr(0, used);
+    corrupt[0] = static_cast<char>(corrupt[0] + 1);
+    corrupt.push_back('x');
+    REQUIRE(sysmon::decode_binary(corrupt.data(), corrupt.size(), decoded) == SIZE_MAX);
+}
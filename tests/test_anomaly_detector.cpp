@@ -0,0 +1,136 @@
+#include <catch2/catch_test_macros.hpp>
+#include "sysmon/alert_engine.hpp"
+#include "sysmon/anomaly_detector.hpp"
+
+namespace {
+
+sysmon::AnomalyConfig make_config(const std::string& method) {
+    sysmon::AnomalyConfig config;
+    config.enabled = true;
+    config.method = method;
+    config.warmup_samples = 20;
+    config.min_deviation = 5.0;
+    return config;
+}
+
+// Deterministic noise in [-1, 1]
+double jitter(int i) {
+    return ((i * 7919) % 21 - 10) / 10.0;
+}
+
+} // namespace
+
+TEST_CASE("Anomaly detector flags a spike after warmup", "[anomaly]") {
+    for (const char* method : {"ewma", "mad"}) {
+        auto config = make_config(method);
+        sysmon::AnomalyDetector detector;
+    detector.configure(config);
+        detector.configure(config);
+        std::vector<sysmon::Alert> alerts;
+        auto now = std::chrono::system_clock::now();
+        sysmon::SeriesKey key{"disk", 0, "/var"};
+
+        for (int i = 0; i < 60; ++i) {
+            detector.observe(key, 40.0 + jitter(i), now, alerts);
+        }
+        REQUIRE(alerts.empty());
+
+        detector.observe(key, 95.0, now, alerts);
+        REQUIRE(alerts.size() == 1);
+        REQUIRE(alerts[0].category == "Anomaly");
+        REQUIRE(alerts[0].level == sysmon::AlertLevel::Critical);
+        REQUIRE(alerts[0].entity == "disk /var");
+        REQUIRE(alerts[0].threshold > 38.0);
+        REQUIRE(alerts[0].threshold < 42.0);
+    }
+}
+
+TEST_CASE("Anomaly detector ignores small deviations and unwarmed series", "[anomaly]") {
+    auto config = make_config("mad");
+    sysmon::AnomalyDetector detector;
+    detector.configure(config);
+    std::vector<sysmon::Alert> alerts;
+    auto now = std::chrono::system_clock::now();
+
+    // Perfectly flat series: a 3-point move is many sigma but below min_deviation
+    for (int i = 0; i < 40; ++i) {
+        detector.observe({"cpu", 0, {}}, 10.0, now, alerts);
+    }
+    detector.observe({"cpu", 0, {}}, 13.0, now, alerts);
+    REQUIRE(alerts.empty());
+
+    // New series is not judged during warmup
+    detector.observe({"memory", 0, {}}, 10.0, now, alerts);
+    detector.observe({"memory", 0, {}}, 90.0, now, alerts);
+    REQUIRE(alerts.empty());
+    REQUIRE(detector.series_count() == 2);
+}
+
+TEST_CASE("Seasonal baseline follows the time of period", "[anomaly]") {
+    auto config = make_config("seasonal");
+    config.seasonal_period_minutes = 60;
+    config.seasonal_buckets = 2;     // 30 minute slots
+    sysmon::AnomalyDetector detector;
+    detector.configure(config);
+    std::vector<sysmon::Alert> alerts;
+    sysmon::SeriesKey key{"cpu", 0, {}};
+
+    // Busy first half hour, idle second half, for three hours
+    auto start = std::chrono::system_clock::time_point(std::chrono::hours(24 * 365 * 50));
+    for (int minute = 0; minute < 180; ++minute) {
+        double value = (minute % 60) < 30 ? 80.0 + jitter(minute) : 10.0 + jitter(minute);
+        detector.observe(key, value, start + std::chrono::minutes(minute), alerts);
+    }
+    REQUIRE(alerts.empty());
+
+    // Busy level during the idle slot is anomalous; during the busy slot it is not
+    detector.observe(key, 80.0, start + std::chrono::minutes(180), alerts);
+    REQUIRE(alerts.empty());
+    detector.observe(key, 80.0, start + std::chrono::minutes(215), alerts);
+    REQUIRE(alerts.size() == 1);
+}
+
+TEST_CASE("Anomaly detector caps tracked series", "[anomaly]") {
+    auto config = make_config("ewma");
+    config.max_series = 3;
+    sysmon::AnomalyDetector detector;
+    detector.configure(config);
+    std::vector<sysmon::Alert> alerts;
+    auto now = std::chrono::system_clock::now();
+
+    for (uint32_t i = 0; i < 10; ++i) {
+        detector.observe({"core", i, {}}, 50.0, now, alerts);
+    }
+    REQUIRE(detector.series_count() == 3);
+    REQUIRE(detector.dropped_series() == 7);
+
+    // Switching method discards the learned state
+    config.method = "mad";
+    detector.configure(config);
+    detector.observe({"core", 0, {}}, 50.0, now, alerts);
+    REQUIRE(detector.series_count() == 1);
+}
+
+TEST_CASE("Anomaly detector replaces series that left the host", "[anomaly]") {
+    sysmon::SysMonConfig config;
+    config.anomaly = make_config("ewma");
+    config.anomaly.max_series = 3;       // cpu, memory and one disk
+    sysmon::AnomalyDetector detector;
+    std::vector<sysmon::Alert> alerts;
+
+    sysmon::MetricSnapshot snapshot;
+    snapshot.wall_time = std::chrono::system_clock::now();
+    snapshot.disks.resize(1);
+    snapshot.disks[0].mount_point = "/mnt/old";
+    detector.observe_snapshot(snapshot, config, alerts);
+    REQUIRE(detector.series_count() == 3);
+
+    // The new mount is dropped while the old one may only be late, then
+    // takes its slot once the old one has missed a whole tick
+    snapshot.disks[0].mount_point = "/mnt/new";
+    detector.observe_snapshot(snapshot, config, alerts);
+    REQUIRE(detector.dropped_series() == 1);
+    detector.observe_snapshot(snapshot, config, alerts);
+    REQUIRE(detector.series_count() == 3);
+    REQUIRE(detector.dropped_series() == 1);
+}
@@ -1,6 +1,8 @@
 #include <catch2/catch_test_macros.hpp>
 #include "sysmon/config_manager.hpp"
+#include <atomic>
 #include <fstream>
+#include <thread>
 
 TEST_CASE("ConfigManager loads valid YAML", "[config]") {
     // Create a temporary test config
@@ -129,3 +131,128 @@ TEST_CASE("ThresholdConfig validates correctly", "[config]") {
     sysmon::ThresholdConfig out_of_range{-10.0, 110.0};
     REQUIRE_FALSE(out_of_range.validate());
 }
+
+TEST_CASE("AnomalyConfig rejects unknown methods", "[config]") {
+    sysmon::AnomalyConfig config;
+    REQUIRE(config.validate());
+    config.method = "seasonal";
+    REQUIRE(config.validate());
+    config.method = "median";
+    REQUIRE_FALSE(config.validate());
+}
+
+TEST_CASE("Per-mount thresholds inherit only when unset", "[config]") {
+    sysmon::SysMonConfig config;
+    sysmon::MountPointConfig logs;
+    logs.path = "/var/log";
+    config.disk.mount_points = {logs};
+    REQUIRE(config.validate());
+    REQUIRE(config.disk.thresholds_for("/var/log") == config.disk.thresholds);
+
+    config.disk.mount_points[0].thresholds = {95.0, 90.0};   // inverted
+    REQUIRE_FALSE(config.validate());
+    config.disk.mount_points[0].thresholds = {80.0, 0.0};    // only warning set
+    REQUIRE_FALSE(config.validate());
+    config.disk.mount_points[0].thresholds = {40.0, 60.0};
+    REQUIRE(config.validate());
+    REQUIRE(config.disk.thresholds_for("/var/log").critical == 60.0);
+}
+
+TEST_CASE("Disk forecast critical hours stay within the horizon", "[config]") {
+    sysmon::SysMonConfig config;
+    REQUIRE(config.validate());
+    config.disk.forecast_critical_hours = 48.0;
+    REQUIRE_FALSE(config.validate());
+    config.disk.forecast_horizon_hours = 0.0;   // forecasting off
+    REQUIRE(config.validate());
+}
+
+TEST_CASE("Config snapshots survive reloads and are never torn", "[config]") {
+    auto write = [](int warning) {
+        std::ofstream("snapshot_config.yaml", std::ios::trunc)
+            << "history_size: " << warning << "\n"
+            << "cpu:\n  thresholds:\n    warning: " << warning << "\n    critical: " << warning + 10 << "\n";
+    };
+    write(10);
+    sysmon::ConfigManager manager("snapshot_config.yaml");
+    REQUIRE(manager.load());
+
+    sysmon::ConfigSnapshot held = manager.snapshot();
+    write(20);
+    REQUIRE(manager.load());
+    REQUIRE(held->cpu.thresholds.warning == 10.0);
+    REQUIRE(manager.snapshot()->cpu.thresholds.warning == 20.0);
+
+    // A reader thread sees one whole config or the other, never a mix
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+    std::atomic<int> reads{0};
+    std::thread reader([&] {
+        while (!done.load()) {
+            sysmon::ConfigSnapshot config = manager.snapshot();
+            double warning = config->cpu.thresholds.warning;
+            if (config->cpu.thresholds.critical != warning + 10 || config->history_size != static_cast<int>(warning)) {
+                ++torn;
+            }
+            ++reads;
+        }
+    });
+    for (int i = 0; i < 50; ++i) {
+        write(i % 2 ? 30 : 40);
+        manager.load();
+    }
+    while (reads.load() == 0) {
+        std::this_thread::yield();
+    }
+    done = true;
+    reader.join();
+    REQUIRE(torn.load() == 0);
+}
+
+TEST_CASE("Config diffs name the changed sections", "[config]") {
+    sysmon::SysMonConfig before;
+    sysmon::SysMonConfig after = before;
+    REQUIRE(sysmon::diff_configs(before, after).empty());
+
+    after.cpu.thresholds.warning = 60.0;
+    after.history_size = 10;
+    auto diff = sysmon::diff_configs(before, after);
+    REQUIRE(diff.sections == std::vector<std::string>{"history_size", "cpu"});
+    REQUIRE_FALSE(diff.alerts);
+    REQUIRE_FALSE(diff.display);
+    REQUIRE_FALSE(diff.services);
+
+    after.alerts.log_path = "other.log";
+    after.exporter.port = 9200;
+    after.fs_root = "/host";
+    diff = sysmon::diff_configs(before, after);
+    REQUIRE(diff.alerts);
+    REQUIRE(diff.services);
+    REQUIRE(diff.collector);
+    REQUIRE(diff.sections.size() == 5);
+}
+
+TEST_CASE("Reloads reject invalid configs and keep the running one", "[config]") {
+    std::ofstream("reload_config.yaml", std::ios::trunc) << "update_interval: 3\n";
+    sysmon::ConfigManager manager("reload_config.yaml");
+    REQUIRE(manager.load());
+
+    std::ofstream("reload_config.yaml", std::ios::trunc) << "update_interval: 0\n";
+    std::filesystem::last_write_time("reload_config.yaml",
+                                     std::filesystem::last_write_time("reload_config.yaml") + std::chrono::seconds(1));
+    manager.wait_for_change(std::chrono::seconds(1));
+    REQUIRE_FALSE(manager.check_and_reload());
+    REQUIRE(manager.get_config().update_interval == 3);
+
+    // One rule that does not compile rejects the whole reload
+    std::ofstream("reload_config.yaml", std::ios::trunc)
+        << "update_interval: 5\nalerts:\n  rules:\n"
+        << "    - name: fine\n      expr: \"cpu.usage > 90\"\n"
+        << "    - name: broken\n      expr: \"cpu.usage >\"\n";
+    std::filesystem::last_write_time("reload_config.yaml",
+                                     std::filesystem::last_write_time("reload_config.yaml") + std::chrono::seconds(2));
+    manager.wait_for_change(std::chrono::seconds(1));
+    REQUIRE_FALSE(manager.check_and_reload());
+    REQUIRE(manager.get_config().update_interval == 3);
+    REQUIRE(manager.get_config().alerts.rules.empty());
+}
@@ -0,0 +1,98 @@
+#include <catch2/catch_test_macros.hpp>
+#include "sysmon/config_manager.hpp"
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+void write_config(const fs::path& path, int update_interval) {
+    std::ofstream(path, std::ios::trunc) << "update_interval: " << update_interval << "\n";
+}
+
+} // namespace
+
+#ifdef __linux__
+
+TEST_CASE("Config changes end the wait and reload without polling", "[config][watcher]") {
+    fs::path dir = fs::temp_directory_path() / ("sysmon_watch_" + std::to_string(std::random_device{}()));
+    fs::create_directories(dir);
+    fs::path path = dir / "sysmon.yaml";
+    write_config(path, 2);
+
+    sysmon::ConfigManager manager(path.string());
+    REQUIRE(manager.load());
+    REQUIRE(manager.get_config().update_interval == 2);
+
+    // Nothing changed: the wait times out and there is nothing to reload
+    REQUIRE_FALSE(manager.wait_for_change(std::chrono::milliseconds(10)));
+    REQUIRE_FALSE(manager.check_and_reload());
+
+    // Other files in the directory are ignored
+    write_config(dir / "other.yaml", 9);
+    REQUIRE_FALSE(manager.wait_for_change(std::chrono::milliseconds(10)));
+    REQUIRE_FALSE(manager.check_and_reload());
+
+    SECTION("rename-replace with an unchanged mtime") {
+        auto mtime = fs::last_write_time(path);
+        write_config(dir / "sysmon.yaml.tmp", 5);
+        fs::last_write_time(dir / "sysmon.yaml.tmp", mtime);
+        fs::rename(dir / "sysmon.yaml.tmp", path);
+
+        REQUIRE(manager.wait_for_change(std::chrono::seconds(5)));
+        REQUIRE(manager.check_and_reload());
+        REQUIRE(manager.get_config().update_interval == 5);
+        REQUIRE_FALSE(manager.check_and_reload());
+
+        // The watch is on the directory, so it survives the replacement
+        write_config(path, 7);
+        REQUIRE(manager.wait_for_change(std::chrono::seconds(5)));
+        REQUIRE(manager.check_and_reload());
+        REQUIRE(manager.get_config().update_interval == 7);
+    }
+
+    SECTION("a broken edit keeps the previous config") {
+        std::ofstream(path, std::ios::trunc) << "update_interval: [\n";
+        REQUIRE(manager.wait_for_change(std::chrono::seconds(5)));
+        REQUIRE_FALSE(manager.check_and_reload());
+        REQUIRE(manager.get_config().update_interval == 2);
+    }
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("Swapping a symlinked config's target is a change", "[config][watcher]") {
+    // The layout a Kubernetes ConfigMap volume uses
+    fs::path dir = fs::temp_directory_path() / ("sysmon_watch_" + std::to_string(std::random_device{}()));
+    fs::create_directories(dir / "..v1");
+    write_config(dir / "..v1" / "sysmon.yaml", 2);
+    fs::create_directory_symlink("..v1", dir / "..data");
+    fs::create_symlink("..data/sysmon.yaml", dir / "sysmon.yaml");
+
+    sysmon::ConfigManager manager((dir / "sysmon.yaml").string());
+    REQUIRE(manager.load());
+    REQUIRE_FALSE(manager.wait_for_change(std::chrono::milliseconds(10)));
+
+    fs::create_directories(dir / "..v2");
+    write_config(dir / "..v2" / "sysmon.yaml", 5);
+    REQUIRE_FALSE(manager.wait_for_change(std::chrono::milliseconds(10)));
+    fs::create_directory_symlink("..v2", dir / "..data_tmp");
+    fs::rename(dir / "..data_tmp", dir / "..data");
+    fs::remove_all(dir / "..v1");
+
+    REQUIRE(manager.wait_for_change(std::chrono::seconds(5)));
+    REQUIRE(manager.check_and_reload());
+    REQUIRE(manager.get_config().update_interval == 5);
+
+    // An edit in place of the new target is seen through the link
+    write_config(dir / "..v2" / "sysmon.yaml", 7);
+    REQUIRE(manager.wait_for_change(std::chrono::seconds(5)));
+    REQUIRE(manager.check_and_reload());
+    REQUIRE(manager.get_config().update_interval == 7);
+
+    fs::remove_all(dir);
+}
+
+#endif
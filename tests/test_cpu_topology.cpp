@@ -0,0 +1,73 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "sysmon/cpu_topology.hpp"
+
+namespace {
+
+// 2 packages x 4 cores x 2 threads, numbered as Linux does on x86: the
+// first thread of every core, then the second, core ids sparse
+sysmon::CpuTopology two_socket_smt() {
+    std::vector<int> packages;
+    std::vector<int> cores;
+    for (int thread = 0; thread < 2; ++thread) {
+        for (int core = 0; core < 8; ++core) {
+            packages.push_back(core / 4);
+            cores.push_back((core % 4) * 2);
+        }
+    }
+    return sysmon::CpuTopology(packages, cores);
+}
+
+} // namespace
+
+TEST_CASE("CPU topology numbers cores socket by socket", "[topology]") {
+    auto topology = two_socket_smt();
+    REQUIRE(topology.threads() == 16);
+    REQUIRE(topology.cores() == 8);
+    REQUIRE(topology.packages() == 2);
+    REQUIRE(topology.threads_per_core() == 2);
+    // SMT siblings 1 and 9 share a core; 5 is on the second package
+    REQUIRE(topology.core_of(1) == topology.core_of(9));
+    REQUIRE(topology.core_of(5) == 5);
+    REQUIRE(topology.package_of(5) == 1);
+    REQUIRE(topology.package_of(12) == 1);
+
+    REQUIRE(sysmon::CpuTopology().empty());
+}
+
+TEST_CASE("CPU topology folds thread usage into cores and sockets", "[topology]") {
+    auto topology = two_socket_smt();
+    std::vector<double> usage(16, 0.0);
+    usage[0] = 100.0;      // core 0: one busy thread of two
+    usage[2] = 100.0;      // core 2: both threads busy
+    usage[10] = 100.0;
+    for (int t = 4; t < 8; ++t) {
+        usage[t] = 80.0;   // second socket's first threads
+    }
+
+    sysmon::CpuTopologyMetrics metrics;
+    topology.aggregate(usage, metrics);
+    REQUIRE(metrics.available);
+    REQUIRE(metrics.threads_per_core == 2);
+    REQUIRE(metrics.package_cores == std::vector<uint32_t>{4, 4});
+    REQUIRE(metrics.core_usage.size() == 8);
+    REQUIRE(metrics.core_usage[0] == Catch::Approx(50.0));
+    REQUIRE(metrics.core_usage[2] == Catch::Approx(100.0));
+    REQUIRE(metrics.core_usage[7] == Catch::Approx(40.0));
+    REQUIRE(metrics.package_usage[0] == Catch::Approx(37.5));
+    REQUIRE(metrics.package_usage[1] == Catch::Approx(40.0));
+
+    // A CPU went offline since the topology was read
+    usage.pop_back();
+    topology.aggregate(usage, metrics);
+    REQUIRE_FALSE(metrics.available);
+}
+
+TEST_CASE("CPU topology without SMT or sockets", "[topology]") {
+    sysmon::CpuTopology flat({0, 0, 0}, {0, 1, 2});
+    sysmon::CpuTopologyMetrics metrics;
+    flat.aggregate({10.0, 20.0, 30.0}, metrics);
+    REQUIRE(metrics.threads_per_core == 1);
+    REQUIRE(metrics.core_usage == std::vector<double>{10.0, 20.0, 30.0});
+    REQUIRE(metrics.package_usage[0] == Catch::Approx(20.0));
+}
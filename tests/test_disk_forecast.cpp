@@ -0,0 +1,107 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "sysmon/alert_engine.hpp"
+#include "sysmon/disk_forecast.hpp"
+
+namespace {
+
+constexpr double kGB = 1024.0 * 1024.0 * 1024.0;
+
+} // namespace
+
+TEST_CASE("Capacity trend projects time to full", "[forecast]") {
+    sysmon::CapacityTrend trend;
+    const double total = 100 * kGB;
+
+    // 50 GB used, growing 1 GB per minute with a little noise
+    for (int i = 0; i < 30; ++i) {
+        double noise = (i % 3 - 1) * 0.01 * kGB;
+        trend.add(i * 60.0, 50 * kGB + i * kGB + noise, total, 3600.0);
+    }
+
+    // 79 GB used after 29 minutes: 21 GB left at 1 GB per minute
+    REQUIRE(trend.slope() == Catch::Approx(kGB / 60.0).epsilon(0.01));
+    REQUIRE(trend.seconds_to_full(29 * 60.0, total) == Catch::Approx(21 * 60.0).epsilon(0.01));
+
+    // Already past capacity
+    REQUIRE(trend.seconds_to_full(60 * 60.0, total) == 0.0);
+}
+
+TEST_CASE("Capacity trend ignores bursts and resets after cleanup", "[forecast]") {
+    sysmon::CapacityTrend trend;
+    const double total = 1000 * kGB;
+
+    for (int i = 0; i < 100; ++i) {
+        double used = 100 * kGB + i * 0.1 * kGB;
+        if (i == 50) {
+            used += 50 * kGB;    // temporary file, gone next sample
+        }
+        trend.add(i * 10.0, used, total, 600.0);
+    }
+    REQUIRE(trend.slope() == Catch::Approx(0.01 * kGB).epsilon(0.05));
+    double eta = trend.seconds_to_full(990.0, total);
+    REQUIRE(eta == Catch::Approx((total - 109.9 * kGB) / (0.01 * kGB)).epsilon(0.05));
+
+    // Large drop (log rotation) starts a new trend
+    trend.add(1000.0, 20 * kGB, total, 600.0);
+    REQUIRE(trend.samples() == 1);
+    REQUIRE(trend.seconds_to_full(1000.0, total) < 0.0);
+}
+
+TEST_CASE("Shrinking usage has no time to full", "[forecast]") {
+    sysmon::CapacityTrend trend;
+    for (int i = 0; i < 30; ++i) {
+        trend.add(i, 50 * kGB - i * 1024.0, 100 * kGB, 60.0);
+    }
+    REQUIRE(trend.seconds_to_full(29, 100 * kGB) < 0.0);
+}
+
+TEST_CASE("check_disk alerts on projected exhaustion", "[forecast][alerts]") {
+    sysmon::AlertConfig alert_config;
+    alert_config.log_to_file = false;
+    sysmon::AlertEngine engine(alert_config);
+
+    sysmon::DiskConfig config;
+    config.forecast_horizon_hours = 24.0;
+    config.forecast_critical_hours = 2.0;
+
+    sysmon::DiskMetrics disk;
+    disk.mount_point = "/var";
+    disk.usage_percent = 40.0;
+    disk.total_bytes = static_cast<uint64_t>(100 * kGB);
+    disk.used_bytes = static_cast<uint64_t>(40 * kGB);
+
+    disk.seconds_to_full = 10 * 3600.0;
+    auto alerts = engine.check_disk({disk}, config);
+    REQUIRE(alerts.size() == 1);
+    REQUIRE(alerts[0].level == sysmon::AlertLevel::Warning);
+    REQUIRE(alerts[0].entity == "/var");
+
+    disk.seconds_to_full = 3600.0;
+    alerts = engine.check_disk({disk}, config);
+    REQUIRE(alerts.size() == 1);
+    REQUIRE(alerts[0].level == sysmon::AlertLevel::Critical);
+
+    disk.seconds_to_full = -1.0;
+    REQUIRE(engine.check_disk({disk}, config).empty());
+
+    config.forecast_horizon_hours = 0.0;
+    disk.seconds_to_full = 3600.0;
+    REQUIRE(engine.check_disk({disk}, config).empty());
+}
+
+TEST_CASE("Disk forecaster fills seconds_to_full per mount", "[forecast]") {
+    sysmon::DiskForecaster forecaster;
+    sysmon::DiskConfig config;
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<sysmon::DiskMetrics> disks(1);
+    disks[0].mount_point = "/";
+    disks[0].total_bytes = static_cast<uint64_t>(100 * kGB);
+    for (int i = 0; i < 20; ++i) {
+        disks[0].used_bytes = static_cast<uint64_t>(10 * kGB + i * 0.5 * kGB);
+        forecaster.update(disks, start + std::chrono::seconds(i * 60), config);
+    }
+    // 80.5 GB free at 0.5 GB/min
+    REQUIRE(disks[0].seconds_to_full == Catch::Approx(80.5 / 0.5 * 60.0).epsilon(0.01));
+}
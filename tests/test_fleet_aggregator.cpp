@@ -0,0 +1,141 @@
+#include <catch2/catch_test_macros.hpp>
+#include "sysmon/fleet_aggregator.hpp"
+#include "sysmon/push_sink.hpp"
+#include "test_support.hpp"
+#include <filesystem>
+#include <thread>
+
+namespace {
+
+sysmon::MetricSnapshot make_snapshot(int64_t ms, double cpu, double memory, double disk) {
+    auto snapshot = sysmon::testing::make_snapshot(ms, cpu);
+    snapshot.memory.usage_percent = memory;
+    snapshot.disks = {sysmon::testing::make_disk("/", disk / 2), sysmon::testing::make_disk("/data", disk)};
+    return snapshot;
+}
+
+} // namespace
+
+TEST_CASE("Fleet state rolls up percentiles and top hosts incrementally", "[fleet]") {
+    using namespace std::chrono_literals;
+    sysmon::FleetState state(4, 30s, 2000);
+    auto now = sysmon::FleetState::Clock::now();
+
+    // Hosts 1..1000 with cpu = i / 10 (0.1% .. 100%)
+    for (int i = 1; i <= 1000; ++i) {
+        REQUIRE(state.ingest("node-" + std::to_string(i), make_snapshot(0, i / 10.0, 50.0, 10.0), now));
+    }
+    auto summary = state.summary(3, now);
+    REQUIRE(summary.hosts_total == 1000);
+    REQUIRE(summary.hosts_up == 1000);
+    REQUIRE(summary.cpu.p50 == 50.0);
+    REQUIRE(summary.cpu.p90 == 90.0);
+    REQUIRE(summary.cpu.p99 == 99.0);
+    REQUIRE(summary.cpu.max == 100.0);
+    REQUIRE(summary.disk.max == 10.0);           // fullest mount
+    REQUIRE(summary.top_cpu.size() == 3);
+    REQUIRE(summary.top_cpu[0].host == "node-1000");
+    REQUIRE(summary.top_cpu[2].host == "node-998");
+
+    // A new sample replaces the host's previous contribution
+    state.ingest("node-1", make_snapshot(1000, 100.0, 99.0, 10.0), now);
+    summary = state.summary(2, now);
+    REQUIRE(summary.hosts_up == 1000);
+    REQUIRE(summary.top_memory[0].host == "node-1");
+    REQUIRE(summary.cpu.p50 == 50.1);
+
+    // Silent hosts leave the rollups but stay listed
+    for (int i = 2; i <= 1000; ++i) {
+        state.ingest("node-" + std::to_string(i), make_snapshot(2000, 5.0, 20.0, 10.0), now + 20s);
+    }
+    state.expire(now + 40s);
+    summary = state.summary(5, now + 40s);
+    REQUIRE(summary.hosts_up == 999);
+    REQUIRE(summary.cpu.max == 5.0);
+    REQUIRE(summary.stale.size() == 1);
+    REQUIRE(summary.stale[0].host == "node-1");
+    REQUIRE(summary.stale[0].age_seconds == 40.0);
+}
+
+TEST_CASE("Fleet state merges per-host window sketches", "[fleet]") {
+    using namespace std::chrono_literals;
+    sysmon::FleetState state(4, 30s, 100);
+    auto now = sysmon::FleetState::Clock::now();
+
+    // Two hosts, 50 samples each: a busy one and an idle one
+    for (int i = 0; i < 50; ++i) {
+        state.ingest("busy", make_snapshot(i * 1000, 90.0, 60.0, 10.0), now + i * 1s);
+        state.ingest("idle", make_snapshot(i * 1000, 10.0, 20.0, 10.0), now + i * 1s);
+    }
+    auto summary = state.summary(1, now + 49s);
+    REQUIRE(summary.window_seconds == 300);
+    REQUIRE(summary.cpu_window.p99 > 89.0);
+    REQUIRE(summary.cpu_window.max == 90.0);
+    REQUIRE(summary.cpu_window.mean == 50.0);
+    REQUIRE(summary.memory_window.p50 < 21.0);
+
+    sysmon::QuantileConfig disabled;
+    disabled.enabled = false;
+    sysmon::FleetState plain(4, 30s, 100, disabled);
+    plain.ingest("busy", make_snapshot(0, 90.0, 60.0, 10.0), now);
+    REQUIRE(plain.summary(1, now).window_seconds == 0);
+}
+
+TEST_CASE("Fleet state keeps a bounded ring per host", "[fleet]") {
+    using namespace std::chrono_literals;
+    sysmon::FleetState state(3, 30s, 1);
+    auto now = sysmon::FleetState::Clock::now();
+    for (int i = 0; i < 5; ++i) {
+        state.ingest("a", make_snapshot(1000 * i, i, 0, 0), now);
+    }
+    REQUIRE_FALSE(state.ingest("b", make_snapshot(0, 0, 0, 0), now));
+
+    std::vector<sysmon::FleetSample> history;
+    REQUIRE(state.history("a", history));
+    REQUIRE(history.size() == 3);
+    REQUIRE(history.front().timestamp_ms == 2000);
+    REQUIRE(history.back().cpu == 4.0f);
+    REQUIRE_FALSE(state.history("b", history));
+}
+
+#ifdef __linux__
+TEST_CASE("Aggregator merges pushes from several instances", "[fleet]") {
+    sysmon::AggregatorConfig config;
+    config.listen_address = "127.0.0.1";
+    config.port = 0;
+    sysmon::FleetAggregator aggregator(config, sysmon::QuantileConfig{});
+    REQUIRE(aggregator.is_running());
+
+    auto spool_dir = std::filesystem::temp_directory_path();
+    std::vector<std::unique_ptr<sysmon::PushSink>> sinks;
+    for (int i = 0; i < 3; ++i) {
+        sysmon::PushConfig push;
+        push.enabled = true;
+        push.endpoint = "127.0.0.1:" + std::to_string(aggregator.port());
+        push.transport = i == 2 ? "udp" : "tcp";
+        push.compression = i == 1 && sysmon::codec_available(sysmon::Codec::Lz4) ? "lz4" : "none";
+        push.batch_interval_ms = 20;
+        push.host = "instance-" + std::to_string(i);
+        push.spool_path = (spool_dir / ("sysmon_test_fleet_" + std::to_string(i) + ".spool")).string();
+        std::filesystem::remove(push.spool_path);
+        sinks.push_back(std::make_unique<sysmon::PushSink>(push));
+        sinks.back()->submit(make_snapshot(1000, 10.0 * (i + 1), 40.0, 70.0));
+    }
+
+    sysmon::FleetSummary summary;
+    for (int i = 0; i < 500 && summary.hosts_up < 3; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        summary = aggregator.summary();
+    }
+    REQUIRE(summary.hosts_up == 3);
+    REQUIRE(summary.top_cpu[0].host == "instance-2");
+    REQUIRE(summary.top_cpu[0].latest.cpu == 30.0f);
+    REQUIRE(summary.cpu.p50 == 20.0);
+    REQUIRE(summary.disk.max == 70.0);
+    REQUIRE(aggregator.rejected() == 0);
+
+    std::vector<sysmon::FleetSample> history;
+    REQUIRE(aggregator.history("instance-1", history));
+    REQUIRE(history.size() == 1);
+}
+#endif
@@ -0,0 +1,182 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "sysmon/flight_recorder.hpp"
+#include "sysmon/recording.hpp"
+#include "test_support.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <random>
+
+namespace {
+
+sysmon::MetricSnapshot make_snapshot(int i, int disks = 1) {
+    auto snapshot = sysmon::testing::make_snapshot((1700000000ll + i) * 1000, i % 100 + 0.123, 4);
+    snapshot.timestamp = std::chrono::steady_clock::time_point(std::chrono::seconds(i));
+    snapshot.cpu.model_name = "Test CPU";
+    snapshot.cpu.per_core_usage = {1.0, 2.5, 99.99, i % 100 * 1.0};
+    snapshot.memory.used_bytes = (4ull << 30) + i;
+    for (int d = 0; d < disks; ++d) {
+        auto disk = sysmon::testing::make_disk("/mnt/disk" + std::to_string(d), 50.0);
+        disk.label = "Disk " + std::to_string(d);
+        disk.seconds_to_full = 3600.0;
+        snapshot.disks.push_back(disk);
+    }
+    snapshot.network.push_back(sysmon::testing::make_interface("eth0", 1000000ull * i, 12.5));
+    return snapshot;
+}
+
+std::string temp_directory() {
+    auto path = std::filesystem::temp_directory_path() / ("sysmon_flight_" + std::to_string(std::random_device{}()));
+    std::filesystem::create_directories(path);
+    return path.string();
+}
+
+} // namespace
+
+TEST_CASE("Flight recorder keeps the last minutes at full resolution", "[flight]") {
+    sysmon::FlightRecorderConfig config;
+    config.minutes = 1;
+    sysmon::FlightRecorder recorder(config, 1);
+    REQUIRE(recorder.capacity() == 60);
+
+    for (int i = 0; i < 150; ++i) {
+        recorder.record(make_snapshot(i));
+    }
+    REQUIRE(recorder.size() == 60);
+    // Fixed size, far smaller than the snapshot it packs
+    REQUIRE(recorder.record_bytes() < 200);
+
+    auto snapshots = recorder.snapshots();
+    REQUIRE(snapshots.size() == 60);
+    for (size_t k = 0; k < snapshots.size(); ++k) {
+        int i = 90 + static_cast<int>(k);
+        const auto& s = snapshots[k];
+        REQUIRE(s.wall_time == std::chrono::system_clock::time_point(std::chrono::seconds(1700000000 + i)));
+        REQUIRE(s.cpu.overall_usage == Catch::Approx(i % 100 + 0.123).margin(0.005));
+        REQUIRE(s.cpu.per_core_usage[2] == Catch::Approx(99.99).margin(0.005));
+        REQUIRE(s.memory.used_bytes == (4ull << 30) + i);
+        REQUIRE(s.disks[0].label == "Disk 0");
+        REQUIRE(s.disks[0].seconds_to_full == Catch::Approx(3600.0));
+        REQUIRE(s.network[0].bytes_received == 1000000ull * i);
+        REQUIRE(s.network[0].download_mbps == Catch::Approx(12.5));
+    }
+}
+
+TEST_CASE("Flight recorder keeps history across a change in the machine's shape", "[flight]") {
+    sysmon::FlightRecorderConfig config;
+    config.minutes = 1;
+    sysmon::FlightRecorder recorder(config, 1);
+    REQUIRE(recorder.capacity() == 60);
+
+    for (int i = 0; i < 40; ++i) {
+        recorder.record(make_snapshot(i));
+    }
+    size_t one_disk = recorder.record_bytes();
+    for (int i = 40; i < 50; ++i) {
+        recorder.record(make_snapshot(i, 2));
+    }
+    REQUIRE(recorder.record_bytes() > one_disk);
+    REQUIRE(recorder.size() == 50);
+
+    auto snapshots = recorder.snapshots();
+    REQUIRE(snapshots.size() == 50);
+    REQUIRE(snapshots[39].disks.size() == 1);
+    REQUIRE(snapshots[39].memory.used_bytes == (4ull << 30) + 39);
+    REQUIRE(snapshots[40].disks[1].mount_point == "/mnt/disk1");
+
+    // The window stays capacity() long, retiring the old shape first
+    for (int i = 50; i < 90; ++i) {
+        recorder.record(make_snapshot(i, i < 70 ? 2 : 1));
+    }
+    snapshots = recorder.snapshots();
+    REQUIRE(snapshots.size() == 60);
+    for (size_t k = 0; k < snapshots.size(); ++k) {
+        int i = 30 + static_cast<int>(k);
+        REQUIRE(snapshots[k].memory.used_bytes == (4ull << 30) + i);
+        REQUIRE(snapshots[k].disks.size() == (i >= 40 && i < 70 ? 2u : 1u));
+    }
+}
+
+TEST_CASE("Flight recorder dumps a replayable recording", "[flight]") {
+    sysmon::FlightRecorderConfig config;
+    config.directory = temp_directory();
+    config.min_dump_interval_seconds = 300;
+    sysmon::FlightRecorder recorder(config, 1);
+
+    REQUIRE(recorder.dump("signal").empty());   // nothing recorded yet
+    for (int i = 0; i < 100; ++i) {
+        auto snapshot = make_snapshot(i);
+        snapshot.disks[0].growth_bytes_per_sec = 1024.0 * i;
+        snapshot.cpu.scheduler.available = true;
+        snapshot.cpu.scheduler.context_switches_per_sec = 5000.0 + i;
+        snapshot.cpu.scheduler.procs_blocked = static_cast<uint32_t>(i % 7);
+        snapshot.cpu.scheduler.load5 = 1.25;
+        snapshot.cpu.interrupts.available = true;
+        snapshot.cpu.interrupts.irq_total = 2000.0 + i;
+        snapshot.cpu.interrupts.net_softirq_total = 300.0;
+        snapshot.cpu.interrupts.imbalance = 2.5;
+        snapshot.cpu.interrupts.busiest_cpu = 3;
+        recorder.record(snapshot);
+    }
+    auto path = recorder.dump("signal");
+    REQUIRE_FALSE(path.empty());
+    recorder.wait();
+
+    sysmon::RecordingReader reader(path);
+    REQUIRE(reader.is_open());
+    sysmon::MetricSnapshot snapshot;
+    int count = 0;
+    while (reader.next(snapshot)) {
+        REQUIRE(snapshot.cpu.per_core_usage.size() == 4);
+        REQUIRE(snapshot.cpu.overall_usage == Catch::Approx(count % 100 + 0.123).margin(0.005));
+        REQUIRE(snapshot.disks[0].growth_bytes_per_sec == 1024.0 * count);
+        const auto& sched = snapshot.cpu.scheduler;
+        REQUIRE(sched.available);
+        REQUIRE(sched.context_switches_per_sec == 5000.0 + count);
+        REQUIRE(sched.procs_blocked == static_cast<uint32_t>(count % 7));
+        REQUIRE(sched.load5 == 1.25);
+        const auto& irq = snapshot.cpu.interrupts;
+        REQUIRE(irq.available);
+        REQUIRE(irq.irq_total == 2000.0 + count);
+        REQUIRE(irq.net_softirq_total == 300.0);
+        REQUIRE(irq.imbalance == 2.5);
+        REQUIRE(irq.busiest_cpu == 3);
+        ++count;
+    }
+    REQUIRE(count == 100);
+    std::filesystem::remove_all(config.directory);
+}
+
+TEST_CASE("Flight recorder rate-limits dumps for critical alerts", "[flight]") {
+    sysmon::FlightRecorderConfig config;
+    config.directory = temp_directory();
+    config.min_dump_interval_seconds = 60;
+    sysmon::FlightRecorder recorder(config, 1);
+    recorder.record(make_snapshot(0));
+
+    auto start = std::chrono::steady_clock::time_point(std::chrono::hours(1));
+    REQUIRE_FALSE(recorder.dump_on_critical(start).empty());
+    recorder.wait();
+    REQUIRE(recorder.dump_on_critical(start + std::chrono::seconds(30)).empty());
+    REQUIRE_FALSE(recorder.dump_on_critical(start + std::chrono::seconds(61)).empty());
+    recorder.wait();
+    REQUIRE(recorder.dumps() == 2);
+
+    // Dumps within one second get distinct files
+    std::vector<std::string> paths;
+    for (int i = 0; i < 3; ++i) {
+        paths.push_back(recorder.dump("signal"));
+        recorder.wait();
+    }
+    std::sort(paths.begin(), paths.end());
+    REQUIRE(std::unique(paths.begin(), paths.end()) == paths.end());
+    for (const auto& path : paths) {
+        REQUIRE(std::filesystem::exists(path));
+    }
+
+    config.dump_on_critical = false;
+    sysmon::FlightRecorder quiet(config, 1);
+    quiet.record(make_snapshot(0));
+    REQUIRE(quiet.dump_on_critical(start).empty());
+    std::filesystem::remove_all(config.directory);
+}
@@ -0,0 +1,86 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "sysmon/interrupts.hpp"
+
+namespace {
+
+const char* kInterrupts =
+    "            CPU0       CPU1       CPU2       CPU3\n"
+    "   0:         40          0          0          0   IO-APIC   2-edge      timer\n"
+    "  24:       1000          0       3000          0   PCI-MSI 524288-edge      eth0-TxRx-0\n"
+    " 125:          5          6          7          8   PCI-MSI 1-edge      nvme0q1 123 456\n"
+    " NMI:          1          1          1          1   Non-maskable interrupts\n"
+    " LOC:     100000     200000     300000     400000   Local timer interrupts\n"
+    " ERR:          7\n"
+    " MIS:          0\n";
+
+const char* kSoftirqs =
+    "                    CPU0       CPU1       CPU2       CPU3\n"
+    "          HI:          1          0          0          0\n"
+    "       TIMER:        100        100        100        100\n"
+    "      NET_TX:         10         20         30         40\n"
+    "      NET_RX:       1000       2000       3000       4000\n";
+
+} // namespace
+
+TEST_CASE("Interrupt matrix parser sums columns", "[interrupts]") {
+    sysmon::InterruptCounts counts;
+    REQUIRE(sysmon::parse_interrupt_matrix(kInterrupts, counts) == 4);
+    // Device rows only; the numbers in a description are not counts
+    REQUIRE(counts.devices == std::vector<uint64_t>{1045, 6, 3007, 8});
+    // ERR's single count lands on the first column
+    REQUIRE(counts.total == std::vector<uint64_t>{101053, 200007, 303008, 400009});
+    REQUIRE(counts.net == std::vector<uint64_t>{0, 0, 0, 0});
+
+    REQUIRE(sysmon::parse_interrupt_matrix(kSoftirqs, counts) == 4);
+    REQUIRE(counts.net == std::vector<uint64_t>{1010, 2020, 3030, 4040});
+    REQUIRE(counts.devices == std::vector<uint64_t>{0, 0, 0, 0});
+    REQUIRE(counts.total[0] == 1111);
+
+    REQUIRE(sysmon::parse_interrupt_matrix("", counts) == 0);
+    REQUIRE(counts.total.empty());
+    REQUIRE(sysmon::parse_interrupt_matrix("garbage\n  1: 2 3\n", counts) == 0);
+}
+
+TEST_CASE("Interrupt matrix parser handles wide hosts", "[interrupts]") {
+    std::string header = "     ";
+    std::string row = "  30:";
+    for (int i = 0; i < 300; ++i) {
+        header += "     CPU" + std::to_string(i);
+        row += "          " + std::to_string(i);
+    }
+    sysmon::InterruptCounts counts;
+    REQUIRE(sysmon::parse_interrupt_matrix(header + "\n" + row + "  PCI-MSI eth0\n", counts) == 300);
+    REQUIRE(counts.devices[0] == 0);
+    REQUIRE(counts.devices[299] == 299);
+    // No trailing newline
+    REQUIRE(sysmon::parse_interrupt_matrix(header + "\n" + row, counts) == 300);
+    REQUIRE(counts.devices[123] == 123);
+}
+
+TEST_CASE("Interrupt rates find the busiest CPU", "[interrupts]") {
+    sysmon::InterruptCounts irq_before{{0, 0, 0, 0}, {100, 100, 100, 100}, {}};
+    sysmon::InterruptCounts irq_after{{0, 0, 0, 0}, {200, 200, 1800, 200}, {}};
+    sysmon::InterruptCounts soft_before{{10, 10, 10, 10}, {}, {5, 5, 5, 5}};
+    sysmon::InterruptCounts soft_after{{30, 30, 30, 30}, {}, {15, 15, 15, 15}};
+
+    auto metrics = sysmon::interrupt_rates(irq_before, irq_after, soft_before, soft_after, 2.0);
+    REQUIRE(metrics.available);
+    REQUIRE(metrics.irq_per_cpu == std::vector<double>{50.0, 50.0, 850.0, 50.0});
+    REQUIRE(metrics.irq_total == Catch::Approx(1000.0));
+    REQUIRE(metrics.softirq_total == Catch::Approx(40.0));
+    REQUIRE(metrics.net_softirq_total == Catch::Approx(20.0));
+    REQUIRE(metrics.busiest_cpu == 2);
+    REQUIRE(metrics.imbalance == Catch::Approx(3.4));
+
+    // A CPU going offline resets its counters; its rate is zero, not huge
+    irq_before.devices[1] = 5000;
+    metrics = sysmon::interrupt_rates(irq_before, irq_after, soft_before, soft_after, 2.0);
+    REQUIRE(metrics.irq_per_cpu[1] == 0.0);
+
+    // Width changed (CPU hotplug) or first reading: no rates
+    metrics = sysmon::interrupt_rates({}, irq_after, {}, soft_after, 1.0);
+    REQUIRE(metrics.irq_total == 0.0);
+    REQUIRE(metrics.busiest_cpu == -1);
+    REQUIRE(metrics.irq_per_cpu.size() == 4);
+}
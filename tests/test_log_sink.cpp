@@ -0,0 +1,131 @@
+#include <catch2/catch_test_macros.hpp>
+#include "sysmon/alert_engine.hpp"
+#include "sysmon/log_sink.hpp"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+sysmon::Alert make_alert(const std::string& message) {
+    sysmon::Alert alert;
+    alert.category = "CPU";
+    alert.message = message;
+    alert.level = sysmon::AlertLevel::Warning;
+    alert.timestamp = std::chrono::system_clock::now();
+    return alert;
+}
+
+std::string read_file(const std::string& path) {
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+} // namespace
+
+TEST_CASE("LogSink writes queued alerts on shutdown", "[log]") {
+    const std::string path = "test_log_sink.log";
+    std::filesystem::remove(path);
+
+    {
+        sysmon::LogSinkOptions options;
+        options.path = path;
+        options.flush_interval = std::chrono::milliseconds(60000);
+        sysmon::LogSink sink(options);
+        REQUIRE(sink.is_open());
+        REQUIRE(sink.submit(make_alert("first")));
+        REQUIRE(sink.submit(make_alert("second")));
+    }
+
+    std::string content = read_file(path);
+    REQUIRE(content.find("WARNING - CPU: first\n") != std::string::npos);
+    REQUIRE(content.find("WARNING - CPU: second\n") != std::string::npos);
+    REQUIRE(content.front() == '[');
+}
+
+TEST_CASE("LogSink rotates by size", "[log]") {
+    const std::string path = "test_log_rotate.log";
+    for (const auto& suffix : {"", ".1", ".2", ".1.gz", ".2.gz"}) {
+        std::filesystem::remove(path + suffix);
+    }
+
+    {
+        sysmon::LogSinkOptions options;
+        options.path = path;
+        options.flush_bytes = 1;          // commit every record
+        options.max_file_bytes = 256;
+        options.max_files = 2;
+        sysmon::LogSink sink(options);
+        for (int i = 0; i < 40; ++i) {
+            sink.submit(make_alert("message number " + std::to_string(i)));
+        }
+    }
+
+    REQUIRE(std::filesystem::file_size(path) <= 256);
+    bool rotated = std::filesystem::exists(path + ".1") || std::filesystem::exists(path + ".1.gz");
+    REQUIRE(rotated);
+    REQUIRE_FALSE(std::filesystem::exists(path + ".3"));
+    REQUIRE_FALSE(std::filesystem::exists(path + ".3.gz"));
+}
+
+TEST_CASE("LogSink shifts compressed and plain rotations together", "[log]") {
+    const std::string path = "test_log_rotate_mixed.log";
+    for (const auto& suffix : {"", ".1", ".2", ".3", ".1.gz", ".2.gz", ".3.gz"}) {
+        std::filesystem::remove(path + suffix);
+    }
+    // Left over from a run that compressed its rotations
+    std::ofstream(path + ".1.gz") << "old";
+
+    {
+        sysmon::LogSinkOptions options;
+        options.path = path;
+        options.flush_bytes = 1;
+        options.max_file_bytes = 256;
+        options.max_files = 2;
+        options.compress_rotated = false;
+        sysmon::LogSink sink(options);
+        for (int i = 0; i < 40; ++i) {
+            sink.submit(make_alert("message number " + std::to_string(i)));
+        }
+    }
+
+    REQUIRE(std::filesystem::exists(path + ".1"));
+    REQUIRE(std::filesystem::exists(path + ".2"));
+    REQUIRE_FALSE(std::filesystem::exists(path + ".1.gz"));
+    REQUIRE_FALSE(std::filesystem::exists(path + ".2.gz"));
+    REQUIRE_FALSE(std::filesystem::exists(path + ".3"));
+}
+
+TEST_CASE("LogSink rotates a log written in another format", "[log]") {
+    const std::string path = "test_log_format_change.log";
+    for (const auto& suffix : {"", ".1", ".1.gz"}) {
+        std::filesystem::remove(path + suffix);
+    }
+
+    sysmon::LogSinkOptions options;
+    options.path = path;
+    options.compress_rotated = false;
+    {
+        sysmon::LogSink sink(options);
+        sink.submit(make_alert("as text"));
+    }
+    {
+        options.format = sysmon::LogFormat::Binary;
+        sysmon::LogSink sink(options);
+        sink.submit(make_alert("as binary"));
+    }
+    {
+        sysmon::LogSink sink(options);   // same format: appended
+        sink.submit(make_alert("more binary"));
+    }
+
+    REQUIRE(read_file(path + ".1").front() == '[');
+    std::string binary = read_file(path);
+    REQUIRE(sysmon::detect_log_format(binary.data(), binary.size()) == sysmon::LogFormat::Binary);
+    REQUIRE(binary.find("as binary") != std::string::npos);
+    REQUIRE(binary.find("more binary") != std::string::npos);
+    REQUIRE(binary.find("SMONLOG1", 1) == std::string::npos);
+}
+
@@ -0,0 +1,199 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "sysmon/metrics_collector.hpp"
+#include "sysmon/numa.hpp"
+#include "fake_procfs.hpp"
+
+#ifdef __linux__
+
+TEST_CASE("Collector reads CPU usage per tick from the fs root", "[collector]") {
+    sysmon::testing::FakeProcfs procfs({.cores = 8});
+    auto collector = sysmon::create_metrics_collector(procfs.root());
+
+    procfs.tick(50.0);
+    auto cpu = collector->collect_cpu();
+    REQUIRE(cpu.core_count == 8);
+    REQUIRE(cpu.model_name == "Fake CPU @ 3.00GHz");
+    REQUIRE(cpu.overall_usage == Catch::Approx(50.0));
+    REQUIRE(cpu.iowait_percent == Catch::Approx(5.0));
+    REQUIRE(cpu.per_core_usage.size() == 8);
+    // Per core too, not the average since boot
+    REQUIRE(cpu.per_core_usage[7] == Catch::Approx(50.0));
+
+    procfs.tick(20.0);
+    cpu = collector->collect_cpu();
+    REQUIRE(cpu.overall_usage == Catch::Approx(20.0));
+    REQUIRE(cpu.per_core_usage[0] == Catch::Approx(20.0));
+
+    // No time passed: no usage rather than a division by zero
+    cpu = collector->collect_cpu();
+    REQUIRE(cpu.overall_usage == 0.0);
+    REQUIRE(cpu.per_core_usage[0] == 0.0);
+}
+
+TEST_CASE("Collector reads memory, disks and interfaces from the fs root", "[collector]") {
+    sysmon::testing::FakeProcfs procfs({.cores = 2, .disks = 3, .interfaces = 2, .memory_kb = 1000});
+    auto collector = sysmon::create_metrics_collector(procfs.root());
+
+    procfs.set_memory(250, 400, 100);
+    auto memory = collector->collect_memory();
+    REQUIRE(memory.total_bytes == 1000 * 1024);
+    REQUIRE(memory.available_bytes == 250 * 1024);
+    REQUIRE(memory.usage_percent == 75.0);
+    REQUIRE(memory.swap_total_bytes == 400 * 1024);
+    REQUIRE(memory.swap_used_bytes == 300 * 1024);
+
+    auto disks = collector->collect_disk(procfs.mount_points());
+    REQUIRE(disks.size() == 3);
+    REQUIRE(disks[1].mount_point == "/mnt/disk1");
+    REQUIRE(disks[1].model_name == "FAKE SSD 1");
+    REQUIRE(disks[1].total_bytes > 0);   // statvfs of the directory under the root
+
+    auto nics = collector->collect_network({});
+    REQUIRE(nics.size() == 2);           // lo is skipped
+    REQUIRE(nics[0].interface_name == "eth0");
+    REQUIRE(nics[0].model_name == "fakenet Network Adapter");
+    REQUIRE(nics[1].bytes_received == 2000000);
+    REQUIRE(nics[1].bytes_sent == 1000000);
+
+    procfs.tick(10.0, 4096, 1024);
+    nics = collector->collect_network({"eth1"});
+    REQUIRE(nics.size() == 1);
+    REQUIRE(nics[0].bytes_sent == 1001024);
+}
+
+TEST_CASE("Collector reads scheduler activity from the same /proc/stat pass", "[collector]") {
+    sysmon::testing::FakeProcfs procfs({.cores = 4, .disks = 0, .interfaces = 0});
+    auto collector = sysmon::create_metrics_collector(procfs.root());
+
+    procfs.set_load(6.5, 4.25, 2.0, 9, 3);
+    procfs.tick(50.0);
+    auto scheduler = collector->collect_cpu().scheduler;
+    REQUIRE(scheduler.available);
+    // The tick is one second of jiffies on every core
+    REQUIRE(scheduler.context_switches_per_sec == Catch::Approx(5000.0));
+    REQUIRE(scheduler.interrupts_per_sec == Catch::Approx(2000.0));
+    REQUIRE(scheduler.softirqs_per_sec == Catch::Approx(1000.0));
+    REQUIRE(scheduler.forks_per_sec == Catch::Approx(10.0));
+    REQUIRE(scheduler.procs_running == 9);
+    REQUIRE(scheduler.procs_blocked == 3);
+    REQUIRE(scheduler.run_queue_per_core == Catch::Approx(2.0));   // 8 besides sysmon
+    REQUIRE(scheduler.load1 == Catch::Approx(6.5));
+    REQUIRE(scheduler.load15 == Catch::Approx(2.0));
+    REQUIRE(scheduler.threads == 309);
+
+    // No time passed: no rates rather than a division by zero
+    scheduler = collector->collect_cpu().scheduler;
+    REQUIRE(scheduler.context_switches_per_sec == 0.0);
+    REQUIRE(scheduler.procs_running == 9);
+}
+
+TEST_CASE("Collector reads per-CPU interrupt and softirq rates", "[collector]") {
+    sysmon::testing::FakeProcfs procfs({.cores = 4, .disks = 0, .interfaces = 0});
+    auto collector = sysmon::create_metrics_collector(procfs.root());
+
+    auto irq = collector->collect_interrupts();
+    REQUIRE(irq.available);
+    REQUIRE(irq.busiest_cpu == -1);     // no rates before a second reading
+
+    // Rates are over wall time, so compare CPUs rather than absolute values
+    procfs.tick(10.0);
+    irq = collector->collect_interrupts();
+    REQUIRE(irq.irq_per_cpu.size() == 4);
+    REQUIRE(irq.irq_total > 0.0);
+    REQUIRE(irq.imbalance == Catch::Approx(1.0));
+    REQUIRE(irq.net_softirq_per_cpu[3] == Catch::Approx(irq.net_softirq_per_cpu[0]));
+    // TIMER and SCHED tick alongside NET_RX
+    REQUIRE(irq.softirq_total == Catch::Approx(irq.net_softirq_total * 2.0));
+
+    procfs.steer_irqs(2);
+    procfs.tick(10.0);
+    irq = collector->collect_interrupts();
+    REQUIRE(irq.busiest_cpu == 2);
+    REQUIRE(irq.imbalance == Catch::Approx(4.0));
+    REQUIRE(irq.irq_per_cpu[0] == 0.0);
+    REQUIRE(irq.net_softirq_per_cpu[2] == Catch::Approx(irq.net_softirq_total));
+}
+
+TEST_CASE("Collector reads memory and allocations per NUMA node", "[collector]") {
+    sysmon::testing::FakeProcfs procfs({.cores = 8, .disks = 0, .interfaces = 0, .memory_kb = 32ull << 20,
+                                        .numa_nodes = 2});
+    auto collector = sysmon::create_metrics_collector(procfs.root());
+
+    procfs.set_node_memory(1, 1ull << 20);
+    auto numa = collector->collect_numa();
+    REQUIRE(numa.available);
+    REQUIRE(numa.nodes.size() == 2);
+    REQUIRE(numa.nodes[1].node == 1);
+    REQUIRE(numa.nodes[1].cpus == std::vector<int>{4, 5, 6, 7});
+    REQUIRE(numa.nodes[0].total_bytes == 16ull << 30);
+    // 8 GB free plus 1 GB of page cache on node 0, 1 GB and 1 GB on node 1
+    REQUIRE(numa.nodes[0].usage_percent == Catch::Approx(43.75));
+    REQUIRE(numa.nodes[1].usage_percent == Catch::Approx(87.5));
+
+    // Rates are over wall time, so compare shares rather than absolute values
+    procfs.set_node_allocations(1, 6000, 4000);
+    procfs.tick(50.0);
+    numa = collector->collect_numa();
+    REQUIRE(numa.nodes[0].local_allocs_per_sec > 0.0);
+    REQUIRE(numa.nodes[0].remote_percent == Catch::Approx(100.0 / 101.0));
+    REQUIRE(numa.nodes[1].remote_percent == Catch::Approx(40.0));
+
+    sysmon::testing::FakeProcfs flat({.cores = 1, .disks = 0, .interfaces = 0, .numa_nodes = 0});
+    REQUIRE_FALSE(sysmon::create_metrics_collector(flat.root())->collect_numa().available);
+}
+
+TEST_CASE("NUMA node usage follows CPU numbers across offline CPUs", "[collector]") {
+    // CPUs 2 and 3 offline: /proc/stat lists 0, 1, 4, 5, 6, 7 in that order
+    sysmon::testing::FakeProcfs procfs({.cores = 6, .disks = 0, .interfaces = 0, .numa_nodes = 2});
+    procfs.write("sys/devices/system/cpu/online", "0-1,4-7\n");
+    procfs.write("sys/devices/system/node/node0/cpulist", "0-1,4\n");
+    procfs.write("sys/devices/system/node/node1/cpulist", "5-7\n");
+    auto collector = sysmon::create_metrics_collector(procfs.root());
+    REQUIRE(collector->online_cpus() == std::vector<int>{0, 1, 4, 5, 6, 7});
+
+    auto numa = collector->collect_numa();
+    REQUIRE(numa.nodes.size() == 2);
+    sysmon::numa_cpu_usage(numa, {10.0, 20.0, 30.0, 40.0, 50.0, 60.0}, collector->online_cpus());
+    REQUIRE(numa.nodes[0].cpu_usage == Catch::Approx(20.0));
+    REQUIRE(numa.nodes[1].cpu_usage == Catch::Approx(50.0));
+}
+
+TEST_CASE("Collector folds usage up the CPU topology", "[collector]") {
+    sysmon::testing::FakeProcfs procfs({.cores = 16, .disks = 0, .interfaces = 0, .packages = 2,
+                                        .threads_per_core = 2});
+    auto collector = sysmon::create_metrics_collector(procfs.root());
+
+    procfs.tick(60.0);
+    auto topology = collector->collect_cpu().topology;
+    REQUIRE(topology.available);
+    REQUIRE(topology.threads_per_core == 2);
+    REQUIRE(topology.package_cores == std::vector<uint32_t>{4, 4});
+    REQUIRE(topology.core_usage.size() == 8);
+    REQUIRE(topology.core_usage[7] == Catch::Approx(60.0));
+    REQUIRE(topology.package_usage[1] == Catch::Approx(60.0));
+
+    // Without sysfs every logical processor is a core of one package
+    sysmon::testing::FakeProcfs bare({.cores = 4, .disks = 0, .interfaces = 0, .packages = 0});
+    bare.tick(20.0);
+    topology = sysmon::create_metrics_collector(bare.root())->collect_cpu().topology;
+    REQUIRE(topology.available);
+    REQUIRE(topology.core_usage.size() == 4);
+    REQUIRE(topology.package_cores == std::vector<uint32_t>{4});
+}
+
+TEST_CASE("Collector handles machines with many cores", "[collector]") {
+    sysmon::testing::FakeProcfs procfs({.cores = 512, .disks = 0, .interfaces = 0});
+    auto collector = sysmon::create_metrics_collector(procfs.root());
+
+    procfs.tick(75.0);
+    auto cpu = collector->collect_cpu();
+    REQUIRE(cpu.core_count == 512);
+    REQUIRE(cpu.per_core_usage.size() == 512);
+    REQUIRE(cpu.per_core_usage[511] == Catch::Approx(75.0));
+    procfs.tick(75.0);
+    REQUIRE(collector->collect_interrupts().irq_per_cpu.size() == 512);
+    REQUIRE(collector->collect_network({}).empty());
+}
+
+#endif
@@ -0,0 +1,170 @@
+#include <catch2/catch_test_macros.hpp>
+#include "sysmon/alert_engine.hpp"
+#include "sysmon/metrics_exporter.hpp"
+#include "sysmon/quantile_sketch.hpp"
+#include "test_support.hpp"
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+sysmon::MetricSnapshot make_snapshot() {
+    auto snapshot = sysmon::testing::make_snapshot(0, 42.5, 2);
+    snapshot.disks.push_back(sysmon::testing::make_disk("/mnt/\"odd\"", 50.0));
+    snapshot.network.push_back(sysmon::testing::make_interface("eth0", 12345));
+    return snapshot;
+}
+
+#ifdef __linux__
+std::string http_get(uint16_t port, const std::string& request) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        ::close(fd);
+        return {};
+    }
+    [[maybe_unused]] auto sent = ::send(fd, request.data(), request.size(), 0);
+
+    std::string response;
+    char buf[4096];
+    ssize_t n;
+    while ((n = ::recv(fd, buf, sizeof(buf), 0)) > 0) {
+        response.append(buf, static_cast<size_t>(n));
+    }
+    ::close(fd);
+    return response;
+}
+#endif
+
+} // namespace
+
+TEST_CASE("OpenMetrics rendering", "[exporter]") {
+    std::vector<sysmon::Alert> alerts(1);
+    alerts[0].level = sysmon::AlertLevel::Critical;
+
+    std::string out;
+    sysmon::render_openmetrics(out, make_snapshot(), alerts);
+
+    REQUIRE(out.find("sysmon_cpu_usage_percent 42.5\n") != std::string::npos);
+    REQUIRE(out.find("sysmon_cpu_core_usage_percent{core=\"1\"} 21.25\n") != std::string::npos);
+    REQUIRE(out.find("sysmon_memory_total_bytes 17179869184\n") != std::string::npos);
+    REQUIRE(out.find("sysmon_disk_usage_percent{mount=\"/mnt/\\\"odd\\\"\"} 50\n") != std::string::npos);
+    REQUIRE(out.find("# TYPE sysmon_network_receive_bytes counter\n") != std::string::npos);
+    REQUIRE(out.find("sysmon_network_receive_bytes_total{interface=\"eth0\"} 12345\n") != std::string::npos);
+    REQUIRE(out.find("sysmon_alerts_active{level=\"critical\"} 1\n") != std::string::npos);
+    REQUIRE(out.find("sysmon_disk_seconds_to_full{") == std::string::npos);
+    REQUIRE(out.size() >= 6);
+    REQUIRE(out.substr(out.size() - 6) == "# EOF\n");
+}
+
+TEST_CASE("OpenMetrics perf counters", "[exporter]") {
+    auto snapshot = make_snapshot();
+    std::string out;
+    sysmon::render_openmetrics(out, snapshot, {});
+    REQUIRE(out.find("sysmon_perf_") == std::string::npos);
+
+    auto& perf = snapshot.cpu.perf;
+    perf.available = true;
+    perf.total.context_switches = 250.0;
+    perf.total.cycles = 2500000.0;
+    perf.per_cpu.resize(2);
+    perf.per_socket.resize(1);
+    perf.per_socket[0].ipc = 1.25;
+    out.clear();
+    sysmon::render_openmetrics(out, snapshot, {});
+    REQUIRE(out.find("sysmon_perf_events_per_second{event=\"context_switches\"} 250\n") != std::string::npos);
+    // Software counters only: no cycles, no IPC
+    REQUIRE(out.find("event=\"cycles\"") == std::string::npos);
+    REQUIRE(out.find("sysmon_perf_ipc") == std::string::npos);
+
+    perf.hardware = true;
+    out.clear();
+    sysmon::render_openmetrics(out, snapshot, {});
+    REQUIRE(out.find("sysmon_perf_events_per_second{event=\"cycles\"} 2500000\n") != std::string::npos);
+    REQUIRE(out.find("sysmon_perf_ipc{core=\"1\"} 0\n") != std::string::npos);
+    REQUIRE(out.find("sysmon_perf_socket_ipc{socket=\"0\"} 1.25\n") != std::string::npos);
+}
+
+TEST_CASE("OpenMetrics CPU topology", "[exporter]") {
+    auto snapshot = make_snapshot();
+    auto& topology = snapshot.cpu.topology;
+    topology.available = true;
+    topology.threads_per_core = 2;
+    topology.package_cores = {1, 1};
+    topology.core_usage = {50.0, 12.5};
+    topology.package_usage = {50.0, 12.5};
+    std::string out;
+    sysmon::render_openmetrics(out, snapshot, {});
+    REQUIRE(out.find("sysmon_cpu_threads_per_core 2\n") != std::string::npos);
+    REQUIRE(out.find("sysmon_cpu_socket_usage_percent{socket=\"1\"} 12.5\n") != std::string::npos);
+    REQUIRE(out.find("sysmon_cpu_physical_core_usage_percent{core=\"0\"} 50\n") != std::string::npos);
+}
+
+TEST_CASE("OpenMetrics NUMA nodes", "[exporter]") {
+    auto snapshot = make_snapshot();
+    auto& numa = snapshot.memory.numa;
+    numa.available = true;
+    numa.nodes.resize(2);
+    numa.nodes[1].node = 1;
+    numa.nodes[1].total_bytes = 1024;
+    numa.nodes[1].remote_allocs_per_sec = 12.5;
+    std::string out;
+    sysmon::render_openmetrics(out, snapshot, {});
+    REQUIRE(out.find("sysmon_numa_memory_total_bytes{node=\"1\"} 1024\n") != std::string::npos);
+    REQUIRE(out.find("sysmon_numa_remote_allocations_per_second{node=\"1\"} 12.5\n") != std::string::npos);
+    REQUIRE(out.find("sysmon_numa_cpu_usage_percent{node=\"0\"} 0\n") != std::string::npos);
+}
+
+TEST_CASE("OpenMetrics window percentiles", "[exporter]") {
+    sysmon::SeriesSketches sketches(sysmon::QuantileConfig{});
+    auto now = std::chrono::steady_clock::now();
+    auto snapshot = make_snapshot();
+    sketches.observe(snapshot, now);
+    sketches.observe(snapshot, now + std::chrono::seconds(1));
+
+    std::string out;
+    sysmon::render_openmetrics(out, snapshot, {}, &sketches);
+    REQUIRE(out.find("# TYPE sysmon_series_window summary\n") != std::string::npos);
+    REQUIRE(out.find("sysmon_series_window{series=\"memory.usage\",quantile=\"0.99\"} 2") != std::string::npos);
+    REQUIRE(out.find("sysmon_series_window_count{series=\"cpu.usage\"} 2\n") != std::string::npos);
+    REQUIRE(out.find("sysmon_series_window_sum{series=\"cpu.usage\"} 85\n") != std::string::npos);
+}
+
+#ifdef __linux__
+TEST_CASE("Exporter serves the published page", "[exporter]") {
+    sysmon::ExporterConfig config;
+    config.enabled = true;
+    config.port = 0;
+    sysmon::MetricsExporter exporter(config);
+    REQUIRE(exporter.is_running());
+    REQUIRE(exporter.port() != 0);
+
+    // Nothing published yet
+    auto response = http_get(exporter.port(), "GET /metrics HTTP/1.1\r\nConnection: close\r\n\r\n");
+    REQUIRE(response.rfind("HTTP/1.1 503", 0) == 0);
+
+    exporter.publish(make_snapshot(), {});
+    response = http_get(exporter.port(), "GET /metrics?x=1 HTTP/1.1\r\nHost: x\r\nConnection: close\r\n\r\n");
+    REQUIRE(response.rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+    REQUIRE(response.find("application/openmetrics-text") != std::string::npos);
+    REQUIRE(response.find("sysmon_cpu_usage_percent 42.5\n") != std::string::npos);
+    REQUIRE(response.substr(response.size() - 6) == "# EOF\n");
+
+    // Keep-alive with two pipelined requests, then close
+    response = http_get(exporter.port(),
+                        "HEAD /metrics HTTP/1.1\r\n\r\nGET /other HTTP/1.1\r\nConnection: close\r\n\r\n");
+    REQUIRE(response.rfind("HTTP/1.1 200 OK\r\n", 0) == 0);
+    REQUIRE(response.find("# EOF") == std::string::npos);
+    REQUIRE(response.find("HTTP/1.1 404 Not Found") != std::string::npos);
+
+    REQUIRE(exporter.scrapes() == 2);
+}
+#endif
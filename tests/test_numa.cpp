@@ -0,0 +1,60 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "sysmon/numa.hpp"
+
+TEST_CASE("Node meminfo counts the page cache as available", "[numa]") {
+    const char* meminfo =
+        "Node 1 MemTotal:        8388608 kB\n"
+        "Node 1 MemFree:         1048576 kB\n"
+        "Node 1 MemUsed:         7340032 kB\n"
+        "Node 1 Active(file):     524288 kB\n"
+        "Node 1 Inactive(file):   524288 kB\n"
+        "Node 1 FilePages:       1200000 kB\n"
+        "Node 1 SReclaimable:     262144 kB\n"
+        "Node 1 HugePages_Total:     0\n";
+    sysmon::NumaNodeMetrics node;
+    REQUIRE(sysmon::parse_node_meminfo(meminfo, node));
+    REQUIRE(node.total_bytes == 8ull << 30);
+    REQUIRE(node.available_bytes == (2ull << 30) + (256ull << 20));
+    REQUIRE(node.used_bytes == node.total_bytes - node.available_bytes);
+    REQUIRE(node.usage_percent == Catch::Approx(71.875));
+
+    sysmon::NumaNodeMetrics empty;
+    REQUIRE_FALSE(sysmon::parse_node_meminfo("", empty));
+    REQUIRE(empty.usage_percent == 0.0);
+}
+
+TEST_CASE("Numastat rates split local and remote allocations", "[numa]") {
+    auto before = sysmon::parse_numastat(
+        "numa_hit 1000\nnuma_miss 10\nnuma_foreign 0\ninterleave_hit 5\nlocal_node 900\nother_node 100\n");
+    REQUIRE(before.local == 900);
+    REQUIRE(before.remote == 100);
+    REQUIRE(before.miss == 10);
+
+    sysmon::NumaCounts after{before.local + 3000, before.remote + 1000, before.miss + 50};
+    sysmon::NumaNodeMetrics node;
+    sysmon::numa_rates(node, before, after, 2.0);
+    REQUIRE(node.local_allocs_per_sec == Catch::Approx(1500.0));
+    REQUIRE(node.remote_allocs_per_sec == Catch::Approx(500.0));
+    REQUIRE(node.miss_allocs_per_sec == Catch::Approx(25.0));
+    REQUIRE(node.remote_percent == Catch::Approx(25.0));
+
+    // First reading: no rates
+    sysmon::NumaNodeMetrics first;
+    sysmon::numa_rates(first, {}, after, 0.0);
+    REQUIRE(first.local_allocs_per_sec == 0.0);
+    REQUIRE(first.remote_percent == 0.0);
+}
+
+TEST_CASE("Node CPU usage averages the node's logical processors", "[numa]") {
+    sysmon::NumaMetrics numa;
+    numa.nodes.resize(2);
+    numa.nodes[0].cpus = {0, 1, 4, 5};
+    numa.nodes[1].cpus = {2, 3, 6, 7, 64};     // 64 is not in the usage vector
+    sysmon::numa_cpu_usage(numa, {10.0, 20.0, 90.0, 100.0, 30.0, 40.0, 80.0, 70.0}, {});
+    REQUIRE(numa.nodes[0].cpu_usage == Catch::Approx(25.0));
+    REQUIRE(numa.nodes[1].cpu_usage == Catch::Approx(85.0));
+
+    sysmon::numa_cpu_usage(numa, {}, {});
+    REQUIRE(numa.nodes[1].cpu_usage == 0.0);
+}
@@ -0,0 +1,88 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+#include "sysmon/perf_events.hpp"
+#include <cmath>
+
+TEST_CASE("CPU lists parse like sysfs writes them", "[perf]") {
+    REQUIRE(sysmon::parse_cpu_list("0-3,8,10-11\n") == std::vector<int>{0, 1, 2, 3, 8, 10, 11});
+    REQUIRE(sysmon::parse_cpu_list("5") == std::vector<int>{5});
+    REQUIRE(sysmon::parse_cpu_list("").empty());
+    REQUIRE(sysmon::parse_cpu_list("x,2").size() == 1);
+}
+
+TEST_CASE("Perf rates derive IPC and miss percentage", "[perf]") {
+    sysmon::PerfCounts before{};
+    sysmon::PerfCounts after{};
+    after[static_cast<size_t>(sysmon::PerfEvent::Cycles)] = 2000;
+    after[static_cast<size_t>(sysmon::PerfEvent::Instructions)] = 3000;
+    after[static_cast<size_t>(sysmon::PerfEvent::CacheReferences)] = 400;
+    after[static_cast<size_t>(sysmon::PerfEvent::CacheMisses)] = 40;
+    after[static_cast<size_t>(sysmon::PerfEvent::ContextSwitches)] = 10;
+
+    auto rates = sysmon::perf_rates(before, after, 2.0);
+    REQUIRE(rates.cycles == 1000.0);
+    REQUIRE(rates.context_switches == 5.0);
+    REQUIRE(rates.ipc == Catch::Approx(1.5));
+    REQUIRE(rates.cache_miss_percent == Catch::Approx(10.0));
+
+    // Ratios of a sum weigh each part by its cycles, not an average of ratios
+    sysmon::PerfCounters idle;
+    idle.cycles = 1000.0;
+    idle.instructions = 500.0;
+    sysmon::PerfCounters socket;
+    sysmon::add_perf_rates(socket, rates);
+    sysmon::add_perf_rates(socket, idle);
+    REQUIRE(socket.ipc == Catch::Approx(1.0));
+
+    // A counter that went backwards (reopened) is no rate at all
+    REQUIRE(sysmon::perf_rates(after, before, 1.0).cycles == 0.0);
+    REQUIRE(sysmon::perf_rates(before, after, 0.0).ipc == 0.0);
+}
+
+TEST_CASE("Multiplexed counts scale per interval", "[perf]") {
+    constexpr size_t cycles = static_cast<size_t>(sysmon::PerfEvent::Cycles);
+    sysmon::PerfReading before;
+    before.values[cycles] = 1000;
+    before.enabled = 1000;
+    before.running = 1000;       // fully on the PMU so far
+
+    // Half of this interval multiplexed out: its 500 counts stand for 1000,
+    // however the cumulative times compare
+    sysmon::PerfReading after = before;
+    after.values[cycles] = 1500;
+    after.enabled = 2000;
+    after.running = 1500;
+    sysmon::PerfCounts counts;
+    REQUIRE(sysmon::perf_interval(before, after, counts));
+    REQUIRE(counts[cycles] == 1000);
+
+    // Never scheduled in the interval: unknown rather than zero
+    sysmon::PerfReading idle = after;
+    idle.enabled = 3000;
+    REQUIRE_FALSE(sysmon::perf_interval(after, idle, counts));
+}
+
+TEST_CASE("Perf groups read one group per CPU, or nothing if not permitted", "[perf]") {
+    sysmon::PerfEventGroups groups({0}, {0});
+    auto first = groups.read();
+    REQUIRE(first.available == groups.available());
+    if (!groups.available()) {
+        REQUIRE(first.per_cpu.empty());
+        return;
+    }
+    REQUIRE(first.per_cpu.size() == 1);
+    REQUIRE(first.per_socket.size() == 1);
+    REQUIRE(sysmon::PerfEventGroups({0}, {7}).read().per_socket.size() <= 1);   // sparse package ids
+    REQUIRE(first.total.page_faults == 0.0);   // nothing to compare with yet
+
+    // Fault in some fresh pages so the software counters move
+    std::vector<char> pages(64 << 20);
+    for (size_t i = 0; i < pages.size(); i += 4096) {
+        pages[i] = 1;
+    }
+    auto second = groups.read();
+    REQUIRE(second.hardware == groups.hardware());
+    REQUIRE(second.total.context_switches >= 0.0);
+    REQUIRE(std::isfinite(second.total.ipc));
+    REQUIRE(second.per_socket[0].page_faults == Catch::Approx(second.total.page_faults));
+}
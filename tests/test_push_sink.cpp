@@ -0,0 +1,221 @@
+#include <catch2/catch_test_macros.hpp>
+#include "sysmon/push_sink.hpp"
+#include "test_support.hpp"
+#include <filesystem>
+#include <thread>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+namespace {
+
+using sysmon::testing::make_snapshot;
+
+// Loopback socket on an ephemeral port; listening is optional so tests can
+// start with a refused endpoint
+class Receiver {
+public:
+    explicit Receiver(int type) {
+        fd_ = ::socket(AF_INET, type, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        ::bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        socklen_t len = sizeof(addr);
+        ::getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+    }
+    ~Receiver() {
+        if (conn_ >= 0) ::close(conn_);
+        ::close(fd_);
+    }
+
+    std::string endpoint() const { return "127.0.0.1:" + std::to_string(port_); }
+    void listen() { ::listen(fd_, 4); }
+
+    bool wait_readable(int fd, int timeout_ms) {
+        pollfd pfd{fd, POLLIN, 0};
+        return ::poll(&pfd, 1, timeout_ms) == 1;
+    }
+
+    // Next push message on the stream (TCP) or next datagram (UDP)
+    bool next(std::string& message, sysmon::PushHeader& header, bool stream) {
+        if (!stream) {
+            if (!wait_readable(fd_, 5000)) return false;
+            message.resize(65536);
+            ssize_t n = ::recv(fd_, &message[0], message.size(), 0);
+            if (n <= 0) return false;
+            message.resize(static_cast<size_t>(n));
+            return sysmon::parse_push_header(message.data(), message.size(), header);
+        }
+        if (conn_ < 0) {
+            if (!wait_readable(fd_, 5000)) return false;
+            conn_ = ::accept(fd_, nullptr, nullptr);
+        }
+        message = read_exact(sysmon::kPushHeaderSize);
+        if (!sysmon::parse_push_header(message.data(), message.size(), header)) return false;
+        message += read_exact(header.payload_size);
+        return message.size() == sysmon::kPushHeaderSize + header.payload_size;
+    }
+
+private:
+    std::string read_exact(size_t len) {
+        std::string data(len, '\0');
+        size_t got = 0;
+        while (got < len && wait_readable(conn_, 5000)) {
+            ssize_t n = ::recv(conn_, &data[got], len - got, 0);
+            if (n <= 0) break;
+            got += static_cast<size_t>(n);
+        }
+        data.resize(got);
+        return data;
+    }
+
+    int fd_ = -1;
+    int conn_ = -1;
+    uint16_t port_ = 0;
+};
+
+std::vector<sysmon::MetricSnapshot> decode(const std::string& message, const sysmon::PushHeader& header,
+                                           std::string& host) {
+    std::string raw;
+    REQUIRE(sysmon::decompress_block(header.codec, std::string_view(message).substr(sysmon::kPushHeaderSize),
+                                     header.raw_size, raw));
+    sysmon::WireDecoder decoder;
+    std::vector<sysmon::MetricSnapshot> out;
+    REQUIRE(decoder.decode(raw, host, out));
+    return out;
+}
+
+template<typename Pred>
+bool wait_for(Pred pred) {
+    for (int i = 0; i < 500 && !pred(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return pred();
+}
+
+} // namespace
+
+TEST_CASE("Push sink batches samples over TCP", "[push]") {
+    Receiver receiver(SOCK_STREAM);
+    receiver.listen();
+
+    sysmon::PushConfig config;
+    config.enabled = true;
+    config.endpoint = receiver.endpoint();
+    config.batch_interval_ms = 100;
+    config.host = "test-host";
+    config.compression = sysmon::codec_available(sysmon::Codec::Zstd) ? "zstd" : "none";
+    config.spool_path = (std::filesystem::temp_directory_path() / "sysmon_test_push_tcp.spool").string();
+    std::filesystem::remove(config.spool_path);
+
+    sysmon::PushSink sink(config);
+    REQUIRE(sink.is_running());
+    REQUIRE(sink.host() == "test-host");
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(sink.submit(make_snapshot(1000 * i, 10.0 * i)));
+    }
+
+    std::string message;
+    sysmon::PushHeader header;
+    REQUIRE(receiver.next(message, header, true));
+    REQUIRE(header.format == sysmon::WireFormat::Binary);
+
+    std::string host;
+    auto snapshots = decode(message, header, host);
+    REQUIRE(host == "test-host");
+    REQUIRE(snapshots.size() == 3);
+    REQUIRE(snapshots[2].cpu.overall_usage == 20.0);
+    REQUIRE(wait_for([&] { return sink.sent_messages() == 1; }));
+    REQUIRE(sink.spool_bytes() == 0);
+}
+
+TEST_CASE("Push sink spools while the receiver is down and replays in order", "[push]") {
+    Receiver receiver(SOCK_STREAM);         // bound but not listening: refused
+
+    sysmon::PushConfig config;
+    config.enabled = true;
+    config.endpoint = receiver.endpoint();
+    config.batch_interval_ms = 50;
+    config.host = "spooler";
+    config.spool_path = (std::filesystem::temp_directory_path() / "sysmon_test_push.spool").string();
+    std::filesystem::remove(config.spool_path);
+
+    {
+        sysmon::PushSink sink(config);
+        sink.submit(make_snapshot(1000, 1.0));
+        REQUIRE(wait_for([&] { return sink.spool_bytes() > 0; }));
+        sink.submit(make_snapshot(2000, 2.0));
+        uint64_t first = sink.spool_bytes();
+        REQUIRE(wait_for([&] { return sink.spool_bytes() > first; }));
+        REQUIRE(sink.sent_messages() == 0);
+    }
+    REQUIRE(std::filesystem::file_size(config.spool_path) > 0);
+
+    // A new sink picks up the spool from the previous run
+    receiver.listen();
+    sysmon::PushSink sink(config);
+    sink.submit(make_snapshot(3000, 3.0));
+
+    std::string message;
+    sysmon::PushHeader header;
+    std::string host;
+    for (double expected : {1.0, 2.0, 3.0}) {
+        REQUIRE(receiver.next(message, header, true));
+        auto snapshots = decode(message, header, host);
+        REQUIRE(snapshots.size() == 1);
+        REQUIRE(snapshots[0].cpu.overall_usage == expected);
+    }
+    REQUIRE(wait_for([&] { return sink.spool_bytes() == 0; }));
+    REQUIRE_FALSE(std::filesystem::exists(config.spool_path));
+}
+
+TEST_CASE("Push sink drops messages when the spool is full", "[push]") {
+    Receiver receiver(SOCK_STREAM);
+
+    sysmon::PushConfig config;
+    config.enabled = true;
+    config.endpoint = receiver.endpoint();
+    config.batch_interval_ms = 20;
+    config.spool_max_mb = 0;
+    config.spool_path = (std::filesystem::temp_directory_path() / "sysmon_test_push_full.spool").string();
+    std::filesystem::remove(config.spool_path);
+
+    sysmon::PushSink sink(config);
+    sink.submit(make_snapshot(1000, 1.0));
+    REQUIRE(wait_for([&] { return sink.dropped_messages() == 1; }));
+    REQUIRE(sink.spool_bytes() == 0);
+}
+
+TEST_CASE("Push sink sends line protocol datagrams over UDP", "[push]") {
+    Receiver receiver(SOCK_DGRAM);
+
+    sysmon::PushConfig config;
+    config.enabled = true;
+    config.endpoint = receiver.endpoint();
+    config.transport = "udp";
+    config.format = "line";
+    config.batch_interval_ms = 50;
+    config.host = "udp-host";
+    config.spool_path = (std::filesystem::temp_directory_path() / "sysmon_test_push_udp.spool").string();
+
+    sysmon::PushSink sink(config);
+    sink.submit(make_snapshot(1000, 42.0));
+
+    std::string message;
+    sysmon::PushHeader header;
+    REQUIRE(receiver.next(message, header, false));
+    REQUIRE(header.format == sysmon::WireFormat::LineProtocol);
+    std::string raw;
+    REQUIRE(sysmon::decompress_block(header.codec, std::string_view(message).substr(sysmon::kPushHeaderSize),
+                                     header.raw_size, raw));
+    REQUIRE(raw.rfind("sysmon_cpu,host=udp-host usage=42,iowait=0 1000000000\n", 0) == 0);
+}
+#endif
@@ -0,0 +1,129 @@
+#include <catch2/catch_test_macros.hpp>
+#include "sysmon/quantile_sketch.hpp"
+#include <cmath>
+
+namespace {
+
+bool within(double actual, double expected, double relative) {
+    return std::abs(actual - expected) <= relative * std::abs(expected) + 1e-12;
+}
+
+} // namespace
+
+TEST_CASE("Sketch quantiles stay within the relative accuracy", "[sketch]") {
+    sysmon::QuantileSketch sketch(0.01);
+    for (int i = 1; i <= 10000; ++i) {
+        sketch.add(i);
+    }
+    REQUIRE(sketch.count() == 10000);
+    REQUIRE(sketch.min() == 1.0);
+    REQUIRE(sketch.max() == 10000.0);
+    REQUIRE(sketch.mean() == 5000.5);
+    for (double q : {0.0, 0.25, 0.5, 0.95, 0.99, 1.0}) {
+        double expected = 1.0 + q * 9999.0;
+        REQUIRE(within(sketch.quantile(q), expected, 0.01));
+    }
+    // Bins grow with log(range), not with the sample count
+    REQUIRE(sketch.bin_count() < 500);
+}
+
+TEST_CASE("Sketches merge losslessly", "[sketch]") {
+    sysmon::QuantileSketch low(0.01);
+    sysmon::QuantileSketch high(0.01);
+    sysmon::QuantileSketch all(0.01);
+    for (int i = 1; i <= 5000; ++i) {
+        low.add(i * 0.01);
+        all.add(i * 0.01);
+    }
+    for (int i = 5001; i <= 10000; ++i) {
+        high.add(i * 0.01);
+        all.add(i * 0.01);
+    }
+
+    REQUIRE(high.merge(low));
+    REQUIRE(high.count() == all.count());
+    REQUIRE(high.min() == all.min());
+    for (double q : {0.01, 0.5, 0.9, 0.999}) {
+        REQUIRE(high.quantile(q) == all.quantile(q));
+    }
+
+    sysmon::QuantileSketch other(0.05);
+    REQUIRE_FALSE(high.merge(other));
+}
+
+TEST_CASE("Sketch memory is bounded", "[sketch]") {
+    sysmon::QuantileSketch sketch(0.01, 64);
+    for (int e = -6; e <= 3; ++e) {
+        sketch.add(std::pow(10.0, e));
+    }
+    for (int i = 0; i < 100; ++i) {
+        sketch.add(1000.0 + i);
+    }
+    REQUIRE(sketch.bin_count() <= 64);
+    // Only the lowest values lose accuracy
+    REQUIRE(within(sketch.quantile(0.5), 1044.5, 0.02));
+    REQUIRE(within(sketch.quantile(0.99), 1098.0, 0.02));
+    REQUIRE(sketch.quantile(0.05) > 1.0);
+    REQUIRE(sketch.quantile(1.0) == 1099.0);
+
+    sysmon::QuantileSketch zeros(0.01);
+    zeros.add(0.0, 3);
+    zeros.add(-5.0);
+    zeros.add(10.0);
+    REQUIRE(zeros.count() == 5);
+    REQUIRE(zeros.quantile(0.5) == 0.0);
+    REQUIRE(within(zeros.quantile(1.0), 10.0, 0.01));
+}
+
+TEST_CASE("Windowed sketches forget old slots", "[sketch]") {
+    sysmon::QuantileConfig config;
+    config.window_seconds = 10;
+    config.window_slots = 5;
+    sysmon::WindowedSketch window(config);
+
+    auto t0 = std::chrono::steady_clock::time_point(std::chrono::seconds(1000));
+    window.add(90.0, t0);
+    window.add(10.0, t0 + std::chrono::seconds(4));
+
+    sysmon::QuantileSketch merged(config.relative_accuracy);
+    window.merge_into(merged, t0 + std::chrono::seconds(5));
+    REQUIRE(merged.count() == 2);
+
+    merged.clear();
+    window.merge_into(merged, t0 + std::chrono::seconds(11));
+    REQUIRE(merged.count() == 1);
+    REQUIRE(merged.max() == 10.0);
+
+    // Slot reuse clears what was there before
+    window.add(50.0, t0 + std::chrono::seconds(20));
+    merged.clear();
+    window.merge_into(merged, t0 + std::chrono::seconds(20));
+    REQUIRE(merged.count() == 1);
+    REQUIRE(merged.max() == 50.0);
+}
+
+TEST_CASE("Series sketches track every snapshot series", "[sketch]") {
+    sysmon::SeriesSketches sketches(sysmon::QuantileConfig{});
+    auto now = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100; ++i) {
+        sysmon::MetricSnapshot snapshot;
+        snapshot.cpu.core_count = 1;
+        snapshot.cpu.overall_usage = i;
+        sysmon::DiskMetrics disk;
+        disk.mount_point = "/";
+        disk.usage_percent = 40.0;
+        snapshot.disks.push_back(disk);
+        sketches.observe(snapshot, now + std::chrono::milliseconds(100 * i));
+    }
+
+    sysmon::QuantileSketch window(0.01);
+    REQUIRE(sketches.window("cpu.usage", window));
+    REQUIRE(window.count() == 100);
+    REQUIRE(within(window.quantile(0.95), 94.0, 0.02));
+
+    window.clear();
+    REQUIRE(sketches.window("disk.usage:/", window));
+    REQUIRE(window.quantile(0.5) == 40.0);
+    REQUIRE_FALSE(sketches.window("memory.usage", window));
+    REQUIRE(sketches.names() == std::vector<std::string>{"cpu.iowait", "cpu.usage", "disk.usage:/"});
+}
@@ -0,0 +1,226 @@
+#include <catch2/catch_test_macros.hpp>
+#include "sysmon/alert_log_format.hpp"
+#include "sysmon/query_server.hpp"
+#include "test_support.hpp"
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <thread>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+sysmon::MetricSnapshot make_snapshot(int64_t ms, double cpu) {
+    auto snapshot = sysmon::testing::make_snapshot(ms, cpu, 2);
+    snapshot.disks.push_back(sysmon::testing::make_disk("/var", 60.0));
+    snapshot.network.push_back(sysmon::testing::make_interface("eth0", 0, 1.5));
+    return snapshot;
+}
+
+#ifdef __linux__
+class Client {
+public:
+    explicit Client(const std::string& path) {
+        fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        connected_ = ::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    }
+    ~Client() { ::close(fd_); }
+
+    bool connected() const { return connected_; }
+
+    void send(const std::string& data) {
+        [[maybe_unused]] auto n = ::send(fd_, data.data(), data.size(), 0);
+    }
+
+    std::string read_exact(size_t len) {
+        std::string data(len, '\0');
+        size_t got = 0;
+        while (got < len) {
+            ssize_t n = ::recv(fd_, &data[got], len - got, 0);
+            if (n <= 0) break;
+            got += static_cast<size_t>(n);
+        }
+        data.resize(got);
+        return data;
+    }
+
+    std::string read_line() {
+        std::string line;
+        char c;
+        while (::recv(fd_, &c, 1, 0) == 1 && c != '\n') {
+            line.push_back(c);
+        }
+        return line;
+    }
+
+    // Binary request; returns status and fills payload
+    uint8_t call(sysmon::QueryType type, const std::string& payload, std::string& response) {
+        std::string request;
+        request.push_back('\0');
+        request.push_back(static_cast<char>(type));
+        uint16_t len = static_cast<uint16_t>(payload.size());
+        request.append(reinterpret_cast<const char*>(&len), 2);
+        request += payload;
+        send(request);
+
+        std::string header = read_exact(sysmon::kQueryResponseHeader);
+        REQUIRE(header.size() == sysmon::kQueryResponseHeader);
+        REQUIRE(static_cast<uint8_t>(header[1]) == static_cast<uint8_t>(type));
+        uint32_t body;
+        std::memcpy(&body, header.data() + 2, 4);
+        response = read_exact(body);
+        return static_cast<uint8_t>(header[0]);
+    }
+
+private:
+    int fd_ = -1;
+    bool connected_ = false;
+};
+#endif
+
+} // namespace
+
+TEST_CASE("Binary snapshot encoding round-trips", "[query]") {
+    auto snapshot = make_snapshot(1700000000123, 12.5);
+    snapshot.disks[0].seconds_to_full = 3600.0;
+
+    std::string payload;
+    sysmon::encode_snapshot(payload, snapshot);
+
+    sysmon::MetricSnapshot decoded;
+    REQUIRE(sysmon::decode_snapshot(payload, decoded));
+    REQUIRE(decoded.wall_time == snapshot.wall_time);
+    REQUIRE(decoded.cpu.overall_usage == 12.5);
+    REQUIRE(decoded.cpu.per_core_usage.size() == 2);
+    REQUIRE(decoded.memory.used_bytes == 4ull << 30);
+    REQUIRE(decoded.disks.size() == 1);
+    REQUIRE(decoded.disks[0].mount_point == "/var");
+    REQUIRE(decoded.disks[0].seconds_to_full == 3600.0);
+    REQUIRE(decoded.network[0].interface_name == "eth0");
+    REQUIRE(decoded.network[0].download_mbps == 1.5);
+
+    REQUIRE_FALSE(sysmon::decode_snapshot(std::string_view(payload).substr(0, payload.size() - 1), decoded));
+}
+
+TEST_CASE("Series history keeps a bounded window", "[query]") {
+    sysmon::SeriesHistory history(4);
+    for (int i = 0; i < 6; ++i) {
+        history.append(make_snapshot(1000 * i, i));
+    }
+
+    std::vector<sysmon::SeriesHistory::Point> points;
+    REQUIRE(history.range("cpu.usage", INT64_MIN, INT64_MAX, points));
+    REQUIRE(points.size() == 4);
+    REQUIRE(points.front().timestamp_ms == 2000);
+    REQUIRE(points.back().value == 5.0);
+
+    REQUIRE(history.range("cpu.usage", 3000, 5000, points));
+    REQUIRE(points.size() == 2);
+
+    REQUIRE(history.range("disk.usage:/var", INT64_MIN, INT64_MAX, points));
+    REQUIRE_FALSE(history.range("disk.usage:/nope", INT64_MIN, INT64_MAX, points));
+}
+
+#ifdef __linux__
+TEST_CASE("Query server answers binary and JSON requests", "[query]") {
+    auto path = (std::filesystem::temp_directory_path() / "sysmon_test_query.sock").string();
+
+    sysmon::QueryConfig config;
+    config.enabled = true;
+    config.socket_path = path;
+    sysmon::QueryServer server(config);
+    REQUIRE(server.is_running());
+
+    Client client(path);
+    REQUIRE(client.connected());
+
+    std::string response;
+    REQUIRE(client.call(sysmon::QueryType::Snapshot, "", response) ==
+            static_cast<uint8_t>(sysmon::QueryStatus::NoData));
+
+    std::vector<sysmon::Alert> alerts(1);
+    alerts[0].category = "Disk";
+    alerts[0].entity = "/var";
+    alerts[0].message = "full";
+    alerts[0].level = sysmon::AlertLevel::Warning;
+    server.publish(std::make_shared<const sysmon::MetricSnapshot>(make_snapshot(1000, 10.0)), nullptr);
+    server.publish(std::make_shared<const sysmon::MetricSnapshot>(make_snapshot(2000, 20.0)),
+                   std::make_shared<const std::vector<sysmon::Alert>>(alerts));
+
+    REQUIRE(client.call(sysmon::QueryType::Snapshot, "", response) == 0);
+    sysmon::MetricSnapshot decoded;
+    REQUIRE(sysmon::decode_snapshot(response, decoded));
+    REQUIRE(decoded.cpu.overall_usage == 20.0);
+
+    std::string range(16, '\0');
+    int64_t since = 0;
+    int64_t until = INT64_MAX;
+    std::memcpy(&range[0], &since, 8);
+    std::memcpy(&range[8], &until, 8);
+    range += "cpu.usage";
+    REQUIRE(client.call(sysmon::QueryType::Range, range, response) == 0);
+    uint32_t count;
+    std::memcpy(&count, response.data(), 4);
+    REQUIRE(count == 2);
+    REQUIRE(response.size() == 4 + 2 * 16);
+
+    REQUIRE(client.call(sysmon::QueryType::Alerts, "", response) == 0);
+    sysmon::AlertLogEntry entry;
+    REQUIRE(sysmon::decode_binary(response.data() + 2, response.size() - 2, entry) == response.size() - 2);
+    REQUIRE(entry.entity == "/var");
+
+    // JSON mode on the same connection, two pipelined lines
+    client.send("range memory.usage 1500\nalerts\r\n");
+    REQUIRE(client.read_line() == "{\"series\":\"memory.usage\",\"points\":[[2000,25]]}");
+    std::string alerts_json = client.read_line();
+    REQUIRE(alerts_json.rfind("{\"alerts\":[{", 0) == 0);
+    REQUIRE(alerts_json.find("\"entity\":\"/var\"") != std::string::npos);
+
+    client.send("snapshot\n");
+    REQUIRE(client.read_line().find("\"disks\":[{\"mount\":\"/var\"") != std::string::npos);
+
+    client.send("bogus\n");
+    REQUIRE(client.read_line() == "{\"error\":\"unknown command\"}");
+}
+
+TEST_CASE("Query server idles while a pipelined reply is blocked", "[query]") {
+    auto path = (std::filesystem::temp_directory_path() / "sysmon_test_query_pipeline.sock").string();
+
+    sysmon::QueryConfig config;
+    config.enabled = true;
+    config.socket_path = path;
+    config.history_points = 20000;
+    sysmon::QueryServer server(config);
+    REQUIRE(server.is_running());
+    for (int i = 0; i < config.history_points; ++i) {
+        server.publish(std::make_shared<const sysmon::MetricSnapshot>(make_snapshot(1000 * i, i % 100)), nullptr);
+    }
+
+    // Each reply is far larger than the socket buffer; the second request
+    // arrives while the first one is stuck and waits in the socket
+    Client client(path);
+    REQUIRE(client.connected());
+    client.send("range cpu.usage\n");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    client.send("range cpu.usage\n");
+
+    std::clock_t cpu_before = std::clock();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    double cpu_ms = 1000.0 * static_cast<double>(std::clock() - cpu_before) / CLOCKS_PER_SEC;
+    REQUIRE(cpu_ms < 100.0);
+
+    std::string first = client.read_line();
+    std::string second = client.read_line();
+    REQUIRE(first.rfind("{\"series\":\"cpu.usage\",\"points\":[[0,0],", 0) == 0);
+    REQUIRE(first.size() > 200000);
+    REQUIRE(second == first);
+}
+#endif
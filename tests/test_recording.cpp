@@ -0,0 +1,82 @@
+#include <catch2/catch_test_macros.hpp>
+#include "sysmon/recording.hpp"
+#include "test_support.hpp"
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+sysmon::MetricSnapshot make_snapshot(int64_t ms, double cpu) {
+    auto snapshot = sysmon::testing::make_snapshot(ms, cpu, 2);
+    snapshot.disks.push_back(sysmon::testing::make_disk("/", 60.0));
+    return snapshot;
+}
+
+} // namespace
+
+TEST_CASE("Recordings round-trip snapshots across blocks", "[recording]") {
+    auto path = (std::filesystem::temp_directory_path() / "sysmon_test.smr").string();
+    {
+        sysmon::RecordingWriter writer(path, sysmon::preferred_recording_codec(), 7);
+        REQUIRE(writer.is_open());
+        for (int i = 0; i < 100; ++i) {
+            REQUIRE(writer.append(make_snapshot(1700000000000 + i * 1000, i % 50)));
+        }
+        REQUIRE(writer.frames() == 100);
+    }  // the destructor writes the partial last block
+
+    sysmon::RecordingReader reader(path);
+    REQUIRE(reader.is_open());
+    sysmon::MetricSnapshot snapshot;
+    int count = 0;
+    while (reader.next(snapshot)) {
+        REQUIRE(snapshot.cpu.overall_usage == count % 50);
+        REQUIRE(snapshot.cpu.per_core_usage.size() == 2);
+        REQUIRE(snapshot.memory.usage_percent == 25.0);
+        REQUIRE(snapshot.disks.size() == 1);
+        REQUIRE(snapshot.disks[0].mount_point == "/");
+        // Steady timestamps keep the recorded spacing
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(snapshot.timestamp.time_since_epoch());
+        REQUIRE(ms.count() == 1700000000000 + count * 1000);
+        ++count;
+    }
+    REQUIRE(count == 100);
+    REQUIRE_FALSE(reader.truncated());
+    REQUIRE_FALSE(reader.host().empty());
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Torn recordings replay up to the last whole block", "[recording]") {
+    auto path = (std::filesystem::temp_directory_path() / "sysmon_test_torn.smr").string();
+    {
+        sysmon::RecordingWriter writer(path, sysmon::Codec::None, 10);
+        for (int i = 0; i < 25; ++i) {
+            writer.append(make_snapshot(i * 1000, 10.0));
+        }
+    }
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 3);
+
+    sysmon::RecordingReader reader(path);
+    sysmon::MetricSnapshot snapshot;
+    int count = 0;
+    while (reader.next(snapshot)) {
+        ++count;
+    }
+    REQUIRE(count == 20);
+    REQUIRE(reader.truncated());
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Files that are not recordings are rejected", "[recording]") {
+    auto path = (std::filesystem::temp_directory_path() / "sysmon_test_bad.smr").string();
+    std::ofstream(path) << "cpu: 50\n";
+
+    sysmon::RecordingReader reader(path);
+    REQUIRE_FALSE(reader.is_open());
+    sysmon::MetricSnapshot snapshot;
+    REQUIRE_FALSE(reader.next(snapshot));
+
+    sysmon::RecordingReader missing(path + ".missing");
+    REQUIRE_FALSE(missing.is_open());
+    std::filesystem::remove(path);
+}
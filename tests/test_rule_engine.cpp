@@ -0,0 +1,169 @@
+#include <catch2/catch_test_macros.hpp>
+#include "sysmon/alert_engine.hpp"
+#include "sysmon/rule_engine.hpp"
+#include "test_support.hpp"
+
+namespace {
+
+sysmon::AlertRuleConfig make_rule(const std::string& name, const std::string& expr,
+                                  const std::string& level = "warning") {
+    sysmon::AlertRuleConfig rule;
+    rule.name = name;
+    rule.expr = expr;
+    rule.level = level;
+    return rule;
+}
+
+using sysmon::testing::make_snapshot;
+
+} // namespace
+
+TEST_CASE("Rule compiler rejects invalid expressions", "[rules]") {
+    sysmon::CompiledRule rule;
+    std::string error;
+
+    REQUIRE(sysmon::compile_rule(make_rule("ok", "cpu.iowait > 30% and memory.usage >= 50"), rule, error));
+    REQUIRE_FALSE(sysmon::compile_rule(make_rule("unknown", "cpu.bogus > 1"), rule, error));
+    REQUIRE_FALSE(sysmon::compile_rule(make_rule("syntax", "cpu.usage > "), rule, error));
+    REQUIRE_FALSE(sysmon::compile_rule(make_rule("scopes", "disk.usage > 1 and net.rx_mbps > 1"), rule, error));
+    REQUIRE_FALSE(sysmon::compile_rule(make_rule("level", "cpu.usage > 1", "fatal"), rule, error));
+    REQUIRE_FALSE(sysmon::compile_rule(make_rule("window", "avg_over(cpu.usage, cpu.cores) > 1"), rule, error));
+
+    auto host_match = make_rule("host_match", "memory.usage > 90");
+    host_match.match = "/var*";
+    REQUIRE_FALSE(sysmon::compile_rule(host_match, rule, error));
+}
+
+TEST_CASE("Rule engine evaluates host rules", "[rules]") {
+    sysmon::RuleEngine engine;
+    std::vector<std::string> errors;
+    REQUIRE(engine.compile({make_rule("iowait", "cpu.iowait > 30 and not (memory.usage < 10)", "critical")}, errors));
+
+    auto snapshot = make_snapshot(1000, 0.0);
+    snapshot.cpu.iowait_percent = 35.0;
+    snapshot.memory.usage_percent = 50.0;
+
+    std::vector<sysmon::Alert> alerts;
+    engine.evaluate(snapshot, alerts);
+    REQUIRE(alerts.size() == 1);
+    REQUIRE(alerts[0].category == "Rule");
+    REQUIRE(alerts[0].level == sysmon::AlertLevel::Critical);
+
+    alerts.clear();
+    snapshot.cpu.iowait_percent = 10.0;
+    engine.evaluate(snapshot, alerts);
+    REQUIRE(alerts.empty());
+}
+
+TEST_CASE("Rule engine reads scheduler metrics", "[rules]") {
+    sysmon::RuleEngine engine;
+    std::vector<std::string> errors;
+    REQUIRE(engine.compile({make_rule("storage stall", "sched.blocked > 4 and load.1 > cpu.cores")}, errors));
+
+    auto snapshot = make_snapshot(1000, 0.0);
+    snapshot.cpu.core_count = 8;
+    snapshot.cpu.scheduler.procs_blocked = 6;
+    snapshot.cpu.scheduler.load1 = 12.0;
+    std::vector<sysmon::Alert> alerts;
+    engine.evaluate(snapshot, alerts);
+    REQUIRE(alerts.size() == 1);
+
+    alerts.clear();
+    snapshot.cpu.scheduler.load1 = 3.0;
+    engine.evaluate(snapshot, alerts);
+    REQUIRE(alerts.empty());
+}
+
+TEST_CASE("Rule engine tracks rate and avg_over state", "[rules]") {
+    sysmon::RuleEngine engine;
+    std::vector<std::string> errors;
+    REQUIRE(engine.compile({make_rule("rising", "rate(memory.usage) > 1"),
+                            make_rule("sustained", "avg_over(cpu.usage, 3) >= 80")}, errors));
+
+    std::vector<sysmon::Alert> alerts;
+    auto snapshot = make_snapshot(10000, 0.0);
+    snapshot.memory.usage_percent = 40.0;
+    snapshot.cpu.overall_usage = 90.0;
+    engine.evaluate(snapshot, alerts);
+    REQUIRE(alerts.size() == 1);  // no rate yet, avg of one sample is 90
+    REQUIRE(alerts[0].message == "sustained");
+
+    alerts.clear();
+    snapshot = make_snapshot(12000, 0.0);
+    snapshot.memory.usage_percent = 46.0;  // +3%/s
+    snapshot.cpu.overall_usage = 60.0;     // avg 75
+    engine.evaluate(snapshot, alerts);
+    REQUIRE(alerts.size() == 1);
+    REQUIRE(alerts[0].message == "rising");
+}
+
+TEST_CASE("Recompiling keeps the history of unchanged rules", "[rules]") {
+    sysmon::RuleEngine engine;
+    std::vector<std::string> errors;
+    REQUIRE(engine.compile({make_rule("rising", "rate(memory.usage) > 1"),
+                            make_rule("sustained", "avg_over(cpu.usage, 3) >= 80")}, errors));
+
+    std::vector<sysmon::Alert> alerts;
+    auto snapshot = make_snapshot(10000, 90.0);
+    snapshot.memory.usage_percent = 40.0;
+    engine.evaluate(snapshot, alerts);
+
+    // Edit one rule, add another and change the first one's level
+    REQUIRE(engine.compile({make_rule("rising", "rate(memory.usage) > 1", "critical"),
+                            make_rule("sustained", "avg_over(cpu.usage, 2) >= 80"),
+                            make_rule("busy", "cpu.usage > 95")}, errors));
+    alerts.clear();
+    snapshot = make_snapshot(12000, 60.0);
+    snapshot.memory.usage_percent = 46.0;
+    engine.evaluate(snapshot, alerts);
+    REQUIRE(alerts.size() == 1);   // rising kept its previous sample; sustained starts over at 60
+    REQUIRE(alerts[0].message == "rising");
+    REQUIRE(alerts[0].level == sysmon::AlertLevel::Critical);
+}
+
+TEST_CASE("Rule engine matches per-entity rules", "[rules]") {
+    auto rule = make_rule("var_full", "disk.usage > 50");
+    rule.match = "/var*";
+    rule.message = "volume filling";
+
+    sysmon::RuleEngine engine;
+    std::vector<std::string> errors;
+    REQUIRE(engine.compile({rule}, errors));
+
+    auto snapshot = make_snapshot(1000, 0.0);
+    snapshot.disks.resize(3);
+    snapshot.disks[0].mount_point = "/";
+    snapshot.disks[0].usage_percent = 90.0;
+    snapshot.disks[1].mount_point = "/var";
+    snapshot.disks[1].usage_percent = 60.0;
+    snapshot.disks[2].mount_point = "/var/log";
+    snapshot.disks[2].usage_percent = 20.0;
+
+    std::vector<sysmon::Alert> alerts;
+    engine.evaluate(snapshot, alerts);
+    REQUIRE(alerts.size() == 1);
+    REQUIRE(alerts[0].message == "var_full [/var]: volume filling");
+}
+
+TEST_CASE("Disk alerts use per-mount thresholds", "[alerts][rules]") {
+    sysmon::AlertConfig alert_config;
+    alert_config.log_to_file = false;
+    sysmon::AlertEngine engine(alert_config);
+
+    sysmon::DiskConfig disk_config;
+    disk_config.thresholds = {75.0, 90.0};
+    sysmon::MountPointConfig logs;
+    logs.path = "/var/log";
+    logs.thresholds = {40.0, 60.0};
+    disk_config.mount_points = {logs};
+
+    std::vector<sysmon::DiskMetrics> disks(2);
+    disks[0].mount_point = "/";
+    disks[0].usage_percent = 50.0;
+    disks[1].mount_point = "/var/log";
+    disks[1].usage_percent = 50.0;
+
+    auto alerts = engine.check_disk(disks, disk_config);
+    REQUIRE(alerts.size() == 1);
+    REQUIRE(alerts[0].level == sysmon::AlertLevel::Warning);
+}
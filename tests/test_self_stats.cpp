@@ -0,0 +1,73 @@
+#include <catch2/catch_test_macros.hpp>
+#include "sysmon/alert_engine.hpp"
+#include "sysmon/metrics_exporter.hpp"
+#include "sysmon/self_stats.hpp"
+#include <sstream>
+#include <thread>
+
+TEST_CASE("Stage scopes record calls and latency", "[self_stats]") {
+    sysmon::SelfStats stats;
+    for (int i = 0; i < 20; ++i) {
+        sysmon::SelfStats::Scope timed(&stats, sysmon::Stage::CollectCpu);
+    }
+    stats.record(sysmon::Stage::Render, std::chrono::milliseconds(5), 3);
+    stats.record(sysmon::Stage::Render, std::chrono::milliseconds(15), 1);
+
+    REQUIRE(stats.stage(sysmon::Stage::CollectCpu).calls == 20);
+    REQUIRE(stats.stage(sysmon::Stage::CollectMemory).calls == 0);
+
+    auto render = stats.stage(sysmon::Stage::Render);
+    REQUIRE(render.calls == 2);
+    REQUIRE(render.last_ms == 15.0);
+    REQUIRE(render.mean_ms == 10.0);
+    REQUIRE(render.max_ms == 15.0);
+    REQUIRE(render.total_seconds == 0.02);
+    REQUIRE(render.allocations_per_call == 2.0);
+    REQUIRE(render.p99_ms >= render.p50_ms);
+
+    // A null SelfStats turns scopes into no-ops
+    sysmon::SelfStats::Scope untimed(nullptr, sysmon::Stage::Render);
+}
+
+TEST_CASE("Ticks over budget count as missed deadlines", "[self_stats]") {
+    sysmon::SelfStats stats;
+    stats.begin_tick();
+    stats.end_tick(std::chrono::seconds(1));
+    REQUIRE(stats.ticks() == 1);
+    REQUIRE(stats.missed_deadlines() == 0);
+
+    stats.begin_tick();
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    stats.end_tick(std::chrono::milliseconds(1));
+    REQUIRE(stats.ticks() == 2);
+    REQUIRE(stats.missed_deadlines() == 1);
+    REQUIRE(stats.stage(sysmon::Stage::Tick).last_ms >= 2.0);
+#ifdef __linux__
+    REQUIRE(stats.resident_bytes() > 0);
+#endif
+}
+
+TEST_CASE("Self stats dump and export every timed stage", "[self_stats]") {
+    sysmon::SelfStats stats;
+    stats.begin_tick();
+    stats.record(sysmon::Stage::Alerts, std::chrono::microseconds(250), 0);
+    stats.end_tick(std::chrono::seconds(1));
+
+    std::ostringstream dump;
+    stats.dump(dump);
+    REQUIRE(dump.str().find("alerts") != std::string::npos);
+    REQUIRE(dump.str().find("tick") != std::string::npos);
+    REQUIRE(dump.str().find("render") == std::string::npos);
+
+    std::string page;
+    sysmon::render_openmetrics(page, sysmon::MetricSnapshot{}, {}, nullptr, &stats);
+    REQUIRE(page.find("# TYPE sysmon_self_stage_seconds summary\n") != std::string::npos);
+    REQUIRE(page.find("sysmon_self_stage_seconds{stage=\"alerts\",quantile=\"0.99\"}") != std::string::npos);
+    REQUIRE(page.find("sysmon_self_stage_seconds_count{stage=\"tick\"} 1\n") != std::string::npos);
+    REQUIRE(page.find("sysmon_self_missed_deadlines_total 0\n") != std::string::npos);
+    REQUIRE(page.find("sysmon_self_alert_log_dropped_total 0\n") != std::string::npos);
+    REQUIRE(page.find("sysmon_self_cpu_seconds_total ") != std::string::npos);
+    REQUIRE(page.rfind("# EOF\n") == page.size() - 6);
+
+    REQUIRE(std::string(sysmon::stage_name(sysmon::Stage::CollectNetwork)) == "collect_network");
+}
@@ -0,0 +1,144 @@
+#include <catch2/catch_test_macros.hpp>
+#include "sysmon/shm_publisher.hpp"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+#ifdef SYSMON_SHM_POSIX
+
+namespace {
+
+std::string segment_name() {
+    return "/sysmon_test_" + std::to_string(::getpid());
+}
+
+} // namespace
+
+TEST_CASE("Shared memory snapshot is readable by name", "[shm]") {
+    sysmon::ShmConfig config;
+    config.enabled = true;
+    config.name = segment_name();
+    sysmon::ShmPublisher publisher(config);
+    REQUIRE(publisher.is_open());
+
+    sysmon::shm::Reader reader;
+    REQUIRE(reader.open(config.name.c_str()));
+
+    // Nothing published yet
+    sysmon::shm::Payload payload;
+    REQUIRE_FALSE(reader.read(payload));
+
+    sysmon::MetricSnapshot snapshot;
+    snapshot.cpu.overall_usage = 37.5;
+    snapshot.cpu.core_count = 2;
+    snapshot.cpu.per_core_usage = {30.0, 45.0};
+    snapshot.memory.total_bytes = 1 << 20;
+    sysmon::DiskMetrics disk;
+    disk.mount_point = std::string(100, 'm');
+    disk.usage_percent = 80.0;
+    snapshot.disks.push_back(disk);
+    publisher.publish(snapshot);
+
+    REQUIRE(reader.read(payload));
+    REQUIRE(payload.update_count == 1);
+    REQUIRE(payload.cpu.usage == 37.5);
+    REQUIRE(payload.cpu.per_core_count == 2);
+    REQUIRE(payload.cpu.per_core[1] == 45.0);
+    REQUIRE(payload.memory.total_bytes == (1 << 20));
+    REQUIRE(payload.disk_count == 1);
+    REQUIRE(std::string(payload.disks[0].mount_point) == std::string(sysmon::shm::kNameSize - 1, 'm'));
+
+    double cpu = 0.0;
+    REQUIRE(reader.read([&](const sysmon::shm::Payload& p) { cpu = p.cpu.usage; }));
+    REQUIRE(cpu == 37.5);
+}
+
+TEST_CASE("Seqlock readers never observe a torn update", "[shm]") {
+    sysmon::ShmConfig config;
+    config.enabled = true;
+    config.name = segment_name();
+    sysmon::ShmPublisher publisher(config);
+    REQUIRE(publisher.is_open());
+
+    sysmon::shm::Reader reader;
+    REQUIRE(reader.open(config.name.c_str()));
+
+    // Every update writes one value into all per-core slots
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        sysmon::MetricSnapshot snapshot;
+        snapshot.cpu.per_core_usage.resize(256);
+        for (int i = 1; i <= 20000; ++i) {
+            std::fill(snapshot.cpu.per_core_usage.begin(), snapshot.cpu.per_core_usage.end(), i);
+            snapshot.cpu.overall_usage = i;
+            publisher.publish(snapshot);
+        }
+        done = true;
+    });
+
+    uint64_t consistent = 0;
+    bool torn = false;
+    sysmon::shm::Payload payload;
+    while (!done) {
+        if (reader.read(payload)) {
+            ++consistent;
+            for (uint32_t c = 0; c < payload.cpu.per_core_count; ++c) {
+                if (payload.cpu.per_core[c] != payload.cpu.usage) {
+                    torn = true;
+                }
+            }
+        }
+    }
+    writer.join();
+
+    REQUIRE_FALSE(torn);
+    REQUIRE(reader.read(payload));
+    REQUIRE(payload.cpu.usage == 20000.0);
+    REQUIRE(payload.update_count == 20000);
+}
+
+TEST_CASE("Readers notice when the publisher replaces the segment", "[shm]") {
+    sysmon::ShmConfig config;
+    config.enabled = true;
+    config.name = segment_name();
+    sysmon::MetricSnapshot snapshot;
+    snapshot.cpu.overall_usage = 10.0;
+
+    auto publisher = std::make_unique<sysmon::ShmPublisher>(config);
+    publisher->publish(snapshot);
+    sysmon::shm::Reader reader;
+    REQUIRE(reader.open(config.name.c_str()));
+    sysmon::shm::Payload payload;
+    REQUIRE(reader.read(payload));
+    REQUIRE_FALSE(reader.closed());
+
+    // A reload recreates the segment; the old mapping stops reading
+    publisher.reset();
+    publisher = std::make_unique<sysmon::ShmPublisher>(config);
+    snapshot.cpu.overall_usage = 20.0;
+    publisher->publish(snapshot);
+    REQUIRE(reader.closed());
+    REQUIRE_FALSE(reader.read(payload));
+
+    REQUIRE(reader.open(config.name.c_str()));
+    REQUIRE(reader.read(payload));
+    REQUIRE(payload.cpu.usage == 20.0);
+}
+
+TEST_CASE("A new publisher closes a segment left behind under its name", "[shm]") {
+    sysmon::ShmConfig config;
+    config.enabled = true;
+    config.name = segment_name();
+    sysmon::ShmPublisher first(config);
+    first.publish(sysmon::MetricSnapshot{});
+    sysmon::shm::Reader reader;
+    REQUIRE(reader.open(config.name.c_str()));
+    REQUIRE(reader.read([](const sysmon::shm::Payload&) {}));
+
+    // As if the first writer had crashed without cleaning up
+    sysmon::ShmPublisher second(config);
+    REQUIRE(reader.closed());
+}
+
+#endif
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "sysmon/metrics_collector.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace sysmon::testing {
+
+// A small host sampled at ms (both clocks): overall CPU usage cpu, core k
+// at cpu / (k + 1), and 4 GB of 16 GB memory in use. No disks or
+// interfaces; add them with make_disk() and make_interface().
+inline MetricSnapshot make_snapshot(int64_t ms, double cpu, int cores = 1) {
+    MetricSnapshot snapshot;
+    snapshot.wall_time = std::chrono::system_clock::time_point(std::chrono::milliseconds(ms));
+    snapshot.timestamp = std::chrono::steady_clock::time_point(std::chrono::milliseconds(ms));
+    snapshot.cpu.overall_usage = cpu;
+    snapshot.cpu.core_count = static_cast<uint32_t>(cores);
+    for (int k = 0; k < cores; ++k) {
+        snapshot.cpu.per_core_usage.push_back(cpu / (k + 1));
+    }
+    snapshot.memory.total_bytes = 16ull << 30;
+    snapshot.memory.used_bytes = 4ull << 30;
+    snapshot.memory.available_bytes = 12ull << 30;
+    snapshot.memory.usage_percent = 25.0;
+    return snapshot;
+}
+
+// A 100 GB filesystem usage_percent full
+inline DiskMetrics make_disk(const std::string& mount_point, double usage_percent) {
+    DiskMetrics disk;
+    disk.mount_point = mount_point;
+    disk.total_bytes = 100ull << 30;
+    disk.used_bytes = static_cast<uint64_t>(static_cast<double>(disk.total_bytes) * usage_percent / 100.0);
+    disk.usage_percent = usage_percent;
+    return disk;
+}
+
+inline NetworkMetrics make_interface(const std::string& name, uint64_t bytes_received = 0,
+                                     double download_mbps = 0.0) {
+    NetworkMetrics net;
+    net.interface_name = name;
+    net.bytes_received = bytes_received;
+    net.download_mbps = download_mbps;
+    return net;
+}
+
+} // namespace sysmon::testing
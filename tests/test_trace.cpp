@@ -0,0 +1,108 @@
+#include <catch2/catch_test_macros.hpp>
+#include "sysmon/trace.hpp"
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace {
+
+size_t count_lines(const std::string& text) {
+    size_t lines = 0;
+    for (char c : text) {
+        lines += c == '\n';
+    }
+    return lines;
+}
+
+} // namespace
+
+TEST_CASE("Trace records are formatted on drain", "[trace]") {
+    std::ostringstream discard;
+    sysmon::trace::drain(discard);
+
+    sysmon::trace::set_enabled(true);
+    std::string path = "/proc/stat";
+    SYSMON_TRACE(Debug, "read {} lines from {} in {} ms", 17, path, 0.25);
+    SYSMON_TRACE(Warn, "hresult 0x{x}, ok {}", 0x80041003u, true);
+    SYSMON_TRACE(Info, "no arguments");
+    SYSMON_TRACE(Debug, "missing {} and {}", -3);
+    sysmon::trace::set_enabled(false);
+    SYSMON_TRACE(Debug, "disabled {}", 1);
+
+    std::ostringstream out;
+    REQUIRE(sysmon::trace::drain(out) == 4);
+    std::string text = out.str();
+    REQUIRE(text.find("[DEBUG] ") != std::string::npos);
+    REQUIRE(text.find("test_trace.cpp:") != std::string::npos);
+    REQUIRE(text.find("read 17 lines from /proc/stat in 0.25 ms\n") != std::string::npos);
+    REQUIRE(text.find("[WARN] ") != std::string::npos);
+    REQUIRE(text.find("hresult 0x80041003, ok 1\n") != std::string::npos);
+    REQUIRE(text.find("no arguments\n") != std::string::npos);
+    REQUIRE(text.find("missing -3 and {?}\n") != std::string::npos);
+    REQUIRE(text.find("disabled") == std::string::npos);
+
+    // Drained records are not repeated
+    std::ostringstream again;
+    REQUIRE(sysmon::trace::drain(again) == 0);
+}
+
+TEST_CASE("Long strings are truncated to the record", "[trace]") {
+    std::ostringstream discard;
+    sysmon::trace::drain(discard);
+
+    sysmon::trace::set_enabled(true);
+    SYSMON_TRACE(Debug, "{} {}", 1, std::string(200, 'a'));
+    sysmon::trace::set_enabled(false);
+
+    std::ostringstream out;
+    sysmon::trace::drain(out);
+    REQUIRE(out.str().find("1 " + std::string(31, 'a') + "\n") != std::string::npos);
+}
+
+TEST_CASE("Each thread traces into its own ring", "[trace]") {
+    std::ostringstream discard;
+    sysmon::trace::drain(discard);
+
+    sysmon::trace::set_enabled(true);
+    auto worker = [](int id) {
+        for (int i = 0; i < 1000; ++i) {
+            SYSMON_TRACE(Debug, "worker {} step {}", id, i);
+        }
+    };
+    std::thread a(worker, 1);
+    std::thread b(worker, 2);
+    a.join();
+    b.join();
+
+    // Overrunning a ring loses the oldest records, and says so
+    for (size_t i = 0; i < sysmon::trace::kRingRecords + 10; ++i) {
+        SYSMON_TRACE(Debug, "flood {}", i);
+    }
+    sysmon::trace::set_enabled(false);
+
+    std::ostringstream out;
+    REQUIRE(sysmon::trace::drain(out) == 2000 + sysmon::trace::kRingRecords);
+    std::string text = out.str();
+    REQUIRE(count_lines(text) == 2000 + sysmon::trace::kRingRecords + 1);
+    REQUIRE(text.find("trace: 10 records lost") != std::string::npos);
+    REQUIRE(text.find("worker 2 step 999\n") != std::string::npos);
+    REQUIRE(text.find("flood 9\n") == std::string::npos);
+    REQUIRE(text.find("flood 10\n") != std::string::npos);
+}
+
+TEST_CASE("Rings of exited threads are reused once drained", "[trace]") {
+    std::ostringstream discard;
+    sysmon::trace::set_enabled(true);
+    std::thread([] { SYSMON_TRACE(Debug, "warm up"); }).join();
+    sysmon::trace::drain(discard);
+    size_t rings = sysmon::trace::ring_count();
+
+    for (int round = 0; round < 20; ++round) {
+        std::thread([round] { SYSMON_TRACE(Debug, "round {}", round); }).join();
+        std::ostringstream out;
+        REQUIRE(sysmon::trace::drain(out) == 1);
+        REQUIRE(out.str().find("round " + std::to_string(round) + "\n") != std::string::npos);
+    }
+    sysmon::trace::set_enabled(false);
+    REQUIRE(sysmon::trace::ring_count() == rings);
+}
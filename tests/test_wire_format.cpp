@@ -0,0 +1,227 @@
+#include <catch2/catch_test_macros.hpp>
+#include "sysmon/wire_format.hpp"
+#include "test_support.hpp"
+#include <cstring>
+
+namespace {
+
+sysmon::MetricSnapshot make_snapshot(int64_t ms, double cpu, uint64_t rx) {
+    auto snapshot = sysmon::testing::make_snapshot(ms, cpu, 2);
+    snapshot.cpu.iowait_percent = 1.25;
+    auto disk = sysmon::testing::make_disk("/var", 60.0);
+    disk.seconds_to_full = 7200.0;
+    snapshot.disks.push_back(disk);
+    auto net = sysmon::testing::make_interface("eth0", rx, 12.345);
+    net.bytes_sent = rx / 4;
+    snapshot.network.push_back(net);
+    return snapshot;
+}
+
+} // namespace
+
+TEST_CASE("Varints and zigzag round-trip", "[wire]") {
+    const uint64_t values[] = {0, 1, 127, 128, 300, 1ull << 35, UINT64_MAX};
+    std::string buf;
+    for (uint64_t v : values) {
+        sysmon::put_varint(buf, v);
+    }
+    REQUIRE(buf.size() == 1 + 1 + 1 + 2 + 2 + 6 + 10);
+
+    const char* p = buf.data();
+    for (uint64_t v : values) {
+        uint64_t out;
+        REQUIRE(sysmon::get_varint(p, buf.data() + buf.size(), out));
+        REQUIRE(out == v);
+    }
+
+    for (int64_t v : {int64_t{0}, int64_t{-1}, int64_t{1}, INT64_MIN, INT64_MAX}) {
+        REQUIRE(sysmon::unzigzag(sysmon::zigzag(v)) == v);
+    }
+    REQUIRE(sysmon::zigzag(-1) == 1);
+
+    const char truncated = static_cast<char>(0x80);
+    const char* q = &truncated;
+    uint64_t out;
+    REQUIRE_FALSE(sysmon::get_varint(q, q + 1, out));
+}
+
+TEST_CASE("Binary batches delta-encode and decode", "[wire]") {
+    sysmon::WireEncoder encoder;
+    std::string batch;
+    encoder.begin(batch, "web-1");
+    encoder.append(batch, make_snapshot(1700000000000, 12.5, 1000000));
+    size_t first = batch.size();
+    encoder.append(batch, make_snapshot(1700000002000, 13.0, 1002000));
+    // Unchanged layout and small deltas: far smaller than the first frame
+    REQUIRE(batch.size() - first < first / 3);
+
+    auto third = make_snapshot(1700000004000, 50.0, 1004000);
+    third.disks.clear();
+    encoder.append(batch, third);
+    REQUIRE(encoder.frames() == 3);
+
+    sysmon::WireDecoder decoder;
+    std::string host;
+    std::vector<sysmon::MetricSnapshot> out;
+    REQUIRE(decoder.decode(batch, host, out));
+    REQUIRE(host == "web-1");
+    REQUIRE(out.size() == 3);
+
+    REQUIRE(out[1].wall_time == std::chrono::system_clock::time_point(std::chrono::milliseconds(1700000002000)));
+    REQUIRE(out[1].cpu.overall_usage == 13.0);
+    REQUIRE(out[1].cpu.iowait_percent == 1.25);
+    REQUIRE(out[1].cpu.per_core_usage == std::vector<double>{13.0, 6.5});
+    REQUIRE(out[1].memory.used_bytes == 4ull << 30);
+    REQUIRE(out[1].disks.size() == 1);
+    REQUIRE(out[1].disks[0].mount_point == "/var");
+    REQUIRE(out[1].disks[0].seconds_to_full == 7200.0);
+    REQUIRE(out[1].network[0].interface_name == "eth0");
+    REQUIRE(out[1].network[0].bytes_received == 1002000);
+    REQUIRE(out[1].network[0].download_mbps == 12.345);
+
+    REQUIRE(out[2].disks.empty());
+    REQUIRE(out[2].cpu.overall_usage == 50.0);
+    REQUIRE(out[2].network[0].bytes_sent == 1004000 / 4);
+
+    out.clear();
+    REQUIRE_FALSE(decoder.decode(std::string_view(batch).substr(0, batch.size() - 1), host, out));
+    REQUIRE_FALSE(decoder.decode("SMW0", host, out));
+}
+
+TEST_CASE("Binary batches carry scheduler, interrupts and disk growth", "[wire]") {
+    auto first = make_snapshot(1700000000000, 12.5, 1000000);
+    first.disks[0].growth_bytes_per_sec = 4096.0;
+    auto& sched = first.cpu.scheduler;
+    sched.available = true;
+    sched.context_switches_per_sec = 12345.5;
+    sched.interrupts_per_sec = 800.25;
+    sched.forks_per_sec = 3.0;
+    sched.procs_running = 5;
+    sched.procs_blocked = 2;
+    sched.threads = 812;
+    sched.run_queue_per_core = 1.5;
+    sched.load1 = 2.75;
+    sched.load15 = 0.5;
+    auto& irq = first.cpu.interrupts;
+    irq.available = true;
+    irq.irq_per_cpu = {900.0, 100.0};
+    irq.softirq_per_cpu = {50.0, 25.5};
+    irq.net_softirq_per_cpu = {40.0, 0.0};
+    irq.irq_total = 1000.0;
+    irq.softirq_total = 75.5;
+    irq.net_softirq_total = 40.0;
+    irq.imbalance = 1.8;
+    irq.busiest_cpu = 0;
+    auto second = first;
+    second.wall_time += std::chrono::seconds(1);
+    second.cpu.scheduler.available = false;
+    second.cpu.interrupts.irq_per_cpu.clear();
+    auto third = first;
+    third.wall_time += std::chrono::seconds(2);
+
+    sysmon::WireEncoder encoder;
+    std::string batch;
+    encoder.begin(batch, "web-1");
+    for (const auto& snapshot : {first, second, third}) {
+        encoder.append(batch, snapshot);
+    }
+
+    sysmon::WireDecoder decoder;
+    std::string host;
+    std::vector<sysmon::MetricSnapshot> out;
+    REQUIRE(decoder.decode(batch, host, out));
+    REQUIRE(out.size() == 3);
+
+    for (size_t i : {size_t{0}, size_t{2}}) {
+        REQUIRE(out[i].disks[0].growth_bytes_per_sec == 4096.0);
+        const auto& s = out[i].cpu.scheduler;
+        REQUIRE(s.available);
+        REQUIRE(s.context_switches_per_sec == 12345.5);
+        REQUIRE(s.interrupts_per_sec == 800.25);
+        REQUIRE(s.forks_per_sec == 3.0);
+        REQUIRE(s.procs_running == 5);
+        REQUIRE(s.procs_blocked == 2);
+        REQUIRE(s.threads == 812);
+        REQUIRE(s.run_queue_per_core == 1.5);
+        REQUIRE(s.load1 == 2.75);
+        REQUIRE(s.load15 == 0.5);
+        const auto& q = out[i].cpu.interrupts;
+        REQUIRE(q.available);
+        REQUIRE(q.irq_per_cpu == std::vector<double>{900.0, 100.0});
+        REQUIRE(q.softirq_per_cpu == std::vector<double>{50.0, 25.5});
+        REQUIRE(q.net_softirq_per_cpu == std::vector<double>{40.0, 0.0});
+        REQUIRE(q.softirq_total == 75.5);
+        REQUIRE(q.imbalance == 1.8);
+        REQUIRE(q.busiest_cpu == 0);
+    }
+
+    // Absent sections read back as unavailable, without disturbing the deltas
+    REQUIRE_FALSE(out[1].cpu.scheduler.available);
+    REQUIRE(out[1].cpu.scheduler.threads == 0);
+    REQUIRE(out[1].cpu.interrupts.available);
+    REQUIRE(out[1].cpu.interrupts.irq_total == 1000.0);
+    REQUIRE(out[1].cpu.interrupts.irq_per_cpu.empty());
+}
+
+TEST_CASE("Version 1 batches still decode", "[wire]") {
+    // One frame: 1 s after the epoch, no cores or entities, cpu 5%, no
+    // memory, in the layout that predates the optional sections
+    std::string batch("SMW1\x01h", 6);
+    sysmon::put_varint(batch, sysmon::zigzag(1000));
+    batch.push_back(1);
+    batch.append(3, '\0');
+    sysmon::put_varint(batch, sysmon::zigzag(500));
+    batch.append(7, '\0');
+
+    sysmon::WireDecoder decoder;
+    std::string host;
+    std::vector<sysmon::MetricSnapshot> out;
+    REQUIRE(decoder.decode(batch, host, out));
+    REQUIRE(host == "h");
+    REQUIRE(out.size() == 1);
+    REQUIRE(out[0].cpu.overall_usage == 5.0);
+    REQUIRE_FALSE(out[0].cpu.scheduler.available);
+
+    batch[8] = 3;   // optional sections are not part of version 1
+    REQUIRE_FALSE(decoder.decode(batch, host, out));
+}
+
+TEST_CASE("Line protocol escapes tags", "[wire]") {
+    auto snapshot = make_snapshot(1000, 10.0, 5);
+    snapshot.disks[0].mount_point = "/mnt/my disk";
+
+    std::string out;
+    sysmon::append_line_protocol(out, "web,1", snapshot);
+    REQUIRE(out.find("sysmon_cpu,host=web\\,1 usage=10,iowait=1.25 1000000000\n") != std::string::npos);
+    REQUIRE(out.find("sysmon_disk,host=web\\,1,mount=/mnt/my\\ disk total_bytes=") != std::string::npos);
+    REQUIRE(out.find("sysmon_net,host=web\\,1,interface=eth0 rx_bytes=5u,") != std::string::npos);
+}
+
+TEST_CASE("Push messages carry format, codec and sizes", "[wire]") {
+    std::string raw(4096, 'x');
+    for (auto codec : {sysmon::Codec::None, sysmon::Codec::Zstd, sysmon::Codec::Lz4, sysmon::Codec::Zlib}) {
+        if (!sysmon::codec_available(codec)) {
+            continue;
+        }
+        std::string message;
+        REQUIRE(sysmon::encode_push_message(message, sysmon::WireFormat::LineProtocol, codec, raw));
+
+        sysmon::PushHeader header;
+        REQUIRE(sysmon::parse_push_header(message.data(), message.size(), header));
+        REQUIRE(header.format == sysmon::WireFormat::LineProtocol);
+        REQUIRE(header.codec == codec);
+        REQUIRE(header.raw_size == raw.size());
+        REQUIRE(header.payload_size == message.size() - sysmon::kPushHeaderSize);
+        if (codec != sysmon::Codec::None) {
+            REQUIRE(header.payload_size < raw.size());
+        }
+
+        std::string decoded;
+        REQUIRE(sysmon::decompress_block(codec, std::string_view(message).substr(sysmon::kPushHeaderSize),
+                                         header.raw_size, decoded));
+        REQUIRE(decoded == raw);
+    }
+
+    sysmon::PushHeader header;
+    REQUIRE_FALSE(sysmon::parse_push_header("SMPB", 4, header));
+}
@@ -0,0 +1,241 @@
+// sysmon-logcat: decode and filter structured sysmon alert logs
+// (alerts.log_format: jsonl or binary) in a single streaming pass.
+#include "sysmon/alert_engine.hpp"
+#include "sysmon/alert_log_format.hpp"
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Filter {
+    bool has_level = false;
+    sysmon::AlertLevel min_level;
+    std::string category;
+    std::string entity_prefix;
+    int64_t since_us = INT64_MIN;
+    int64_t until_us = INT64_MAX;
+
+    bool accepts(const sysmon::AlertLogEntry& e) const {
+        if (has_level && static_cast<int>(e.level) < static_cast<int>(min_level)) return false;
+        if (!category.empty() && e.category != category) return false;
+        if (!entity_prefix.empty() && e.entity.substr(0, entity_prefix.size()) != entity_prefix) return false;
+        return e.timestamp_us >= since_us && e.timestamp_us < until_us;
+    }
+};
+
+struct Output {
+    sysmon::LogFormat format = sysmon::LogFormat::Text;
+    bool count_only = false;
+    uint64_t matched = 0;
+    std::string buffer;
+    sysmon::TimestampFormatter timestamps;
+
+    void emit(const sysmon::AlertLogEntry& entry) {
+        ++matched;
+        if (count_only) {
+            return;
+        }
+        switch (format) {
+            case sysmon::LogFormat::Text:      sysmon::append_text(buffer, entry, timestamps); break;
+            case sysmon::LogFormat::JsonLines: sysmon::append_jsonl(buffer, entry); break;
+            case sysmon::LogFormat::Binary:    sysmon::append_binary(buffer, entry); break;
+        }
+        if (buffer.size() >= (1 << 20)) {
+            flush();
+        }
+    }
+
+    void flush() {
+        std::fwrite(buffer.data(), 1, buffer.size(), stdout);
+        buffer.clear();
+    }
+};
+
+constexpr size_t kChunkSize = 1 << 20;
+
+bool process_stream(std::FILE* in, const std::string& name, const Filter& filter, Output& out) {
+    std::vector<char> buf(kChunkSize * 2);
+    size_t have = std::fread(buf.data(), 1, kChunkSize, in);
+    size_t pos = 0;
+
+    bool binary = sysmon::has_binary_log_magic(buf.data(), have);
+    if (binary) {
+        pos = sizeof(sysmon::kBinaryLogMagic);
+    }
+
+    sysmon::AlertLogEntry entry;
+    std::string scratch;
+    uint64_t bad = 0;
+
+    for (;;) {
+        // Decode every complete record in [pos, have)
+        for (;;) {
+            if (binary) {
+                size_t used = sysmon::decode_binary(buf.data() + pos, have - pos, entry);
+                if (used == 0) break;
+                if (used == SIZE_MAX) {
+                    std::cerr << name << ": corrupt binary record at offset " << pos << ", stopping\n";
+                    return false;
+                }
+                if (filter.accepts(entry)) out.emit(entry);
+                pos += used;
+            } else {
+                const char* start = buf.data() + pos;
+                const char* nl = static_cast<const char*>(std::memchr(start, '\n', have - pos));
+                if (!nl) break;
+                std::string_view line(start, nl - start);
+                if (!line.empty()) {
+                    if (sysmon::decode_jsonl(line, entry, scratch)) {
+                        if (filter.accepts(entry)) out.emit(entry);
+                    } else {
+                        ++bad;
+                    }
+                }
+                pos += line.size() + 1;
+            }
+        }
+
+        // Keep the partial record and refill
+        size_t rest = have - pos;
+        if (rest > kChunkSize) {
+            std::cerr << name << ": record larger than buffer\n";
+            return false;
+        }
+        std::memmove(buf.data(), buf.data() + pos, rest);
+        pos = 0;
+        size_t n = std::fread(buf.data() + rest, 1, kChunkSize, in);
+        have = rest + n;
+        if (n == 0) {
+            if (!binary && rest > 0) {
+                // Last line without trailing newline
+                if (sysmon::decode_jsonl(std::string_view(buf.data(), rest), entry, scratch)) {
+                    if (filter.accepts(entry)) out.emit(entry);
+                } else {
+                    ++bad;
+                }
+            } else if (rest > 0) {
+                std::cerr << name << ": truncated final record\n";
+            }
+            break;
+        }
+    }
+
+    if (bad > 0) {
+        std::cerr << name << ": skipped " << bad << " unparseable line(s)\n";
+    }
+    return true;
+}
+
+void print_usage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " [options] [file...]\n";
+    std::cout << "\n";
+    std::cout << "Decodes sysmon alert logs written with alerts.log_format jsonl or binary.\n";
+    std::cout << "The input format is detected per file; '-' or no file reads stdin.\n";
+    std::cout << "\n";
+    std::cout << "Options:\n";
+    std::cout << "  -f, --format FMT     Output format: text (default), jsonl, binary\n";
+    std::cout << "  -l, --level LEVEL    Minimum level: warning, critical\n";
+    std::cout << "  -c, --category NAME  Only this category (CPU, Memory, Disk, Rule, ...)\n";
+    std::cout << "  -e, --entity PREFIX  Only entities starting with PREFIX\n";
+    std::cout << "      --since SECONDS  Only entries at or after this Unix time\n";
+    std::cout << "      --until SECONDS  Only entries before this Unix time\n";
+    std::cout << "      --count          Print the number of matching entries\n";
+    std::cout << "  -h, --help           Show this help message\n";
+    std::cout << "\n";
+}
+
+// Unix seconds to microseconds; rejects trailing junk and values that
+// would overflow the conversion
+bool parse_epoch_seconds(const std::string& text, int64_t& out_us) {
+    int64_t seconds = 0;
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), seconds);
+    if (ec != std::errc() || end != text.data() + text.size() || text.empty() ||
+        seconds > INT64_MAX / 1000000 || seconds < INT64_MIN / 1000000) {
+        return false;
+    }
+    out_us = seconds * 1000000;
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Filter filter;
+    Output out;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << "\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "-h" || arg == "--help") {
+            print_usage(argv[0]);
+            return 0;
+        } else if (arg == "-f" || arg == "--format") {
+            if (!sysmon::parse_log_format(value(), out.format)) {
+                std::cerr << "Unknown output format\n";
+                return 2;
+            }
+        } else if (arg == "-l" || arg == "--level") {
+            if (!sysmon::parse_log_level(value(), filter.min_level)) {
+                std::cerr << "Unknown level\n";
+                return 2;
+            }
+            filter.has_level = true;
+        } else if (arg == "-c" || arg == "--category") {
+            filter.category = value();
+        } else if (arg == "-e" || arg == "--entity") {
+            filter.entity_prefix = value();
+        } else if (arg == "--since" || arg == "--until") {
+            std::string text = value();
+            if (!parse_epoch_seconds(text, arg == "--since" ? filter.since_us : filter.until_us)) {
+                std::cerr << "Invalid " << arg << " '" << text << "' (expected Unix seconds)\n";
+                return 2;
+            }
+        } else if (arg == "--count") {
+            out.count_only = true;
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.empty()) {
+        files.push_back("-");
+    }
+
+    if (out.format == sysmon::LogFormat::Binary && !out.count_only) {
+        out.buffer.append(sysmon::kBinaryLogMagic, sizeof(sysmon::kBinaryLogMagic));
+    }
+
+    bool ok = true;
+    for (const auto& file : files) {
+        std::FILE* in = file == "-" ? stdin : std::fopen(file.c_str(), "rb");
+        if (!in) {
+            std::cerr << "Cannot open " << file << "\n";
+            ok = false;
+            continue;
+        }
+        ok = process_stream(in, file, filter, out) && ok;
+        if (in != stdin) {
+            std::fclose(in);
+        }
+    }
+
+    if (out.count_only) {
+        std::cout << out.matched << "\n";
+    } else {
+        out.flush();
+    }
+    return ok ? 0 : 1;
+}